@@ -18,17 +18,20 @@
 ///
 /// \file This file defines a base class template for directed graphs.
 ///
+/// The nodes and edges of a graph are allocated from an arena owned by the
+/// graph, and the adjacency lists of each node keep their first few edges
+/// inline. Removing a node or edge runs its destructor, but its memory is
+/// only released when the graph itself is destroyed.
+///
 //===----------------------------------------------------------------------===//
 #ifndef GAZER_ADT_GRAPH_H
 #define GAZER_ADT_GRAPH_H
 
-#include "gazer/ADT/Iterator.h"
-
 #include <llvm/ADT/GraphTraits.h>
 #include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/iterator_range.h>
-
-#include <boost/iterator/indirect_iterator.hpp>
+#include <llvm/Support/Allocator.h>
 
 #include <vector>
 #include <memory>
@@ -42,7 +45,8 @@ class Graph;
 template<class NodeTy, class EdgeTy>
 class GraphNode
 {
-    using EdgeVectorTy = std::vector<EdgeTy*>;
+    // Most nodes have only one or two incoming and outgoing edges.
+    using EdgeVectorTy = llvm::SmallVector<EdgeTy*, 2>;
     friend class Graph<NodeTy, EdgeTy>;
 public:
     // Iterator support
@@ -80,23 +84,40 @@ protected:
     void addIncoming(EdgeTy* edge)
     {
         assert(edge->getTarget() == this);
+        edge->mTargetPos = mIncoming.size();
         mIncoming.emplace_back(edge);
     }
 
     void addOutgoing(EdgeTy* edge)
     {
         assert(edge->getSource() == this);
+        edge->mSourcePos = mOutgoing.size();
         mOutgoing.emplace_back(edge);
     }
 
+    // Edges know their position within the adjacency lists of their endpoints,
+    // thus they can be removed in constant time by moving the last edge of the
+    // list into their place. Note that this does not preserve the edge order.
     void removeIncoming(EdgeTy* edge)
     {
-        mIncoming.erase(std::remove(mIncoming.begin(), mIncoming.end(), edge), mIncoming.end());
+        unsigned pos = edge->mTargetPos;
+        assert(pos < mIncoming.size() && mIncoming[pos] == edge);
+
+        EdgeTy* last = mIncoming.back();
+        mIncoming[pos] = last;
+        last->mTargetPos = pos;
+        mIncoming.pop_back();
     }
 
     void removeOutgoing(EdgeTy* edge)
     {
-        mOutgoing.erase(std::remove(mOutgoing.begin(), mOutgoing.end(), edge), mOutgoing.end());
+        unsigned pos = edge->mSourcePos;
+        assert(pos < mOutgoing.size() && mOutgoing[pos] == edge);
+
+        EdgeTy* last = mOutgoing.back();
+        mOutgoing[pos] = last;
+        last->mSourcePos = pos;
+        mOutgoing.pop_back();
     }
 
 private:
@@ -108,6 +129,7 @@ template<class NodeTy, class EdgeTy>
 class GraphEdge
 {
     friend class Graph<NodeTy, EdgeTy>;
+    friend class GraphNode<NodeTy, EdgeTy>;
 public:
     GraphEdge(NodeTy* source, NodeTy* target)
         : mSource(source), mTarget(target)
@@ -119,6 +141,11 @@ public:
 private:
     NodeTy* mSource;
     NodeTy* mTarget;
+
+    // The index of this edge in the outgoing list of its source and
+    // in the incoming list of its target.
+    unsigned mSourcePos = 0;
+    unsigned mTargetPos = 0;
 };
 
 /// Represents a graph with a list of nodes and edges.
@@ -128,12 +155,17 @@ class Graph
     static_assert(std::is_base_of_v<GraphNode<NodeTy, EdgeTy>, NodeTy>, "");
     static_assert(std::is_base_of_v<GraphEdge<NodeTy, EdgeTy>, EdgeTy>, "");
 
-    using NodeVectorTy = std::vector<std::unique_ptr<NodeTy>>;
-    using EdgeVectorTy = std::vector<std::unique_ptr<EdgeTy>>;
+    using NodeVectorTy = std::vector<NodeTy*>;
+    using EdgeVectorTy = std::vector<EdgeTy*>;
 
 public:
-    using node_iterator = SmartPtrGetIterator<typename NodeVectorTy::iterator>;
-    using const_node_iterator = SmartPtrGetIterator<typename NodeVectorTy::const_iterator>;
+    Graph() = default;
+
+    Graph(const Graph&) = delete;
+    Graph& operator=(const Graph&) = delete;
+
+    using node_iterator = typename NodeVectorTy::iterator;
+    using const_node_iterator = typename NodeVectorTy::const_iterator;
 
     node_iterator node_begin() { return mNodes.begin(); }
     node_iterator node_end() { return mNodes.end(); }
@@ -148,8 +180,8 @@ public:
         return llvm::make_range(node_begin(), node_end());
     }
 
-    using edge_iterator = SmartPtrGetIterator<typename EdgeVectorTy::iterator>;
-    using const_edge_iterator = SmartPtrGetIterator<typename EdgeVectorTy::const_iterator>;
+    using edge_iterator = typename EdgeVectorTy::iterator;
+    using const_edge_iterator = typename EdgeVectorTy::const_iterator;
 
     edge_iterator edge_begin() { return mEdges.begin(); }
     edge_iterator edge_end() { return mEdges.end(); }
@@ -166,23 +198,49 @@ public:
     size_t node_size() const { return mNodes.size(); }
     size_t edge_size() const { return mEdges.size(); }
 
+    ~Graph()
+    {
+        for (EdgeTy* edge : mEdges) {
+            edge->~EdgeTy();
+        }
+
+        for (NodeTy* node : mNodes) {
+            node->~NodeTy();
+        }
+    }
+
 protected:
+    /// Removes all incident edges of \p node. The removed edges are left in
+    /// the graph as tombstones until the next call to clearDisconnectedElements().
+    /// The cost is linear in the degree of \p node.
     void disconnectNode(NodeTy* node)
     {
         for (EdgeTy* edge : node->incoming()) {
             edge->mTarget = nullptr;
-            edge->mSource->removeOutgoing(edge);
+            if (edge->mSource != node) {
+                edge->mSource->removeOutgoing(edge);
+            }
+            edge->mSource = nullptr;
         }
 
         for (EdgeTy* edge : node->outgoing()) {
+            if (edge->mSource == nullptr) {
+                // A self-loop, which was already handled above.
+                continue;
+            }
             edge->mSource = nullptr;
             edge->mTarget->removeIncoming(edge);
+            edge->mTarget = nullptr;
         }
 
         node->mIncoming.clear();
         node->mOutgoing.clear();
+        ++mNumRemoved;
     }
 
+    /// Removes \p edge from the adjacency lists of its endpoints in constant
+    /// time. The edge is left in the graph as a tombstone until the next call
+    /// to clearDisconnectedElements().
     void disconnectEdge(EdgeTy* edge)
     {
         edge->mSource->removeOutgoing(edge);
@@ -190,55 +248,101 @@ protected:
 
         edge->mSource = nullptr;
         edge->mTarget = nullptr;
+        ++mNumRemoved;
     }
 
     void clearDisconnectedElements()
     {
-        mNodes.erase(llvm::remove_if(mNodes, [](auto& node) {
-            return node->mIncoming.empty() && node->mOutgoing.empty();
-        }), mNodes.end());
-        mEdges.erase(llvm::remove_if(mEdges, [](auto& edge) {
-            return edge->mSource == nullptr || edge->mTarget == nullptr;
-        }), mEdges.end());
+        this->clearDisconnectedElements([](NodeTy*) { return false; });
     }
 
-    template<class... Args>
-    NodeTy* createNode(Args&&... args)
+    /// Removes the disconnected nodes and edges of the graph, except the
+    /// nodes for which \p keep returns true. The tombstones left by the
+    /// removals since the last call are compacted in a single pass over the
+    /// nodes and edges, keeping the relative order of the surviving elements.
+    /// If nothing was disconnected since the last call, this is a no-op.
+    template<class Predicate>
+    void clearDisconnectedElements(Predicate keep)
     {
-        auto& ptr = mNodes.emplace_back(std::make_unique<NodeTy>(std::forward<Args...>(args...)));
-        return &*ptr;
+        if (mNumRemoved == 0) {
+            return;
+        }
+
+        compact(mNodes, [&keep](NodeTy* node) {
+            return node->mIncoming.empty() && node->mOutgoing.empty() && !keep(node);
+        });
+        compact(mEdges, [](EdgeTy* edge) {
+            return edge->mSource == nullptr;
+        });
+        mNumRemoved = 0;
     }
 
+    /// Returns true if the graph contains tombstones which were not yet
+    /// removed by clearDisconnectedElements().
+    bool hasDisconnectedElements() const { return mNumRemoved != 0; }
+
+    /// Returns uninitialized memory for \p num objects of type \p T from the
+    /// arena of this graph. Derived classes may use this to construct their
+    /// nodes and edges, and any other data which lives as long as the graph.
+    template<class T>
+    T* allocate(size_t num = 1) { return mAllocator.Allocate<T>(num); }
+
     template<class... Args>
-    EdgeTy* createEdge(NodeTy* source, NodeTy* target)
+    NodeTy* createNode(Args&&... args)
     {
-        auto& edge = mEdges.emplace_back(std::make_unique<EdgeTy>(source, target));
-        
-        static_cast<GraphNode<NodeTy, EdgeTy>*>(source)->mOutgoing.emplace_back(&*edge);
-        static_cast<GraphNode<NodeTy, EdgeTy>*>(target)->mIncoming.emplace_back(&*edge);
+        NodeTy* node = new (this->allocate<NodeTy>()) NodeTy(std::forward<Args>(args)...);
+        mNodes.push_back(node);
 
-        return &*edge;
+        return node;
     }
 
     template<class... Args>
-    EdgeTy* createEdge(GraphNode<NodeTy, EdgeTy>* source, GraphNode<NodeTy, EdgeTy>* target, Args&&... args)
+    EdgeTy* createEdge(NodeTy* source, NodeTy* target, Args&&... args)
     {
-        auto& edge = mEdges.emplace_back(std::make_unique<EdgeTy>(
-            source, target, std::forward<Args...>(args...)
-        ));
-        
-        source->mOutgoing.emplace_back(&*edge);
-        target->mIncoming.emplace_back(&*edge);
+        EdgeTy* edge = new (this->allocate<EdgeTy>()) EdgeTy(source, target, std::forward<Args>(args)...);
+        this->addEdge(edge);
 
-        return &*edge;
+        return edge;
     }
 
+    /// Adds a node constructed in the arena of this graph.
     void addNode(NodeTy* node) { mNodes.push_back(node); }
-    void addEdge(EdgeTy* edge) { mEdges.push_back(edge); }
+
+    /// Adds an edge constructed in the arena of this graph, and inserts it
+    /// into the adjacency lists of its source and target.
+    void addEdge(EdgeTy* edge)
+    {
+        mEdges.push_back(edge);
+        static_cast<GraphNode<NodeTy, EdgeTy>*>(edge->mSource)->addOutgoing(edge);
+        static_cast<GraphNode<NodeTy, EdgeTy>*>(edge->mTarget)->addIncoming(edge);
+    }
+
+private:
+    /// Destroys the elements of \p vec matching \p pred, and moves the
+    /// remaining ones to the front of the vector, keeping their order.
+    template<class T, class Predicate>
+    static void compact(std::vector<T*>& vec, Predicate pred)
+    {
+        auto out = vec.begin();
+        for (T* elem : vec) {
+            if (pred(elem)) {
+                elem->~T();
+            } else {
+                *out++ = elem;
+            }
+        }
+        vec.erase(out, vec.end());
+    }
 
 protected:
     NodeVectorTy mNodes;
     EdgeVectorTy mEdges;
+
+private:
+    llvm::BumpPtrAllocator mAllocator;
+
+    // The number of removals since the last compaction.
+    size_t mNumRemoved = 0;
 };
 
 } // namespace gazer
@@ -26,6 +26,7 @@
 #include "gazer/Core/Expr.h"
 #include "gazer/ADT/Graph.h"
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/GraphTraits.h>
 #include <llvm/ADT/DenseMap.h>
 #include <boost/iterator/indirect_iterator.hpp>
@@ -102,24 +103,25 @@ class AssignTransition final : public Transition
 {
     friend class Cfa;
 protected:
-    AssignTransition(Location* source, Location* target, ExprPtr guard, std::vector<VariableAssignment> assignments);
+    AssignTransition(
+        Location* source, Location* target, ExprPtr guard, llvm::MutableArrayRef<VariableAssignment> assignments);
 
 public:
-    using iterator = std::vector<VariableAssignment>::const_iterator;
+    using iterator = const VariableAssignment*;
     iterator begin() const { return mAssignments.begin(); }
     iterator end() const { return mAssignments.end(); }
 
     size_t getNumAssignments() const { return mAssignments.size(); }
-    void addAssignment(VariableAssignment assignment) {
-        mAssignments.push_back(assignment);
-    }
 
     static bool classof(const Transition* edge) {
         return edge->getKind() == Edge_Assign;
     }
 
+    ~AssignTransition() override;
+
 private:
-    std::vector<VariableAssignment> mAssignments;
+    /// The assignments are stored in the arena of the parent automaton.
+    llvm::MutableArrayRef<VariableAssignment> mAssignments;
 };
 
 /// Represents a (potentially guarded) transition with a procedure call.
@@ -131,16 +133,16 @@ protected:
         Location* source, Location* target,
         ExprPtr guard,
         Cfa* callee,
-        std::vector<VariableAssignment> inputArgs,
-        std::vector<VariableAssignment> outputArgs
+        llvm::MutableArrayRef<VariableAssignment> inputArgs,
+        llvm::MutableArrayRef<VariableAssignment> outputArgs
     );
 
 public:
     Cfa* getCalledAutomaton() const { return mCallee; }
 
     //-------------------------- Iterator support ---------------------------//
-    using input_arg_iterator  = std::vector<VariableAssignment>::const_iterator;
-    using output_arg_iterator = std::vector<VariableAssignment>::const_iterator;
+    using input_arg_iterator  = const VariableAssignment*;
+    using output_arg_iterator = const VariableAssignment*;
 
     input_arg_iterator input_begin() const { return mInputArgs.begin(); }
     input_arg_iterator input_end() const { return mInputArgs.end(); }
@@ -163,10 +165,12 @@ public:
         return edge->getKind() == Edge_Call;
     }
 
+    ~CallTransition() override;
+
 private:
     Cfa* mCallee;
-    std::vector<VariableAssignment> mInputArgs;
-    std::vector<VariableAssignment> mOutputArgs;
+    llvm::MutableArrayRef<VariableAssignment> mInputArgs;
+    llvm::MutableArrayRef<VariableAssignment> mOutputArgs;
 };
 
 class AutomataSystem;
@@ -217,6 +221,11 @@ public:
     /// Marks an already existing variable as an output.
     void addOutput(Variable* variable);
 
+    /// Creates a new variable of the given type which takes the place of
+    /// \p variable in the input, output and local lists of this automaton.
+    /// Note that the uses of the old variable are not updated.
+    Variable* replaceVariable(Variable* variable, Type& type);
+
     void addErrorCode(Location* location, ExprPtr errorCodeExpr);
     ExprPtr getErrorFieldExpr(Location* location);
 
@@ -302,14 +311,41 @@ public:
         );
     }
 
+    /// Removes the inputs and outputs matching the given predicate.
+    /// Note that the call transitions calling this automaton are not updated,
+    /// they must be recreated with the new argument lists.
+    template<class Predicate>
+    void removeInputsIf(Predicate p) {
+        mInputs.erase(
+            std::remove_if(mInputs.begin(), mInputs.end(), p),
+            mInputs.end()
+        );
+    }
+
+    template<class Predicate>
+    void removeOutputsIf(Predicate p) {
+        mOutputs.erase(
+            std::remove_if(mOutputs.begin(), mOutputs.end(), p),
+            mOutputs.end()
+        );
+    }
+
     using Graph::disconnectNode;
     using Graph::disconnectEdge;
-    using Graph::clearDisconnectedElements;
+
+    /// Removes the disconnected locations and edges of this automaton.
+    /// The entry and exit locations are always kept, and removed error
+    /// locations are also removed from the error code mapping.
+    void clearDisconnectedElements();
 
     ~Cfa();
 
 private:
     Variable* createMemberVariable(const std::string& name, Type& type);
+
+    /// Copies \p assignments into the arena of this automaton.
+    llvm::MutableArrayRef<VariableAssignment> copyAssignments(llvm::ArrayRef<VariableAssignment> assignments);
+
     Variable* findVariableByName(const std::vector<Variable*>& vec, llvm::StringRef name) const;
 
 private:
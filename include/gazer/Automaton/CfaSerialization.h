@@ -0,0 +1,82 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a compact binary format for automata systems.
+///
+/// The format stores the types, variables, locations, transitions and error
+/// codes of a system, along with its expressions as a DAG: shared nodes are
+/// written only once. Expressions are stored in a table with a fixed-width
+/// offset index, thus the reader may work on a memory-mapped file directly,
+/// materializing each expression into the target context only when it is
+/// first referenced.
+///
+/// The mapping between the automata and the original LLVM module is not
+/// stored, as it refers to the module itself. Systems loaded from a file
+/// cannot be used to build LLVM-level error traces.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_CFASERIALIZATION_H
+#define GAZER_AUTOMATON_CFASERIALIZATION_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <map>
+
+namespace gazer
+{
+
+/// Writes \p system into \p os in the binary format. The optional \p messages
+/// table maps error codes to their descriptions, so that the verdicts on the
+/// loaded system may be reported without the frontend which created them.
+void WriteAutomataSystem(
+    AutomataSystem& system,
+    llvm::raw_ostream& os,
+    const std::map<unsigned, std::string>& messages = {}
+);
+
+struct SerializedAutomataSystem
+{
+    /// The loaded system, or nullptr if the input was malformed.
+    std::unique_ptr<AutomataSystem> system;
+
+    /// Descriptions of the error codes, as supplied to the writer.
+    std::map<unsigned, std::string> messages;
+
+    /// The reason of the failure if the system could not be loaded.
+    std::string error;
+};
+
+/// Returns true if \p buffer starts with the header of the binary format.
+bool IsSerializedAutomataSystem(llvm::StringRef buffer);
+
+/// Returns true if the file at \p filename contains a serialized system.
+bool IsAutomataSystemFile(llvm::StringRef filename);
+
+/// Loads a system written by WriteAutomataSystem into \p context.
+/// The reader validates the structure of the input, but it assumes that the
+/// stored expressions are well-typed.
+SerializedAutomataSystem ReadAutomataSystem(llvm::MemoryBufferRef buffer, GazerContext& context);
+
+/// Memory-maps \p filename and loads the system stored in it into \p context.
+SerializedAutomataSystem ReadAutomataSystemFile(llvm::StringRef filename, GazerContext& context);
+
+} // end namespace gazer
+
+#endif
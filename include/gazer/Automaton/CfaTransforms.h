@@ -27,15 +27,46 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/ADT/DenseMap.h>
 
+#include <functional>
+
 namespace gazer
 {
 
+class ExprBuilder;
+
 //===----------------------------------------------------------------------===//
 /// Creates a clone of the given CFA with the given name.
 /// Note that the clone shall be shallow one: automata called by the source
 /// CFA shall be the same in the cloned one.
 Cfa* CloneAutomaton(Cfa* cfa, llvm::StringRef name);
 
+//===----------------------------------------------------------------------===//
+struct CloneSystemResult
+{
+    std::unique_ptr<AutomataSystem> system;
+
+    /// Maps the locations and variables of the clone to their originals.
+    llvm::DenseMap<Location*, Location*> locations;
+    llvm::DenseMap<Variable*, Variable*> variables;
+};
+
+/// Creates a deep copy of the given automata system in the given context,
+/// rebuilding each expression of the source system in \p context.
+/// As the clone shares no mutable state with the source, the two systems may
+/// be used by different threads if their contexts are different.
+CloneSystemResult CloneAutomataSystem(AutomataSystem& system, GazerContext& context);
+
+/// Translates a counterexample recorded on a cloned system back to the
+/// original one, whose expressions live in \p context. Variables and locations
+/// introduced into the clone after cloning have no counterpart in the original
+/// system: such assignments are dropped, and the actions leading to such
+/// locations are merged into the next step.
+void TranslateClonedTrace(
+    const CloneSystemResult& clone,
+    GazerContext& context,
+    std::vector<Location*>& states,
+    std::vector<std::vector<VariableAssignment>>& actions);
+
 
 //===----------------------------------------------------------------------===//
 struct RecursiveToCyclicResult
@@ -47,11 +78,105 @@ struct RecursiveToCyclicResult
 };
 
 /// Transforms the given recursive CFA into a cyclic one, by inlining all
-/// tail-recursive calls and adding latch edges.
+/// tail-recursive calls and adding latch edges. Mutually recursive automata
+/// are handled as well, if every call between them is a tail call which
+/// forwards the outputs of the callee: each automaton of such a component is
+/// inlined once per call site, and the calls between them are replaced with
+/// latch edges to the entry of the inlined callee, assigning its inputs.
+/// Calls to automata which do not call any other automaton are also inlined.
 /// Note that cyclic CFAs are non-canon, and should only be used if they are
 /// transformed into the input format of a different verifier.
 RecursiveToCyclicResult TransformRecursiveToCyclic(Cfa* cfa);
 
+//===----------------------------------------------------------------------===//
+/// Replaces the recursive loop automata of the given system which represent
+/// simple counting loops with a closed-form summary. The summary calculates the
+/// number of iterations into a new local variable, and only contains the last
+/// iteration of the loop, without any recursive calls.
+/// Returns the number of accelerated automata.
+unsigned AccelerateLoops(AutomataSystem& system);
+
+//===----------------------------------------------------------------------===//
+struct BitWidthReductionResult
+{
+    /// Maps each narrowed variable to an expression over its replacement,
+    /// which yields the value of the original variable.
+    llvm::DenseMap<Variable*, ExprPtr> replacements;
+
+    /// The total width of the bit-vector variables before and after the reduction.
+    unsigned originalBits = 0;
+    unsigned reducedBits = 0;
+};
+
+/// Replaces the bit-vector variables of the system whose values provably fit
+/// into fewer bits with narrower ones, inserting extensions and truncations
+/// where the narrowed values meet expressions of the original width.
+/// The analysis assumes that each local variable is assigned before it is
+/// read, which holds for automata translated from SSA form.
+BitWidthReductionResult ReduceBitWidths(AutomataSystem& system);
+
+//===----------------------------------------------------------------------===//
+struct DischargeResult
+{
+    /// The number of error locations before and after the transformation.
+    unsigned numErrors = 0;
+    unsigned numRemaining = 0;
+
+    unsigned getNumDischarged() const { return numErrors - numRemaining; }
+};
+
+/// Runs an interprocedural abstract interpretation on the system using the
+/// reduced product of the interval and congruence domains. Transitions which
+/// are proven infeasible are removed, along with the error locations which
+/// become unreachable and the locations which may only lead to those.
+/// The analysis assumes that each local variable is assigned before it is
+/// read, which holds for automata translated from SSA form.
+DischargeResult DischargeUnreachableErrors(AutomataSystem& system);
+
+/// Runs the abstract interpretation of DischargeUnreachableErrors without
+/// modifying the system, and returns the bounds and congruences it proves
+/// for the variables at each location. Unreachable locations are mapped to
+/// false, locations without any known facts are left out.
+llvm::DenseMap<Location*, ExprVector> ComputeLocationInvariants(AutomataSystem& system, ExprBuilder& builder);
+
+//===----------------------------------------------------------------------===//
+struct ConeOfInfluenceResult
+{
+    /// The total number of input and local variables before the reduction.
+    unsigned numVariables = 0;
+    unsigned numRemovedVariables = 0;
+
+    /// The number of removed assignments and call arguments.
+    unsigned numRemovedAssignments = 0;
+};
+
+/// Removes the variables of the system which cannot influence the guards of
+/// the transitions or the error codes, along with their assignments. Unused
+/// inputs and outputs are removed from the automata other than the main one,
+/// and the call transitions are updated accordingly.
+ConeOfInfluenceResult RemoveIrrelevantVariables(AutomataSystem& system);
+
+//===----------------------------------------------------------------------===//
+struct LargeBlockEncodingResult
+{
+    /// The total number of locations and transitions before and after the encoding.
+    unsigned originalLocations = 0;
+    unsigned remainingLocations = 0;
+    unsigned originalTransitions = 0;
+    unsigned remainingTransitions = 0;
+};
+
+/// Compacts the automata of the system using large-block encoding: chains of
+/// assign transitions are merged into a single transition, and parallel
+/// assign transitions with the same assignments are merged into one with a
+/// disjunctive guard. Locations for which \p keep returns true are never
+/// removed, along with the entry, exit and error locations.
+/// Guards composed by substitution may contain at most \p maxTermSize nodes.
+LargeBlockEncodingResult EncodeLargeBlocks(
+    AutomataSystem& system,
+    const std::function<bool(Location*)>& keep = nullptr,
+    unsigned maxTermSize = 64);
+
 //===----------------------------------------------------------------------===//
 struct InlineResult
 {
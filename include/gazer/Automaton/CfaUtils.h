@@ -20,6 +20,7 @@
 
 #include "gazer/Automaton/Cfa.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/PostOrderIterator.h>
 
@@ -44,28 +45,76 @@ void createTopologicalSort(Cfa& cfa, Seq& topoVec, Map* locNumbers = nullptr)
     }
 }
 
+/// Controls the shape of the formulas built by PathConditionCalculator.
+///
+/// The nested encoding is the default. On larger branching automata the
+/// reachability and block encodings are usually solved faster, but neither
+/// of them is consistently better than the other.
+enum class PathConditionEncoding
+{
+    /// The reachability condition of each location is inlined into the
+    /// conditions of its successors, forming a single nested formula.
+    Nested,
+
+    /// Each location gets a Boolean reachability variable, defined
+    /// by the reachability conditions of its predecessors.
+    Reachability,
+
+    /// Reachability variables are only introduced at the boundaries of
+    /// basic blocks, that is, at branches and join points. Conditions
+    /// within a block are inlined.
+    Block
+};
+
 /// Class for calculating verification path conditions.
+///
+/// If \p instantiate is set, every guard, assignment and call formula found
+/// on a transition is passed through it before being added to the path
+/// condition. This allows the same transitions to be encoded over different
+/// sets of variables, such as the steps of an unrolled transition relation.
 class PathConditionCalculator
 {
 public:
+    using InstantiateFn = std::function<ExprPtr(Transition*, const ExprPtr&)>;
+
     PathConditionCalculator(
         const std::vector<Location*>& topo,
         ExprBuilder& builder,
         std::function<size_t(Location*)> index,
         std::function<ExprPtr(CallTransition*)> calls,
-        std::function<void(Location*, ExprPtr)> preds = nullptr
+        std::function<void(Location*, ExprPtr)> preds = nullptr,
+        InstantiateFn instantiate = nullptr
     );
 
 public:
     ExprPtr encode(Location* source, Location* target);
 
+    void setEncoding(PathConditionEncoding encoding) { mEncoding = encoding; }
+
+private:
+    /// Returns true if the reachability condition of \p loc should be
+    /// replaced by a variable in the current encoding.
+    bool needsDefinition(Location* loc, size_t numPreds) const;
+
+    /// Returns the reachability variable of \p loc in regions starting
+    /// at \p source. The same variable is returned for every encoding of
+    /// the pair, so repeated queries do not grow the context. As each
+    /// encoding defines the variable again, callers must not keep two
+    /// encodings of overlapping regions with the same source asserted
+    /// at the same time, but pop the previous one first.
+    Variable* getReachVariable(Location* source, Location* loc);
+
 private:
     const std::vector<Location*>& mTopo;
     ExprBuilder& mExprBuilder;
     std::function<size_t(Location*)> mIndex;
     std::function<ExprPtr(CallTransition*)> mCalls;
     std::function<void(Location*, ExprPtr)> mPredecessors;
+    InstantiateFn mInstantiate;
+    PathConditionEncoding mEncoding = PathConditionEncoding::Nested;
     unsigned mPredIdx = 0;
+    unsigned mReachIdx = 0;
+    llvm::DenseMap<std::pair<Location*, Location*>, Variable*> mReachVariables;
 };
 
 /// Returns the lowest common dominator of each transition in \p targets.
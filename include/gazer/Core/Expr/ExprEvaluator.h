@@ -109,6 +109,13 @@ private:
     ExprRef<AtomicExpr> visitFIsNan(const ExprRef<FIsNanExpr>& expr);
     ExprRef<AtomicExpr> visitFIsInf(const ExprRef<FIsInfExpr>& expr);
 
+    // Floating-point casts
+    ExprRef<AtomicExpr> visitFCast(const ExprRef<FCastExpr>& expr);
+    ExprRef<AtomicExpr> visitSignedToFp(const ExprRef<SignedToFpExpr>& expr);
+    ExprRef<AtomicExpr> visitUnsignedToFp(const ExprRef<UnsignedToFpExpr>& expr);
+    ExprRef<AtomicExpr> visitFpToSigned(const ExprRef<FpToSignedExpr>& expr);
+    ExprRef<AtomicExpr> visitFpToUnsigned(const ExprRef<FpToUnsignedExpr>& expr);
+
     // Floating-point arithmetic
     ExprRef<AtomicExpr> visitFAdd(const ExprRef<FAddExpr>& expr);
     ExprRef<AtomicExpr> visitFSub(const ExprRef<FSubExpr>& expr);
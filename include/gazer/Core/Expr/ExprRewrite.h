@@ -80,6 +80,39 @@ private:
     llvm::DenseMap<Variable*, ExprPtr> mRewriteMap;
 };
 
+/// Rebuilds expressions of a different context in the context of the given
+/// builder. Each variable occurring in the imported expressions must be mapped
+/// to its counterpart in the target context using operator[].
+class ExprImporter : public ExprRewrite<ExprImporter>
+{
+    friend class ExprWalker<ExprImporter, ExprPtr>;
+public:
+    explicit ExprImporter(ExprBuilder& builder)
+        : ExprRewrite(builder)
+    {}
+
+    Variable*& operator[](Variable* variable);
+
+    /// Returns the type corresponding to \p type in the target context.
+    Type& importType(Type& type);
+
+    /// Returns the literal corresponding to \p expr in the target context.
+    ExprRef<LiteralExpr> importLiteral(const ExprRef<LiteralExpr>& expr);
+
+protected:
+    ExprPtr visitLiteral(const ExprRef<LiteralExpr>& expr) { return this->importLiteral(expr); }
+    ExprPtr visitUndef(const ExprRef<UndefExpr>& expr);
+    ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr);
+    ExprPtr visitNonNullary(const ExprRef<NonNullaryExpr>& expr);
+
+    bool shouldSkip(const ExprPtr& expr, ExprPtr* ret);
+    void handleResult(const ExprPtr& expr, ExprPtr& ret);
+
+private:
+    llvm::DenseMap<Variable*, Variable*> mVariableMap;
+    llvm::DenseMap<Expr*, std::pair<ExprPtr, ExprPtr>> mCache;
+};
+
 }
 
 #endif
@@ -66,6 +66,11 @@ public:
     virtual void push() = 0;
     virtual void pop() = 0;
 
+    /// Requests the termination of the currently running query, which shall
+    /// then return UNKNOWN. Unlike other methods, this one may be called from
+    /// a different thread than the one executing run().
+    virtual void interrupt() = 0;
+
     virtual ~Solver() = default;
 
 protected:
@@ -71,6 +71,8 @@ public:
     iterator find(const Variable* variable) { return mMap.find(variable); }
     const_iterator find(const Variable* variable) const { return mMap.find(variable); }
 
+    void erase(const Variable* variable) { mMap.erase(variable); }
+
     iterator begin() { return mMap.begin(); }
     iterator end() { return mMap.end(); }
     const_iterator begin() const { return mMap.begin(); }
@@ -66,6 +66,15 @@ protected:
         return nullptr;
     }
 
+    /// Returns true if the floating-point operation \p inst should be translated
+    /// with precise IEEE-754 semantics. Otherwise, transform() abstracts its
+    /// result into an undef value.
+    virtual bool isPreciseFloatOperation(const llvm::Instruction& inst);
+
+    /// Called when the result of \p inst was abstracted into an undef value.
+    /// The \p precise expression may be used to refine the abstraction later on.
+    virtual void abstractedFloatOperation(const llvm::Instruction& inst, const ExprPtr& precise) {}
+
 protected:
     ExprPtr visitBinaryOperator(const llvm::BinaryOperator& binop, Type& expectedType);
     ExprPtr visitSelectInst(const llvm::SelectInst& select, Type& expectedType);
@@ -23,6 +23,7 @@
 #include "gazer/LLVM/Memory/ValueOrMemoryObject.h"
 #include "gazer/LLVM/LLVMFrontendSettings.h"
 #include "gazer/LLVM/LLVMTraceBuilder.h"
+#include "gazer/Verifier/FloatRefinement.h"
 
 #include <llvm/Pass.h>
 
@@ -44,6 +45,7 @@ namespace gazer
 {
 
 class MemoryModel;
+class ExprBuilder;
 
 // Extension points
 //==------------------------------------------------------------------------==//
@@ -177,6 +179,10 @@ public:
     ExprPtr getExpressionForValue(const Cfa* parent, const llvm::Value* value);
     Variable* getVariableForValue(const Cfa* parent, const llvm::Value* value);
 
+    /// Rewrites the value mappings after the variables in \p replacements
+    /// were replaced by a CFA transformation.
+    void replaceVariables(const llvm::DenseMap<Variable*, ExprPtr>& replacements, ExprBuilder& builder);
+
 private:
     llvm::DenseMap<const Location*, BlockToLocationInfo> mLocationsToBlocks;
     llvm::DenseMap<const Cfa*, ValueMappingInfo> mValueMaps;
@@ -207,15 +213,20 @@ public:
     llvm::DenseMap<llvm::Value*, Variable*>& getVariableMap() { return mVariables; }
     CfaToLLVMTrace& getTraceInfo() { return mTraceInfo; }
 
+    /// Returns the floating-point operations abstracted into undef values.
+    std::vector<AbstractedOperation>& getAbstractedFloats() { return mAbstractedFloats; }
+
 private:
     std::unique_ptr<AutomataSystem> mSystem;
     llvm::DenseMap<llvm::Value*, Variable*> mVariables;
     CfaToLLVMTrace mTraceInfo;
+    std::vector<AbstractedOperation> mAbstractedFloats;
     GazerContext& mContext;
     LLVMFrontendSettings& mSettings;
 };
 
 class SpecialFunctions;
+class CheckRegistry;
 
 std::unique_ptr<AutomataSystem> translateModuleToAutomata(
     llvm::Module& module,
@@ -225,11 +236,17 @@ std::unique_ptr<AutomataSystem> translateModuleToAutomata(
     MemoryModel& memoryModel,
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
     CfaToLLVMTrace& blockEntries,
-    const SpecialFunctions* specialFunctions = nullptr
+    const SpecialFunctions* specialFunctions = nullptr,
+    std::vector<AbstractedOperation>* abstractedFloats = nullptr
 );
 
 llvm::Pass* createCfaPrinterPass();
 
+/// Creates a pass which writes the translated automata system into \p os in
+/// the binary format of CfaSerialization.h. If \p checks is present, the
+/// descriptions of the error codes of the system are written as well.
+llvm::Pass* createCfaWriterPass(llvm::raw_ostream& os, const CheckRegistry* checks = nullptr);
+
 llvm::Pass* createCfaViewerPass();
 
 }
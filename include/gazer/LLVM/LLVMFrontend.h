@@ -129,11 +129,14 @@ public:
 
     /// Sets the backend algorithm to be used in the verification process.
     /// The LLVMFrontend instance will take ownership of the backend object.
+    /// The description should identify every setting of the backend which
+    /// may influence its verdict, verdicts are only cached if it is set.
     /// Note: this function *must* be called before `registerVerificationPipeline`!
-    void setBackendAlgorithm(VerificationAlgorithm* backend)
+    void setBackendAlgorithm(VerificationAlgorithm* backend, std::string description = "")
     {
         assert(mBackendAlgorithm == nullptr && "Can register only one backend algorithm!");
         mBackendAlgorithm.reset(backend);
+        mBackendDescription = std::move(description);
     }
 
     /// Runs the registered LLVM pass pipeline.
@@ -160,10 +163,19 @@ private:
 
     LLVMFrontendSettings& mSettings;
     std::unique_ptr<VerificationAlgorithm> mBackendAlgorithm = nullptr; 
+    std::string mBackendDescription;
 
     std::unique_ptr<llvm::ToolOutputFile> mModuleOutput = nullptr;
 };
 
+/// Loads an automata system written by gazer-cfa and runs \p algorithm on it,
+/// skipping the LLVM frontend entirely. The verdict is printed in the same
+/// format as in the verification pipeline, but without an error trace, as the
+/// loaded system is not mapped to an LLVM module.
+/// \return False if the file could not be loaded.
+bool VerifyAutomataSystemFile(
+    llvm::StringRef filename, GazerContext& context, VerificationAlgorithm& algorithm, bool trace);
+
 }
 
 #endif
\ No newline at end of file
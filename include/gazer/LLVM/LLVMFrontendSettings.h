@@ -51,7 +51,8 @@ enum class FloatRepresentation
 {
     Fpa,        ///< Use floating-point bitvectors to represent floats.
     Real,       ///< Approximate floats using rational types.
-    Undef       ///< Use undef's for float operations.
+    Undef,      ///< Use undef's for float operations.
+    Refine      ///< Start with undef's, make operations precise on spurious counterexamples.
 };
 
 enum class LoopRepresentation
@@ -125,6 +126,11 @@ public:
     FloatRepresentation floats = FloatRepresentation::Fpa;
     bool simplifyExpr = true;
     bool strict = false;
+    bool accelerateLoops = false;
+    bool reduceBitWidths = false;
+    bool dischargeErrors = false;
+    bool coneOfInfluence = false;
+    bool largeBlockEncoding = false;
 
     std::string function = "main";
 
@@ -133,6 +139,10 @@ public:
     MemoryModelSetting memoryModel = MemoryModelSetting::Flat;
     EnumSet<ExternFuncGlobalBehavior> externFuncGlobals = ExternFuncGlobalBehavior::PointerArgModifies;
 
+    // Verdict cache
+    std::string verdictCache;
+    unsigned verdictCacheSize = 256;
+
 public:
     /// Returns true if the current settings can be applied to the given module.
     bool validate(const llvm::Module& module, llvm::raw_ostream& os) const;
@@ -143,6 +153,10 @@ public:
     bool isElimVarsNormal() const { return elimVars == ElimVarsLevel::Normal; }
     bool isElimVarsAggressive() const { return elimVars == ElimVarsLevel::Aggressive; }
 
+    /// Returns true if counterexamples must be built, either to print them or
+    /// to validate them during float refinement.
+    bool isTraceRequired() const { return trace || floats == FloatRepresentation::Refine; }
+
 public:
     static LLVMFrontendSettings initFromCommandLine();
     std::string toString() const;
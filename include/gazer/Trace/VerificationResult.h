@@ -20,6 +20,9 @@
 
 #include "gazer/Trace/Trace.h"
 #include <llvm/ADT/Twine.h>
+#include <llvm/ADT/iterator.h>
+
+#include <vector>
 
 namespace gazer
 {
@@ -75,6 +78,27 @@ public:
     [[nodiscard]] Trace& getTrace() const { return *mTrace; }
     [[nodiscard]] unsigned getErrorID() const { return mErrorID; }
 
+    /// Some verification algorithms (e.g. BMC in all-errors mode) may find
+    /// multiple distinct failures in a single run. The first one is described
+    /// by this object, the others are stored in the order they were found.
+    void addFailure(std::unique_ptr<FailResult> fail) {
+        assert(fail != nullptr);
+        mOtherFailures.push_back(std::move(fail));
+    }
+
+    using failure_iterator = llvm::pointee_iterator<
+        std::vector<std::unique_ptr<FailResult>>::const_iterator
+    >;
+    failure_iterator failure_begin() const { return failure_iterator(mOtherFailures.begin()); }
+    failure_iterator failure_end() const { return failure_iterator(mOtherFailures.end()); }
+
+    /// Returns the additional failures found during verification.
+    llvm::iterator_range<failure_iterator> other_failures() const {
+        return llvm::make_range(failure_begin(), failure_end());
+    }
+
+    [[nodiscard]] size_t getNumFailures() const { return mOtherFailures.size() + 1; }
+
     static bool classof(const VerificationResult* result) {
         return result->getStatus() == VerificationResult::Fail;
     }
@@ -82,6 +106,7 @@ public:
 private:
     unsigned mErrorID;
     std::unique_ptr<Trace> mTrace;
+    std::vector<std::unique_ptr<FailResult>> mOtherFailures;
 };
 
 } // end namespace gazer
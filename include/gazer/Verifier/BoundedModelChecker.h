@@ -24,6 +24,7 @@
 #define GAZER_VERIFIER_BOUNDEDMODELCHECKER_H
 
 #include "gazer/Verifier/VerificationAlgorithm.h"
+#include "gazer/Automaton/CfaUtils.h"
 
 namespace gazer
 {
@@ -32,6 +33,13 @@ class Location;
 class SolverFactory;
 class AutomataSystem;
 
+/// Controls which open calls of a counterexample are inlined first.
+enum class BmcInlineStrategy
+{
+    CexOrder,   ///< Keep the unranked order, the last call found in the counterexample goes first.
+    CostModel   ///< Rank calls by callee size, depth and frequency in counterexamples.
+};
+
 struct BmcSettings
 {
     // Environment
@@ -49,6 +57,42 @@ struct BmcSettings
     unsigned maxBound;
     unsigned eagerUnroll;
     bool simplifyExpr;
+
+    /// The shape of the path condition formulas passed to the solver.
+    PathConditionEncoding encoding;
+
+    // Inlining heuristics
+    BmcInlineStrategy inlineStrategy;
+
+    /// The maximum number of calls to inline in one step, zero means unlimited.
+    unsigned inlineBudget;
+
+    /// Weights of the cost model, used with BmcInlineStrategy::CostModel.
+    double inlineSizeWeight;
+    double inlineDepthWeight;
+    double inlineFrequencyWeight;
+
+    /// The number of solver instances to run concurrently. If larger than one,
+    /// the under-approximation and over-approximations with increasing bounds
+    /// are checked in parallel.
+    unsigned numWorkers;
+
+    /// Do not stop at the first counterexample, instead block the found error
+    /// code and continue the search to enumerate every reachable error.
+    bool findAllErrors;
+
+    /// Compute procedure summaries before the first iteration and use them
+    /// as the over-approximation of call sites, instead of 'True'.
+    bool useSummaries;
+
+    /// Turn the loop automata called by the main automaton into cycles and
+    /// unroll the resulting cyclic automaton in time frames, instead of
+    /// inlining the recursive calls one iteration at a time. The bound is
+    /// the number of time frames, each of which runs from one loop head to
+    /// the next. Calls which are not part of a loop must be inlined before.
+    /// The settings of the lazy inlining, the parallel and all-errors modes
+    /// and the summaries do not apply to this mode.
+    bool cyclicUnroll;
 };
 
 class BoundedModelChecker : public VerificationAlgorithm
@@ -0,0 +1,90 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a counterexample-guided refinement loop for
+/// abstracted floating-point operations.
+///
+/// Floating-point operations may be translated into undef assignments, which
+/// spares the solver from reasoning about IEEE-754 semantics at the cost of
+/// spurious counterexamples. The refinement loop runs the backend on such a
+/// system and replays each counterexample with the precise semantics of the
+/// abstracted operations. If an abstracted value on the path differs from its
+/// precise value, the operations responsible are made precise and the backend
+/// is run again. Otherwise, the counterexample is genuine.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_FLOATREFINEMENT_H
+#define GAZER_VERIFIER_FLOATREFINEMENT_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+#include "gazer/Core/Expr.h"
+
+namespace gazer
+{
+
+class Cfa;
+
+/// An operation whose result was abstracted into an undef assignment.
+struct AbstractedOperation
+{
+    /// The automaton containing the abstracted assignment.
+    Cfa* automaton;
+
+    /// The variable receiving the result of the operation.
+    Variable* variable;
+
+    /// The result of the operation under precise semantics.
+    ExprPtr precise;
+};
+
+class FloatAbstractionRefinement : public VerificationAlgorithm
+{
+public:
+    FloatAbstractionRefinement(
+        VerificationAlgorithm& backend,
+        std::vector<AbstractedOperation> abstractions,
+        bool trace
+    ) : mBackend(backend), mAbstractions(std::move(abstractions)), mTrace(trace)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+    void interrupt() override { mBackend.interrupt(); }
+
+private:
+    /// Returns the indices of the abstracted operations whose value in the
+    /// counterexample differs from their precise value.
+    std::vector<size_t> findSpuriousOperations(
+        const std::vector<std::vector<VariableAssignment>>& actions);
+
+    /// Replaces the undef assignments of the given operations with their
+    /// precise value. Returns false if none of them could be found.
+    bool refine(const std::vector<size_t>& operations);
+
+private:
+    VerificationAlgorithm& mBackend;
+    std::vector<AbstractedOperation> mAbstractions;
+    bool mTrace;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,89 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares the k-induction verification backend.
+///
+/// The main automaton is first turned into a cyclic one by inlining its
+/// loops, then its transition relation is unrolled between cut points
+/// (the entry, the loop heads and the error location). The base case
+/// searches for counterexamples of length k, while the inductive step
+/// checks whether k consecutive safe states imply a safe successor.
+/// The two cases are solved in parallel, in separate solver instances.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_KINDUCTION_H
+#define GAZER_VERIFIER_KINDUCTION_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+#include "gazer/Automaton/CfaUtils.h"
+
+namespace gazer
+{
+
+class SolverFactory;
+
+struct KInductionSettings
+{
+    // Environment
+    bool trace = false;
+
+    // Debug
+    bool dumpFormula = false;
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    unsigned maxBound = 100;
+    bool simplifyExpr = true;
+
+    /// The shape of the path condition formulas between cut points.
+    PathConditionEncoding encoding = PathConditionEncoding::Nested;
+
+    /// Strengthen the inductive step with invariants of the loop heads. The
+    /// candidates are the bounds and congruences found by the abstract
+    /// interpretation of the automata, and the constant initial values of
+    /// loop variables. They are checked to be inductive before the first
+    /// iteration.
+    bool useInvariants = false;
+
+    /// Run the inductive step alongside the base case. Without it, only the
+    /// base case is unrolled, which makes the algorithm a bounded model
+    /// checker for cyclic automata. Safety is then only proven if no
+    /// execution is longer than the bound.
+    bool inductiveStep = true;
+};
+
+class KInduction : public VerificationAlgorithm
+{
+public:
+    KInduction(SolverFactory& solverFactory, KInductionSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    KInductionSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
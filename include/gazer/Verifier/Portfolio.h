@@ -0,0 +1,87 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a portfolio of verification algorithms.
+///
+/// The portfolio runs several verification backends concurrently on the same
+/// automata system. As expressions are not thread-safe, each engine works on
+/// its own clone of the system, built in a separate GazerContext. The first
+/// conclusive verdict (success or failure) is returned and the remaining
+/// engines are interrupted.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_PORTFOLIO_H
+#define GAZER_VERIFIER_PORTFOLIO_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+#include <functional>
+#include <mutex>
+
+namespace gazer
+{
+
+class SolverFactory;
+
+struct PortfolioSettings
+{
+    // Environment
+    bool trace = false;
+
+    /// Print the status and running time of each engine after the race.
+    bool printTimes = true;
+};
+
+class Portfolio : public VerificationAlgorithm
+{
+public:
+    /// Creates an engine using the given solver factory. Engines must create
+    /// all of their solvers through this factory, so that they can be stopped
+    /// when another engine has already found a verdict.
+    using EngineBuilder = std::function<
+        std::unique_ptr<VerificationAlgorithm>(SolverFactory& solverFactory)
+    >;
+
+    Portfolio(SolverFactory& solverFactory, PortfolioSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    /// Adds an engine to the portfolio with a name used in the reports.
+    void addEngine(std::string name, EngineBuilder builder);
+
+    size_t getNumEngines() const { return mEngines.size(); }
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+    void interrupt() override;
+
+private:
+    SolverFactory& mSolverFactory;
+    PortfolioSettings mSettings;
+    std::vector<std::pair<std::string, EngineBuilder>> mEngines;
+
+    std::mutex mMutex;
+    std::function<void()> mInterrupt;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,97 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares an in-process predicate abstraction engine,
+/// using counterexample-guided abstraction refinement (CEGAR).
+///
+/// The engine works on the cyclic form of the main automaton. It explores an
+/// abstract reachability graph (ARG) using Cartesian predicate abstraction.
+/// If an abstract error path is found and it is infeasible, the weakest
+/// preconditions along the path are added to the precision, and the search
+/// is restarted.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_PREDICATEABSTRACTION_H
+#define GAZER_VERIFIER_PREDICATEABSTRACTION_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+class SolverFactory;
+
+/// The order in which the abstract reachability graph is explored.
+enum class CegarSearch
+{
+    Bfs,    ///< Breadth-first search, finds shortest counterexamples.
+    Dfs     ///< Depth-first search.
+};
+
+/// Controls where the predicates found by refinement are tracked.
+enum class CegarPrecision
+{
+    Global, ///< Each predicate is tracked at every location.
+    Local   ///< Predicates are tracked only at the location they were found for.
+};
+
+/// Controls how refinement formulas are turned into predicates.
+enum class CegarPredSplit
+{
+    Whole,  ///< Use each formula as a single predicate.
+    Atoms   ///< Use the atoms of each formula as predicates.
+};
+
+struct CegarSettings
+{
+    // Environment
+    bool trace = false;
+
+    // Debug
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    bool simplifyExpr = true;
+    CegarSearch search = CegarSearch::Bfs;
+    CegarPrecision precision = CegarPrecision::Global;
+    CegarPredSplit predSplit = CegarPredSplit::Whole;
+
+    /// The maximum number of refinement iterations, zero means unlimited.
+    unsigned maxIterations = 0;
+};
+
+class PredicateAbstraction : public VerificationAlgorithm
+{
+public:
+    PredicateAbstraction(SolverFactory& solverFactory, CegarSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    CegarSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
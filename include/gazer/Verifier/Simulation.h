@@ -0,0 +1,81 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a random simulation pre-pass for verification
+/// backends.
+///
+/// Before running the actual backend, the automata system is executed
+/// concretely a number of times, choosing random or boundary values for
+/// nondeterministic assignments and random transitions between enabled
+/// ones. If a simulation reaches an error location, its path is returned as
+/// a counterexample. Otherwise, the backend is run as usual.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_SIMULATION_H
+#define GAZER_VERIFIER_SIMULATION_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+struct SimulationSettings
+{
+    // Environment
+    bool trace = false;
+
+    /// The maximum number of simulation runs.
+    unsigned numRuns = 10000;
+
+    /// The maximum number of transitions taken in a single run.
+    unsigned maxSteps = 10000;
+
+    /// The maximum time spent in simulation, in milliseconds.
+    unsigned timeBudget = 2000;
+
+    /// The number of threads running simulations.
+    unsigned numWorkers = 1;
+
+    /// The seed of the random number generators.
+    unsigned seed = 0;
+};
+
+/// Runs random simulations on the automata system before running
+/// the wrapped verification backend.
+class SimulationPrePass : public VerificationAlgorithm
+{
+public:
+    SimulationPrePass(std::unique_ptr<VerificationAlgorithm> backend, SimulationSettings settings)
+        : mBackend(std::move(backend)), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+    void interrupt() override { mBackend->interrupt(); }
+
+private:
+    std::unique_ptr<VerificationAlgorithm> mBackend;
+    SimulationSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,90 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a symbolic execution engine for automata systems.
+///
+/// Execution states consist of a location, a call stack of symbolic stores
+/// mapping variables to expressions and a path condition. Calls are followed
+/// on the explicit call stack, up to a given depth. Small acyclic regions
+/// between a branch and its immediate post-dominator may be executed as a
+/// whole, merging the states of their paths into a single one.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_SYMBOLICEXECUTION_H
+#define GAZER_VERIFIER_SYMBOLICEXECUTION_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+class SolverFactory;
+
+/// The order in which pending execution states are explored.
+enum class SymExecSearch
+{
+    Dfs,        ///< Depth-first search, finds deep errors quickly.
+    Bfs,        ///< Breadth-first search, finds the shortest paths to errors.
+    Coverage    ///< Prefer states at the least visited locations.
+};
+
+struct SymExecSettings
+{
+    // Environment
+    bool trace = false;
+
+    // Debug
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    bool simplifyExpr = true;
+    SymExecSearch search = SymExecSearch::Dfs;
+
+    /// The maximum depth of the call stack. As loops are represented as
+    /// recursive automata, this also bounds the number of loop iterations.
+    unsigned maxCallDepth = 100;
+
+    /// The maximum number of locations in a region executed as a whole,
+    /// zero disables state merging. Regions with overlapping branch guards
+    /// are never merged.
+    unsigned mergeLimit = 8;
+
+    /// The number of solver instances checking path feasibility in parallel.
+    unsigned numWorkers = 1;
+};
+
+class SymbolicExecution : public VerificationAlgorithm
+{
+public:
+    SymbolicExecution(SolverFactory& solverFactory, SymExecSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    SymExecSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
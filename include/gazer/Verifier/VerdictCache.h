@@ -0,0 +1,75 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a persistent cache of verification verdicts.
+///
+/// Each verdict is stored in its own file in the cache directory, named after
+/// the hash of its key. The key is supplied by the client and must identify
+/// everything the verdict depends on: the verified program and the settings
+/// of the translation and the backend. The full key is also stored in the
+/// entry, thus hash collisions and stale entries are detected on load.
+///
+/// Counterexamples are stored on the level of the automata system, and their
+/// traces are rebuilt with the trace builder of the current run. Inconclusive
+/// verdicts (timeouts, unknown results and internal errors) are not stored.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_VERDICTCACHE_H
+#define GAZER_VERIFIER_VERDICTCACHE_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+struct VerdictCacheSettings
+{
+    /// The directory containing the cache entries.
+    std::string directory;
+
+    /// The maximum total size of the entries in bytes, zero means unlimited.
+    /// Least recently used entries are removed when the limit is exceeded.
+    /// Regardless of the limit, entries unused for a week are removed.
+    uint64_t maxSize = 0;
+};
+
+/// Looks up the verdict of the wrapped backend in a persistent cache, and
+/// only runs the backend if it is not found.
+class VerdictCache : public VerificationAlgorithm
+{
+public:
+    VerdictCache(VerificationAlgorithm& backend, std::string key, VerdictCacheSettings settings)
+        : mBackend(backend), mKey(std::move(key)), mSettings(std::move(settings))
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+    void interrupt() override { mBackend.interrupt(); }
+
+private:
+    VerificationAlgorithm& mBackend;
+    std::string mKey;
+    VerdictCacheSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
@@ -37,9 +37,41 @@ public:
         CfaTraceBuilder& traceBuilder
     ) = 0;
 
+    /// Requests a check() running on a different thread to stop as soon as
+    /// possible, returning an inconclusive result. The default implementation
+    /// does nothing, algorithms may only be stopped through their solvers then.
+    virtual void interrupt() {}
+
     virtual ~VerificationAlgorithm() = default;
 };
 
+/// Records the first counterexample built by an algorithm, so that it may be
+/// post-processed before building the actual trace.
+class CfaTraceRecorder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        if (!mRecorded) {
+            mStates = states;
+            mActions = actions;
+            mRecorded = true;
+        }
+
+        return nullptr;
+    }
+
+    bool isRecorded() const { return mRecorded; }
+
+    std::vector<Location*> mStates;
+    std::vector<std::vector<VariableAssignment>> mActions;
+
+private:
+    bool mRecorded = false;
+};
+
 }
 
 #endif
@@ -0,0 +1,66 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a verification backend which encodes an automata
+/// system as constrained Horn clauses and solves them using the Spacer engine
+/// of Z3.
+///
+/// Each location of each automaton becomes an uninterpreted predicate over
+/// the variables of its automaton. Call transitions refer to the summary
+/// predicate of their callee, which relates the input and output values
+/// of the procedure. Error locations propagate their error code through a
+/// failure predicate up to the main automaton.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_Z3SOLVER_Z3CHCVERIFIER_H
+#define GAZER_Z3SOLVER_Z3CHCVERIFIER_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+struct ChcSettings
+{
+    // Debug
+    bool dumpRules = false;
+    bool printSolverStats = false;
+
+    // Traceability
+    bool trace = false;
+};
+
+class Z3ChcVerifier : public VerificationAlgorithm
+{
+public:
+    explicit Z3ChcVerifier(ChcSettings settings)
+        : mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    ChcSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
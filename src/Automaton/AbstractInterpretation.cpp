@@ -0,0 +1,1600 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements an abstract interpretation of automata systems,
+/// which is used to remove error locations before running a verifier.
+///
+/// Each variable is abstracted by the reduced product of an interval and a
+/// congruence, that is, by a set of the form {x | lo <= x <= hi, x = r mod s}.
+/// Bit-vectors are interpreted as signed integers and booleans as 0 and 1.
+/// Operations whose result may wrap around yield the full range of their type.
+///
+/// The analysis is interprocedural: the entry state of an automaton is the
+/// join of its inputs at each call site, and its summary is the state of its
+/// exit location, which is used to evaluate the outputs of calls. As loops are
+/// represented by recursive automata, widening is applied to the entry states
+/// and summaries after a fixed number of updates, as well as at the targets of
+/// back edges in cyclic automata.
+///
+/// Transitions whose guard is infeasible in their source state are removed.
+/// Then, error locations which lost their incoming transitions are removed,
+/// along with every location which may only reach removed error locations.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprWalker.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/CheckedArithmetic.h>
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <array>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <set>
+
+#define DEBUG_TYPE "AbstractInterpretation"
+
+using namespace gazer;
+
+namespace
+{
+
+/// The number of updates after which entry states, summaries and the states
+/// of loop heads are widened.
+constexpr unsigned WideningDelay = 3;
+
+/// The maximum number of boolean definitions substituted into a guard.
+constexpr unsigned MaxRefinementDepth = 4;
+
+/// The maximum number of disjuncts which are refined separately.
+constexpr unsigned MaxDisjuncts = 4;
+
+/// A bound of an interval, nothing represents infinity.
+using Bound = std::optional<int64_t>;
+
+Bound addBounds(Bound a, Bound b)
+{
+    if (a && b) {
+        if (auto result = llvm::checkedAdd(*a, *b)) {
+            return *result;
+        }
+    }
+
+    return std::nullopt;
+}
+
+Bound subBounds(Bound a, Bound b)
+{
+    if (a && b) {
+        if (auto result = llvm::checkedSub(*a, *b)) {
+            return *result;
+        }
+    }
+
+    return std::nullopt;
+}
+
+/// Returns the non-negative remainder of \p value divided by \p modulus.
+int64_t euclidMod(int64_t value, int64_t modulus)
+{
+    int64_t result = value % modulus;
+    return result < 0 ? result + modulus : result;
+}
+
+/// Returns the greatest common divisor of \p stride and the distance of \p a
+/// and \p b, or 1 if the distance is not representable.
+int64_t gcdOfDistance(int64_t stride, int64_t a, int64_t b)
+{
+    auto diff = llvm::checkedSub(a, b);
+    if (!diff || *diff == std::numeric_limits<int64_t>::min()) {
+        return 1;
+    }
+
+    return std::gcd(stride, *diff < 0 ? -*diff : *diff);
+}
+
+/// A set of integers represented by an interval and a congruence.
+class AbstractValue
+{
+public:
+    /// Creates the set of all integers.
+    AbstractValue() = default;
+
+    static AbstractValue getBottom()
+    {
+        AbstractValue value;
+        value.mBottom = true;
+        return value;
+    }
+
+    static AbstractValue getRange(Bound lo, Bound hi)
+    {
+        AbstractValue value;
+        value.mLo = lo;
+        value.mHi = hi;
+        value.normalize();
+        return value;
+    }
+
+    static AbstractValue getConstant(int64_t value) {
+        return getRange(value, value);
+    }
+
+    static AbstractValue getBool(std::optional<bool> value)
+    {
+        if (value) {
+            return getConstant(*value ? 1 : 0);
+        }
+
+        return getRange(0, 1);
+    }
+
+    /// Returns the set of all values of \p type.
+    static AbstractValue getTop(Type& type)
+    {
+        if (auto bvTy = llvm::dyn_cast<BvType>(&type); bvTy && bvTy->getWidth() <= 64) {
+            unsigned width = bvTy->getWidth();
+            return getRange(llvm::APInt::getSignedMinValue(width).getSExtValue(),
+                llvm::APInt::getSignedMaxValue(width).getSExtValue());
+        }
+
+        if (type.isBoolType()) {
+            return getRange(0, 1);
+        }
+
+        return AbstractValue();
+    }
+
+    bool isBottom() const { return mBottom; }
+    Bound getLower() const { return mLo; }
+    Bound getUpper() const { return mHi; }
+    int64_t getStride() const { return mStride; }
+    int64_t getRemainder() const { return mRem; }
+
+    bool isNonNegative() const { return !mBottom && mLo && *mLo >= 0; }
+
+    std::optional<int64_t> getConstantValue() const
+    {
+        if (!mBottom && mLo && mHi && *mLo == *mHi) {
+            return *mLo;
+        }
+
+        return std::nullopt;
+    }
+
+    bool contains(int64_t value) const
+    {
+        if (mBottom || (mLo && value < *mLo) || (mHi && value > *mHi)) {
+            return false;
+        }
+
+        return mStride == 0 ? value == mRem : euclidMod(value, mStride) == mRem;
+    }
+
+    bool operator==(const AbstractValue& other) const
+    {
+        return mBottom == other.mBottom && mLo == other.mLo && mHi == other.mHi
+            && mStride == other.mStride && mRem == other.mRem;
+    }
+
+    bool operator!=(const AbstractValue& other) const { return !(*this == other); }
+
+    AbstractValue join(const AbstractValue& other) const
+    {
+        if (mBottom) { return other; }
+        if (other.mBottom) { return *this; }
+
+        AbstractValue result;
+        result.mLo = mLo && other.mLo ? Bound(std::min(*mLo, *other.mLo)) : std::nullopt;
+        result.mHi = mHi && other.mHi ? Bound(std::max(*mHi, *other.mHi)) : std::nullopt;
+        result.mStride = gcdOfDistance(std::gcd(mStride, other.mStride), mRem, other.mRem);
+        result.mRem = mRem;
+        result.normalize();
+
+        return result;
+    }
+
+    AbstractValue meet(const AbstractValue& other) const
+    {
+        if (mBottom || other.mBottom) {
+            return getBottom();
+        }
+
+        if (auto value = other.getConstantValue()) {
+            return this->contains(*value) ? other : getBottom();
+        }
+
+        if (auto value = this->getConstantValue()) {
+            return other.contains(*value) ? *this : getBottom();
+        }
+
+        AbstractValue result;
+        result.mLo = !mLo ? other.mLo : (!other.mLo ? mLo : Bound(std::max(*mLo, *other.mLo)));
+        result.mHi = !mHi ? other.mHi : (!other.mHi ? mHi : Bound(std::min(*mHi, *other.mHi)));
+
+        // Keeping the larger stride is sound, although it may lose some
+        // precision if the congruences are not comparable.
+        const AbstractValue& congruence = mStride >= other.mStride ? *this : other;
+        result.mStride = congruence.mStride;
+        result.mRem = congruence.mRem;
+        result.normalize();
+
+        return result;
+    }
+
+    /// Returns an upper bound of this value and \p next, which ensures
+    /// the termination of increasing chains.
+    AbstractValue widen(const AbstractValue& next) const
+    {
+        if (mBottom || next.mBottom) {
+            return this->join(next);
+        }
+
+        AbstractValue result = this->join(next);
+        result.mLo = mLo && next.mLo && *next.mLo >= *mLo ? mLo : std::nullopt;
+        result.mHi = mHi && next.mHi && *next.mHi <= *mHi ? mHi : std::nullopt;
+        result.normalize();
+
+        return result;
+    }
+
+    AbstractValue add(const AbstractValue& other) const
+    {
+        if (mBottom || other.mBottom) {
+            return getBottom();
+        }
+
+        AbstractValue result;
+        result.mLo = addBounds(mLo, other.mLo);
+        result.mHi = addBounds(mHi, other.mHi);
+        result.setCongruence(std::gcd(mStride, other.mStride), llvm::checkedAdd(mRem, other.mRem));
+        result.normalize();
+
+        return result;
+    }
+
+    AbstractValue sub(const AbstractValue& other) const
+    {
+        if (mBottom || other.mBottom) {
+            return getBottom();
+        }
+
+        AbstractValue result;
+        result.mLo = subBounds(mLo, other.mHi);
+        result.mHi = subBounds(mHi, other.mLo);
+        result.setCongruence(std::gcd(mStride, other.mStride), llvm::checkedSub(mRem, other.mRem));
+        result.normalize();
+
+        return result;
+    }
+
+    AbstractValue mul(const AbstractValue& other) const
+    {
+        if (mBottom || other.mBottom) {
+            return getBottom();
+        }
+
+        if (other.getConstantValue() == 0 || this->getConstantValue() == 0) {
+            return getConstant(0);
+        }
+
+        AbstractValue result;
+        if (mLo && mHi && other.mLo && other.mHi) {
+            std::array<decltype(llvm::checkedMul(int64_t{}, int64_t{})), 4> products = {
+                llvm::checkedMul(*mLo, *other.mLo), llvm::checkedMul(*mLo, *other.mHi),
+                llvm::checkedMul(*mHi, *other.mLo), llvm::checkedMul(*mHi, *other.mHi)
+            };
+
+            if (llvm::all_of(products, [](auto& p) { return p.hasValue(); })) {
+                result.mLo = *products[0];
+                result.mHi = *products[0];
+                for (auto& p : products) {
+                    result.mLo = std::min(*result.mLo, *p);
+                    result.mHi = std::max(*result.mHi, *p);
+                }
+            }
+        }
+
+        // Multiplying x = r mod s with a constant c yields x*c = r*c mod s*|c|.
+        auto scale = [&result](const AbstractValue& value, int64_t factor) {
+            auto stride = llvm::checkedMul(value.mStride, factor < 0 ? -factor : factor);
+            result.setCongruence(stride ? *stride : 1, llvm::checkedMul(value.mRem, factor));
+        };
+
+        if (auto factor = other.getConstantValue(); factor && *factor != std::numeric_limits<int64_t>::min()) {
+            scale(*this, *factor);
+        } else if (auto factor = this->getConstantValue(); factor && *factor != std::numeric_limits<int64_t>::min()) {
+            scale(other, *factor);
+        }
+
+        result.normalize();
+
+        return result;
+    }
+
+    /// Removes \p value from this set if it is one of its bounds.
+    AbstractValue exclude(int64_t value) const
+    {
+        if (!this->contains(value)) {
+            return *this;
+        }
+
+        if (this->getConstantValue() == value) {
+            return getBottom();
+        }
+
+        AbstractValue result = *this;
+        if (mLo == value) {
+            result.mLo = *mLo + 1;
+        } else if (mHi == value) {
+            result.mHi = *mHi - 1;
+        }
+        result.normalize();
+
+        return result;
+    }
+
+    /// Returns the values of this set which are representable in \p type.
+    /// If some values are out of range, the operation which produced them
+    /// may have wrapped around, thus the result is the full range of the type.
+    AbstractValue fit(Type& type) const
+    {
+        if (mBottom) {
+            return *this;
+        }
+
+        if (auto bvTy = llvm::dyn_cast<BvType>(&type); bvTy && bvTy->getWidth() <= 64) {
+            AbstractValue top = getTop(type);
+            if (mLo && mHi && *mLo >= *top.mLo && *mHi <= *top.mHi) {
+                return *this;
+            }
+
+            return top;
+        }
+
+        if (type.isBoolType()) {
+            return this->meet(getRange(0, 1));
+        }
+
+        return *this;
+    }
+
+    void print(llvm::raw_ostream& os) const
+    {
+        if (mBottom) {
+            os << "bottom";
+            return;
+        }
+
+        os << "[";
+        if (mLo) { os << *mLo; } else { os << "-inf"; }
+        os << ", ";
+        if (mHi) { os << *mHi; } else { os << "+inf"; }
+        os << "]";
+        if (mStride > 1) {
+            os << " = " << mRem << " mod " << mStride;
+        }
+    }
+
+private:
+    void setCongruence(int64_t stride, decltype(llvm::checkedAdd(int64_t{}, int64_t{})) rem)
+    {
+        if (!rem) {
+            mStride = 1;
+            mRem = 0;
+            return;
+        }
+
+        mStride = stride;
+        mRem = *rem;
+    }
+
+    /// Tightens the bounds to the values satisfying the congruence, and
+    /// turns empty sets into bottom.
+    void normalize()
+    {
+        if (mBottom) {
+            return;
+        }
+
+        if (mStride == 0) {
+            if ((mLo && mRem < *mLo) || (mHi && mRem > *mHi)) {
+                *this = getBottom();
+                return;
+            }
+
+            mLo = mRem;
+            mHi = mRem;
+            return;
+        }
+
+        if (mStride == 1) {
+            mRem = 0;
+        } else {
+            mRem = euclidMod(mRem, mStride);
+            if (mLo) {
+                mLo = addBounds(mLo, euclidMod(mRem - euclidMod(*mLo, mStride), mStride));
+            }
+            if (mHi) {
+                mHi = subBounds(mHi, euclidMod(euclidMod(*mHi, mStride) - mRem, mStride));
+            }
+        }
+
+        if (mLo && mHi) {
+            if (*mLo > *mHi) {
+                *this = getBottom();
+            } else if (*mLo == *mHi) {
+                mStride = 0;
+                mRem = *mLo;
+            }
+        }
+    }
+
+private:
+    bool mBottom = false;
+    Bound mLo;
+    Bound mHi;
+
+    /// The stride of the congruence, zero for singleton sets.
+    int64_t mStride = 1;
+    int64_t mRem = 0;
+};
+
+/// Maps each variable to an abstract value. Variables which are not
+/// present in the map may take any value of their type.
+class AbstractState
+{
+public:
+    static AbstractState getBottom()
+    {
+        AbstractState state;
+        state.mBottom = true;
+        return state;
+    }
+
+    bool isBottom() const { return mBottom; }
+
+    AbstractValue get(Variable* variable) const
+    {
+        if (mBottom) {
+            return AbstractValue::getBottom();
+        }
+
+        auto it = mValues.find(variable);
+        if (it != mValues.end()) {
+            return it->second;
+        }
+
+        return AbstractValue::getTop(variable->getType());
+    }
+
+    void set(Variable* variable, const AbstractValue& value)
+    {
+        if (mBottom) {
+            return;
+        }
+
+        // Arithmetic results are wrapped by the evaluator, thus out-of-range
+        // values may only come from widening, which is safe to clamp.
+        AbstractValue top = AbstractValue::getTop(variable->getType());
+        AbstractValue clamped = value.meet(top);
+        if (clamped.isBottom()) {
+            this->setBottom();
+        } else if (clamped == top) {
+            mValues.erase(variable);
+        } else {
+            mValues[variable] = clamped;
+        }
+    }
+
+    void setBottom()
+    {
+        mBottom = true;
+        mValues.clear();
+    }
+
+    AbstractState join(const AbstractState& other) const
+    {
+        return this->combine(other, [](const AbstractValue& a, const AbstractValue& b) {
+            return a.join(b);
+        });
+    }
+
+    AbstractState widen(const AbstractState& next) const
+    {
+        return this->combine(next, [](const AbstractValue& a, const AbstractValue& b) {
+            return a.widen(b);
+        });
+    }
+
+    bool operator==(const AbstractState& other) const
+    {
+        if (mBottom != other.mBottom || mValues.size() != other.mValues.size()) {
+            return false;
+        }
+
+        return llvm::all_of(mValues, [&other](auto& entry) {
+            auto it = other.mValues.find(entry.first);
+            return it != other.mValues.end() && it->second == entry.second;
+        });
+    }
+
+    bool operator!=(const AbstractState& other) const { return !(*this == other); }
+
+private:
+    template<class Function>
+    AbstractState combine(const AbstractState& other, Function function) const
+    {
+        if (mBottom) { return other; }
+        if (other.mBottom) { return *this; }
+
+        // Variables missing from either state are unconstrained in the result.
+        AbstractState result;
+        for (auto& [variable, value] : mValues) {
+            auto it = other.mValues.find(variable);
+            if (it != other.mValues.end()) {
+                result.set(variable, function(value, it->second));
+            }
+        }
+
+        return result;
+    }
+
+private:
+    bool mBottom = false;
+    llvm::DenseMap<Variable*, AbstractValue> mValues;
+};
+
+/// Evaluates expressions over an abstract state.
+class AbstractEvaluator : public ExprWalker<AbstractEvaluator, AbstractValue>
+{
+    friend class ExprWalker<AbstractEvaluator, AbstractValue>;
+public:
+    explicit AbstractEvaluator(const AbstractState& state)
+        : mState(state)
+    {}
+
+protected:
+    AbstractValue visitExpr(const ExprPtr& expr) {
+        return AbstractValue::getTop(expr->getType());
+    }
+
+    AbstractValue visitBoolLiteral(const ExprRef<BoolLiteralExpr>& expr) {
+        return AbstractValue::getBool(expr->getValue());
+    }
+
+    AbstractValue visitIntLiteral(const ExprRef<IntLiteralExpr>& expr) {
+        return AbstractValue::getConstant(expr->getValue());
+    }
+
+    AbstractValue visitBvLiteral(const ExprRef<BvLiteralExpr>& expr)
+    {
+        if (expr->getValue().getBitWidth() > 64) {
+            return this->visitExpr(expr);
+        }
+
+        return AbstractValue::getConstant(expr->getValue().getSExtValue());
+    }
+
+    AbstractValue visitVarRef(const ExprRef<VarRefExpr>& expr) {
+        return mState.get(&expr->getVariable());
+    }
+
+    AbstractValue visitZExt(const ExprRef<ZExtExpr>& expr)
+    {
+        if (getOperand(0).isNonNegative()) {
+            return getOperand(0);
+        }
+
+        unsigned width = llvm::cast<BvType>(expr->getOperand(0)->getType()).getWidth();
+        if (width < 63) {
+            return AbstractValue::getRange(0, (int64_t{1} << width) - 1);
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitSExt(const ExprRef<SExtExpr>& expr) {
+        return getOperand(0).fit(expr->getType());
+    }
+
+    AbstractValue visitExtract(const ExprRef<ExtractExpr>& expr)
+    {
+        // Extracting the low bits of a value which fits into them.
+        if (expr->getOffset() == 0) {
+            return getOperand(0).fit(expr->getType());
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitAdd(const ExprRef<AddExpr>& expr) {
+        return getOperand(0).add(getOperand(1)).fit(expr->getType());
+    }
+
+    AbstractValue visitSub(const ExprRef<SubExpr>& expr) {
+        return getOperand(0).sub(getOperand(1)).fit(expr->getType());
+    }
+
+    AbstractValue visitMul(const ExprRef<MulExpr>& expr) {
+        return getOperand(0).mul(getOperand(1)).fit(expr->getType());
+    }
+
+    AbstractValue visitBvSDiv(const ExprRef<BvSDivExpr>& expr)
+    {
+        // Truncating division by a positive constant is monotonic.
+        auto divisor = getOperand(1).getConstantValue();
+        if (divisor && *divisor > 0) {
+            AbstractValue dividend = getOperand(0);
+            auto div = [d = *divisor](Bound bound) -> Bound {
+                return bound ? Bound(*bound / d) : std::nullopt;
+            };
+            return AbstractValue::getRange(div(dividend.getLower()), div(dividend.getUpper()));
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitBvUDiv(const ExprRef<BvUDivExpr>& expr)
+    {
+        auto divisor = getOperand(1).getConstantValue();
+        if (divisor && *divisor > 0 && getOperand(0).isNonNegative()) {
+            AbstractValue dividend = getOperand(0);
+            auto div = [d = *divisor](Bound bound) -> Bound {
+                return bound ? Bound(*bound / d) : std::nullopt;
+            };
+            return AbstractValue::getRange(div(dividend.getLower()), div(dividend.getUpper()));
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitBvSRem(const ExprRef<BvSRemExpr>& expr)
+    {
+        // The magnitude of the remainder is less than the magnitude of the
+        // divisor, and its sign is the sign of the dividend.
+        auto divisor = getOperand(1).getConstantValue();
+        if (!divisor || *divisor == 0 || *divisor == std::numeric_limits<int64_t>::min()) {
+            return this->visitExpr(expr);
+        }
+
+        int64_t max = (*divisor < 0 ? -*divisor : *divisor) - 1;
+        if (getOperand(0).isNonNegative()) {
+            Bound hi = getOperand(0).getUpper();
+            return AbstractValue::getRange(0, hi ? std::min(*hi, max) : max);
+        }
+
+        return AbstractValue::getRange(-max, max);
+    }
+
+    AbstractValue visitBvURem(const ExprRef<BvURemExpr>& expr)
+    {
+        auto divisor = getOperand(1).getConstantValue();
+        if (divisor && *divisor > 0 && getOperand(0).isNonNegative()) {
+            return AbstractValue::getRange(0, std::min(*getOperand(0).getUpper(), *divisor - 1));
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitMod(const ExprRef<ModExpr>& expr)
+    {
+        auto divisor = getOperand(1).getConstantValue();
+        if (divisor && *divisor > 0) {
+            return AbstractValue::getRange(0, *divisor - 1);
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitShl(const ExprRef<ShlExpr>& expr)
+    {
+        auto amount = getOperand(1).getConstantValue();
+        if (amount && *amount >= 0 && *amount < 62) {
+            return getOperand(0).mul(AbstractValue::getConstant(int64_t{1} << *amount)).fit(expr->getType());
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitLShr(const ExprRef<LShrExpr>& expr)
+    {
+        auto amount = getOperand(1).getConstantValue();
+        if (amount && *amount >= 0 && *amount < 63 && getOperand(0).isNonNegative()) {
+            AbstractValue value = getOperand(0);
+            auto shift = [n = *amount](Bound bound) -> Bound {
+                return bound ? Bound(*bound >> n) : std::nullopt;
+            };
+            return AbstractValue::getRange(shift(value.getLower()), shift(value.getUpper()));
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitBvAnd(const ExprRef<BvAndExpr>& expr)
+    {
+        // Masking with a non-negative value cannot set the sign bit, nor
+        // can it yield a value above the mask.
+        Bound hi;
+        for (size_t i = 0; i < 2; ++i) {
+            if (getOperand(i).isNonNegative() && getOperand(i).getUpper()) {
+                hi = hi ? std::min(*hi, *getOperand(i).getUpper()) : *getOperand(i).getUpper();
+            }
+        }
+
+        if (hi) {
+            return AbstractValue::getRange(0, hi);
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    AbstractValue visitNot(const ExprRef<NotExpr>& expr)
+    {
+        if (auto value = getOperand(0).getConstantValue()) {
+            return AbstractValue::getBool(*value == 0);
+        }
+
+        return AbstractValue::getBool(std::nullopt);
+    }
+
+    AbstractValue visitAnd(const ExprRef<AndExpr>& expr)
+    {
+        bool allTrue = true;
+        for (size_t i = 0; i < expr->getNumOperands(); ++i) {
+            auto value = getOperand(i).getConstantValue();
+            if (value == 0) {
+                return AbstractValue::getBool(false);
+            }
+            allTrue &= value == 1;
+        }
+
+        return AbstractValue::getBool(allTrue ? std::optional<bool>(true) : std::nullopt);
+    }
+
+    AbstractValue visitOr(const ExprRef<OrExpr>& expr)
+    {
+        bool allFalse = true;
+        for (size_t i = 0; i < expr->getNumOperands(); ++i) {
+            auto value = getOperand(i).getConstantValue();
+            if (value == 1) {
+                return AbstractValue::getBool(true);
+            }
+            allFalse &= value == 0;
+        }
+
+        return AbstractValue::getBool(allFalse ? std::optional<bool>(false) : std::nullopt);
+    }
+
+    AbstractValue visitImply(const ExprRef<ImplyExpr>& expr)
+    {
+        auto lhs = getOperand(0).getConstantValue();
+        auto rhs = getOperand(1).getConstantValue();
+        if (lhs == 0 || rhs == 1) {
+            return AbstractValue::getBool(true);
+        }
+
+        if (lhs == 1 && rhs == 0) {
+            return AbstractValue::getBool(false);
+        }
+
+        return AbstractValue::getBool(std::nullopt);
+    }
+
+    AbstractValue visitSelect(const ExprRef<SelectExpr>& expr)
+    {
+        auto condition = getOperand(0).getConstantValue();
+        if (condition == 1) {
+            return getOperand(1);
+        }
+
+        if (condition == 0) {
+            return getOperand(2);
+        }
+
+        return getOperand(1).join(getOperand(2));
+    }
+
+    AbstractValue visitNonNullary(const ExprRef<NonNullaryExpr>& expr)
+    {
+        if (expr->isCompare()) {
+            return AbstractValue::getBool(
+                evaluateRelation(expr->getKind(), getOperand(0), getOperand(1)));
+        }
+
+        return this->visitExpr(expr);
+    }
+
+public:
+    /// Returns whether the relation \p kind holds between all, none, or only
+    /// some of the elements of the given values.
+    static std::optional<bool> evaluateRelation(
+        Expr::ExprKind kind, const AbstractValue& left, const AbstractValue& right);
+
+private:
+    const AbstractState& mState;
+};
+
+/// Maps the comparison \p kind to its signed or integer counterpart,
+/// and sets \p isUnsigned if the comparison was unsigned.
+Expr::ExprKind getRelation(Expr::ExprKind kind, bool* isUnsigned = nullptr)
+{
+    if (isUnsigned != nullptr) {
+        *isUnsigned = Expr::BvULt <= kind && kind <= Expr::BvUGtEq;
+    }
+
+    switch (kind) {
+        case Expr::BvSLt: case Expr::BvULt: return Expr::Lt;
+        case Expr::BvSLtEq: case Expr::BvULtEq: return Expr::LtEq;
+        case Expr::BvSGt: case Expr::BvUGt: return Expr::Gt;
+        case Expr::BvSGtEq: case Expr::BvUGtEq: return Expr::GtEq;
+        default:
+            return kind;
+    }
+}
+
+/// Returns the relation which holds if \p kind does not.
+Expr::ExprKind negateRelation(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq: return Expr::NotEq;
+        case Expr::NotEq: return Expr::Eq;
+        case Expr::Lt: return Expr::GtEq;
+        case Expr::LtEq: return Expr::Gt;
+        case Expr::Gt: return Expr::LtEq;
+        case Expr::GtEq: return Expr::Lt;
+        case Expr::BvSLt: return Expr::BvSGtEq;
+        case Expr::BvSLtEq: return Expr::BvSGt;
+        case Expr::BvSGt: return Expr::BvSLtEq;
+        case Expr::BvSGtEq: return Expr::BvSLt;
+        case Expr::BvULt: return Expr::BvUGtEq;
+        case Expr::BvULtEq: return Expr::BvUGt;
+        case Expr::BvUGt: return Expr::BvULtEq;
+        case Expr::BvUGtEq: return Expr::BvULt;
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+/// Returns the relation R' for which (a R b) is equivalent to (b R' a).
+Expr::ExprKind swapRelation(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Lt: return Expr::Gt;
+        case Expr::LtEq: return Expr::GtEq;
+        case Expr::Gt: return Expr::Lt;
+        case Expr::GtEq: return Expr::LtEq;
+        default:
+            return kind;
+    }
+}
+
+std::optional<bool> AbstractEvaluator::evaluateRelation(
+    Expr::ExprKind kind, const AbstractValue& left, const AbstractValue& right)
+{
+    if (left.isBottom() || right.isBottom()) {
+        return std::nullopt;
+    }
+
+    bool isUnsigned;
+    kind = getRelation(kind, &isUnsigned);
+    if (isUnsigned && !(left.isNonNegative() && right.isNonNegative())) {
+        // Signed and unsigned comparisons only agree on non-negative values.
+        if (kind != Expr::Eq && kind != Expr::NotEq) {
+            return std::nullopt;
+        }
+    }
+
+    auto lo1 = left.getLower(), hi1 = left.getUpper();
+    auto lo2 = right.getLower(), hi2 = right.getUpper();
+
+    switch (kind) {
+        case Expr::Eq:
+            if (left.meet(right).isBottom()) {
+                return false;
+            }
+            if (left.getConstantValue() && left.getConstantValue() == right.getConstantValue()) {
+                return true;
+            }
+            return std::nullopt;
+        case Expr::NotEq:
+            if (auto result = evaluateRelation(Expr::Eq, left, right)) {
+                return !*result;
+            }
+            return std::nullopt;
+        case Expr::Lt:
+            if (hi1 && lo2 && *hi1 < *lo2) { return true; }
+            if (lo1 && hi2 && *lo1 >= *hi2) { return false; }
+            return std::nullopt;
+        case Expr::LtEq:
+            if (hi1 && lo2 && *hi1 <= *lo2) { return true; }
+            if (lo1 && hi2 && *lo1 > *hi2) { return false; }
+            return std::nullopt;
+        case Expr::Gt:
+            return evaluateRelation(Expr::Lt, right, left);
+        case Expr::GtEq:
+            return evaluateRelation(Expr::LtEq, right, left);
+        default:
+            return std::nullopt;
+    }
+}
+
+class AbstractInterpreter
+{
+public:
+    explicit AbstractInterpreter(AutomataSystem& system)
+        : mSystem(system)
+    {}
+
+    void analyze();
+    DischargeResult discharge();
+
+    /// Returns the facts proven about the variables of \p location.
+    ExprVector getInvariants(Location* location, ExprBuilder& builder) const;
+
+private:
+    void collectDefinitions();
+    void analyzeAutomaton(Cfa& cfa);
+
+    AbstractState getState(Location* location) const;
+    AbstractState transfer(Transition* edge, const AbstractState& state);
+    bool isFeasible(Transition* edge);
+
+    AbstractValue evaluate(const ExprPtr& expr, const AbstractState& state) {
+        return AbstractEvaluator(state).walk(expr);
+    }
+
+    AbstractState applyGuard(const AbstractState& state, const ExprPtr& guard)
+    {
+        AbstractState result = state;
+        this->refine(result, guard, true, 0);
+        return result;
+    }
+
+    void refine(AbstractState& state, const ExprPtr& condition, bool truth, unsigned depth);
+    void refineDisjunction(
+        AbstractState& state, llvm::ArrayRef<std::pair<ExprPtr, bool>> disjuncts, unsigned depth);
+    void refineRelation(AbstractState& state, Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right);
+    Variable* getRefinableVariable(const ExprPtr& expr, const AbstractState& state);
+
+    void updateEntryState(Cfa* cfa, const AbstractState& input);
+    void updateSummary(Cfa* cfa, const AbstractState& exit);
+
+    void removeIrrelevantLocations(Cfa& cfa, const llvm::DenseSet<Cfa*>& mayFail);
+
+private:
+    AutomataSystem& mSystem;
+    llvm::DenseMap<Location*, AbstractState> mStates;
+
+    /// Entry states and summaries, missing automata are unreachable.
+    llvm::DenseMap<Cfa*, AbstractState> mEntryStates;
+    llvm::DenseMap<Cfa*, AbstractState> mSummaries;
+    llvm::DenseMap<Cfa*, unsigned> mNumEntryUpdates;
+    llvm::DenseMap<Cfa*, unsigned> mNumSummaryUpdates;
+
+    /// Boolean variables which are defined by a single assignment over
+    /// variables that are assigned at most once.
+    llvm::DenseMap<Variable*, ExprPtr> mDefinitions;
+
+    bool mChanged = false;
+};
+
+} // end anonymous namespace
+
+void AbstractInterpreter::collectDefinitions()
+{
+    llvm::DenseMap<Variable*, unsigned> numAssigns;
+    std::vector<std::pair<Variable*, ExprPtr>> candidates;
+
+    // Call inputs are assigned in the activation of the callee,
+    // thus they do not count as assignments.
+    for (Cfa& cfa : mSystem) {
+        for (Transition* edge : cfa.edges()) {
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                for (const VariableAssignment& va : *assign) {
+                    numAssigns[va.getVariable()]++;
+                    if (va.getVariable()->getType().isBoolType()) {
+                        candidates.emplace_back(va.getVariable(), va.getValue());
+                    }
+                }
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+                for (const VariableAssignment& va : call->outputs()) {
+                    numAssigns[va.getVariable()]++;
+                }
+            }
+        }
+    }
+
+    std::function<bool(const ExprPtr&)> isStable = [&](const ExprPtr& expr) {
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+            return numAssigns.lookup(&varRef->getVariable()) <= 1;
+        }
+
+        if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            return llvm::all_of(nonNullary->operands(), isStable);
+        }
+
+        return true;
+    };
+
+    for (auto& [variable, value] : candidates) {
+        if (numAssigns.lookup(variable) == 1 && isStable(value)) {
+            mDefinitions[variable] = value;
+        }
+    }
+}
+
+AbstractState AbstractInterpreter::getState(Location* location) const
+{
+    auto it = mStates.find(location);
+    if (it == mStates.end()) {
+        return AbstractState::getBottom();
+    }
+
+    return it->second;
+}
+
+void AbstractInterpreter::refine(AbstractState& state, const ExprPtr& condition, bool truth, unsigned depth)
+{
+    if (state.isBottom()) {
+        return;
+    }
+
+    switch (condition->getKind()) {
+        case Expr::Not:
+            this->refine(state, llvm::cast<NotExpr>(condition)->getOperand(0), !truth, depth);
+            break;
+        case Expr::And:
+        case Expr::Or: {
+            auto nonNullary = llvm::cast<NonNullaryExpr>(condition);
+            bool isConjunction = (condition->getKind() == Expr::And) == truth;
+            if (isConjunction) {
+                for (const ExprPtr& op : nonNullary->operands()) {
+                    this->refine(state, op, truth, depth);
+                }
+            } else {
+                std::vector<std::pair<ExprPtr, bool>> disjuncts;
+                for (const ExprPtr& op : nonNullary->operands()) {
+                    disjuncts.emplace_back(op, truth);
+                }
+                this->refineDisjunction(state, disjuncts, depth);
+            }
+            break;
+        }
+        case Expr::Imply: {
+            auto imply = llvm::cast<ImplyExpr>(condition);
+            if (truth) {
+                this->refineDisjunction(state, {{imply->getLeft(), false}, {imply->getRight(), true}}, depth);
+            } else {
+                this->refine(state, imply->getLeft(), true, depth);
+                this->refine(state, imply->getRight(), false, depth);
+            }
+            break;
+        }
+        case Expr::VarRef: {
+            Variable* variable = &llvm::cast<VarRefExpr>(condition)->getVariable();
+            if (!variable->getType().isBoolType()) {
+                break;
+            }
+
+            state.set(variable, state.get(variable).meet(AbstractValue::getBool(truth)));
+
+            auto it = mDefinitions.find(variable);
+            if (it != mDefinitions.end() && depth < MaxRefinementDepth) {
+                this->refine(state, it->second, truth, depth + 1);
+            }
+            break;
+        }
+        default:
+            if (condition->isCompare()) {
+                auto cmp = llvm::cast<NonNullaryExpr>(condition);
+                Expr::ExprKind kind = truth ? condition->getKind() : negateRelation(condition->getKind());
+                this->refineRelation(state, kind, cmp->getOperand(0), cmp->getOperand(1));
+            }
+            break;
+    }
+
+    if (state.isBottom()) {
+        return;
+    }
+
+    auto value = this->evaluate(condition, state).getConstantValue();
+    if (value && *value != (truth ? 1 : 0)) {
+        state.setBottom();
+    }
+}
+
+void AbstractInterpreter::refineDisjunction(
+    AbstractState& state, llvm::ArrayRef<std::pair<ExprPtr, bool>> disjuncts, unsigned depth)
+{
+    if (disjuncts.size() > MaxDisjuncts) {
+        return;
+    }
+
+    AbstractState result = AbstractState::getBottom();
+    for (auto& [condition, truth] : disjuncts) {
+        AbstractState branch = state;
+        this->refine(branch, condition, truth, depth);
+        result = result.join(branch);
+    }
+
+    state = result;
+}
+
+Variable* AbstractInterpreter::getRefinableVariable(const ExprPtr& expr, const AbstractState& state)
+{
+    // Sign extension preserves the signed value of its operand, while zero
+    // extension only preserves non-negative values.
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+        return &varRef->getVariable();
+    }
+
+    if (auto sext = llvm::dyn_cast<SExtExpr>(expr)) {
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(sext->getOperand(0))) {
+            return &varRef->getVariable();
+        }
+    }
+
+    if (auto zext = llvm::dyn_cast<ZExtExpr>(expr)) {
+        auto varRef = llvm::dyn_cast<VarRefExpr>(zext->getOperand(0));
+        if (varRef != nullptr && state.get(&varRef->getVariable()).isNonNegative()) {
+            return &varRef->getVariable();
+        }
+    }
+
+    return nullptr;
+}
+
+void AbstractInterpreter::refineRelation(
+    AbstractState& state, Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right)
+{
+    bool isUnsigned;
+    kind = getRelation(kind, &isUnsigned);
+
+    AbstractValue lhs = this->evaluate(left, state);
+    AbstractValue rhs = this->evaluate(right, state);
+
+    // An unsigned comparison may only be interpreted as a signed one if both
+    // operands are non-negative. If the greater operand is non-negative, the
+    // lesser one must also be non-negative.
+    AbstractValue nonNegative = AbstractValue::getRange(0, std::nullopt);
+    if (isUnsigned && !(lhs.isNonNegative() && rhs.isNonNegative())) {
+        if ((kind == Expr::Lt || kind == Expr::LtEq) && rhs.isNonNegative()) {
+            lhs = lhs.meet(nonNegative);
+        } else if ((kind == Expr::Gt || kind == Expr::GtEq) && lhs.isNonNegative()) {
+            rhs = rhs.meet(nonNegative);
+        } else {
+            return;
+        }
+    }
+
+    // Returns the elements of 'value' which are in relation 'rel' with some element of 'other'.
+    auto constrain = [](Expr::ExprKind rel, const AbstractValue& value, const AbstractValue& other) {
+        switch (rel) {
+            case Expr::Eq:
+                return value.meet(other);
+            case Expr::NotEq:
+                if (auto c = other.getConstantValue()) {
+                    return value.exclude(*c);
+                }
+                return value;
+            case Expr::Lt:
+                return value.meet(AbstractValue::getRange(std::nullopt, subBounds(other.getUpper(), 1)));
+            case Expr::LtEq:
+                return value.meet(AbstractValue::getRange(std::nullopt, other.getUpper()));
+            case Expr::Gt:
+                return value.meet(AbstractValue::getRange(addBounds(other.getLower(), 1), std::nullopt));
+            case Expr::GtEq:
+                return value.meet(AbstractValue::getRange(other.getLower(), std::nullopt));
+            default:
+                return value;
+        }
+    };
+
+    AbstractValue newLhs = constrain(kind, lhs, rhs);
+    AbstractValue newRhs = constrain(swapRelation(kind), rhs, lhs);
+    if (newLhs.isBottom() || newRhs.isBottom()) {
+        state.setBottom();
+        return;
+    }
+
+    if (Variable* variable = this->getRefinableVariable(left, state)) {
+        state.set(variable, state.get(variable).meet(newLhs));
+    }
+
+    if (Variable* variable = this->getRefinableVariable(right, state)) {
+        state.set(variable, state.get(variable).meet(newRhs));
+    }
+}
+
+AbstractState AbstractInterpreter::transfer(Transition* edge, const AbstractState& state)
+{
+    AbstractState result = this->applyGuard(state, edge->getGuard());
+    if (result.isBottom()) {
+        return result;
+    }
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        // Assignments of a transition are sequential.
+        for (const VariableAssignment& va : *assign) {
+            result.set(va.getVariable(), this->evaluate(va.getValue(), result));
+        }
+
+        return result;
+    }
+
+    auto call = llvm::cast<CallTransition>(edge);
+    Cfa* callee = call->getCalledAutomaton();
+
+    AbstractState input;
+    for (const VariableAssignment& va : call->inputs()) {
+        input.set(va.getVariable(), this->evaluate(va.getValue(), result));
+    }
+    this->updateEntryState(callee, input);
+
+    auto it = mSummaries.find(callee);
+    if (it == mSummaries.end() || it->second.isBottom()) {
+        // The callee never returns, as far as we know.
+        return AbstractState::getBottom();
+    }
+
+    AbstractState summary = it->second;
+    for (const VariableAssignment& va : call->outputs()) {
+        result.set(va.getVariable(), this->evaluate(va.getValue(), summary));
+    }
+
+    return result;
+}
+
+void AbstractInterpreter::updateEntryState(Cfa* cfa, const AbstractState& input)
+{
+    auto [it, inserted] = mEntryStates.try_emplace(cfa, input);
+    if (inserted) {
+        mChanged = true;
+        return;
+    }
+
+    AbstractState joined = it->second.join(input);
+    if (joined == it->second) {
+        return;
+    }
+
+    if (++mNumEntryUpdates[cfa] > WideningDelay) {
+        joined = it->second.widen(joined);
+    }
+
+    it->second = joined;
+    mChanged = true;
+}
+
+void AbstractInterpreter::updateSummary(Cfa* cfa, const AbstractState& exit)
+{
+    if (exit.isBottom()) {
+        return;
+    }
+
+    auto [it, inserted] = mSummaries.try_emplace(cfa, exit);
+    if (inserted) {
+        mChanged = true;
+        return;
+    }
+
+    AbstractState joined = it->second.join(exit);
+    if (joined == it->second) {
+        return;
+    }
+
+    if (++mNumSummaryUpdates[cfa] > WideningDelay) {
+        joined = it->second.widen(joined);
+    }
+
+    it->second = joined;
+    mChanged = true;
+}
+
+void AbstractInterpreter::analyzeAutomaton(Cfa& cfa)
+{
+    for (Location* loc : cfa.nodes()) {
+        mStates.erase(loc);
+    }
+
+    auto entry = mEntryStates.find(&cfa);
+    if (entry == mEntryStates.end()) {
+        return;
+    }
+
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> topoNumbers;
+    createTopologicalSort(cfa, topo, &topoNumbers);
+
+    llvm::DenseMap<Location*, unsigned> numUpdates;
+    std::set<size_t> worklist;
+
+    mStates[cfa.getEntry()] = entry->second;
+    worklist.insert(topoNumbers[cfa.getEntry()]);
+
+    while (!worklist.empty()) {
+        size_t idx = *worklist.begin();
+        worklist.erase(worklist.begin());
+
+        Location* loc = topo[idx];
+        AbstractState state = mStates[loc];
+
+        for (Transition* edge : loc->outgoing()) {
+            AbstractState post = this->transfer(edge, state);
+            if (post.isBottom()) {
+                continue;
+            }
+
+            Location* target = edge->getTarget();
+            size_t targetIdx = topoNumbers[target];
+            AbstractState old = this->getState(target);
+            AbstractState joined = old.join(post);
+            if (joined == old) {
+                continue;
+            }
+
+            // Back edges point to a location which precedes their source in
+            // the topological order.
+            if (targetIdx <= idx && ++numUpdates[target] > WideningDelay) {
+                joined = old.widen(joined);
+            }
+
+            mStates[target] = joined;
+            worklist.insert(targetIdx);
+        }
+    }
+
+    this->updateSummary(&cfa, this->getState(cfa.getExit()));
+}
+
+void AbstractInterpreter::analyze()
+{
+    this->collectDefinitions();
+
+    if (Cfa* main = mSystem.getMainAutomaton()) {
+        mEntryStates[main] = AbstractState();
+    }
+
+    unsigned round = 0;
+    do {
+        mChanged = false;
+        for (Cfa& cfa : mSystem) {
+            this->analyzeAutomaton(cfa);
+        }
+        ++round;
+    } while (mChanged);
+
+    LLVM_DEBUG(llvm::dbgs() << "Abstract interpretation converged in " << round << " rounds.\n");
+}
+
+bool AbstractInterpreter::isFeasible(Transition* edge)
+{
+    AbstractState state = this->getState(edge->getSource());
+    if (state.isBottom()) {
+        return false;
+    }
+
+    // A call may fail within the callee even if it never returns.
+    if (llvm::isa<CallTransition>(edge)) {
+        return !this->applyGuard(state, edge->getGuard()).isBottom();
+    }
+
+    return !this->transfer(edge, state).isBottom();
+}
+
+void AbstractInterpreter::removeIrrelevantLocations(Cfa& cfa, const llvm::DenseSet<Cfa*>& mayFail)
+{
+    // Keep the locations which may reach the exit location, an error
+    // location, or a call to an automaton which may fail.
+    std::vector<Location*> worklist;
+    worklist.push_back(cfa.getExit());
+
+    for (Location* loc : cfa.nodes()) {
+        if (loc->isError() && loc->getNumIncoming() != 0) {
+            worklist.push_back(loc);
+        }
+    }
+
+    for (Transition* edge : cfa.edges()) {
+        auto call = llvm::dyn_cast<CallTransition>(edge);
+        if (call != nullptr && call->getSource() != nullptr && call->getTarget() != nullptr
+            && mayFail.count(call->getCalledAutomaton()) != 0) {
+            worklist.push_back(call->getTarget());
+        }
+    }
+
+    llvm::DenseSet<Location*> visited;
+    while (!worklist.empty()) {
+        Location* loc = worklist.back();
+        worklist.pop_back();
+
+        if (!visited.insert(loc).second) {
+            continue;
+        }
+
+        for (Transition* edge : loc->incoming()) {
+            worklist.push_back(edge->getSource());
+        }
+    }
+
+    for (Location* loc : cfa.nodes()) {
+        if (visited.count(loc) == 0 && loc != cfa.getEntry() && loc != cfa.getExit()) {
+            cfa.disconnectNode(loc);
+        }
+    }
+
+    cfa.clearDisconnectedElements();
+}
+
+DischargeResult AbstractInterpreter::discharge()
+{
+    DischargeResult result;
+    for (Cfa& cfa : mSystem) {
+        result.numErrors += cfa.getNumErrors();
+    }
+
+    for (Cfa& cfa : mSystem) {
+        std::vector<Transition*> infeasible;
+        for (Transition* edge : cfa.edges()) {
+            if (!this->isFeasible(edge)) {
+                infeasible.push_back(edge);
+            }
+        }
+
+        for (Transition* edge : infeasible) {
+            cfa.disconnectEdge(edge);
+        }
+    }
+
+    // An automaton may fail if it has a reachable error location, or if it
+    // calls an automaton which may fail.
+    llvm::DenseSet<Cfa*> mayFail;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (Cfa& cfa : mSystem) {
+            if (mayFail.count(&cfa) != 0) {
+                continue;
+            }
+
+            bool fails = llvm::any_of(cfa.nodes(), [](Location* loc) {
+                return loc->isError() && loc->getNumIncoming() != 0;
+            }) || llvm::any_of(cfa.edges(), [&mayFail](Transition* edge) {
+                auto call = llvm::dyn_cast<CallTransition>(edge);
+                return call != nullptr && call->getSource() != nullptr && call->getTarget() != nullptr
+                    && mayFail.count(call->getCalledAutomaton()) != 0;
+            });
+
+            if (fails) {
+                mayFail.insert(&cfa);
+                changed = true;
+            }
+        }
+    }
+
+    for (Cfa& cfa : mSystem) {
+        this->removeIrrelevantLocations(cfa, mayFail);
+        result.numRemaining += cfa.getNumErrors();
+    }
+
+    return result;
+}
+
+ExprVector AbstractInterpreter::getInvariants(Location* location, ExprBuilder& builder) const
+{
+    AbstractState state = this->getState(location);
+    if (state.isBottom()) {
+        return { builder.False() };
+    }
+
+    ExprVector result;
+    auto addFacts = [&state, &builder, &result](Variable* variable) {
+        AbstractValue value = state.get(variable);
+        Type& type = variable->getType();
+        if (value == AbstractValue::getTop(type)) {
+            return;
+        }
+
+        ExprPtr ref = variable->getRefExpr();
+        if (type.isBoolType()) {
+            if (auto constant = value.getConstantValue()) {
+                result.push_back(*constant != 0 ? ref : builder.Not(ref));
+            }
+        } else if (auto bvTy = llvm::dyn_cast<BvType>(&type); bvTy && bvTy->getWidth() <= 64) {
+            unsigned width = bvTy->getWidth();
+            auto literal = [&builder, width](int64_t v) {
+                return builder.BvLit(llvm::APInt(width, v, /*isSigned=*/true));
+            };
+
+            if (auto lo = value.getLower()) {
+                result.push_back(builder.BvSGtEq(ref, literal(*lo)));
+            }
+            if (auto hi = value.getUpper()) {
+                result.push_back(builder.BvSLtEq(ref, literal(*hi)));
+            }
+
+            // The remainder of a two's complement number modulo a power of
+            // two is given by its low bits, regardless of its sign.
+            int64_t stride = value.getStride();
+            if (stride > 1 && llvm::isPowerOf2_64(stride)
+                && stride <= llvm::APInt::getSignedMaxValue(width).getSExtValue()
+            ) {
+                result.push_back(builder.Eq(
+                    builder.BvURem(ref, literal(stride)), literal(value.getRemainder())
+                ));
+            }
+        } else if (type.isIntType()) {
+            if (auto lo = value.getLower()) {
+                result.push_back(builder.GtEq(ref, builder.IntLit(*lo)));
+            }
+            if (auto hi = value.getUpper()) {
+                result.push_back(builder.LtEq(ref, builder.IntLit(*hi)));
+            }
+            if (value.getStride() > 1) {
+                result.push_back(builder.Eq(
+                    builder.Mod(ref, builder.IntLit(value.getStride())), builder.IntLit(value.getRemainder())
+                ));
+            }
+        }
+    };
+
+    Cfa* cfa = location->getAutomaton();
+    for (Variable& input : cfa->inputs()) {
+        addFacts(&input);
+    }
+    for (Variable& local : cfa->locals()) {
+        addFacts(&local);
+    }
+
+    return result;
+}
+
+DischargeResult gazer::DischargeUnreachableErrors(AutomataSystem& system)
+{
+    AbstractInterpreter interpreter(system);
+    interpreter.analyze();
+
+    return interpreter.discharge();
+}
+
+auto gazer::ComputeLocationInvariants(AutomataSystem& system, ExprBuilder& builder)
+    -> llvm::DenseMap<Location*, ExprVector>
+{
+    AbstractInterpreter interpreter(system);
+    interpreter.analyze();
+
+    llvm::DenseMap<Location*, ExprVector> result;
+    for (Cfa& cfa : system) {
+        for (Location* loc : cfa.nodes()) {
+            ExprVector invariants = interpreter.getInvariants(loc, builder);
+            if (!invariants.empty()) {
+                result[loc] = std::move(invariants);
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,555 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the reduction of bit-vector variable widths.
+///
+/// The analysis computes an upper bound for the unsigned value of each
+/// bit-vector variable, which is equivalent to the interval [0, bound] and
+/// to knowing that the bits above the highest set bit of the bound are zero.
+/// The bounds are computed over the whole system in a flow-insensitive
+/// manner: each assignment, call input and call output is a definition of its
+/// target variable, whose bound is the maximum of the bounds of its defining
+/// expressions. Bounds which keep increasing are widened to the maximum value
+/// of their type after a fixed number of rounds.
+///
+/// Variables whose bound fits into fewer bits than their type are replaced
+/// with narrower ones. Their uses are zero-extended back to the original
+/// width, while the values assigned to them are truncated. Truncations are
+/// pushed through modular arithmetic, so in most cases the extension of
+/// the narrowed operands cancels out. Comparisons of zero-extended operands
+/// are also performed on the narrower width.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/raw_ostream.h>
+
+#define DEBUG_TYPE "BitWidthReduction"
+
+using namespace gazer;
+
+namespace
+{
+
+/// The number of fixpoint rounds in which bounds may increase freely.
+constexpr unsigned WideningDelay = 3;
+
+unsigned getBvWidth(const ExprPtr& expr)
+{
+    return llvm::cast<BvType>(expr->getType()).getWidth();
+}
+
+/// Computes an upper bound for the unsigned value of bit-vector expressions,
+/// using the given bounds of the variables.
+class UpperBoundWalker : public ExprWalker<UpperBoundWalker, llvm::APInt>
+{
+    friend class ExprWalker<UpperBoundWalker, llvm::APInt>;
+public:
+    explicit UpperBoundWalker(const llvm::DenseMap<Variable*, llvm::APInt>& bounds)
+        : mBounds(bounds)
+    {}
+
+protected:
+    llvm::APInt visitExpr(const ExprPtr& expr)
+    {
+        if (auto bvTy = llvm::dyn_cast<BvType>(&expr->getType())) {
+            return llvm::APInt::getMaxValue(bvTy->getWidth());
+        }
+
+        // The value is not used for expressions of other types.
+        return llvm::APInt(1, 1);
+    }
+
+    llvm::APInt visitBvLiteral(const ExprRef<BvLiteralExpr>& expr) {
+        return expr->getValue();
+    }
+
+    llvm::APInt visitVarRef(const ExprRef<VarRefExpr>& expr)
+    {
+        auto it = mBounds.find(&expr->getVariable());
+        if (it != mBounds.end()) {
+            return it->second;
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    llvm::APInt visitZExt(const ExprRef<ZExtExpr>& expr) {
+        return getOperand(0).zext(expr->getExtendedWidth());
+    }
+
+    llvm::APInt visitSExt(const ExprRef<SExtExpr>& expr)
+    {
+        // Sign extension is zero extension if the sign bit is known to be zero.
+        llvm::APInt operand = getOperand(0);
+        if (!operand.isSignBitSet()) {
+            return operand.zext(expr->getExtendedWidth());
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    llvm::APInt visitExtract(const ExprRef<ExtractExpr>& expr)
+    {
+        llvm::APInt shifted = getOperand(0).lshr(expr->getOffset());
+        if (shifted.getActiveBits() > expr->getWidth()) {
+            return llvm::APInt::getMaxValue(expr->getWidth());
+        }
+
+        return shifted.trunc(expr->getWidth());
+    }
+
+    llvm::APInt visitAdd(const ExprRef<AddExpr>& expr)
+    {
+        if (!expr->getType().isBvType()) {
+            return this->visitExpr(expr);
+        }
+
+        bool overflow = false;
+        llvm::APInt result = getOperand(0).uadd_ov(getOperand(1), overflow);
+
+        return overflow ? this->visitExpr(expr) : result;
+    }
+
+    llvm::APInt visitMul(const ExprRef<MulExpr>& expr)
+    {
+        if (!expr->getType().isBvType()) {
+            return this->visitExpr(expr);
+        }
+
+        bool overflow = false;
+        llvm::APInt result = getOperand(0).umul_ov(getOperand(1), overflow);
+
+        return overflow ? this->visitExpr(expr) : result;
+    }
+
+    llvm::APInt visitBvUDiv(const ExprRef<BvUDivExpr>& expr)
+    {
+        // An unsigned division by zero yields all ones, so the quotient is
+        // only bounded by the dividend if the divisor is known to be non-zero.
+        if (auto divisor = llvm::dyn_cast<BvLiteralExpr>(expr->getOperand(1)); divisor && !divisor->isZero()) {
+            return getOperand(0).udiv(divisor->getValue());
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    llvm::APInt visitBvURem(const ExprRef<BvURemExpr>& expr)
+    {
+        // The remainder of a division by zero is the dividend.
+        if (auto divisor = llvm::dyn_cast<BvLiteralExpr>(expr->getOperand(1)); divisor && !divisor->isZero()) {
+            return llvm::APIntOps::umin(getOperand(0), divisor->getValue() - 1);
+        }
+
+        return getOperand(0);
+    }
+
+    llvm::APInt visitLShr(const ExprRef<LShrExpr>& expr)
+    {
+        if (auto amount = llvm::dyn_cast<BvLiteralExpr>(expr->getOperand(1))) {
+            return getOperand(0).lshr(amount->getValue());
+        }
+
+        return getOperand(0);
+    }
+
+    llvm::APInt visitShl(const ExprRef<ShlExpr>& expr)
+    {
+        auto amount = llvm::dyn_cast<BvLiteralExpr>(expr->getOperand(1));
+        if (amount != nullptr && amount->getValue().ule(getOperand(0).countLeadingZeros())) {
+            return getOperand(0).shl(amount->getValue());
+        }
+
+        return this->visitExpr(expr);
+    }
+
+    llvm::APInt visitBvAnd(const ExprRef<BvAndExpr>& expr) {
+        return llvm::APIntOps::umin(getOperand(0), getOperand(1));
+    }
+
+    llvm::APInt visitBvOr(const ExprRef<BvOrExpr>& expr) {
+        return getLowBitsBound(expr);
+    }
+
+    llvm::APInt visitBvXor(const ExprRef<BvXorExpr>& expr) {
+        return getLowBitsBound(expr);
+    }
+
+    llvm::APInt visitSelect(const ExprRef<SelectExpr>& expr)
+    {
+        if (!expr->getType().isBvType()) {
+            return this->visitExpr(expr);
+        }
+
+        return llvm::APIntOps::umax(getOperand(1), getOperand(2));
+    }
+
+private:
+    /// Returns the bound of a bitwise operation which cannot set bits above
+    /// the highest possibly set bit of its operands.
+    llvm::APInt getLowBitsBound(const ExprPtr& expr)
+    {
+        unsigned bits = std::max(getOperand(0).getActiveBits(), getOperand(1).getActiveBits());
+        return llvm::APInt::getLowBitsSet(getBvWidth(expr), bits);
+    }
+
+private:
+    const llvm::DenseMap<Variable*, llvm::APInt>& mBounds;
+};
+
+/// Truncates \p expr to its lowest \p width bits. As the low bits of modular
+/// arithmetic and bitwise operations only depend on the low bits of their
+/// operands, the truncation is pushed down to the operands of such operations.
+ExprPtr truncate(ExprBuilder& builder, const ExprPtr& expr, unsigned width)
+{
+    if (getBvWidth(expr) == width) {
+        return expr;
+    }
+
+    auto& type = BvType::Get(expr->getContext(), width);
+    auto trunc = [&builder, &expr, width](size_t i) {
+        return truncate(builder, llvm::cast<NonNullaryExpr>(expr)->getOperand(i), width);
+    };
+
+    switch (expr->getKind()) {
+        case Expr::ZExt:
+        case Expr::SExt: {
+            ExprPtr operand = llvm::cast<NonNullaryExpr>(expr)->getOperand(0);
+            unsigned operandWidth = getBvWidth(operand);
+            if (operandWidth >= width) {
+                return truncate(builder, operand, width);
+            }
+
+            return expr->getKind() == Expr::ZExt ? builder.ZExt(operand, type) : builder.SExt(operand, type);
+        }
+        case Expr::Add: return builder.Add(trunc(0), trunc(1));
+        case Expr::Sub: return builder.Sub(trunc(0), trunc(1));
+        case Expr::Mul: return builder.Mul(trunc(0), trunc(1));
+        case Expr::BvAnd: return builder.BvAnd(trunc(0), trunc(1));
+        case Expr::BvOr: return builder.BvOr(trunc(0), trunc(1));
+        case Expr::BvXor: return builder.BvXor(trunc(0), trunc(1));
+        case Expr::Select:
+            return builder.Select(llvm::cast<SelectExpr>(expr)->getCondition(), trunc(1), trunc(2));
+        default:
+            return builder.Extract(expr, 0, width);
+    }
+}
+
+/// Returns the number of low bits of \p expr which may be non-zero, based on
+/// the structure of the expression.
+unsigned getZeroExtendedWidth(const ExprPtr& expr)
+{
+    if (auto zext = llvm::dyn_cast<ZExtExpr>(expr)) {
+        return getBvWidth(zext->getOperand(0));
+    }
+
+    if (auto lit = llvm::dyn_cast<BvLiteralExpr>(expr)) {
+        return std::max(lit->getValue().getActiveBits(), 1u);
+    }
+
+    return getBvWidth(expr);
+}
+
+/// Replaces the uses of narrowed variables with their zero-extended value,
+/// and evaluates comparisons of zero-extended operands on the narrower width.
+class NarrowingRewrite : public ExprRewrite<NarrowingRewrite>
+{
+    friend class ExprWalker<NarrowingRewrite, ExprPtr>;
+public:
+    NarrowingRewrite(ExprBuilder& builder, const llvm::DenseMap<Variable*, ExprPtr>& replacements)
+        : ExprRewrite(builder), mReplacements(replacements)
+    {}
+
+protected:
+    ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr)
+    {
+        auto it = mReplacements.find(&expr->getVariable());
+        if (it != mReplacements.end()) {
+            return it->second;
+        }
+
+        return expr;
+    }
+
+    ExprPtr visitNonNullary(const ExprRef<NonNullaryExpr>& expr)
+    {
+        ExprVector ops(expr->getNumOperands(), nullptr);
+        for (size_t i = 0; i < expr->getNumOperands(); ++i) {
+            ops[i] = this->getOperand(i);
+        }
+
+        if (Expr::FirstCompare <= expr->getKind() && expr->getKind() <= Expr::LastCompare
+            && ops[0]->getType().isBvType()
+        ) {
+            if (auto narrowed = this->narrowComparison(expr->getKind(), ops[0], ops[1])) {
+                return narrowed;
+            }
+        }
+
+        return this->rewriteNonNullary(expr, ops);
+    }
+
+private:
+    ExprPtr narrowComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right)
+    {
+        unsigned width = std::max(getZeroExtendedWidth(left), getZeroExtendedWidth(right));
+        if (width >= getBvWidth(left)) {
+            return nullptr;
+        }
+
+        // Both operands are non-negative in the original width, thus signed
+        // comparisons are equivalent to unsigned ones.
+        ExprPtr lhs = truncate(mExprBuilder, left, width);
+        ExprPtr rhs = truncate(mExprBuilder, right, width);
+
+        switch (kind) {
+            case Expr::Eq: return mExprBuilder.Eq(lhs, rhs);
+            case Expr::NotEq: return mExprBuilder.NotEq(lhs, rhs);
+            case Expr::BvSLt: case Expr::BvULt: return mExprBuilder.BvULt(lhs, rhs);
+            case Expr::BvSLtEq: case Expr::BvULtEq: return mExprBuilder.BvULtEq(lhs, rhs);
+            case Expr::BvSGt: case Expr::BvUGt: return mExprBuilder.BvUGt(lhs, rhs);
+            case Expr::BvSGtEq: case Expr::BvUGtEq: return mExprBuilder.BvUGtEq(lhs, rhs);
+            default:
+                return nullptr;
+        }
+    }
+
+private:
+    const llvm::DenseMap<Variable*, ExprPtr>& mReplacements;
+};
+
+class BitWidthReducer
+{
+public:
+    BitWidthReducer(AutomataSystem& system, ExprBuilder& builder)
+        : mSystem(system), mExprBuilder(builder)
+    {}
+
+    BitWidthReductionResult reduce();
+
+private:
+    void collectDefinitions();
+    void computeBounds();
+    void rewriteAutomaton(Cfa& cfa, NarrowingRewrite& rewrite);
+    VariableAssignment rewriteAssignment(const VariableAssignment& assign, NarrowingRewrite& rewrite);
+
+private:
+    AutomataSystem& mSystem;
+    ExprBuilder& mExprBuilder;
+
+    std::vector<std::pair<Variable*, ExprPtr>> mDefinitions;
+    llvm::DenseMap<Variable*, llvm::APInt> mBounds;
+    llvm::DenseMap<Variable*, Variable*> mNarrowed;
+};
+
+void BitWidthReducer::collectDefinitions()
+{
+    for (Cfa& cfa : mSystem) {
+        for (Transition* edge : cfa.edges()) {
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                for (const VariableAssignment& va : *assign) {
+                    mDefinitions.emplace_back(va.getVariable(), va.getValue());
+                }
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+                for (const VariableAssignment& va : call->inputs()) {
+                    mDefinitions.emplace_back(va.getVariable(), va.getValue());
+                }
+                for (const VariableAssignment& va : call->outputs()) {
+                    mDefinitions.emplace_back(va.getVariable(), va.getValue());
+                }
+            }
+        }
+    }
+
+    // The inputs of the main automaton are unconstrained, and so are the
+    // variables without definitions: these are not tracked.
+    Cfa* main = mSystem.getMainAutomaton();
+    for (auto& [variable, value] : mDefinitions) {
+        auto bvTy = llvm::dyn_cast<BvType>(&variable->getType());
+        if (bvTy == nullptr) {
+            continue;
+        }
+
+        bool isMainInput = main != nullptr && llvm::any_of(main->inputs(), [variable = variable](Variable& input) {
+            return &input == variable;
+        });
+        if (!isMainInput) {
+            mBounds.try_emplace(variable, llvm::APInt::getNullValue(bvTy->getWidth()));
+        }
+    }
+}
+
+void BitWidthReducer::computeBounds()
+{
+    UpperBoundWalker walker(mBounds);
+
+    bool changed = true;
+    for (unsigned round = 0; changed; ++round) {
+        changed = false;
+        for (auto& [variable, value] : mDefinitions) {
+            if (mBounds.count(variable) == 0) {
+                continue;
+            }
+
+            llvm::APInt valueBound = walker.walk(value);
+            llvm::APInt& bound = mBounds.find(variable)->second;
+
+            if (valueBound.ugt(bound)) {
+                bound = round < WideningDelay ? valueBound : llvm::APInt::getMaxValue(bound.getBitWidth());
+                changed = true;
+            }
+        }
+    }
+}
+
+VariableAssignment BitWidthReducer::rewriteAssignment(
+    const VariableAssignment& assign, NarrowingRewrite& rewrite)
+{
+    ExprPtr value = rewrite.walk(assign.getValue());
+
+    Variable* narrowed = mNarrowed.lookup(assign.getVariable());
+    if (narrowed == nullptr) {
+        return VariableAssignment(assign.getVariable(), value);
+    }
+
+    unsigned width = llvm::cast<BvType>(narrowed->getType()).getWidth();
+    return VariableAssignment(narrowed, truncate(mExprBuilder, value, width));
+}
+
+void BitWidthReducer::rewriteAutomaton(Cfa& cfa, NarrowingRewrite& rewrite)
+{
+    std::vector<Transition*> edges(cfa.edge_begin(), cfa.edge_end());
+
+    for (Transition* edge : edges) {
+        ExprPtr guard = rewrite.walk(edge->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            std::vector<VariableAssignment> assigns;
+            for (const VariableAssignment& va : *assign) {
+                assigns.push_back(this->rewriteAssignment(va, rewrite));
+            }
+
+            if (guard == edge->getGuard() && std::equal(assigns.begin(), assigns.end(), assign->begin())) {
+                continue;
+            }
+
+            cfa.createAssignTransition(edge->getSource(), edge->getTarget(), guard, assigns);
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            std::vector<VariableAssignment> inputs;
+            for (const VariableAssignment& va : call->inputs()) {
+                inputs.push_back(this->rewriteAssignment(va, rewrite));
+            }
+
+            std::vector<VariableAssignment> outputs;
+            for (const VariableAssignment& va : call->outputs()) {
+                outputs.push_back(this->rewriteAssignment(va, rewrite));
+            }
+
+            if (guard == edge->getGuard()
+                && std::equal(inputs.begin(), inputs.end(), call->input_begin())
+                && std::equal(outputs.begin(), outputs.end(), call->output_begin())
+            ) {
+                continue;
+            }
+
+            cfa.createCallTransition(
+                edge->getSource(), edge->getTarget(), guard, call->getCalledAutomaton(), inputs, outputs
+            );
+        } else {
+            llvm_unreachable("Unknown transition kind!");
+        }
+
+        cfa.disconnectEdge(edge);
+    }
+
+    std::vector<std::pair<Location*, ExprPtr>> errors(cfa.error_begin(), cfa.error_end());
+    for (auto& [location, errorCode] : errors) {
+        cfa.addErrorCode(location, rewrite.walk(errorCode));
+    }
+
+    cfa.clearDisconnectedElements();
+}
+
+BitWidthReductionResult BitWidthReducer::reduce()
+{
+    BitWidthReductionResult result;
+
+    this->collectDefinitions();
+    this->computeBounds();
+
+    for (Cfa& cfa : mSystem) {
+        std::vector<Variable*> variables;
+        for (Variable& variable : cfa.inputs()) {
+            variables.push_back(&variable);
+        }
+        for (Variable& variable : cfa.locals()) {
+            variables.push_back(&variable);
+        }
+
+        for (Variable* variable : variables) {
+            auto bvTy = llvm::dyn_cast<BvType>(&variable->getType());
+            if (bvTy == nullptr) {
+                continue;
+            }
+
+            result.originalBits += bvTy->getWidth();
+
+            auto it = mBounds.find(variable);
+            unsigned width = it == mBounds.end() ? bvTy->getWidth() : std::max(it->second.getActiveBits(), 1u);
+
+            if (width < bvTy->getWidth()) {
+                Variable* narrowed = cfa.replaceVariable(variable, BvType::Get(mSystem.getContext(), width));
+                mNarrowed[variable] = narrowed;
+                result.replacements[variable] = mExprBuilder.ZExt(narrowed->getRefExpr(), *bvTy);
+
+                LLVM_DEBUG(
+                    llvm::dbgs() << "Narrowing " << variable->getName() << " from "
+                        << bvTy->getWidth() << " to " << width << " bits.\n";
+                );
+            }
+
+            result.reducedBits += width;
+        }
+    }
+
+    if (mNarrowed.empty()) {
+        return result;
+    }
+
+    NarrowingRewrite rewrite(mExprBuilder, result.replacements);
+    for (Cfa& cfa : mSystem) {
+        this->rewriteAutomaton(cfa, rewrite);
+    }
+
+    return result;
+}
+
+} // end anonymous namespace
+
+BitWidthReductionResult gazer::ReduceBitWidths(AutomataSystem& system)
+{
+    auto builder = CreateFoldingExprBuilder(system.getContext());
+    BitWidthReducer reducer(system, *builder);
+
+    return reducer.reduce();
+}
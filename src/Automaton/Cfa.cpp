@@ -25,6 +25,8 @@
 #include <boost/iterator/indirect_iterator.hpp>
 #include <llvm/Support/raw_ostream.h>
 
+#include <memory>
+
 using namespace gazer;
 
 Cfa::Cfa(GazerContext &context, std::string name, AutomataSystem& parent)
@@ -42,8 +44,8 @@ Cfa::Cfa(GazerContext &context, std::string name, AutomataSystem& parent)
 //===----------------------------------------------------------------------===//
 Location* Cfa::createLocation()
 {
-    auto loc = new Location(mLocationIdx++, this);
-    mNodes.emplace_back(loc);
+    auto loc = new (this->allocate<Location>()) Location(mLocationIdx++, this);
+    this->addNode(loc);
     mLocationNumbers[loc->getId()] = loc;
 
     return loc;
@@ -51,8 +53,8 @@ Location* Cfa::createLocation()
 
 Location* Cfa::createErrorLocation()
 {
-    auto loc = new Location(mLocationIdx++, this, Location::Error);
-    mNodes.emplace_back(loc);
+    auto loc = new (this->allocate<Location>()) Location(mLocationIdx++, this, Location::Error);
+    this->addNode(loc);
     mErrorLocations.emplace_back(loc);
     mLocationNumbers[loc->getId()] = loc;
 
@@ -74,12 +76,9 @@ AssignTransition *Cfa::createAssignTransition(
         guard = BoolLiteralExpr::True(mContext);
     }
 
-    std::vector<VariableAssignment> edgeAssigns(assignments.begin(), assignments.end());
-
-    auto edge = new AssignTransition(source, target, std::move(guard), std::move(edgeAssigns));
-    mEdges.emplace_back(edge);
-    source->addOutgoing(edge);
-    target->addIncoming(edge);
+    auto edge = new (this->allocate<AssignTransition>())
+        AssignTransition(source, target, std::move(guard), this->copyAssignments(assignments));
+    this->addEdge(edge);
 
     return edge;
 }
@@ -90,17 +89,25 @@ CallTransition *Cfa::createCallTransition(Location *source, Location *target, co
     assert(source != nullptr);
     assert(target != nullptr);
 
-    std::vector<VariableAssignment> inputs(inputArgs.begin(), inputArgs.end());
-    std::vector<VariableAssignment> outputs(outputArgs.begin(), outputArgs.end());
-
-    auto call = new CallTransition(source, target, guard, callee, std::move(inputs), std::move(outputs));
-    mEdges.emplace_back(call);
-    source->addOutgoing(call);
-    target->addIncoming(call);
+    auto call = new (this->allocate<CallTransition>()) CallTransition(
+        source, target, guard, callee, this->copyAssignments(inputArgs), this->copyAssignments(outputArgs));
+    this->addEdge(call);
 
     return call;
 }
 
+llvm::MutableArrayRef<VariableAssignment> Cfa::copyAssignments(llvm::ArrayRef<VariableAssignment> assignments)
+{
+    if (assignments.empty()) {
+        return {};
+    }
+
+    VariableAssignment* buffer = this->allocate<VariableAssignment>(assignments.size());
+    std::uninitialized_copy(assignments.begin(), assignments.end(), buffer);
+
+    return llvm::makeMutableArrayRef(buffer, assignments.size());
+}
+
 CallTransition *Cfa::createCallTransition(
     Location *source,
     Location *target,
@@ -149,6 +156,18 @@ void Cfa::addOutput(Variable* variable)
     mOutputs.push_back(variable);
 }
 
+Variable* Cfa::replaceVariable(Variable* variable, Type& type)
+{
+    assert(mSymbolNames.count(variable) != 0 && "Can only replace variables of this automaton!");
+    Variable* newVariable = this->createMemberVariable(mSymbolNames[variable], type);
+
+    std::replace(mInputs.begin(), mInputs.end(), variable, newVariable);
+    std::replace(mOutputs.begin(), mOutputs.end(), variable, newVariable);
+    std::replace(mLocals.begin(), mLocals.end(), variable, newVariable);
+
+    return newVariable;
+}
+
 Variable *Cfa::createLocal(const std::string& name, Type& type)
 {
     Variable* variable = this->createMemberVariable(name, type);
@@ -248,6 +267,37 @@ void Cfa::removeUnreachableLocations()
     this->clearDisconnectedElements();
 }
 
+void Cfa::clearDisconnectedElements()
+{
+    if (!this->hasDisconnectedElements()) {
+        return;
+    }
+
+    auto isKept = [this](Location* loc) {
+        return loc == mEntry || loc == mExit;
+    };
+
+    auto isRemoved = [&isKept](Location* loc) {
+        return loc->getNumIncoming() == 0 && loc->getNumOutgoing() == 0 && !isKept(loc);
+    };
+
+    for (Location* loc : nodes()) {
+        if (isRemoved(loc)) {
+            mLocationNumbers.erase(loc->getId());
+            if (loc->isError()) {
+                mErrorFieldExprs.erase(loc);
+            }
+        }
+    }
+
+    mErrorLocations.erase(
+        std::remove_if(mErrorLocations.begin(), mErrorLocations.end(), isRemoved),
+        mErrorLocations.end()
+    );
+
+    Graph::clearDisconnectedElements(isKept);
+}
+
 Cfa::~Cfa() {}
 
 // Transitions
@@ -264,15 +314,20 @@ Transition::Transition(Location* source, Location* target, ExprPtr expr, EdgeKin
 
 AssignTransition::AssignTransition(
     Location *source, Location *target, ExprPtr guard,
-    std::vector<VariableAssignment> assignments
-) : Transition(source, target, std::move(guard), Transition::Edge_Assign), mAssignments(std::move(assignments))
+    llvm::MutableArrayRef<VariableAssignment> assignments
+) : Transition(source, target, std::move(guard), Transition::Edge_Assign), mAssignments(assignments)
 {}
 
+AssignTransition::~AssignTransition()
+{
+    std::destroy(mAssignments.begin(), mAssignments.end());
+}
+
 CallTransition::CallTransition(
     Location *source, Location *target, ExprPtr guard, Cfa *callee,
-    std::vector<VariableAssignment> inputArgs, std::vector<VariableAssignment> outputArgs
+    llvm::MutableArrayRef<VariableAssignment> inputArgs, llvm::MutableArrayRef<VariableAssignment> outputArgs
 ) : Transition(source, target, guard, Transition::Edge_Call), mCallee(callee),
-    mInputArgs(std::move(inputArgs)), mOutputArgs(std::move(outputArgs))
+    mInputArgs(inputArgs), mOutputArgs(outputArgs)
 {
     assert(source != nullptr);
     assert(target != nullptr);
@@ -281,6 +336,12 @@ CallTransition::CallTransition(
     assert(callee->getNumOutputs() == mOutputArgs.size());
 }
 
+CallTransition::~CallTransition()
+{
+    std::destroy(mInputArgs.begin(), mInputArgs.end());
+    std::destroy(mOutputArgs.begin(), mOutputArgs.end());
+}
+
 std::optional<VariableAssignment> CallTransition::getInputArgument(Variable& input) const
 {
     auto result = std::find_if(mInputArgs.begin(), mInputArgs.end(), [&input](auto& assign) {
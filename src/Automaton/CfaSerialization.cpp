@@ -0,0 +1,1202 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the binary format of automata systems.
+///
+/// Integers are written as ULEB128 (or SLEB128) values, except the offsets
+/// of the expression index, which are fixed-width little-endian values.
+/// The layout of a file is the following:
+///
+///     magic, version
+///     types:       count, { type-id, parameters }
+///     automata:    count, { name, inputs, locals, outputs }
+///     expressions: count, size, offset index, { record }
+///     bodies:      { locations, entry, exit, error codes, transitions }
+///     main:        index + 1, or zero if there is no main automaton
+///     messages:    count, { error code, description }
+///
+/// Types, variables, automata, locations and expressions are referred to
+/// by their index. The operands of an expression always precede it in the
+/// table, thus expressions may be rebuilt bottom-up without recursion.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/LEB128.h>
+
+using namespace gazer;
+
+static constexpr char SerializedSystemMagic[] = { 'G', 'Z', 'A', 'S' };
+static constexpr unsigned SerializedSystemVersion = 1;
+
+namespace
+{
+
+enum class TransitionTag : unsigned
+{
+    Assign = 0,
+    Call = 1
+};
+
+bool hasRoundingMode(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::FCast:
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+        case Expr::FAdd:
+        case Expr::FSub:
+        case Expr::FMul:
+        case Expr::FDiv:
+            return true;
+        default:
+            return false;
+    }
+}
+
+llvm::APFloat::roundingMode getRoundingMode(const ExprRef<NonNullaryExpr>& expr)
+{
+    switch (expr->getKind()) {
+        case Expr::FCast: return llvm::cast<FCastExpr>(expr)->getRoundingMode();
+        case Expr::SignedToFp: return llvm::cast<SignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::UnsignedToFp: return llvm::cast<UnsignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::FpToSigned: return llvm::cast<FpToSignedExpr>(expr)->getRoundingMode();
+        case Expr::FpToUnsigned: return llvm::cast<FpToUnsignedExpr>(expr)->getRoundingMode();
+        case Expr::FAdd: return llvm::cast<FAddExpr>(expr)->getRoundingMode();
+        case Expr::FSub: return llvm::cast<FSubExpr>(expr)->getRoundingMode();
+        case Expr::FMul: return llvm::cast<FMulExpr>(expr)->getRoundingMode();
+        case Expr::FDiv: return llvm::cast<FDivExpr>(expr)->getRoundingMode();
+        default:
+            break;
+    }
+
+    llvm_unreachable("Expression has no rounding mode!");
+}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+class SystemWriter
+{
+public:
+    explicit SystemWriter(AutomataSystem& system)
+        : mSystem(system), mTypeOS(mTypeBuffer), mDeclOS(mDeclBuffer),
+        mExprOS(mExprBuffer), mBodyOS(mBodyBuffer)
+    {}
+
+    void write(llvm::raw_ostream& os, const std::map<unsigned, std::string>& messages);
+
+private:
+    void writeDeclarations(Cfa& cfa);
+    void writeBody(Cfa& cfa);
+    void writeAssignments(llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+    uint64_t getTypeId(Type& type);
+    uint64_t getExprId(const ExprPtr& expr);
+    void writeExpr(const ExprPtr& expr);
+    void writeLiteral(const ExprRef<LiteralExpr>& expr);
+
+    static void writeString(llvm::raw_ostream& os, llvm::StringRef str);
+    static void writeAPInt(llvm::raw_ostream& os, const llvm::APInt& value);
+
+private:
+    AutomataSystem& mSystem;
+
+    llvm::DenseMap<Type*, uint64_t> mTypes;
+    llvm::DenseMap<Variable*, uint64_t> mVariables;
+    llvm::DenseMap<Cfa*, uint64_t> mAutomata;
+    llvm::DenseMap<Expr*, uint64_t> mExprs;
+    llvm::DenseMap<Location*, uint64_t> mLocations;
+
+    // Expression records are written in the order of their identifiers, keep
+    // the expressions alive until the whole system is written.
+    std::vector<ExprPtr> mExprList;
+    std::vector<uint64_t> mExprOffsets;
+
+    unsigned mNumTypes = 0;
+
+    llvm::SmallString<256> mTypeBuffer;
+    llvm::SmallString<1024> mDeclBuffer;
+    llvm::SmallString<4096> mExprBuffer;
+    llvm::SmallString<4096> mBodyBuffer;
+    llvm::raw_svector_ostream mTypeOS;
+    llvm::raw_svector_ostream mDeclOS;
+    llvm::raw_svector_ostream mExprOS;
+    llvm::raw_svector_ostream mBodyOS;
+};
+
+} // end anonymous namespace
+
+void SystemWriter::writeString(llvm::raw_ostream& os, llvm::StringRef str)
+{
+    llvm::encodeULEB128(str.size(), os);
+    os << str;
+}
+
+void SystemWriter::writeAPInt(llvm::raw_ostream& os, const llvm::APInt& value)
+{
+    llvm::encodeULEB128(value.getNumWords(), os);
+    for (unsigned i = 0; i < value.getNumWords(); ++i) {
+        llvm::encodeULEB128(value.getRawData()[i], os);
+    }
+}
+
+uint64_t SystemWriter::getTypeId(Type& type)
+{
+    auto it = mTypes.find(&type);
+    if (it != mTypes.end()) {
+        return it->second;
+    }
+
+    // Component types are written before the array types using them.
+    uint64_t indexId = 0;
+    uint64_t elemId = 0;
+    if (auto arrTy = llvm::dyn_cast<ArrayType>(&type)) {
+        indexId = this->getTypeId(arrTy->getIndexType());
+        elemId = this->getTypeId(arrTy->getElementType());
+    }
+
+    llvm::encodeULEB128(type.getTypeID(), mTypeOS);
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+        case Type::IntTypeID:
+        case Type::RealTypeID:
+            break;
+        case Type::BvTypeID:
+            llvm::encodeULEB128(llvm::cast<BvType>(type).getWidth(), mTypeOS);
+            break;
+        case Type::FloatTypeID:
+            llvm::encodeULEB128(llvm::cast<FloatType>(type).getPrecision(), mTypeOS);
+            break;
+        case Type::ArrayTypeID:
+            llvm::encodeULEB128(indexId, mTypeOS);
+            llvm::encodeULEB128(elemId, mTypeOS);
+            break;
+        case Type::TupleTypeID:
+        case Type::FunctionTypeID:
+            llvm_unreachable("Cannot serialize tuple or function types.");
+    }
+
+    mTypes[&type] = mNumTypes;
+    return mNumTypes++;
+}
+
+uint64_t SystemWriter::getExprId(const ExprPtr& root)
+{
+    auto it = mExprs.find(root.get());
+    if (it != mExprs.end()) {
+        return it->second;
+    }
+
+    // Assign identifiers in post-order, so that operands precede their users.
+    llvm::SmallVector<std::pair<ExprPtr, bool>, 16> worklist = { { root, false } };
+    while (!worklist.empty()) {
+        auto [expr, visited] = worklist.pop_back_val();
+        if (mExprs.count(expr.get()) != 0) {
+            continue;
+        }
+
+        if (visited) {
+            this->writeExpr(expr);
+            continue;
+        }
+
+        worklist.emplace_back(expr, true);
+        if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            for (const ExprPtr& operand : nonNullary->operands()) {
+                worklist.emplace_back(operand, false);
+            }
+        } else if (auto array = llvm::dyn_cast<ArrayLiteralExpr>(expr)) {
+            for (auto& [index, elem] : array->getMap()) {
+                worklist.emplace_back(index, false);
+                worklist.emplace_back(elem, false);
+            }
+            if (array->hasDefault()) {
+                worklist.emplace_back(array->getDefault(), false);
+            }
+        }
+    }
+
+    return mExprs[root.get()];
+}
+
+void SystemWriter::writeExpr(const ExprPtr& expr)
+{
+    uint64_t typeId = this->getTypeId(expr->getType());
+
+    mExprOffsets.push_back(mExprBuffer.size());
+    llvm::encodeULEB128(expr->getKind(), mExprOS);
+    llvm::encodeULEB128(typeId, mExprOS);
+
+    switch (expr->getKind()) {
+        case Expr::Undef:
+            break;
+        case Expr::VarRef: {
+            Variable* variable = &llvm::cast<VarRefExpr>(expr)->getVariable();
+            assert(mVariables.count(variable) != 0 && "Referenced variables must be declared!");
+            llvm::encodeULEB128(mVariables[variable], mExprOS);
+            break;
+        }
+        case Expr::Literal:
+            this->writeLiteral(llvm::cast<LiteralExpr>(expr));
+            break;
+        case Expr::TupleSelect:
+        case Expr::TupleConstruct:
+            llvm_unreachable("Cannot serialize tuple expressions.");
+        default: {
+            auto nonNullary = llvm::cast<NonNullaryExpr>(expr);
+            llvm::encodeULEB128(nonNullary->getNumOperands(), mExprOS);
+            for (const ExprPtr& operand : nonNullary->operands()) {
+                llvm::encodeULEB128(mExprs[operand.get()], mExprOS);
+            }
+
+            if (auto extract = llvm::dyn_cast<ExtractExpr>(expr)) {
+                llvm::encodeULEB128(extract->getOffset(), mExprOS);
+                llvm::encodeULEB128(extract->getExtractedWidth(), mExprOS);
+            } else if (hasRoundingMode(expr->getKind())) {
+                llvm::encodeULEB128(static_cast<unsigned>(getRoundingMode(nonNullary)), mExprOS);
+            }
+            break;
+        }
+    }
+
+    mExprs[expr.get()] = mExprList.size();
+    mExprList.push_back(expr);
+}
+
+void SystemWriter::writeLiteral(const ExprRef<LiteralExpr>& expr)
+{
+    switch (expr->getType().getTypeID()) {
+        case Type::BoolTypeID:
+            llvm::encodeULEB128(llvm::cast<BoolLiteralExpr>(expr)->getValue(), mExprOS);
+            return;
+        case Type::IntTypeID:
+            llvm::encodeSLEB128(llvm::cast<IntLiteralExpr>(expr)->getValue(), mExprOS);
+            return;
+        case Type::RealTypeID: {
+            auto value = llvm::cast<RealLiteralExpr>(expr)->getValue();
+            llvm::encodeSLEB128(value.numerator(), mExprOS);
+            llvm::encodeSLEB128(value.denominator(), mExprOS);
+            return;
+        }
+        case Type::BvTypeID:
+            writeAPInt(mExprOS, llvm::cast<BvLiteralExpr>(expr)->getValue());
+            return;
+        case Type::FloatTypeID:
+            writeAPInt(mExprOS, llvm::cast<FloatLiteralExpr>(expr)->getValue().bitcastToAPInt());
+            return;
+        case Type::ArrayTypeID: {
+            auto array = llvm::cast<ArrayLiteralExpr>(expr);
+            llvm::encodeULEB128(array->getMap().size(), mExprOS);
+            for (auto& [index, elem] : array->getMap()) {
+                llvm::encodeULEB128(mExprs[index.get()], mExprOS);
+                llvm::encodeULEB128(mExprs[elem.get()], mExprOS);
+            }
+            llvm::encodeULEB128(array->hasDefault(), mExprOS);
+            if (array->hasDefault()) {
+                llvm::encodeULEB128(mExprs[array->getDefault().get()], mExprOS);
+            }
+            return;
+        }
+        case Type::TupleTypeID:
+        case Type::FunctionTypeID:
+            break;
+    }
+
+    llvm_unreachable("Invalid literal expression type!");
+}
+
+void SystemWriter::writeDeclarations(Cfa& cfa)
+{
+    // Variable names are prefixed with the name of their automaton,
+    // only the suffix is written, as the prefix is added again on loading.
+    std::string prefix = cfa.getName().str() + "/";
+    auto writeVariable = [this, &prefix](Variable& variable) {
+        std::string name = variable.getName();
+        if (llvm::StringRef(name).startswith(prefix)) {
+            name = name.substr(prefix.size());
+        }
+
+        writeString(mDeclOS, name);
+        llvm::encodeULEB128(this->getTypeId(variable.getType()), mDeclOS);
+
+        uint64_t index = mVariables.size();
+        mVariables[&variable] = index;
+    };
+
+    writeString(mDeclOS, cfa.getName());
+
+    llvm::encodeULEB128(cfa.getNumInputs(), mDeclOS);
+    for (Variable& input : cfa.inputs()) {
+        writeVariable(input);
+    }
+
+    llvm::DenseMap<Variable*, uint64_t> localIndices;
+    llvm::encodeULEB128(cfa.getNumLocals(), mDeclOS);
+    for (Variable& local : cfa.locals()) {
+        uint64_t index = localIndices.size();
+        localIndices[&local] = index;
+        writeVariable(local);
+    }
+
+    llvm::encodeULEB128(cfa.getNumOutputs(), mDeclOS);
+    for (Variable& output : cfa.outputs()) {
+        llvm::encodeULEB128(localIndices[&output], mDeclOS);
+    }
+}
+
+void SystemWriter::writeBody(Cfa& cfa)
+{
+    mLocations.clear();
+
+    llvm::encodeULEB128(cfa.getNumLocations(), mBodyOS);
+    for (Location* loc : cfa.nodes()) {
+        uint64_t index = mLocations.size();
+        mLocations[loc] = index;
+        llvm::encodeULEB128(loc->isError(), mBodyOS);
+    }
+    llvm::encodeULEB128(mLocations[cfa.getEntry()], mBodyOS);
+    llvm::encodeULEB128(mLocations[cfa.getExit()], mBodyOS);
+
+    llvm::encodeULEB128(cfa.getNumErrors(), mBodyOS);
+    for (auto& [location, errorCode] : cfa.errors()) {
+        llvm::encodeULEB128(mLocations[location], mBodyOS);
+        llvm::encodeULEB128(this->getExprId(errorCode), mBodyOS);
+    }
+
+    llvm::encodeULEB128(cfa.getNumTransitions(), mBodyOS);
+    for (Transition* edge : cfa.edges()) {
+        if (llvm::isa<AssignTransition>(edge)) {
+            llvm::encodeULEB128(static_cast<unsigned>(TransitionTag::Assign), mBodyOS);
+        } else {
+            llvm::encodeULEB128(static_cast<unsigned>(TransitionTag::Call), mBodyOS);
+        }
+
+        llvm::encodeULEB128(mLocations[edge->getSource()], mBodyOS);
+        llvm::encodeULEB128(mLocations[edge->getTarget()], mBodyOS);
+        llvm::encodeULEB128(this->getExprId(edge->getGuard()), mBodyOS);
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            this->writeAssignments(llvm::make_range(assign->begin(), assign->end()));
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            llvm::encodeULEB128(mAutomata[call->getCalledAutomaton()], mBodyOS);
+            this->writeAssignments(call->inputs());
+            this->writeAssignments(call->outputs());
+        } else {
+            llvm_unreachable("Unknown transition kind!");
+        }
+    }
+}
+
+void SystemWriter::writeAssignments(
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    llvm::encodeULEB128(std::distance(assigns.begin(), assigns.end()), mBodyOS);
+    for (const VariableAssignment& assign : assigns) {
+        llvm::encodeULEB128(mVariables[assign.getVariable()], mBodyOS);
+        llvm::encodeULEB128(this->getExprId(assign.getValue()), mBodyOS);
+    }
+}
+
+void SystemWriter::write(llvm::raw_ostream& os, const std::map<unsigned, std::string>& messages)
+{
+    // The declarations of every automaton must be known before the
+    // bodies, as call transitions refer to the interface of the callee.
+    for (Cfa& cfa : mSystem) {
+        uint64_t index = mAutomata.size();
+        mAutomata[&cfa] = index;
+        this->writeDeclarations(cfa);
+    }
+
+    for (Cfa& cfa : mSystem) {
+        this->writeBody(cfa);
+    }
+
+    os.write(SerializedSystemMagic, sizeof(SerializedSystemMagic));
+    llvm::encodeULEB128(SerializedSystemVersion, os);
+
+    llvm::encodeULEB128(mNumTypes, os);
+    os << mTypeOS.str();
+
+    llvm::encodeULEB128(mSystem.getNumAutomata(), os);
+    os << mDeclOS.str();
+
+    llvm::encodeULEB128(mExprList.size(), os);
+    llvm::encodeULEB128(mExprBuffer.size(), os);
+    for (uint64_t offset : mExprOffsets) {
+        llvm::support::endian::write<uint64_t>(os, offset, llvm::support::little);
+    }
+    os << mExprOS.str();
+
+    os << mBodyOS.str();
+
+    Cfa* main = mSystem.getMainAutomaton();
+    llvm::encodeULEB128(main == nullptr ? 0 : mAutomata[main] + 1, os);
+
+    llvm::encodeULEB128(messages.size(), os);
+    for (auto& [code, message] : messages) {
+        llvm::encodeULEB128(code, os);
+        writeString(os, message);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+class SystemReader
+{
+public:
+    SystemReader(llvm::MemoryBufferRef buffer, GazerContext& context)
+        : mPtr(reinterpret_cast<const uint8_t*>(buffer.getBufferStart())),
+        mEnd(reinterpret_cast<const uint8_t*>(buffer.getBufferEnd())),
+        mBuilder(CreateExprBuilder(context)), mContext(context)
+    {}
+
+    SerializedAutomataSystem read();
+
+private:
+    bool readTypes();
+    bool readDeclarations(AutomataSystem& system);
+    bool readExprTable();
+    bool readBody(Cfa& cfa);
+    bool readAssignments(std::vector<VariableAssignment>& assigns);
+    bool readMessages(std::map<unsigned, std::string>& messages);
+
+    ExprPtr getExpr(uint64_t id);
+    ExprPtr buildExpr(uint64_t id, llvm::SmallVectorImpl<uint64_t>& missing);
+    ExprRef<LiteralExpr> buildLiteral(Type& type, llvm::SmallVectorImpl<uint64_t>& missing);
+
+    Type* getType(uint64_t id);
+    Variable* getVariable(uint64_t id);
+
+    uint64_t readULEB128();
+    int64_t readSLEB128();
+    llvm::StringRef readString();
+    llvm::APInt readAPInt(unsigned width);
+
+    /// Reads an index into a table of \p size elements.
+    bool readIndex(uint64_t size, uint64_t& index);
+
+    bool fail(const llvm::Twine& message)
+    {
+        if (mError.empty()) {
+            mError = message.str();
+        }
+        return false;
+    }
+
+private:
+    const uint8_t* mPtr;
+    const uint8_t* mEnd;
+    std::unique_ptr<ExprBuilder> mBuilder;
+    GazerContext& mContext;
+    std::string mError;
+
+    std::vector<Type*> mTypes;
+    std::vector<Variable*> mVariables;
+    std::vector<Cfa*> mAutomata;
+
+    // The expression table is not copied, records are decoded directly
+    // from the underlying buffer when they are first referenced.
+    const uint8_t* mExprIndex = nullptr;
+    const uint8_t* mExprTable = nullptr;
+    uint64_t mExprTableSize = 0;
+    std::vector<ExprPtr> mExprs;
+
+    std::vector<Location*> mLocations;
+};
+
+} // end anonymous namespace
+
+uint64_t SystemReader::readULEB128()
+{
+    unsigned length = 0;
+    const char* error = nullptr;
+    uint64_t value = llvm::decodeULEB128(mPtr, &length, mEnd, &error);
+    if (error != nullptr) {
+        this->fail(error);
+        mPtr = mEnd;
+        return 0;
+    }
+
+    mPtr += length;
+    return value;
+}
+
+int64_t SystemReader::readSLEB128()
+{
+    unsigned length = 0;
+    const char* error = nullptr;
+    int64_t value = llvm::decodeSLEB128(mPtr, &length, mEnd, &error);
+    if (error != nullptr) {
+        this->fail(error);
+        mPtr = mEnd;
+        return 0;
+    }
+
+    mPtr += length;
+    return value;
+}
+
+llvm::StringRef SystemReader::readString()
+{
+    uint64_t length = this->readULEB128();
+    if (length > static_cast<uint64_t>(mEnd - mPtr)) {
+        this->fail("string exceeds the end of the input");
+        mPtr = mEnd;
+        return "";
+    }
+
+    llvm::StringRef result(reinterpret_cast<const char*>(mPtr), length);
+    mPtr += length;
+
+    return result;
+}
+
+llvm::APInt SystemReader::readAPInt(unsigned width)
+{
+    uint64_t numWords = this->readULEB128();
+    if (numWords != llvm::APInt::getNumWords(width)) {
+        this->fail("invalid number of words in an integer literal");
+        return llvm::APInt(width, 0);
+    }
+
+    llvm::SmallVector<uint64_t, 2> words;
+    for (uint64_t i = 0; i < numWords; ++i) {
+        words.push_back(this->readULEB128());
+    }
+
+    return llvm::APInt(width, words);
+}
+
+bool SystemReader::readIndex(uint64_t size, uint64_t& index)
+{
+    index = this->readULEB128();
+    if (!mError.empty()) {
+        return false;
+    }
+
+    if (index >= size) {
+        return this->fail("index " + llvm::Twine(index) + " is out of range");
+    }
+
+    return true;
+}
+
+Type* SystemReader::getType(uint64_t id)
+{
+    if (id >= mTypes.size()) {
+        this->fail("invalid type reference " + llvm::Twine(id));
+        return nullptr;
+    }
+
+    return mTypes[id];
+}
+
+Variable* SystemReader::getVariable(uint64_t id)
+{
+    if (id >= mVariables.size()) {
+        this->fail("invalid variable reference " + llvm::Twine(id));
+        return nullptr;
+    }
+
+    return mVariables[id];
+}
+
+bool SystemReader::readTypes()
+{
+    uint64_t numTypes = this->readULEB128();
+    for (uint64_t i = 0; i < numTypes && mError.empty(); ++i) {
+        uint64_t typeId = this->readULEB128();
+        switch (typeId) {
+            case Type::BoolTypeID: mTypes.push_back(&BoolType::Get(mContext)); break;
+            case Type::IntTypeID: mTypes.push_back(&IntType::Get(mContext)); break;
+            case Type::RealTypeID: mTypes.push_back(&RealType::Get(mContext)); break;
+            case Type::BvTypeID: {
+                uint64_t width = this->readULEB128();
+                if (width == 0 || width > std::numeric_limits<unsigned>::max()) {
+                    return this->fail("invalid bit-vector width");
+                }
+                mTypes.push_back(&BvType::Get(mContext, width));
+                break;
+            }
+            case Type::FloatTypeID: {
+                uint64_t precision = this->readULEB128();
+                if (precision != FloatType::Half && precision != FloatType::Single
+                    && precision != FloatType::Double && precision != FloatType::Quad) {
+                    return this->fail("invalid floating-point precision");
+                }
+                mTypes.push_back(&FloatType::Get(mContext, static_cast<FloatType::FloatPrecision>(precision)));
+                break;
+            }
+            case Type::ArrayTypeID: {
+                Type* indexType = this->getType(this->readULEB128());
+                Type* elemType = this->getType(this->readULEB128());
+                if (indexType == nullptr || elemType == nullptr) {
+                    return false;
+                }
+                mTypes.push_back(&ArrayType::Get(*indexType, *elemType));
+                break;
+            }
+            default:
+                return this->fail("invalid type identifier " + llvm::Twine(typeId));
+        }
+    }
+
+    return mError.empty();
+}
+
+bool SystemReader::readDeclarations(AutomataSystem& system)
+{
+    uint64_t numAutomata = this->readULEB128();
+    for (uint64_t i = 0; i < numAutomata && mError.empty(); ++i) {
+        Cfa* cfa = system.createCfa(this->readString().str());
+        mAutomata.push_back(cfa);
+
+        auto readVariables = [this, cfa](bool isInput) {
+            uint64_t numVariables = this->readULEB128();
+            for (uint64_t j = 0; j < numVariables && mError.empty(); ++j) {
+                std::string name = this->readString().str();
+                Type* type = this->getType(this->readULEB128());
+                if (type == nullptr) {
+                    return;
+                }
+
+                mVariables.push_back(isInput ? cfa->createInput(name, *type) : cfa->createLocal(name, *type));
+            }
+        };
+
+        readVariables(true);
+
+        size_t firstLocal = mVariables.size();
+        readVariables(false);
+        uint64_t numLocals = mVariables.size() - firstLocal;
+
+        uint64_t numOutputs = this->readULEB128();
+        for (uint64_t j = 0; j < numOutputs; ++j) {
+            uint64_t index;
+            if (!this->readIndex(numLocals, index)) {
+                return false;
+            }
+            cfa->addOutput(mVariables[firstLocal + index]);
+        }
+    }
+
+    return mError.empty();
+}
+
+bool SystemReader::readExprTable()
+{
+    uint64_t numExprs = this->readULEB128();
+    mExprTableSize = this->readULEB128();
+    if (!mError.empty()) {
+        return false;
+    }
+
+    uint64_t available = mEnd - mPtr;
+    if (numExprs > available / sizeof(uint64_t)
+        || mExprTableSize > available - numExprs * sizeof(uint64_t)) {
+        return this->fail("expression table exceeds the end of the input");
+    }
+
+    mExprIndex = mPtr;
+    mExprTable = mPtr + numExprs * sizeof(uint64_t);
+    mExprs.resize(numExprs);
+    mPtr = mExprTable + mExprTableSize;
+
+    return true;
+}
+
+ExprPtr SystemReader::getExpr(uint64_t id)
+{
+    if (id >= mExprs.size()) {
+        this->fail("invalid expression reference " + llvm::Twine(id));
+        return nullptr;
+    }
+
+    if (mExprs[id] != nullptr) {
+        return mExprs[id];
+    }
+
+    // Records are decoded with a cursor of their own, save the current one.
+    const uint8_t* savedPtr = mPtr;
+    const uint8_t* savedEnd = mEnd;
+
+    llvm::SmallVector<uint64_t, 16> worklist = { id };
+    llvm::SmallVector<uint64_t, 4> missing;
+    while (!worklist.empty() && mError.empty()) {
+        uint64_t current = worklist.back();
+        if (mExprs[current] != nullptr) {
+            worklist.pop_back();
+            continue;
+        }
+
+        missing.clear();
+        ExprPtr expr = this->buildExpr(current, missing);
+        if (!missing.empty()) {
+            worklist.append(missing.begin(), missing.end());
+            continue;
+        }
+
+        mExprs[current] = expr;
+        worklist.pop_back();
+    }
+
+    mPtr = savedPtr;
+    mEnd = savedEnd;
+
+    return mExprs[id];
+}
+
+ExprPtr SystemReader::buildExpr(uint64_t id, llvm::SmallVectorImpl<uint64_t>& missing)
+{
+    uint64_t offset = llvm::support::endian::read64le(mExprIndex + id * sizeof(uint64_t));
+    if (offset >= mExprTableSize) {
+        this->fail("invalid expression offset");
+        return nullptr;
+    }
+
+    mPtr = mExprTable + offset;
+    mEnd = mExprTable + mExprTableSize;
+
+    uint64_t kind = this->readULEB128();
+    Type* type = this->getType(this->readULEB128());
+    if (type == nullptr) {
+        return nullptr;
+    }
+
+    // Operands must precede their users, which also guarantees termination.
+    auto readOperand = [this, id, &missing]() -> ExprPtr {
+        uint64_t operand = this->readULEB128();
+        if (operand >= id) {
+            this->fail("invalid operand reference " + llvm::Twine(operand));
+            return nullptr;
+        }
+        if (mExprs[operand] == nullptr) {
+            missing.push_back(operand);
+        }
+        return mExprs[operand];
+    };
+
+    switch (kind) {
+        case Expr::Undef:
+            return mBuilder->Undef(*type);
+        case Expr::VarRef: {
+            Variable* variable = this->getVariable(this->readULEB128());
+            return variable == nullptr ? nullptr : variable->getRefExpr();
+        }
+        case Expr::Literal: {
+            auto array = llvm::dyn_cast<ArrayType>(type);
+            if (array == nullptr) {
+                return this->buildLiteral(*type, missing);
+            }
+
+            auto readLiteral = [&readOperand, this]() -> ExprRef<LiteralExpr> {
+                ExprPtr operand = readOperand();
+                if (operand != nullptr && !llvm::isa<LiteralExpr>(operand)) {
+                    this->fail("array literal contains a non-literal expression");
+                    return nullptr;
+                }
+                return llvm::cast_or_null<LiteralExpr>(operand);
+            };
+
+            ArrayLiteralExpr::Builder builder(*array);
+            uint64_t numElements = this->readULEB128();
+            for (uint64_t i = 0; i < numElements && mError.empty(); ++i) {
+                auto index = readLiteral();
+                auto elem = readLiteral();
+                if (index != nullptr && elem != nullptr) {
+                    builder.addValue(index, elem);
+                }
+            }
+            if (this->readULEB128() != 0) {
+                if (auto elze = readLiteral()) {
+                    builder.setDefault(elze);
+                }
+            }
+
+            if (!missing.empty() || !mError.empty()) {
+                return nullptr;
+            }
+            return builder.build();
+        }
+        default:
+            break;
+    }
+
+    if (kind < Expr::FirstUnary || kind > Expr::LastExprKind
+        || kind == Expr::TupleSelect || kind == Expr::TupleConstruct) {
+        this->fail("invalid expression kind " + llvm::Twine(kind));
+        return nullptr;
+    }
+
+    uint64_t numOps = this->readULEB128();
+    ExprVector ops;
+    for (uint64_t i = 0; i < numOps && mError.empty(); ++i) {
+        ops.push_back(readOperand());
+    }
+
+    if (!missing.empty() || !mError.empty()) {
+        return nullptr;
+    }
+
+    size_t minOps = 2;
+    switch (kind) {
+        case Expr::Not: case Expr::ZExt: case Expr::SExt: case Expr::Extract:
+        case Expr::FIsNan: case Expr::FIsInf:
+        case Expr::FCast: case Expr::SignedToFp: case Expr::UnsignedToFp:
+        case Expr::FpToSigned: case Expr::FpToUnsigned:
+            minOps = 1;
+            break;
+        case Expr::Select: case Expr::ArrayWrite:
+            minOps = 3;
+            break;
+        default:
+            break;
+    }
+
+    if (ops.size() < minOps) {
+        this->fail("missing operands of expression " + llvm::Twine(id));
+        return nullptr;
+    }
+
+    auto rm = llvm::APFloat::rmNearestTiesToEven;
+    if (hasRoundingMode(static_cast<Expr::ExprKind>(kind))) {
+        rm = static_cast<llvm::APFloat::roundingMode>(this->readULEB128());
+    }
+
+    auto bvType = llvm::dyn_cast<BvType>(type);
+    auto fltType = llvm::dyn_cast<FloatType>(type);
+
+    switch (kind) {
+        case Expr::Not: return mBuilder->Not(ops[0]);
+        case Expr::ZExt: if (bvType) { return mBuilder->ZExt(ops[0], *bvType); } break;
+        case Expr::SExt: if (bvType) { return mBuilder->SExt(ops[0], *bvType); } break;
+        case Expr::Extract: {
+            uint64_t offset = this->readULEB128();
+            uint64_t width = this->readULEB128();
+            return mBuilder->Extract(ops[0], offset, width);
+        }
+        case Expr::Add: return mBuilder->Add(ops[0], ops[1]);
+        case Expr::Sub: return mBuilder->Sub(ops[0], ops[1]);
+        case Expr::Mul: return mBuilder->Mul(ops[0], ops[1]);
+        case Expr::Div: return mBuilder->Div(ops[0], ops[1]);
+        case Expr::Mod: return mBuilder->Mod(ops[0], ops[1]);
+        case Expr::Rem: return mBuilder->Rem(ops[0], ops[1]);
+        case Expr::BvSDiv: return mBuilder->BvSDiv(ops[0], ops[1]);
+        case Expr::BvUDiv: return mBuilder->BvUDiv(ops[0], ops[1]);
+        case Expr::BvSRem: return mBuilder->BvSRem(ops[0], ops[1]);
+        case Expr::BvURem: return mBuilder->BvURem(ops[0], ops[1]);
+        case Expr::Shl: return mBuilder->Shl(ops[0], ops[1]);
+        case Expr::LShr: return mBuilder->LShr(ops[0], ops[1]);
+        case Expr::AShr: return mBuilder->AShr(ops[0], ops[1]);
+        case Expr::BvAnd: return mBuilder->BvAnd(ops[0], ops[1]);
+        case Expr::BvOr: return mBuilder->BvOr(ops[0], ops[1]);
+        case Expr::BvXor: return mBuilder->BvXor(ops[0], ops[1]);
+        case Expr::BvConcat: return mBuilder->BvConcat(ops[0], ops[1]);
+        case Expr::And: return mBuilder->And(ops);
+        case Expr::Or: return mBuilder->Or(ops);
+        case Expr::Imply: return mBuilder->Imply(ops[0], ops[1]);
+        case Expr::Eq: return mBuilder->Eq(ops[0], ops[1]);
+        case Expr::NotEq: return mBuilder->NotEq(ops[0], ops[1]);
+        case Expr::Lt: return mBuilder->Lt(ops[0], ops[1]);
+        case Expr::LtEq: return mBuilder->LtEq(ops[0], ops[1]);
+        case Expr::Gt: return mBuilder->Gt(ops[0], ops[1]);
+        case Expr::GtEq: return mBuilder->GtEq(ops[0], ops[1]);
+        case Expr::BvSLt: return mBuilder->BvSLt(ops[0], ops[1]);
+        case Expr::BvSLtEq: return mBuilder->BvSLtEq(ops[0], ops[1]);
+        case Expr::BvSGt: return mBuilder->BvSGt(ops[0], ops[1]);
+        case Expr::BvSGtEq: return mBuilder->BvSGtEq(ops[0], ops[1]);
+        case Expr::BvULt: return mBuilder->BvULt(ops[0], ops[1]);
+        case Expr::BvULtEq: return mBuilder->BvULtEq(ops[0], ops[1]);
+        case Expr::BvUGt: return mBuilder->BvUGt(ops[0], ops[1]);
+        case Expr::BvUGtEq: return mBuilder->BvUGtEq(ops[0], ops[1]);
+        case Expr::FIsNan: return mBuilder->FIsNan(ops[0]);
+        case Expr::FIsInf: return mBuilder->FIsInf(ops[0]);
+        case Expr::FCast: if (fltType) { return mBuilder->FCast(ops[0], *fltType, rm); } break;
+        case Expr::SignedToFp: if (fltType) { return mBuilder->SignedToFp(ops[0], *fltType, rm); } break;
+        case Expr::UnsignedToFp: if (fltType) { return mBuilder->UnsignedToFp(ops[0], *fltType, rm); } break;
+        case Expr::FpToSigned: if (bvType) { return mBuilder->FpToSigned(ops[0], *bvType, rm); } break;
+        case Expr::FpToUnsigned: if (bvType) { return mBuilder->FpToUnsigned(ops[0], *bvType, rm); } break;
+        case Expr::FAdd: return mBuilder->FAdd(ops[0], ops[1], rm);
+        case Expr::FSub: return mBuilder->FSub(ops[0], ops[1], rm);
+        case Expr::FMul: return mBuilder->FMul(ops[0], ops[1], rm);
+        case Expr::FDiv: return mBuilder->FDiv(ops[0], ops[1], rm);
+        case Expr::FEq: return mBuilder->FEq(ops[0], ops[1]);
+        case Expr::FGt: return mBuilder->FGt(ops[0], ops[1]);
+        case Expr::FGtEq: return mBuilder->FGtEq(ops[0], ops[1]);
+        case Expr::FLt: return mBuilder->FLt(ops[0], ops[1]);
+        case Expr::FLtEq: return mBuilder->FLtEq(ops[0], ops[1]);
+        case Expr::Select: return mBuilder->Select(ops[0], ops[1], ops[2]);
+        case Expr::ArrayRead: return mBuilder->Read(ops[0], ops[1]);
+        case Expr::ArrayWrite: return mBuilder->Write(ops[0], ops[1], ops[2]);
+        default:
+            break;
+    }
+
+    this->fail("invalid type of expression " + llvm::Twine(id));
+    return nullptr;
+}
+
+ExprRef<LiteralExpr> SystemReader::buildLiteral(Type& type, llvm::SmallVectorImpl<uint64_t>& missing)
+{
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), this->readULEB128() != 0);
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), this->readSLEB128());
+        case Type::RealTypeID: {
+            int64_t numerator = this->readSLEB128();
+            int64_t denominator = this->readSLEB128();
+            if (denominator <= 0) {
+                this->fail("invalid denominator in a real literal");
+                return nullptr;
+            }
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), numerator, denominator);
+        }
+        case Type::BvTypeID: {
+            auto& bvTy = llvm::cast<BvType>(type);
+            return BvLiteralExpr::Get(bvTy, this->readAPInt(bvTy.getWidth()));
+        }
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            llvm::APFloat value(fltTy.getLLVMSemantics(), this->readAPInt(fltTy.getWidth()));
+            return FloatLiteralExpr::Get(fltTy, value);
+        }
+        default:
+            break;
+    }
+
+    this->fail("invalid literal type");
+    return nullptr;
+}
+
+bool SystemReader::readAssignments(std::vector<VariableAssignment>& assigns)
+{
+    uint64_t numAssigns = this->readULEB128();
+    for (uint64_t i = 0; i < numAssigns && mError.empty(); ++i) {
+        Variable* variable = this->getVariable(this->readULEB128());
+        ExprPtr value = this->getExpr(this->readULEB128());
+        if (variable == nullptr || value == nullptr) {
+            return false;
+        }
+
+        assigns.emplace_back(variable, value);
+    }
+
+    return mError.empty();
+}
+
+bool SystemReader::readBody(Cfa& cfa)
+{
+    uint64_t numLocations = this->readULEB128();
+    if (numLocations > static_cast<uint64_t>(mEnd - mPtr)) {
+        return this->fail("location table exceeds the end of the input");
+    }
+
+    llvm::SmallVector<bool, 32> isError;
+    for (uint64_t i = 0; i < numLocations; ++i) {
+        isError.push_back(this->readULEB128() != 0);
+    }
+
+    uint64_t entry;
+    uint64_t exit;
+    if (!this->readIndex(numLocations, entry) || !this->readIndex(numLocations, exit) || entry == exit) {
+        return this->fail("invalid entry or exit location");
+    }
+
+    mLocations.clear();
+    for (uint64_t i = 0; i < numLocations; ++i) {
+        if (i == entry) {
+            mLocations.push_back(cfa.getEntry());
+        } else if (i == exit) {
+            mLocations.push_back(cfa.getExit());
+        } else if (isError[i]) {
+            mLocations.push_back(cfa.createErrorLocation());
+        } else {
+            mLocations.push_back(cfa.createLocation());
+        }
+    }
+
+    uint64_t numErrors = this->readULEB128();
+    for (uint64_t i = 0; i < numErrors && mError.empty(); ++i) {
+        uint64_t location;
+        if (!this->readIndex(numLocations, location)) {
+            return false;
+        }
+
+        ExprPtr errorCode = this->getExpr(this->readULEB128());
+        if (errorCode == nullptr || !mLocations[location]->isError()) {
+            return this->fail("invalid error code");
+        }
+        cfa.addErrorCode(mLocations[location], errorCode);
+    }
+
+    uint64_t numTransitions = this->readULEB128();
+    for (uint64_t i = 0; i < numTransitions && mError.empty(); ++i) {
+        uint64_t tag = this->readULEB128();
+        uint64_t source;
+        uint64_t target;
+        if (!this->readIndex(numLocations, source) || !this->readIndex(numLocations, target)) {
+            return false;
+        }
+
+        ExprPtr guard = this->getExpr(this->readULEB128());
+        if (guard == nullptr) {
+            return false;
+        }
+
+        if (tag == static_cast<unsigned>(TransitionTag::Assign)) {
+            std::vector<VariableAssignment> assigns;
+            if (!this->readAssignments(assigns)) {
+                return false;
+            }
+            cfa.createAssignTransition(mLocations[source], mLocations[target], guard, assigns);
+        } else if (tag == static_cast<unsigned>(TransitionTag::Call)) {
+            uint64_t calleeIdx;
+            if (!this->readIndex(mAutomata.size(), calleeIdx)) {
+                return false;
+            }
+
+            Cfa* callee = mAutomata[calleeIdx];
+            std::vector<VariableAssignment> inputs;
+            std::vector<VariableAssignment> outputs;
+            if (!this->readAssignments(inputs) || !this->readAssignments(outputs)) {
+                return false;
+            }
+
+            if (inputs.size() != callee->getNumInputs() || outputs.size() != callee->getNumOutputs()) {
+                return this->fail("argument count mismatch in a call to '" + callee->getName() + "'");
+            }
+
+            cfa.createCallTransition(mLocations[source], mLocations[target], guard, callee, inputs, outputs);
+        } else {
+            return this->fail("invalid transition kind " + llvm::Twine(tag));
+        }
+    }
+
+    return mError.empty();
+}
+
+bool SystemReader::readMessages(std::map<unsigned, std::string>& messages)
+{
+    uint64_t numMessages = this->readULEB128();
+    for (uint64_t i = 0; i < numMessages && mError.empty(); ++i) {
+        unsigned code = this->readULEB128();
+        messages[code] = this->readString().str();
+    }
+
+    return mError.empty();
+}
+
+SerializedAutomataSystem SystemReader::read()
+{
+    SerializedAutomataSystem result;
+
+    llvm::StringRef input(reinterpret_cast<const char*>(mPtr), mEnd - mPtr);
+    if (!IsSerializedAutomataSystem(input)) {
+        result.error = "input is not a serialized automata system";
+        return result;
+    }
+    mPtr += sizeof(SerializedSystemMagic);
+
+    uint64_t version = this->readULEB128();
+    if (version != SerializedSystemVersion) {
+        result.error = "unsupported format version " + std::to_string(version);
+        return result;
+    }
+
+    auto system = std::make_unique<AutomataSystem>(mContext);
+
+    bool success = this->readTypes()
+        && this->readDeclarations(*system)
+        && this->readExprTable();
+
+    for (size_t i = 0; success && i < mAutomata.size(); ++i) {
+        success = this->readBody(*mAutomata[i]);
+    }
+
+    uint64_t main = 0;
+    if (success && (success = this->readIndex(mAutomata.size() + 1, main)) && main != 0) {
+        system->setMainAutomaton(mAutomata[main - 1]);
+    }
+
+    success = success && this->readMessages(result.messages);
+
+    if (!success) {
+        result.error = mError;
+        result.messages.clear();
+        return result;
+    }
+
+    result.system = std::move(system);
+    return result;
+}
+
+bool gazer::IsSerializedAutomataSystem(llvm::StringRef buffer)
+{
+    return buffer.startswith(llvm::StringRef(SerializedSystemMagic, sizeof(SerializedSystemMagic)));
+}
+
+bool gazer::IsAutomataSystemFile(llvm::StringRef filename)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(filename, -1, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        return false;
+    }
+
+    return IsSerializedAutomataSystem((*buffer)->getBuffer());
+}
+
+void gazer::WriteAutomataSystem(
+    AutomataSystem& system, llvm::raw_ostream& os, const std::map<unsigned, std::string>& messages)
+{
+    SystemWriter writer(system);
+    writer.write(os, messages);
+}
+
+SerializedAutomataSystem gazer::ReadAutomataSystem(llvm::MemoryBufferRef buffer, GazerContext& context)
+{
+    SystemReader reader(buffer, context);
+    return reader.read();
+}
+
+SerializedAutomataSystem gazer::ReadAutomataSystemFile(llvm::StringRef filename, GazerContext& context)
+{
+    // Large files are memory-mapped, records are decoded from the mapping directly.
+    auto buffer = llvm::MemoryBuffer::getFile(filename, -1, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        SerializedAutomataSystem result;
+        result.error = "could not open '" + filename.str() + "': " + buffer.getError().message();
+        return result;
+    }
+
+    return ReadAutomataSystem((*buffer)->getMemBufferRef(), context);
+}
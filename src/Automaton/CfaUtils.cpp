@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 #include "gazer/Automaton/CfaUtils.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -30,8 +31,10 @@ PathConditionCalculator::PathConditionCalculator(
     ExprBuilder& builder,
     std::function<size_t(Location*)> index,
     std::function<ExprPtr(CallTransition*)> calls,
-    std::function<void(Location*, ExprPtr)> preds
-) : mTopo(topo), mExprBuilder(builder), mIndex(index), mCalls(calls), mPredecessors(preds)
+    std::function<void(Location*, ExprPtr)> preds,
+    InstantiateFn instantiate
+) : mTopo(topo), mExprBuilder(builder), mIndex(index), mCalls(calls),
+    mPredecessors(preds), mInstantiate(instantiate)
 {}
 
 namespace
@@ -69,6 +72,9 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
 
     std::fill(dp.begin(), dp.end(), mExprBuilder.False());
 
+    // Definitions of the reachability variables, if the encoding uses them.
+    ExprVector definitions;
+
     // The first location is always reachable from itself.
     dp[0] = mExprBuilder.True();
 
@@ -84,10 +90,14 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
                 "Maybe there is a loop in the automaton?");
 
             if (predIdx >= startIdx) {
+                auto instantiate = [this, edge](const ExprPtr& expr) {
+                    return mInstantiate == nullptr ? expr : mInstantiate(edge, expr);
+                };
+
                 // We are skipping the predecessors which are outside the region we are interested in.
                 ExprPtr formula = mExprBuilder.And({
                     dp[predIdx - startIdx],
-                    edge->getGuard()
+                    instantiate(edge->getGuard())
                 });
 
                 if (auto assignEdge = llvm::dyn_cast<AssignTransition>(edge)) {
@@ -96,7 +106,10 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
                     for (auto& assignment : *assignEdge) {
                         // As we are dealing with an SSA-formed CFA, we can just omit undef assignments.
                         if (assignment.getValue()->getKind() != Expr::Undef) {
-                            auto eqExpr = mExprBuilder.Eq(assignment.getVariable()->getRefExpr(), assignment.getValue());
+                            auto eqExpr = mExprBuilder.Eq(
+                                instantiate(assignment.getVariable()->getRefExpr()),
+                                instantiate(assignment.getValue())
+                            );
                             assigns.push_back(eqExpr);
                         }
                     }
@@ -105,7 +118,7 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
                         formula = mExprBuilder.And(formula, mExprBuilder.And(assigns));
                     }
                 } else if (auto callEdge = llvm::dyn_cast<CallTransition>(edge)) {
-                    formula = mExprBuilder.And(formula, mCalls(callEdge));
+                    formula = mExprBuilder.And(formula, instantiate(mCalls(callEdge)));
                 }
                 
                 preds.emplace_back(edge, predIdx, formula);
@@ -175,9 +188,51 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
 
             dp[i] = mExprBuilder.Or(exprs);
         }
+
+        if (this->needsDefinition(loc, preds.size()) && !llvm::isa<BoolLiteralExpr>(dp[i])) {
+            Variable* reach = this->getReachVariable(source, loc);
+            definitions.push_back(mExprBuilder.Eq(reach->getRefExpr(), dp[i]));
+            dp[i] = reach->getRefExpr();
+        }
+    }
+
+    if (definitions.empty()) {
+        return dp.back();
+    }
+
+    definitions.push_back(dp.back());
+    return mExprBuilder.And(definitions);
+}
+
+Variable* PathConditionCalculator::getReachVariable(Location* source, Location* loc)
+{
+    Variable*& reach = mReachVariables[{source, loc}];
+    if (reach == nullptr) {
+        auto& ctx = mExprBuilder.getContext();
+
+        std::string name;
+        do {
+            name = "__gazer_reach_" + std::to_string(mReachIdx++);
+        } while (ctx.getVariable(name) != nullptr);
+
+        reach = ctx.createVariable(name, BoolType::Get(ctx));
+    }
+
+    return reach;
+}
+
+bool PathConditionCalculator::needsDefinition(Location* loc, size_t numPreds) const
+{
+    switch (mEncoding) {
+        case PathConditionEncoding::Nested:
+            return false;
+        case PathConditionEncoding::Reachability:
+            return true;
+        case PathConditionEncoding::Block:
+            return numPreds > 1 || loc->getNumOutgoing() > 1;
     }
 
-    return dp.back();
+    llvm_unreachable("Unknown path condition encoding!");
 }
 
 // Lowest common dominators
@@ -0,0 +1,209 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+using namespace gazer;
+
+namespace
+{
+
+class SystemCloner
+{
+public:
+    SystemCloner(AutomataSystem& system, GazerContext& context)
+        : mSource(system), mBuilder(CreateExprBuilder(context)), mImporter(*mBuilder)
+    {}
+
+    CloneSystemResult clone();
+
+private:
+    void cloneDeclarations(Cfa& source, Cfa* target);
+    void cloneBody(Cfa& source, Cfa* target);
+
+    std::vector<VariableAssignment> cloneAssignments(
+        llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+    Variable* mapVariable(Variable* variable) { return mImporter[variable]; }
+
+private:
+    AutomataSystem& mSource;
+    std::unique_ptr<ExprBuilder> mBuilder;
+    ExprImporter mImporter;
+
+    CloneSystemResult mResult;
+    llvm::DenseMap<Cfa*, Cfa*> mAutomata;
+    llvm::DenseMap<Location*, Location*> mLocations;
+};
+
+} // end anonymous namespace
+
+CloneSystemResult SystemCloner::clone()
+{
+    mResult.system = std::make_unique<AutomataSystem>(mBuilder->getContext());
+
+    // Callees may be referenced before their own definition, thus we first
+    // create every automaton with its interface, then fill in the bodies.
+    for (Cfa& cfa : mSource) {
+        Cfa* target = mResult.system->createCfa(cfa.getName().str());
+        mAutomata[&cfa] = target;
+        this->cloneDeclarations(cfa, target);
+    }
+
+    for (Cfa& cfa : mSource) {
+        this->cloneBody(cfa, mAutomata[&cfa]);
+    }
+
+    if (mSource.getMainAutomaton() != nullptr) {
+        mResult.system->setMainAutomaton(mAutomata[mSource.getMainAutomaton()]);
+    }
+
+    return std::move(mResult);
+}
+
+void SystemCloner::cloneDeclarations(Cfa& source, Cfa* target)
+{
+    // Variable names are prefixed with the name of their automaton,
+    // strip it to get the same name in the clone.
+    auto cloneVariable = [&](Variable& variable, bool isInput) {
+        std::string name = variable.getName();
+        std::string prefix = source.getName().str() + "/";
+        if (llvm::StringRef(name).startswith(prefix)) {
+            name = name.substr(prefix.size());
+        }
+
+        Type& type = mImporter.importType(variable.getType());
+        Variable* newVar = isInput
+            ? target->createInput(name, type)
+            : target->createLocal(name, type);
+
+        mImporter[&variable] = newVar;
+        mResult.variables[newVar] = &variable;
+    };
+
+    for (Variable& input : source.inputs()) {
+        cloneVariable(input, true);
+    }
+
+    for (Variable& local : source.locals()) {
+        cloneVariable(local, false);
+    }
+
+    for (Variable& output : source.outputs()) {
+        target->addOutput(this->mapVariable(&output));
+    }
+}
+
+void SystemCloner::cloneBody(Cfa& source, Cfa* target)
+{
+    for (Location* loc : source.nodes()) {
+        Location* newLoc;
+        if (loc == source.getEntry()) {
+            newLoc = target->getEntry();
+        } else if (loc == source.getExit()) {
+            newLoc = target->getExit();
+        } else if (loc->isError()) {
+            newLoc = target->createErrorLocation();
+        } else {
+            newLoc = target->createLocation();
+        }
+
+        mLocations[loc] = newLoc;
+        mResult.locations[newLoc] = loc;
+    }
+
+    for (auto& [errorLoc, errorExpr] : source.errors()) {
+        target->addErrorCode(mLocations[errorLoc], mImporter.walk(errorExpr));
+    }
+
+    for (Transition* edge : source.edges()) {
+        Location* from = mLocations[edge->getSource()];
+        Location* to = mLocations[edge->getTarget()];
+        ExprPtr guard = mImporter.walk(edge->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            target->createAssignTransition(
+                from, to, guard, this->cloneAssignments(llvm::make_range(assign->begin(), assign->end()))
+            );
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            target->createCallTransition(
+                from, to, guard, mAutomata[call->getCalledAutomaton()],
+                this->cloneAssignments(call->inputs()),
+                this->cloneAssignments(call->outputs())
+            );
+        } else {
+            llvm_unreachable("Unknown transition kind!");
+        }
+    }
+}
+
+std::vector<VariableAssignment> SystemCloner::cloneAssignments(
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    std::vector<VariableAssignment> result;
+    for (const VariableAssignment& assign : assigns) {
+        result.emplace_back(this->mapVariable(assign.getVariable()), mImporter.walk(assign.getValue()));
+    }
+
+    return result;
+}
+
+CloneSystemResult gazer::CloneAutomataSystem(AutomataSystem& system, GazerContext& context)
+{
+    SystemCloner cloner{system, context};
+    return cloner.clone();
+}
+
+void gazer::TranslateClonedTrace(
+    const CloneSystemResult& clone,
+    GazerContext& context,
+    std::vector<Location*>& states,
+    std::vector<std::vector<VariableAssignment>>& actions)
+{
+    assert(states.size() == actions.size() + 1);
+
+    auto builder = CreateExprBuilder(context);
+    ExprImporter importer(*builder);
+
+    std::vector<Location*> newStates;
+    std::vector<std::vector<VariableAssignment>> newActions;
+
+    newStates.push_back(clone.locations.lookup(states[0]));
+    std::vector<VariableAssignment> pending;
+
+    for (size_t i = 1; i < states.size(); ++i) {
+        for (VariableAssignment& assign : actions[i - 1]) {
+            Variable* variable = clone.variables.lookup(assign.getVariable());
+            if (variable != nullptr) {
+                pending.emplace_back(variable, importer.walk(assign.getValue()));
+            }
+        }
+
+        Location* loc = clone.locations.lookup(states[i]);
+        if (loc != nullptr) {
+            newStates.push_back(loc);
+            newActions.push_back(std::move(pending));
+            pending.clear();
+        }
+    }
+
+    states = std::move(newStates);
+    actions = std::move(newActions);
+}
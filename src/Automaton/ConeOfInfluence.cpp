@@ -0,0 +1,275 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements an interprocedural cone-of-influence reduction.
+///
+/// The variables occurring in transition guards and error codes are relevant,
+/// as they determine which error locations are reachable and how these errors
+/// are reported. A variable is also relevant if its value flows into a relevant
+/// variable through an assignment or an input or output argument of a call.
+/// The relevant variables are calculated for the whole system at once, thus
+/// the result is a fixpoint over every path of the call graph.
+///
+/// The assignments to irrelevant variables are removed, along with irrelevant
+/// locals, inputs and outputs. The interface of the main automaton is kept.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "ConeOfInfluence"
+
+using namespace gazer;
+
+namespace
+{
+
+class ConeOfInfluence
+{
+public:
+    explicit ConeOfInfluence(AutomataSystem& system)
+        : mSystem(system)
+    {}
+
+    ConeOfInfluenceResult reduce();
+
+private:
+    void collectDependencies(Cfa& cfa);
+    void calculateRelevantVariables();
+    void removeIrrelevantVariables(Cfa& cfa, ConeOfInfluenceResult& result);
+    void rebuildTransitions(Cfa& cfa, ConeOfInfluenceResult& result);
+
+    void addDependencies(Variable* variable, const ExprPtr& expr);
+    void markRelevant(const ExprPtr& expr);
+    void markRelevant(Variable* variable);
+
+    bool isRelevant(Variable* variable) const { return mRelevant.count(variable) != 0; }
+
+private:
+    AutomataSystem& mSystem;
+
+    /// Maps each variable to the variables which its value depends on.
+    llvm::DenseMap<Variable*, llvm::SmallVector<Variable*, 2>> mDependencies;
+    llvm::DenseSet<Variable*> mRelevant;
+    std::vector<Variable*> mWorklist;
+};
+
+} // end anonymous namespace
+
+/// Calls \p callback for each variable occurring in \p expr.
+template<class Callback>
+static void forEachVariable(const ExprPtr& expr, Callback callback)
+{
+    llvm::DenseSet<Expr*> visited;
+    llvm::SmallVector<Expr*, 16> worklist = { expr.get() };
+
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            callback(&varRef->getVariable());
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& operand : nonNullary->operands()) {
+                worklist.push_back(operand.get());
+            }
+        }
+    }
+}
+
+void ConeOfInfluence::addDependencies(Variable* variable, const ExprPtr& expr)
+{
+    forEachVariable(expr, [this, variable](Variable* dependency) {
+        mDependencies[variable].push_back(dependency);
+    });
+}
+
+void ConeOfInfluence::markRelevant(Variable* variable)
+{
+    if (mRelevant.insert(variable).second) {
+        mWorklist.push_back(variable);
+    }
+}
+
+void ConeOfInfluence::markRelevant(const ExprPtr& expr)
+{
+    forEachVariable(expr, [this](Variable* variable) {
+        this->markRelevant(variable);
+    });
+}
+
+void ConeOfInfluence::collectDependencies(Cfa& cfa)
+{
+    for (auto& [location, errorCode] : cfa.errors()) {
+        this->markRelevant(errorCode);
+    }
+
+    for (Transition* edge : cfa.edges()) {
+        this->markRelevant(edge->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            for (const VariableAssignment& assignment : *assign) {
+                this->addDependencies(assignment.getVariable(), assignment.getValue());
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            for (const VariableAssignment& input : call->inputs()) {
+                this->addDependencies(input.getVariable(), input.getValue());
+            }
+
+            // The argument lists of a call must match the outputs of the callee,
+            // thus if an output is kept, the variables receiving it are kept as well.
+            for (const VariableAssignment& output : call->outputs()) {
+                this->addDependencies(output.getVariable(), output.getValue());
+                forEachVariable(output.getValue(), [this, &output](Variable* calleeOutput) {
+                    mDependencies[calleeOutput].push_back(output.getVariable());
+                });
+            }
+        }
+    }
+}
+
+void ConeOfInfluence::calculateRelevantVariables()
+{
+    while (!mWorklist.empty()) {
+        Variable* variable = mWorklist.back();
+        mWorklist.pop_back();
+
+        auto it = mDependencies.find(variable);
+        if (it == mDependencies.end()) {
+            continue;
+        }
+
+        for (Variable* dependency : it->second) {
+            this->markRelevant(dependency);
+        }
+    }
+}
+
+void ConeOfInfluence::removeIrrelevantVariables(Cfa& cfa, ConeOfInfluenceResult& result)
+{
+    auto isIrrelevant = [this](Variable* variable) { return !this->isRelevant(variable); };
+
+    if (&cfa != mSystem.getMainAutomaton()) {
+        cfa.removeOutputsIf(isIrrelevant);
+        cfa.removeInputsIf([&isIrrelevant, &result](Variable* variable) {
+            if (isIrrelevant(variable)) {
+                ++result.numRemovedVariables;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    // Outputs are also present in the list of locals, thus they are only counted here.
+    cfa.removeLocalsIf([&isIrrelevant, &result](Variable* variable) {
+        if (isIrrelevant(variable)) {
+            LLVM_DEBUG(llvm::dbgs() << "Removing irrelevant variable " << variable->getName() << "\n");
+            ++result.numRemovedVariables;
+            return true;
+        }
+        return false;
+    });
+}
+
+void ConeOfInfluence::rebuildTransitions(Cfa& cfa, ConeOfInfluenceResult& result)
+{
+    auto isRelevantAssignment = [this](const VariableAssignment& assignment) {
+        return this->isRelevant(assignment.getVariable());
+    };
+
+    std::vector<Transition*> edges(cfa.edge_begin(), cfa.edge_end());
+    for (Transition* edge : edges) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            std::vector<VariableAssignment> assignments;
+            std::copy_if(assign->begin(), assign->end(), std::back_inserter(assignments), isRelevantAssignment);
+
+            if (assignments.size() == assign->getNumAssignments()) {
+                continue;
+            }
+
+            result.numRemovedAssignments += assign->getNumAssignments() - assignments.size();
+            cfa.createAssignTransition(assign->getSource(), assign->getTarget(), assign->getGuard(), assignments);
+            cfa.disconnectEdge(assign);
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            Cfa* callee = call->getCalledAutomaton();
+            if (call->getNumInputs() == callee->getNumInputs() && call->getNumOutputs() == callee->getNumOutputs()) {
+                continue;
+            }
+
+            std::vector<VariableAssignment> inputs;
+            std::copy_if(call->input_begin(), call->input_end(), std::back_inserter(inputs), isRelevantAssignment);
+
+            std::vector<VariableAssignment> outputs;
+            std::copy_if(call->output_begin(), call->output_end(), std::back_inserter(outputs), isRelevantAssignment);
+
+            result.numRemovedAssignments += (call->getNumInputs() - inputs.size())
+                + (call->getNumOutputs() - outputs.size());
+            cfa.createCallTransition(
+                call->getSource(), call->getTarget(), call->getGuard(), callee, inputs, outputs
+            );
+            cfa.disconnectEdge(call);
+        }
+    }
+
+    cfa.clearDisconnectedElements();
+}
+
+ConeOfInfluenceResult ConeOfInfluence::reduce()
+{
+    ConeOfInfluenceResult result;
+
+    for (Cfa& cfa : mSystem) {
+        this->collectDependencies(cfa);
+
+        if (&cfa == mSystem.getMainAutomaton()) {
+            for (Variable& input : cfa.inputs()) {
+                this->markRelevant(&input);
+            }
+            for (Variable& output : cfa.outputs()) {
+                this->markRelevant(&output);
+            }
+        }
+
+        result.numVariables += cfa.getNumInputs() + cfa.getNumLocals();
+    }
+
+    this->calculateRelevantVariables();
+
+    // The argument lists of the call transitions depend on the interface of
+    // the callees, thus each interface must be updated before the transitions.
+    for (Cfa& cfa : mSystem) {
+        this->removeIrrelevantVariables(cfa, result);
+    }
+
+    for (Cfa& cfa : mSystem) {
+        this->rebuildTransitions(cfa, result);
+    }
+
+    return result;
+}
+
+ConeOfInfluenceResult gazer::RemoveIrrelevantVariables(AutomataSystem& system)
+{
+    ConeOfInfluence coi(system);
+    return coi.reduce();
+}
@@ -0,0 +1,286 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements large-block encoding on CFAs.
+///
+/// Two rules are applied until a fixpoint is reached:
+///
+///  * Sequential composition: a location with a single incoming and a single
+///    outgoing assign transition is removed, and the two transitions are
+///    replaced by one. The guard of the second transition is rewritten over
+///    the state before the first one, by substituting the values assigned by
+///    the first transition. The assignments of the two transitions are
+///    concatenated, thus every variable keeps its value in counterexamples.
+///  * Parallel composition: assign transitions with the same source, target
+///    and assignments are replaced by one, guarded by the disjunction of
+///    their guards.
+///
+/// Sequential composition is not applied if the substitution would exceed
+/// the term size limit, or if the rewritten guard would still depend on a
+/// variable assigned by the first transition, e.g. on an undef value.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "LargeBlockEncoding"
+
+using namespace gazer;
+
+namespace
+{
+
+/// Returns the size of the tree representation of \p expr, or a value
+/// larger than \p limit if it does not fit into the limit.
+unsigned getTermSize(const ExprPtr& expr, unsigned limit)
+{
+    unsigned size = 1;
+    if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+        for (const ExprPtr& operand : nonNullary->operands()) {
+            if (size > limit) {
+                break;
+            }
+            size += getTermSize(operand, limit - size);
+        }
+    }
+
+    return size;
+}
+
+bool referencesAny(const ExprPtr& expr, const llvm::SmallPtrSetImpl<Variable*>& variables)
+{
+    llvm::SmallPtrSet<Expr*, 32> visited;
+    llvm::SmallVector<Expr*, 32> worklist = { expr.get() };
+
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            if (variables.count(&varRef->getVariable()) != 0) {
+                return true;
+            }
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& operand : nonNullary->operands()) {
+                worklist.push_back(operand.get());
+            }
+        }
+    }
+
+    return false;
+}
+
+class LargeBlockEncoder
+{
+public:
+    LargeBlockEncoder(
+        Cfa& cfa, ExprBuilder& builder, const std::function<bool(Location*)>& keep, unsigned maxTermSize
+    ) : mCfa(cfa), mExprBuilder(builder), mKeep(keep), mMaxTermSize(maxTermSize)
+    {}
+
+    void encode();
+
+private:
+    bool mergeSequential(Location* loc);
+    bool mergeParallel(Location* loc);
+
+    bool isRemovable(Location* loc) const;
+    void enqueue(Location* loc);
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mExprBuilder;
+    const std::function<bool(Location*)>& mKeep;
+    unsigned mMaxTermSize;
+
+    std::vector<Location*> mWorklist;
+    llvm::DenseSet<Location*> mInWorklist;
+    llvm::DenseSet<Location*> mRemoved;
+};
+
+} // end anonymous namespace
+
+void LargeBlockEncoder::enqueue(Location* loc)
+{
+    if (mRemoved.count(loc) == 0 && mInWorklist.insert(loc).second) {
+        mWorklist.push_back(loc);
+    }
+}
+
+bool LargeBlockEncoder::isRemovable(Location* loc) const
+{
+    if (loc == mCfa.getEntry() || loc == mCfa.getExit() || loc->isError()) {
+        return false;
+    }
+
+    return mKeep == nullptr || !mKeep(loc);
+}
+
+bool LargeBlockEncoder::mergeSequential(Location* loc)
+{
+    if (loc->getNumIncoming() != 1 || loc->getNumOutgoing() != 1 || !this->isRemovable(loc)) {
+        return false;
+    }
+
+    auto first = llvm::dyn_cast<AssignTransition>(*loc->incoming_begin());
+    auto second = llvm::dyn_cast<AssignTransition>(*loc->outgoing_begin());
+    if (first == nullptr || second == nullptr || first == second) {
+        return false;
+    }
+
+    // Calculate the values assigned by the first transition over the state
+    // before it. Assignments are sequential, thus later values may refer to
+    // variables assigned earlier within the same transition.
+    VariableExprRewrite rewrite(mExprBuilder);
+    llvm::SmallPtrSet<Variable*, 8> assigned;
+    for (const VariableAssignment& assign : *first) {
+        assigned.insert(assign.getVariable());
+        if (llvm::isa<UndefExpr>(assign.getValue())) {
+            // Substituting undef would yield a new non-deterministic value at each use.
+            continue;
+        }
+
+        ExprPtr value = rewrite.walk(assign.getValue());
+        if (getTermSize(value, mMaxTermSize) <= mMaxTermSize) {
+            rewrite[assign.getVariable()] = value;
+        }
+    }
+
+    for (const VariableAssignment& assign : *second) {
+        if (assigned.count(assign.getVariable()) != 0) {
+            return false;
+        }
+    }
+
+    ExprPtr secondGuard = rewrite.walk(second->getGuard());
+    if (referencesAny(secondGuard, assigned)) {
+        return false;
+    }
+
+    ExprPtr guard = mExprBuilder.And(first->getGuard(), secondGuard);
+    if (getTermSize(guard, mMaxTermSize) > mMaxTermSize) {
+        return false;
+    }
+
+    std::vector<VariableAssignment> assignments(first->begin(), first->end());
+    assignments.insert(assignments.end(), second->begin(), second->end());
+
+    Location* source = first->getSource();
+    Location* target = second->getTarget();
+
+    LLVM_DEBUG(llvm::dbgs() << "Merging transitions through location " << loc->getId() << "\n");
+    mCfa.createAssignTransition(source, target, guard, assignments);
+    mCfa.disconnectEdge(first);
+    mCfa.disconnectEdge(second);
+    mRemoved.insert(loc);
+
+    this->enqueue(source);
+    this->enqueue(target);
+
+    return true;
+}
+
+bool LargeBlockEncoder::mergeParallel(Location* loc)
+{
+    llvm::SmallVector<AssignTransition*, 4> edges;
+    for (Transition* edge : loc->outgoing()) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            edges.push_back(assign);
+        }
+    }
+
+    bool changed = false;
+    llvm::SmallDenseMap<Location*, AssignTransition*, 4> edgeToTarget;
+    for (AssignTransition* edge : edges) {
+        Location* target = edge->getTarget();
+        auto [it, inserted] = edgeToTarget.try_emplace(target, edge);
+        if (inserted) {
+            continue;
+        }
+
+        AssignTransition* other = it->second;
+        if (!std::equal(other->begin(), other->end(), edge->begin(), edge->end())) {
+            continue;
+        }
+
+        ExprPtr guard = mExprBuilder.Or(other->getGuard(), edge->getGuard());
+        if (getTermSize(guard, mMaxTermSize) > mMaxTermSize) {
+            continue;
+        }
+
+        std::vector<VariableAssignment> assignments(edge->begin(), edge->end());
+        it->second = mCfa.createAssignTransition(loc, target, guard, assignments);
+        mCfa.disconnectEdge(other);
+        mCfa.disconnectEdge(edge);
+
+        this->enqueue(target);
+        changed = true;
+    }
+
+    return changed;
+}
+
+void LargeBlockEncoder::encode()
+{
+    for (Location* loc : mCfa.nodes()) {
+        this->enqueue(loc);
+    }
+
+    while (!mWorklist.empty()) {
+        Location* loc = mWorklist.back();
+        mWorklist.pop_back();
+        mInWorklist.erase(loc);
+
+        if (mRemoved.count(loc) != 0) {
+            continue;
+        }
+
+        this->mergeParallel(loc);
+        this->mergeSequential(loc);
+    }
+
+    mCfa.clearDisconnectedElements();
+}
+
+LargeBlockEncodingResult gazer::EncodeLargeBlocks(
+    AutomataSystem& system, const std::function<bool(Location*)>& keep, unsigned maxTermSize)
+{
+    auto builder = CreateFoldingExprBuilder(system.getContext());
+    LargeBlockEncodingResult result;
+
+    for (Cfa& cfa : system) {
+        result.originalLocations += cfa.getNumLocations();
+        result.originalTransitions += cfa.getNumTransitions();
+
+        LargeBlockEncoder encoder(cfa, *builder, keep, maxTermSize);
+        encoder.encode();
+
+        result.remainingLocations += cfa.getNumLocations();
+        result.remainingTransitions += cfa.getNumTransitions();
+    }
+
+    return result;
+}
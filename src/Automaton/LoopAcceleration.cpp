@@ -0,0 +1,653 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the acceleration of simple counting loops.
+///
+/// Loops are represented as tail-recursive automata. An automaton is accepted
+/// for acceleration if its locations form a single path from the entry to the
+/// recursive call, with exactly one exit transition leaving this path. The
+/// guard of this exit must be the negation of the loop condition, which in turn
+/// must compare a counter (stepping by one in each iteration) to a loop-invariant
+/// bound. Every other loop-carried variable must be incremented by a loop-invariant
+/// value in each iteration.
+///
+/// For such loops, the number of iterations N can be calculated from the input
+/// values, and the values of the loop-carried variables in the last iteration
+/// are given by closed-form expressions of N. The accelerated automaton only
+/// contains this last iteration, up to its exit transition.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <optional>
+
+#define DEBUG_TYPE "LoopAcceleration"
+
+using namespace gazer;
+
+namespace
+{
+
+/// Represents an expression of the form 'variable + offset' or 'variable - offset'.
+struct AffineTerm
+{
+    Variable* variable = nullptr;
+    ExprPtr offset = nullptr;
+    bool subtract = false;
+};
+
+class LoopAccelerator
+{
+public:
+    static constexpr char IterationCountName[] = "__loop_iterations";
+
+    LoopAccelerator(Cfa* cfa, ExprBuilder& builder)
+        : mCfa(cfa), mExprBuilder(builder), mDefinitions(builder)
+    {}
+
+    bool accelerate();
+
+private:
+    bool collectPath();
+    bool collectDefinitions();
+    bool collectLoopCarried();
+    bool analyzeCondition();
+    void transform();
+
+    bool isInvariant(const ExprPtr& expr) const;
+    std::optional<AffineTerm> matchAffine(const ExprPtr& expr) const;
+    int getStep(const AffineTerm& term) const;
+    ExprPtr castCount(const ExprPtr& count, Type& type);
+    ExprPtr createComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right);
+    std::vector<VariableAssignment> rewriteAssignments(AssignTransition* edge, VariableExprRewrite& rewrite);
+
+private:
+    Cfa* mCfa;
+    ExprBuilder& mExprBuilder;
+
+    // Structure
+    CallTransition* mRecursiveCall = nullptr;
+    std::vector<AssignTransition*> mPath;
+    size_t mConditionIdx = 0;
+    AssignTransition* mExitEdge = nullptr;
+
+    // Variables
+    VariableExprRewrite mDefinitions;
+    llvm::DenseSet<Variable*> mInvariants;
+    std::vector<std::pair<Variable*, AffineTerm>> mLoopCarried;
+
+    // Iteration count
+    ExprPtr mIterationCount = nullptr;
+    ExprPtr mTermination = nullptr;
+};
+
+bool isTrueLiteral(const ExprPtr& expr)
+{
+    if (auto lit = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
+        return lit->isTrue();
+    }
+
+    return false;
+}
+
+/// Returns the predicate which holds for (b, a) iff \p kind holds for (a, b).
+Expr::ExprKind getSwappedPredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Lt: return Expr::Gt;
+        case Expr::LtEq: return Expr::GtEq;
+        case Expr::Gt: return Expr::Lt;
+        case Expr::GtEq: return Expr::LtEq;
+        case Expr::BvSLt: return Expr::BvSGt;
+        case Expr::BvSLtEq: return Expr::BvSGtEq;
+        case Expr::BvSGt: return Expr::BvSLt;
+        case Expr::BvSGtEq: return Expr::BvSLtEq;
+        case Expr::BvULt: return Expr::BvUGt;
+        case Expr::BvULtEq: return Expr::BvUGtEq;
+        case Expr::BvUGt: return Expr::BvULt;
+        case Expr::BvUGtEq: return Expr::BvULtEq;
+        case Expr::NotEq: return Expr::NotEq;
+        default:
+            llvm_unreachable("Unknown comparison predicate!");
+    }
+}
+
+/// Returns the predicate which holds for (a, b) iff \p kind does not.
+std::optional<Expr::ExprKind> getInversePredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq: return Expr::NotEq;
+        case Expr::NotEq: return Expr::Eq;
+        case Expr::Lt: return Expr::GtEq;
+        case Expr::LtEq: return Expr::Gt;
+        case Expr::Gt: return Expr::LtEq;
+        case Expr::GtEq: return Expr::Lt;
+        case Expr::BvSLt: return Expr::BvSGtEq;
+        case Expr::BvSLtEq: return Expr::BvSGt;
+        case Expr::BvSGt: return Expr::BvSLtEq;
+        case Expr::BvSGtEq: return Expr::BvSLt;
+        case Expr::BvULt: return Expr::BvUGtEq;
+        case Expr::BvULtEq: return Expr::BvUGt;
+        case Expr::BvUGt: return Expr::BvULtEq;
+        case Expr::BvUGtEq: return Expr::BvULt;
+        default:
+            return std::nullopt;
+    }
+}
+
+/// Returns true if \p left is syntactically equivalent to the negation of \p right.
+bool isNegationOf(const ExprPtr& left, const ExprPtr& right)
+{
+    if (auto notExpr = llvm::dyn_cast<NotExpr>(left)) {
+        return notExpr->getOperand() == right;
+    }
+
+    if (auto notExpr = llvm::dyn_cast<NotExpr>(right)) {
+        return notExpr->getOperand() == left;
+    }
+
+    auto inverse = getInversePredicate(left->getKind());
+    if (!inverse || *inverse != right->getKind()) {
+        return false;
+    }
+
+    auto lhs = llvm::cast<NonNullaryExpr>(left);
+    auto rhs = llvm::cast<NonNullaryExpr>(right);
+
+    return lhs->getOperand(0) == rhs->getOperand(0) && lhs->getOperand(1) == rhs->getOperand(1);
+}
+
+bool isIncreasingPredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Lt: case Expr::LtEq:
+        case Expr::BvSLt: case Expr::BvSLtEq:
+        case Expr::BvULt: case Expr::BvULtEq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isDecreasingPredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Gt: case Expr::GtEq:
+        case Expr::BvSGt: case Expr::BvSGtEq:
+        case Expr::BvUGt: case Expr::BvUGtEq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isInclusivePredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::LtEq: case Expr::GtEq:
+        case Expr::BvSLtEq: case Expr::BvSGtEq:
+        case Expr::BvULtEq: case Expr::BvUGtEq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // end anonymous namespace
+
+bool LoopAccelerator::accelerate()
+{
+    if (!this->collectPath()) {
+        LLVM_DEBUG(llvm::dbgs() << mCfa->getName() << ": not a single-path loop.\n");
+        return false;
+    }
+
+    if (!this->collectDefinitions() || !this->collectLoopCarried()) {
+        LLVM_DEBUG(llvm::dbgs() << mCfa->getName() << ": loop-carried variables are not affine.\n");
+        return false;
+    }
+
+    if (!this->analyzeCondition()) {
+        LLVM_DEBUG(llvm::dbgs() << mCfa->getName() << ": not a counting loop.\n");
+        return false;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << mCfa->getName() << ": accelerating, iteration count is "
+        << *mIterationCount << "\n");
+    this->transform();
+
+    return true;
+}
+
+bool LoopAccelerator::collectPath()
+{
+    for (Transition* edge : mCfa->edges()) {
+        if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            if (call->getCalledAutomaton() != mCfa || mRecursiveCall != nullptr) {
+                return false;
+            }
+
+            mRecursiveCall = call;
+        }
+    }
+
+    if (mRecursiveCall == nullptr
+        || mRecursiveCall->getTarget() != mCfa->getExit()
+        || !isTrueLiteral(mRecursiveCall->getGuard())
+        || mRecursiveCall->getSource()->getNumOutgoing() != 1
+    ) {
+        return false;
+    }
+
+    Location* current = mCfa->getEntry();
+    while (current != mRecursiveCall->getSource()) {
+        if (current->isError() || mPath.size() > mCfa->getNumLocations()) {
+            return false;
+        }
+
+        Transition* forward = nullptr;
+        Transition* exit = nullptr;
+        for (Transition* edge : current->outgoing()) {
+            Transition*& slot = edge->getTarget() == mCfa->getExit() ? exit : forward;
+            if (slot != nullptr) {
+                return false;
+            }
+            slot = edge;
+        }
+
+        if (forward == nullptr || !forward->isAssign()) {
+            return false;
+        }
+
+        if (exit != nullptr) {
+            // Only a single exit is allowed, with a guard which is the negation
+            // of the loop condition.
+            if (mExitEdge != nullptr || !exit->isAssign() || !isNegationOf(exit->getGuard(), forward->getGuard())) {
+                return false;
+            }
+
+            mExitEdge = llvm::cast<AssignTransition>(exit);
+            mConditionIdx = mPath.size();
+        } else if (!isTrueLiteral(forward->getGuard())) {
+            return false;
+        }
+
+        mPath.push_back(llvm::cast<AssignTransition>(forward));
+        current = forward->getTarget();
+    }
+
+    // The path and the exit location must cover the whole automaton.
+    return mExitEdge != nullptr && mPath.size() + 2 == mCfa->getNumLocations();
+}
+
+bool LoopAccelerator::collectDefinitions()
+{
+    // Each local is defined in terms of the input values of the current iteration.
+    llvm::DenseSet<Variable*> defined;
+    for (AssignTransition* edge : mPath) {
+        for (const VariableAssignment& assign : *edge) {
+            Variable* variable = assign.getVariable();
+            bool isInput = llvm::any_of(mCfa->inputs(), [variable](Variable& input) {
+                return &input == variable;
+            });
+            if (isInput || mCfa->isOutput(variable) || !defined.insert(variable).second) {
+                return false;
+            }
+
+            mDefinitions[variable] = mDefinitions.walk(assign.getValue());
+        }
+    }
+
+    return true;
+}
+
+bool LoopAccelerator::collectLoopCarried()
+{
+    if (mRecursiveCall->getNumInputs() != mCfa->getNumInputs()
+        || mRecursiveCall->getNumOutputs() != mCfa->getNumOutputs()
+    ) {
+        return false;
+    }
+
+    // The outputs of the last iteration must be passed through the call unchanged.
+    for (const VariableAssignment& assign : mRecursiveCall->outputs()) {
+        if (assign.getValue() != assign.getVariable()->getRefExpr()) {
+            return false;
+        }
+    }
+
+    std::vector<std::pair<Variable*, ExprPtr>> updates;
+    for (const VariableAssignment& assign : mRecursiveCall->inputs()) {
+        ExprPtr value = mDefinitions.walk(assign.getValue());
+        if (value == assign.getVariable()->getRefExpr()) {
+            mInvariants.insert(assign.getVariable());
+        } else {
+            updates.emplace_back(assign.getVariable(), value);
+        }
+    }
+
+    for (auto& [variable, value] : updates) {
+        auto term = this->matchAffine(value);
+        if (!term || term->variable != variable || !this->isInvariant(term->offset)) {
+            return false;
+        }
+
+        mLoopCarried.emplace_back(variable, *term);
+    }
+
+    return !mLoopCarried.empty();
+}
+
+bool LoopAccelerator::analyzeCondition()
+{
+    ExprPtr condition = mDefinitions.walk(mPath[mConditionIdx]->getGuard());
+
+    // Normalize the condition into the form 'counter <pred> bound'.
+    Expr::ExprKind kind = condition->getKind();
+    if (auto notExpr = llvm::dyn_cast<NotExpr>(condition)) {
+        condition = notExpr->getOperand();
+        if (condition->getKind() != Expr::Eq) {
+            return false;
+        }
+        kind = Expr::NotEq;
+    } else if (kind != Expr::NotEq && !isIncreasingPredicate(kind) && !isDecreasingPredicate(kind)) {
+        return false;
+    }
+
+    auto cmp = llvm::cast<NonNullaryExpr>(condition);
+    ExprPtr counter = cmp->getOperand(0);
+    ExprPtr bound = cmp->getOperand(1);
+    if (this->isInvariant(counter)) {
+        std::swap(counter, bound);
+        kind = getSwappedPredicate(kind);
+    }
+
+    if (!this->isInvariant(bound)) {
+        return false;
+    }
+
+    auto counterTerm = this->matchAffine(counter);
+    if (!counterTerm || !this->isInvariant(counterTerm->offset)) {
+        return false;
+    }
+
+    auto it = std::find_if(mLoopCarried.begin(), mLoopCarried.end(), [&counterTerm](auto& entry) {
+        return entry.first == counterTerm->variable;
+    });
+    if (it == mLoopCarried.end()) {
+        return false;
+    }
+
+    int step = this->getStep(it->second);
+    if (step == 0 || (step < 0 && isIncreasingPredicate(kind)) || (step > 0 && isDecreasingPredicate(kind))) {
+        return false;
+    }
+
+    // The iteration count has the type of the counter, thus every loop-carried
+    // variable must be of the same kind.
+    Type& type = counter->getType();
+    bool compatible = llvm::all_of(mLoopCarried, [&type](auto& entry) {
+        Type& varTy = entry.first->getType();
+        return (type.isIntType() && varTy.isIntType()) || (type.isBvType() && varTy.isBvType());
+    });
+    if (!compatible) {
+        return false;
+    }
+
+    ExprPtr zero;
+    ExprPtr one;
+    if (type.isIntType()) {
+        zero = mExprBuilder.IntLit(0);
+        one = mExprBuilder.IntLit(1);
+    } else if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+        zero = mExprBuilder.BvLit(0, bvTy->getWidth());
+        one = mExprBuilder.BvLit(1, bvTy->getWidth());
+    } else {
+        return false;
+    }
+
+    // The number of iterations is the distance between the initial value
+    // of the counter and the bound, if the loop condition holds initially.
+    ExprPtr distance = step > 0 ? mExprBuilder.Sub(bound, counter) : mExprBuilder.Sub(counter, bound);
+    mTermination = mExprBuilder.True();
+
+    if (kind == Expr::NotEq) {
+        // Bit-vector counters reach the bound eventually by overflowing,
+        // integer counters only if they are on the right side of the bound.
+        mIterationCount = distance;
+        if (type.isIntType()) {
+            mTermination = step > 0 ? mExprBuilder.LtEq(counter, bound) : mExprBuilder.GtEq(counter, bound);
+        }
+        return true;
+    }
+
+    if (isInclusivePredicate(kind)) {
+        distance = mExprBuilder.Add(distance, one);
+
+        // Inclusive bit-vector loops never terminate if the bound is the
+        // maximum (or minimum) value of the counter type.
+        if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+            unsigned width = bvTy->getWidth();
+            bool isSigned = kind == Expr::BvSLtEq || kind == Expr::BvSGtEq;
+            llvm::APInt limit = step > 0
+                ? (isSigned ? llvm::APInt::getSignedMaxValue(width) : llvm::APInt::getMaxValue(width))
+                : (isSigned ? llvm::APInt::getSignedMinValue(width) : llvm::APInt::getMinValue(width));
+
+            mTermination = mExprBuilder.NotEq(bound, mExprBuilder.BvLit(limit));
+        }
+    }
+
+    mIterationCount = mExprBuilder.Select(this->createComparison(kind, counter, bound), distance, zero);
+
+    return true;
+}
+
+void LoopAccelerator::transform()
+{
+    Variable* iterations = mCfa->createLocal(IterationCountName, mIterationCount->getType());
+    ExprPtr count = iterations->getRefExpr();
+
+    // Replace each loop-carried variable with its value in the last iteration.
+    VariableExprRewrite lastIteration(mExprBuilder);
+    for (auto& [variable, term] : mLoopCarried) {
+        ExprPtr delta = this->castCount(count, variable->getType());
+        delta = mExprBuilder.Mul(delta, term.offset);
+
+        ExprPtr varRef = variable->getRefExpr();
+        lastIteration[variable] = term.subtract ? mExprBuilder.Sub(varRef, delta) : mExprBuilder.Add(varRef, delta);
+    }
+
+    std::vector<Transition*> removed;
+    llvm::SmallVector<std::tuple<Location*, Location*, ExprPtr, std::vector<VariableAssignment>>, 8> created;
+
+    for (size_t i = 0; i < mConditionIdx; ++i) {
+        AssignTransition* edge = mPath[i];
+        created.emplace_back(
+            edge->getSource(), edge->getTarget(), edge->getGuard(), this->rewriteAssignments(edge, lastIteration)
+        );
+        removed.push_back(edge);
+    }
+
+    created.emplace_back(
+        mExitEdge->getSource(), mExitEdge->getTarget(),
+        lastIteration.walk(mExitEdge->getGuard()),
+        this->rewriteAssignments(mExitEdge, lastIteration)
+    );
+    removed.push_back(mExitEdge);
+    removed.push_back(mPath[mConditionIdx]);
+
+    // The iteration count must be calculated before its first use.
+    auto& first = created.front();
+    std::get<2>(first) = mExprBuilder.And(std::get<2>(first), mTermination);
+    std::get<3>(first).insert(std::get<3>(first).begin(), VariableAssignment(iterations, mIterationCount));
+
+    for (Transition* edge : removed) {
+        mCfa->disconnectEdge(edge);
+    }
+
+    for (auto& [source, target, guard, assigns] : created) {
+        mCfa->createAssignTransition(source, target, guard, assigns);
+    }
+
+    // Removes the remaining part of the loop body, along with the recursive call.
+    mCfa->removeUnreachableLocations();
+}
+
+std::vector<VariableAssignment> LoopAccelerator::rewriteAssignments(
+    AssignTransition* edge, VariableExprRewrite& rewrite)
+{
+    std::vector<VariableAssignment> result;
+    for (const VariableAssignment& assign : *edge) {
+        result.emplace_back(assign.getVariable(), rewrite.walk(assign.getValue()));
+    }
+
+    return result;
+}
+
+bool LoopAccelerator::isInvariant(const ExprPtr& expr) const
+{
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+        return mInvariants.count(&varRef->getVariable()) != 0;
+    }
+
+    if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+        return llvm::all_of(nonNullary->operands(), [this](const ExprPtr& op) {
+            return this->isInvariant(op);
+        });
+    }
+
+    return llvm::isa<LiteralExpr>(expr);
+}
+
+std::optional<AffineTerm> LoopAccelerator::matchAffine(const ExprPtr& expr) const
+{
+    AffineTerm result;
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+        result.variable = &varRef->getVariable();
+    } else if (expr->getKind() == Expr::Add || expr->getKind() == Expr::Sub) {
+        auto binary = llvm::cast<NonNullaryExpr>(expr);
+        ExprPtr left = binary->getOperand(0);
+        ExprPtr right = binary->getOperand(1);
+        result.subtract = expr->getKind() == Expr::Sub;
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(left)) {
+            result.variable = &varRef->getVariable();
+            result.offset = right;
+        } else if (auto varRef = llvm::dyn_cast<VarRefExpr>(right); varRef && !result.subtract) {
+            result.variable = &varRef->getVariable();
+            result.offset = left;
+        } else {
+            return std::nullopt;
+        }
+    } else {
+        return std::nullopt;
+    }
+
+    if (result.offset == nullptr) {
+        Type& type = expr->getType();
+        if (type.isIntType()) {
+            result.offset = mExprBuilder.IntLit(0);
+        } else if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+            result.offset = mExprBuilder.BvLit(0, bvTy->getWidth());
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return result;
+}
+
+int LoopAccelerator::getStep(const AffineTerm& term) const
+{
+    int sign = term.subtract ? -1 : 1;
+    if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(term.offset)) {
+        if (intLit->getValue() == 1 || intLit->getValue() == -1) {
+            return sign * intLit->getValue();
+        }
+    } else if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(term.offset)) {
+        if (bvLit->isOne()) {
+            return sign;
+        }
+        if (bvLit->isAllOnes()) {
+            return -sign;
+        }
+    }
+
+    return 0;
+}
+
+ExprPtr LoopAccelerator::castCount(const ExprPtr& count, Type& type)
+{
+    if (&count->getType() == &type) {
+        return count;
+    }
+
+    // Bit-vector arithmetic is modular: truncating the count yields the same
+    // result, while extending it is precise as the count fits into its own type.
+    unsigned countWidth = llvm::cast<BvType>(count->getType()).getWidth();
+    auto& bvTy = llvm::cast<BvType>(type);
+    if (bvTy.getWidth() < countWidth) {
+        return mExprBuilder.Trunc(count, bvTy);
+    }
+
+    return mExprBuilder.ZExt(count, bvTy);
+}
+
+ExprPtr LoopAccelerator::createComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right)
+{
+    switch (kind) {
+        case Expr::NotEq: return mExprBuilder.NotEq(left, right);
+        case Expr::Lt: return mExprBuilder.Lt(left, right);
+        case Expr::LtEq: return mExprBuilder.LtEq(left, right);
+        case Expr::Gt: return mExprBuilder.Gt(left, right);
+        case Expr::GtEq: return mExprBuilder.GtEq(left, right);
+        case Expr::BvSLt: return mExprBuilder.BvSLt(left, right);
+        case Expr::BvSLtEq: return mExprBuilder.BvSLtEq(left, right);
+        case Expr::BvSGt: return mExprBuilder.BvSGt(left, right);
+        case Expr::BvSGtEq: return mExprBuilder.BvSGtEq(left, right);
+        case Expr::BvULt: return mExprBuilder.BvULt(left, right);
+        case Expr::BvULtEq: return mExprBuilder.BvULtEq(left, right);
+        case Expr::BvUGt: return mExprBuilder.BvUGt(left, right);
+        case Expr::BvUGtEq: return mExprBuilder.BvUGtEq(left, right);
+        default:
+            llvm_unreachable("Unknown comparison predicate!");
+    }
+}
+
+unsigned gazer::AccelerateLoops(AutomataSystem& system)
+{
+    auto builder = CreateFoldingExprBuilder(system.getContext());
+
+    unsigned numAccelerated = 0;
+    for (Cfa& cfa : system) {
+        LoopAccelerator accelerator(&cfa, *builder);
+        if (accelerator.accelerate()) {
+            ++numAccelerated;
+        }
+    }
+
+    return numAccelerated;
+}
@@ -24,6 +24,10 @@
 
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/EquivalenceClasses.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/Support/raw_ostream.h>
 
 using namespace gazer;
@@ -31,6 +35,22 @@ using namespace gazer;
 namespace
 {
 
+/// Maps each output of the caller of a tail call to the output of the callee
+/// it is forwarded from.
+using ForwardedOutputs = llvm::SmallVector<std::pair<Variable*, Variable*>, 4>;
+
+/// The clone of a single automaton within an inlined call.
+struct InlinedAutomaton
+{
+    explicit InlinedAutomaton(ExprBuilder& builder)
+        : rewrite(builder)
+    {}
+
+    VariableExprRewrite rewrite;
+    llvm::DenseMap<Location*, Location*> locations;
+    llvm::DenseMap<Variable*, Variable*> variables;
+};
+
 class RecursiveToCyclicTransformer
 {
 public:
@@ -43,29 +63,162 @@ public:
 
 private:
     void addUniqueErrorLocation();
+    void findLoopComponents();
     void inlineCallIntoRoot(CallTransition* call, llvm::Twine suffix);
 
+    /// Binds the outputs of the automata entered through the latches of an
+    /// inlined call. Outputs forwarded through a tail call share a variable,
+    /// and the outputs of the called automaton use the output arguments of
+    /// the call. Returns false if an automaton would have two outputs sharing
+    /// the same variable.
+    bool bindOutputs(
+        CallTransition* call,
+        llvm::ArrayRef<Cfa*> members,
+        llvm::DenseMap<Variable*, Variable*>& bindings,
+        llvm::Twine suffix
+    );
+
+    /// Callees in a loop component are inlined as cycles, while callees
+    /// without any calls (such as accelerated loops) can be simply inlined as-is.
+    bool shouldInline(Cfa* callee)
+    {
+        CallGraph::Node* node = mCallGraph.lookupNode(callee);
+        return mLoopComponents.count(callee) != 0 || node->begin() == node->end();
+    }
+
+    /// Returns true if the given call may be replaced with a latch edge.
+    bool isLatch(CallTransition* call)
+    {
+        return mForwardedOutputs.count(call) != 0;
+    }
+
 private:
     Cfa* mRoot;
     CallGraph mCallGraph;
     llvm::SmallVector<CallTransition*, 8> mTailRecursiveCalls;
     Location* mError;
-    Variable* mErrorFieldVariable;;
+    Variable* mErrorFieldVariable;
     llvm::DenseMap<Location*, Location*> mInlinedLocations;
     llvm::DenseMap<Variable*, Variable*> mInlinedVariables;
     std::unique_ptr<ExprBuilder> mExprBuilder;
     unsigned mInlineCnt = 0;
+
+    /// Maps the automata of each loop component to the index of their component.
+    /// A loop component is a recursive component of the call graph, in which
+    /// every call between the members of the component is a tail call.
+    llvm::DenseMap<Cfa*, unsigned> mLoopComponents;
+    llvm::DenseMap<CallTransition*, ForwardedOutputs> mForwardedOutputs;
 };
 
 } // end anonymous namespace
 
+/// Returns true if the given call is a tail call which forwards the outputs
+/// of the callee, that is, the call is followed by a chain of unconditional
+/// transitions leading to the exit, on which each output of the caller is
+/// assigned the value of an output of the callee.
+static bool isForwardingTailCall(CallTransition* call, ForwardedOutputs& forwarded)
+{
+    Cfa* caller = call->getSource()->getAutomaton();
+    Cfa* callee = call->getCalledAutomaton();
+
+    // The value of each variable in terms of the outputs of the callee,
+    // or nullptr if it is not a simple copy of a callee output.
+    llvm::DenseMap<Variable*, Variable*> values;
+    for (const VariableAssignment& assign : call->outputs()) {
+        auto ref = llvm::dyn_cast<VarRefExpr>(assign.getValue().get());
+        values[assign.getVariable()] = ref != nullptr ? &ref->getVariable() : nullptr;
+    }
+
+    Location* loc = call->getTarget();
+    for (size_t i = 0; loc != caller->getExit(); ++i) {
+        if (i == caller->getNumLocations() || loc->getNumOutgoing() != 1) {
+            return false;
+        }
+
+        auto edge = llvm::dyn_cast<AssignTransition>(*loc->outgoing_begin());
+        if (edge == nullptr) {
+            return false;
+        }
+
+        auto guard = llvm::dyn_cast<BoolLiteralExpr>(edge->getGuard().get());
+        if (guard == nullptr || !guard->isTrue()) {
+            return false;
+        }
+
+        // Assignments on the same transition are sequential, thus a value
+        // may refer to a variable assigned earlier on this transition.
+        for (const VariableAssignment& assign : *edge) {
+            auto ref = llvm::dyn_cast<VarRefExpr>(assign.getValue().get());
+            Variable* value = ref != nullptr ? values.lookup(&ref->getVariable()) : nullptr;
+            values[assign.getVariable()] = value;
+        }
+
+        loc = edge->getTarget();
+    }
+
+    for (Variable& output : caller->outputs()) {
+        Variable* value = values.lookup(&output);
+        if (value == nullptr || !callee->isOutput(value)) {
+            return false;
+        }
+        forwarded.emplace_back(&output, value);
+    }
+
+    return true;
+}
+
+void RecursiveToCyclicTransformer::findLoopComponents()
+{
+    CallGraph::Node* root = mCallGraph.lookupNode(mRoot);
+    unsigned id = 0;
+
+    for (auto it = llvm::scc_begin(root), ie = llvm::scc_end(root); it != ie; ++it) {
+        const std::vector<CallGraph::Node*>& scc = *it;
+        llvm::SmallPtrSet<CallGraph::Node*, 4> members(scc.begin(), scc.end());
+
+        if (members.count(root) != 0) {
+            continue;
+        }
+
+        bool isRecursive = false;
+        bool isLoop = true;
+        llvm::DenseMap<CallTransition*, ForwardedOutputs> latches;
+
+        for (CallGraph::Node* node : scc) {
+            for (auto& [call, callee] : *node) {
+                if (members.count(callee) == 0) {
+                    continue;
+                }
+
+                isRecursive = true;
+                if (!isForwardingTailCall(call, latches[call])) {
+                    isLoop = false;
+                }
+            }
+        }
+
+        if (!isRecursive || !isLoop) {
+            continue;
+        }
+
+        for (CallGraph::Node* node : scc) {
+            mLoopComponents[node->getCfa()] = id;
+        }
+        for (auto& [call, forwarded] : latches) {
+            mForwardedOutputs[call] = std::move(forwarded);
+        }
+        ++id;
+    }
+}
+
 RecursiveToCyclicResult RecursiveToCyclicTransformer::transform()
 {
     this->addUniqueErrorLocation();
+    this->findLoopComponents();
 
     for (Transition* edge : mRoot->edges()) {
         if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
-            if (mCallGraph.isTailRecursive(call->getCalledAutomaton())) {
+            if (this->shouldInline(call->getCalledAutomaton())) {
                 mTailRecursiveCalls.push_back(call);
             }
         }
@@ -80,9 +233,6 @@ RecursiveToCyclicResult RecursiveToCyclicTransformer::transform()
     }
     mRoot->clearDisconnectedElements();
 
-    // Calculate the new call graph and remove unneeded automata.
-    //mCallGraph = CallGraph(mRoot->getParent());
-
     return {
         mError,
         mErrorFieldVariable,
@@ -91,156 +241,260 @@ RecursiveToCyclicResult RecursiveToCyclicTransformer::transform()
     };
 }
 
+bool RecursiveToCyclicTransformer::bindOutputs(
+    CallTransition* call,
+    llvm::ArrayRef<Cfa*> members,
+    llvm::DenseMap<Variable*, Variable*>& bindings,
+    llvm::Twine suffix)
+{
+    Cfa* callee = call->getCalledAutomaton();
+
+    llvm::EquivalenceClasses<Variable*> classes;
+    for (Cfa* member : members) {
+        for (Variable& output : member->outputs()) {
+            classes.insert(&output);
+        }
+
+        for (Transition* edge : member->edges()) {
+            auto latch = llvm::dyn_cast<CallTransition>(edge);
+            if (latch == nullptr || !this->isLatch(latch)) {
+                continue;
+            }
+
+            for (auto& [callerOutput, calleeOutput] : mForwardedOutputs[latch]) {
+                classes.unionSets(callerOutput, calleeOutput);
+            }
+        }
+    }
+
+    for (auto it = classes.begin(), ie = classes.end(); it != ie; ++it) {
+        if (!it->isLeader()) {
+            continue;
+        }
+
+        llvm::SmallPtrSet<Cfa*, 4> owners;
+        for (auto member = classes.member_begin(it); member != classes.member_end(); ++member) {
+            for (Cfa* cfa : members) {
+                if (cfa->isOutput(*member) && !owners.insert(cfa).second) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (auto it = classes.begin(), ie = classes.end(); it != ie; ++it) {
+        if (!it->isLeader()) {
+            continue;
+        }
+
+        Variable* binding = nullptr;
+        for (auto member = classes.member_begin(it); member != classes.member_end(); ++member) {
+            Variable* output = *member;
+            if (callee->isOutput(output)) {
+                auto argument = call->getOutputArgument(*output);
+                assert(argument.has_value() && "Every callee output should be assigned in a call transition!");
+                binding = argument->getVariable();
+            }
+        }
+
+        if (binding == nullptr) {
+            // The value of this output is never returned to the caller.
+            Variable* leader = it->getData();
+            binding = mRoot->createLocal((leader->getName() + suffix).str(), leader->getType());
+        }
+
+        for (auto member = classes.member_begin(it); member != classes.member_end(); ++member) {
+            bindings[*member] = binding;
+        }
+    }
+
+    return true;
+}
+
 void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm::Twine suffix)
 {
     Cfa* callee = call->getCalledAutomaton();
     Location* before = call->getSource();
     Location* after  = call->getTarget();
 
-    VariableExprRewrite rewrite(*mExprBuilder);
-    llvm::DenseMap<Location*, Location*> locToLocMap;
-    llvm::DenseMap<Variable*, Variable*> oldVarToNew;
-
-    // Clone all local variables into the parent
-    for (Variable& local : callee->locals()) {
-        if (!callee->isOutput(&local)) {
-            auto varname = (local.getName() + suffix).str();
-            auto newLocal = mRoot->createLocal(varname, local.getType());
-            oldVarToNew[&local] = newLocal;
-            mInlinedVariables[newLocal] = &local;
-            rewrite[&local] = newLocal->getRefExpr();
+    // Collect the members of the loop component which may be entered
+    // through latches from the called automaton.
+    llvm::SetVector<Cfa*> members;
+    members.insert(callee);
+    for (size_t i = 0; i < members.size(); ++i) {
+        for (Transition* edge : members[i]->edges()) {
+            auto nestedCall = llvm::dyn_cast<CallTransition>(edge);
+            if (nestedCall != nullptr && this->isLatch(nestedCall)) {
+                members.insert(nestedCall->getCalledAutomaton());
+            }
         }
     }
-    
-    // Clone input variables as well; we will insert an assign transition
-    // with the initial values later.
-    for (Variable& input : callee->inputs()) {
-        if (!callee->isOutput(&input)) {
-            auto varname = (input.getName() + suffix).str();
-            auto newInput = mRoot->createLocal(varname, input.getType());
-            oldVarToNew[&input] = newInput;
-            mInlinedVariables[newInput] = &input;
-            //rewrite[input] = call->getInputArgument(i);
-            rewrite[&input] = newInput->getRefExpr();
-        }
+
+    llvm::DenseMap<Variable*, Variable*> outputBindings;
+    if (!this->bindOutputs(call, members.getArrayRef(), outputBindings, suffix)) {
+        // Leave the call as-is, it will not be unrolled into a cycle.
+        return;
     }
 
-    for (Variable& output : callee->outputs()) {
-        auto argument = call->getOutputArgument(output);
-        assert(argument.has_value() && "Every callee output should be assigned in a call transition!");
+    llvm::DenseMap<Cfa*, std::unique_ptr<InlinedAutomaton>> clones;
+    for (Cfa* member : members) {
+        auto& clone = clones[member];
+        clone = std::make_unique<InlinedAutomaton>(*mExprBuilder);
+
+        // Clone all local variables into the parent
+        for (Variable& local : member->locals()) {
+            if (!member->isOutput(&local)) {
+                auto varname = (local.getName() + suffix).str();
+                auto newLocal = mRoot->createLocal(varname, local.getType());
+                clone->variables[&local] = newLocal;
+                mInlinedVariables[newLocal] = &local;
+                clone->rewrite[&local] = newLocal->getRefExpr();
+            }
+        }
 
-        auto newOutput = argument->getVariable();
-        oldVarToNew[&output] = newOutput;
-        mInlinedVariables[newOutput] = &output;
-        rewrite[&output] = newOutput->getRefExpr();
-    }
+        // Clone input variables as well; we will insert an assign transition
+        // with the initial values later.
+        for (Variable& input : member->inputs()) {
+            if (!member->isOutput(&input)) {
+                auto varname = (input.getName() + suffix).str();
+                auto newInput = mRoot->createLocal(varname, input.getType());
+                clone->variables[&input] = newInput;
+                mInlinedVariables[newInput] = &input;
+                clone->rewrite[&input] = newInput->getRefExpr();
+            }
+        }
 
-    // Insert all locations
-    for (Location* origLoc : callee->nodes()) {
-        auto newLoc = mRoot->createLocation();
-        locToLocMap[&*origLoc] = newLoc;
-        mInlinedLocations[newLoc] = origLoc;
-        if (origLoc->isError()) {
-            mRoot->createAssignTransition(newLoc, mError, mExprBuilder->True(), {
-                { mErrorFieldVariable, callee->getErrorFieldExpr(origLoc) }
-            });
+        for (Variable& output : member->outputs()) {
+            auto newOutput = outputBindings[&output];
+            clone->variables[&output] = newOutput;
+            mInlinedVariables[newOutput] = &output;
+            clone->rewrite[&output] = newOutput->getRefExpr();
+        }
+
+        // Insert all locations
+        for (Location* origLoc : member->nodes()) {
+            auto newLoc = mRoot->createLocation();
+            clone->locations[origLoc] = newLoc;
+            mInlinedLocations[newLoc] = origLoc;
+            if (origLoc->isError()) {
+                mRoot->createAssignTransition(newLoc, mError, mExprBuilder->True(), {
+                    { mErrorFieldVariable, clone->rewrite.walk(member->getErrorFieldExpr(origLoc)) }
+                });
+            }
         }
     }
 
     // Clone the edges
-    for (Transition* origEdge : callee->edges()) {
-        Location* source = locToLocMap[origEdge->getSource()];
-        Location* target = locToLocMap[origEdge->getTarget()];
-
-        if (auto assign = llvm::dyn_cast<AssignTransition>(&*origEdge)) {
-            std::vector<VariableAssignment> newAssigns;
-            std::transform(
-                assign->begin(), assign->end(), std::back_inserter(newAssigns),
-                [&oldVarToNew, &rewrite] (const VariableAssignment& origAssign) {
-                    return VariableAssignment {
-                        oldVarToNew[origAssign.getVariable()],
-                        rewrite.walk(origAssign.getValue())
-                    };
-                }
-            );
-
-            mRoot->createAssignTransition(
-                source, target, rewrite.walk(assign->getGuard()), newAssigns
-            );
-        } else if (auto nestedCall = llvm::dyn_cast<CallTransition>(&*origEdge)) {
-            if (nestedCall->getCalledAutomaton() == callee) {
-                // This is where the magic happens: if we are calling this
-                // same automaton, replace the recursive call with a back-edge
-                // to the entry.
-                std::vector<VariableAssignment> recursiveInputArgs;
-                for (size_t i = 0; i < callee->getNumInputs(); ++i) {
-                    Variable* input = callee->getInput(i);
-
-                    auto variable = oldVarToNew[input];
-                    auto value = rewrite.walk(nestedCall->getInputArgument(*input)->getValue());
-
-                    if (variable->getRefExpr() != value) {
-                        // Do not add unneeded assignments (X := X).
-                        recursiveInputArgs.push_back({
-                            oldVarToNew[input],
-                            value
-                        });
-                    }
-                }
+    for (Cfa* member : members) {
+        InlinedAutomaton& clone = *clones[member];
+        auto& oldVarToNew = clone.variables;
+        auto& rewrite = clone.rewrite;
 
-                // Create the assignment back-edge.
-                mRoot->createAssignTransition(
-                    source, locToLocMap[callee->getEntry()],
-                    nestedCall->getGuard(), recursiveInputArgs
-                );
-            } else {
-                // Inline it as a normal call.
-                std::vector<VariableAssignment> newArgs;
-                std::vector<VariableAssignment> newOuts;
+        for (Transition* origEdge : member->edges()) {
+            Location* source = clone.locations[origEdge->getSource()];
+            Location* target = clone.locations[origEdge->getTarget()];
 
+            if (auto assign = llvm::dyn_cast<AssignTransition>(&*origEdge)) {
+                std::vector<VariableAssignment> newAssigns;
                 std::transform(
-                    nestedCall->input_begin(), nestedCall->input_end(),
-                    std::back_inserter(newArgs),
-                    [&rewrite](const VariableAssignment& assign) {
-                        return VariableAssignment{assign.getVariable(), rewrite.walk(assign.getValue())};
-                    }
-                );
-                std::transform(
-                    nestedCall->output_begin(), nestedCall->output_end(),
-                    std::back_inserter(newOuts),
-                    [&oldVarToNew](const VariableAssignment& origAssign) {
-                        Variable* newVar = oldVarToNew.lookup(origAssign.getVariable());
-                        assert(newVar != nullptr
-                            && "All variables should be present in the variable map!");
-
-                        return VariableAssignment{
-                            newVar,
-                            origAssign.getValue()
+                    assign->begin(), assign->end(), std::back_inserter(newAssigns),
+                    [&oldVarToNew, &rewrite] (const VariableAssignment& origAssign) {
+                        return VariableAssignment {
+                            oldVarToNew[origAssign.getVariable()],
+                            rewrite.walk(origAssign.getValue())
                         };
                     }
                 );
 
-                auto newCall = mRoot->createCallTransition(
-                    source, target,
-                    rewrite.walk(nestedCall->getGuard()),
-                    nestedCall->getCalledAutomaton(),
-                    newArgs, newOuts
+                mRoot->createAssignTransition(
+                    source, target, rewrite.walk(assign->getGuard()), newAssigns
                 );
+            } else if (auto nestedCall = llvm::dyn_cast<CallTransition>(&*origEdge)) {
+                if (this->isLatch(nestedCall)) {
+                    // This is where the magic happens: if we are tail-calling an
+                    // automaton of the same loop component, replace the call with
+                    // a latch edge to the entry of its clone. The outputs need
+                    // no assignments, as they are shared between the two.
+                    Cfa* nestedCallee = nestedCall->getCalledAutomaton();
+                    InlinedAutomaton& latchTarget = *clones[nestedCallee];
+
+                    std::vector<VariableAssignment> recursiveInputArgs;
+                    for (size_t i = 0; i < nestedCallee->getNumInputs(); ++i) {
+                        Variable* input = nestedCallee->getInput(i);
+
+                        auto variable = latchTarget.variables[input];
+                        auto value = rewrite.walk(nestedCall->getInputArgument(*input)->getValue());
+
+                        if (variable->getRefExpr() != value) {
+                            // Do not add unneeded assignments (X := X).
+                            recursiveInputArgs.push_back({
+                                variable,
+                                value
+                            });
+                        }
+                    }
 
-                if (mCallGraph.isTailRecursive(nestedCall->getCalledAutomaton())) {
-                    // If the call is to another tail-recursive automaton, we add it
-                    // to the worklist.
-                    mTailRecursiveCalls.push_back(newCall);
+                    // Create the assignment latch edge.
+                    mRoot->createAssignTransition(
+                        source, latchTarget.locations[nestedCallee->getEntry()],
+                        rewrite.walk(nestedCall->getGuard()), recursiveInputArgs
+                    );
+                } else {
+                    // Inline it as a normal call.
+                    std::vector<VariableAssignment> newArgs;
+                    std::vector<VariableAssignment> newOuts;
+
+                    std::transform(
+                        nestedCall->input_begin(), nestedCall->input_end(),
+                        std::back_inserter(newArgs),
+                        [&rewrite](const VariableAssignment& assign) {
+                            return VariableAssignment{assign.getVariable(), rewrite.walk(assign.getValue())};
+                        }
+                    );
+                    std::transform(
+                        nestedCall->output_begin(), nestedCall->output_end(),
+                        std::back_inserter(newOuts),
+                        [&oldVarToNew](const VariableAssignment& origAssign) {
+                            Variable* newVar = oldVarToNew.lookup(origAssign.getVariable());
+                            assert(newVar != nullptr
+                                && "All variables should be present in the variable map!");
+
+                            return VariableAssignment{
+                                newVar,
+                                origAssign.getValue()
+                            };
+                        }
+                    );
+
+                    auto newCall = mRoot->createCallTransition(
+                        source, target,
+                        rewrite.walk(nestedCall->getGuard()),
+                        nestedCall->getCalledAutomaton(),
+                        newArgs, newOuts
+                    );
+
+                    if (this->shouldInline(nestedCall->getCalledAutomaton())) {
+                        // If the call is to another loop component or leaf automaton,
+                        // we add it to the worklist.
+                        mTailRecursiveCalls.push_back(newCall);
+                    }
                 }
             }
         }
+
+        // Returning from any member of the component returns from the call,
+        // as every call between them is a tail call.
+        mRoot->createAssignTransition(
+            clone.locations[member->getExit()], after, mExprBuilder->True()
+        );
     }
-        
+
+    InlinedAutomaton& entry = *clones[callee];
     std::vector<VariableAssignment> inputArgs;
     for (size_t i = 0; i < callee->getNumInputs(); ++i) {
         Variable* input = callee->getInput(i);
         inputArgs.push_back({
-            oldVarToNew[input],
+            entry.variables[input],
             call->getInputArgument(*input)->getValue()
         });
     }
@@ -248,11 +502,7 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
     // We set the input variables to their initial values on a transition
     // between 'before' and the entry of the called CFA.
     mRoot->createAssignTransition(
-        before, locToLocMap[callee->getEntry()], call->getGuard(), inputArgs
-    );
-
-    mRoot->createAssignTransition(
-        locToLocMap[callee->getExit()], after , mExprBuilder->True()
+        before, entry.locations[callee->getEntry()], call->getGuard(), inputArgs
     );
 
     // Remove the original call edge
@@ -261,7 +511,6 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
 
 void RecursiveToCyclicTransformer::addUniqueErrorLocation()
 {
-    auto& intTy = IntType::Get(mRoot->getParent().getContext());
     auto& ctx = mRoot->getParent().getContext();
 
     llvm::SmallVector<Location*, 1> errors;
@@ -270,22 +519,40 @@ void RecursiveToCyclicTransformer::addUniqueErrorLocation()
             errors.push_back(loc);
         }
     }
+
+    // The error field takes the type of the error codes used in the system,
+    // as inlined error locations will also assign their code into it.
+    Type* errorTy = nullptr;
+    for (Cfa& cfa : mRoot->getParent()) {
+        if (cfa.getNumErrors() != 0) {
+            errorTy = &cfa.error_begin()->second->getType();
+            break;
+        }
+    }
+
+    if (errorTy == nullptr) {
+        errorTy = &IntType::Get(ctx);
+    }
     
     mError = mRoot->createErrorLocation();
-    mErrorFieldVariable = mRoot->createLocal("__gazer_error_field", intTy);
+    mErrorFieldVariable = mRoot->createLocal("__gazer_error_field", *errorTy);
 
     if (errors.empty()) {
         // If there are no error locations in the main automaton, they might still exist in a called CFA.
         // A dummy error location will be used as a goal.
+        ExprPtr zero = errorTy->isBvType()
+            ? ExprPtr(mExprBuilder->BvLit(0, llvm::cast<BvType>(errorTy)->getWidth()))
+            : ExprPtr(mExprBuilder->IntLit(0));
+
         mRoot->createAssignTransition(mRoot->getEntry(), mError, BoolLiteralExpr::False(ctx), {
-            VariableAssignment{ mErrorFieldVariable, IntLiteralExpr::Get(intTy, 0) }
+            VariableAssignment{ mErrorFieldVariable, zero }
         });        
     } else {
         // The error location will be directly reachable from already existing error locations.
         for (Location* err : errors) {
             auto errorExpr = mRoot->getErrorFieldExpr(err);
 
-            assert(errorExpr->getType().isIntType() && "Error expression must be arithmetic integers in the theta backend!");
+            assert(errorExpr->getType() == *errorTy && "Error expressions must have the same type!");
 
             mRoot->createAssignTransition(err, mError, BoolLiteralExpr::True(ctx), {
                 VariableAssignment { mErrorFieldVariable, errorExpr }
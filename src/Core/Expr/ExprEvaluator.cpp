@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 #include "gazer/Core/Expr/ExprEvaluator.h"
 
+#include <llvm/ADT/APSInt.h>
 #include <llvm/Support/Debug.h>
 #include <llvm/Support/raw_ostream.h>
 
@@ -454,44 +455,173 @@ HANDLE_BINARY_COMPARE(BvUGtEq)
 #undef HANDLE_BINARY_COMPARE
 
 // Floating-point queries
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFIsNan(const ExprRef<FIsNanExpr>& expr) {
-    return this->visitNonNullary(expr);
-}
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFIsInf(const ExprRef<FIsInfExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitFIsNan(const ExprRef<FIsNanExpr>& expr)
+{
+    auto op = getOperand(0);
+    if (op->isUndef()) {
+        return UndefExpr::Get(expr->getType());
+    }
+
+    return BoolLiteralExpr::Get(expr->getContext(), cast<FloatLiteralExpr>(op)->getValue().isNaN());
 }
 
-// Floating-point arithmetic
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFAdd(const ExprRef<FAddExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitFIsInf(const ExprRef<FIsInfExpr>& expr)
+{
+    auto op = getOperand(0);
+    if (op->isUndef()) {
+        return UndefExpr::Get(expr->getType());
+    }
+
+    return BoolLiteralExpr::Get(expr->getContext(), cast<FloatLiteralExpr>(op)->getValue().isInfinity());
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFSub(const ExprRef<FSubExpr>& expr) {
-    return this->visitNonNullary(expr);
+
+// Floating-point casts
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitFCast(const ExprRef<FCastExpr>& expr)
+{
+    auto op = getOperand(0);
+    if (op->isUndef()) {
+        return UndefExpr::Get(expr->getType());
+    }
+
+    auto& type = cast<FloatType>(expr->getType());
+    llvm::APFloat value = cast<FloatLiteralExpr>(op)->getValue();
+
+    bool losesInfo;
+    value.convert(type.getLLVMSemantics(), expr->getRoundingMode(), &losesInfo);
+
+    return FloatLiteralExpr::Get(type, value);
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFMul(const ExprRef<FMulExpr>& expr) {
-    return this->visitNonNullary(expr);
+
+static ExprRef<AtomicExpr> EvalBvToFp(
+    const ExprRef<AtomicExpr>& op, FloatType& type, bool isSigned, llvm::APFloat::roundingMode rm)
+{
+    if (op->isUndef()) {
+        return UndefExpr::Get(type);
+    }
+
+    llvm::APFloat value(type.getLLVMSemantics());
+    value.convertFromAPInt(cast<BvLiteralExpr>(op)->getValue(), isSigned, rm);
+
+    return FloatLiteralExpr::Get(type, value);
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFDiv(const ExprRef<FDivExpr>& expr) {
-    return this->visitNonNullary(expr);
+
+static ExprRef<AtomicExpr> EvalFpToBv(
+    const ExprRef<AtomicExpr>& op, BvType& type, bool isSigned, llvm::APFloat::roundingMode rm)
+{
+    if (op->isUndef()) {
+        return UndefExpr::Get(type);
+    }
+
+    llvm::APSInt result(type.getWidth(), !isSigned);
+    bool isExact;
+    auto status = cast<FloatLiteralExpr>(op)->getValue().convertToInteger(result, rm, &isExact);
+
+    if (status & llvm::APFloat::opInvalidOp) {
+        // The result of converting NaN, infinity or an out-of-range
+        // value is unspecified.
+        return UndefExpr::Get(type);
+    }
+
+    return BvLiteralExpr::Get(type, result);
 }
 
-// Floating-point compare
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFEq(const ExprRef<FEqExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitSignedToFp(const ExprRef<SignedToFpExpr>& expr) {
+    return EvalBvToFp(getOperand(0), cast<FloatType>(expr->getType()), true, expr->getRoundingMode());
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFGt(const ExprRef<FGtExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitUnsignedToFp(const ExprRef<UnsignedToFpExpr>& expr) {
+    return EvalBvToFp(getOperand(0), cast<FloatType>(expr->getType()), false, expr->getRoundingMode());
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFGtEq(const ExprRef<FGtEqExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitFpToSigned(const ExprRef<FpToSignedExpr>& expr) {
+    return EvalFpToBv(getOperand(0), cast<BvType>(expr->getType()), true, expr->getRoundingMode());
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFLt(const ExprRef<FLtExpr>& expr) {
-    return this->visitNonNullary(expr);
+ExprRef<AtomicExpr> ExprEvaluatorBase::visitFpToUnsigned(const ExprRef<FpToUnsignedExpr>& expr) {
+    return EvalFpToBv(getOperand(0), cast<BvType>(expr->getType()), false, expr->getRoundingMode());
 }
-ExprRef<AtomicExpr> ExprEvaluatorBase::visitFLtEq(const ExprRef<FLtEqExpr>& expr) {
-    return this->visitNonNullary(expr);
+
+// Floating-point arithmetic
+static ExprRef<AtomicExpr> EvalFpArithmetic(
+    Expr::ExprKind kind,
+    const ExprRef<AtomicExpr>& lhs,
+    const ExprRef<AtomicExpr>& rhs,
+    llvm::APFloat::roundingMode rm)
+{
+    if (lhs->isUndef() || rhs->isUndef()) {
+        return UndefExpr::Get(lhs->getType());
+    }
+
+    llvm::APFloat result = cast<FloatLiteralExpr>(lhs)->getValue();
+    llvm::APFloat right = cast<FloatLiteralExpr>(rhs)->getValue();
+
+    switch (kind) {
+        case Expr::FAdd: result.add(right, rm); break;
+        case Expr::FSub: result.subtract(right, rm); break;
+        case Expr::FMul: result.multiply(right, rm); break;
+        case Expr::FDiv: result.divide(right, rm); break;
+        default:
+            llvm_unreachable("Unknown floating-point arithmetic kind.");
+    }
+
+    return FloatLiteralExpr::Get(cast<FloatType>(lhs->getType()), result);
+}
+
+#define HANDLE_FP_ARITHMETIC(KIND)                                                          \
+    ExprRef<AtomicExpr> ExprEvaluatorBase::visit##KIND(const ExprRef<KIND##Expr>& expr) {   \
+        return EvalFpArithmetic(                                                            \
+            Expr::KIND, getOperand(0), getOperand(1), expr->getRoundingMode());             \
+    }                                                                                       \
+
+HANDLE_FP_ARITHMETIC(FAdd)
+HANDLE_FP_ARITHMETIC(FSub)
+HANDLE_FP_ARITHMETIC(FMul)
+HANDLE_FP_ARITHMETIC(FDiv)
+
+#undef HANDLE_FP_ARITHMETIC
+
+// Floating-point compare
+static ExprRef<AtomicExpr> EvalFpCompare(
+    Expr::ExprKind kind, const ExprRef<AtomicExpr>& left, const ExprRef<AtomicExpr>& right)
+{
+    auto& boolTy = BoolType::Get(left->getContext());
+    if (left->isUndef() || right->isUndef()) {
+        return UndefExpr::Get(boolTy);
+    }
+
+    // Comparisons involving NaN are unordered, and thus always false.
+    auto result = cast<FloatLiteralExpr>(left)->getValue().compare(cast<FloatLiteralExpr>(right)->getValue());
+
+    switch (kind) {
+        case Expr::FEq:
+            return BoolLiteralExpr::Get(boolTy, result == llvm::APFloat::cmpEqual);
+        case Expr::FGt:
+            return BoolLiteralExpr::Get(boolTy, result == llvm::APFloat::cmpGreaterThan);
+        case Expr::FGtEq:
+            return BoolLiteralExpr::Get(
+                boolTy, result == llvm::APFloat::cmpGreaterThan || result == llvm::APFloat::cmpEqual);
+        case Expr::FLt:
+            return BoolLiteralExpr::Get(boolTy, result == llvm::APFloat::cmpLessThan);
+        case Expr::FLtEq:
+            return BoolLiteralExpr::Get(
+                boolTy, result == llvm::APFloat::cmpLessThan || result == llvm::APFloat::cmpEqual);
+        default:
+            break;
+    }
+
+    llvm_unreachable("Unknown floating-point comparison kind.");
 }
 
+#define HANDLE_FP_COMPARE(KIND)                                                             \
+    ExprRef<AtomicExpr> ExprEvaluatorBase::visit##KIND(const ExprRef<KIND##Expr>& expr) {   \
+        return EvalFpCompare(Expr::KIND, getOperand(0), getOperand(1));                     \
+    }                                                                                       \
+
+HANDLE_FP_COMPARE(FEq)
+HANDLE_FP_COMPARE(FGt)
+HANDLE_FP_COMPARE(FGtEq)
+HANDLE_FP_COMPARE(FLt)
+HANDLE_FP_COMPARE(FLtEq)
+
+#undef HANDLE_FP_COMPARE
+
 template<class Type, class ExprTy>
 ExprRef<AtomicExpr> EvalSelect(
     const ExprRef<BoolLiteralExpr>& cond,
@@ -141,3 +141,141 @@ ExprPtr& VariableExprRewrite::operator[](Variable* variable)
 {
     return mRewriteMap[variable];
 }
+
+Variable*& ExprImporter::operator[](Variable* variable)
+{
+    return mVariableMap[variable];
+}
+
+Type& ExprImporter::importType(Type& type)
+{
+    GazerContext& context = mExprBuilder.getContext();
+    if (&type.getContext() == &context) {
+        return type;
+    }
+
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID: return BoolType::Get(context);
+        case Type::IntTypeID: return IntType::Get(context);
+        case Type::RealTypeID: return RealType::Get(context);
+        case Type::BvTypeID: return BvType::Get(context, llvm::cast<BvType>(type).getWidth());
+        case Type::FloatTypeID: return FloatType::Get(context, llvm::cast<FloatType>(type).getPrecision());
+        case Type::ArrayTypeID: {
+            auto& arrTy = llvm::cast<ArrayType>(type);
+            return ArrayType::Get(importType(arrTy.getIndexType()), importType(arrTy.getElementType()));
+        }
+        case Type::TupleTypeID:
+        case Type::FunctionTypeID:
+            break;
+    }
+
+    llvm_unreachable("Cannot import tuple or function types.");
+}
+
+ExprRef<LiteralExpr> ExprImporter::importLiteral(const ExprRef<LiteralExpr>& expr)
+{
+    Type& type = this->importType(expr->getType());
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), llvm::cast<BoolLiteralExpr>(expr)->getValue());
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), llvm::cast<IntLiteralExpr>(expr)->getValue());
+        case Type::RealTypeID:
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), llvm::cast<RealLiteralExpr>(expr)->getValue());
+        case Type::BvTypeID:
+            return BvLiteralExpr::Get(llvm::cast<BvType>(type), llvm::cast<BvLiteralExpr>(expr)->getValue());
+        case Type::FloatTypeID:
+            return FloatLiteralExpr::Get(llvm::cast<FloatType>(type), llvm::cast<FloatLiteralExpr>(expr)->getValue());
+        case Type::ArrayTypeID: {
+            auto array = llvm::cast<ArrayLiteralExpr>(expr);
+            ArrayLiteralExpr::Builder builder(llvm::cast<ArrayType>(type));
+            for (auto& [index, elem] : array->getMap()) {
+                builder.addValue(this->importLiteral(index), this->importLiteral(elem));
+            }
+            if (array->hasDefault()) {
+                builder.setDefault(this->importLiteral(array->getDefault()));
+            }
+            return builder.build();
+        }
+        case Type::TupleTypeID:
+        case Type::FunctionTypeID:
+            break;
+    }
+
+    llvm_unreachable("Invalid literal expression type!");
+}
+
+ExprPtr ExprImporter::visitUndef(const ExprRef<UndefExpr>& expr)
+{
+    return mExprBuilder.Undef(this->importType(expr->getType()));
+}
+
+ExprPtr ExprImporter::visitVarRef(const ExprRef<VarRefExpr>& expr)
+{
+    Variable* variable = mVariableMap.lookup(&expr->getVariable());
+    assert(variable != nullptr && "Imported variables must be present in the variable map!");
+
+    return variable->getRefExpr();
+}
+
+ExprPtr ExprImporter::visitNonNullary(const ExprRef<NonNullaryExpr>& expr)
+{
+    ExprVector ops(expr->getNumOperands(), nullptr);
+    for (size_t i = 0; i < expr->getNumOperands(); ++i) {
+        ops[i] = this->getOperand(i);
+    }
+
+    // Expressions carrying a type must be rebuilt with the imported type,
+    // all others are handled by the generic rewrite.
+    switch (expr->getKind()) {
+        case Expr::ZExt:
+            return mExprBuilder.ZExt(ops[0], llvm::cast<BvType>(this->importType(expr->getType())));
+        case Expr::SExt:
+            return mExprBuilder.SExt(ops[0], llvm::cast<BvType>(this->importType(expr->getType())));
+        case Expr::FCast:
+            return mExprBuilder.FCast(
+                ops[0], llvm::cast<FloatType>(this->importType(expr->getType())),
+                llvm::cast<FCastExpr>(expr)->getRoundingMode()
+            );
+        case Expr::SignedToFp:
+            return mExprBuilder.SignedToFp(
+                ops[0], llvm::cast<FloatType>(this->importType(expr->getType())),
+                llvm::cast<SignedToFpExpr>(expr)->getRoundingMode()
+            );
+        case Expr::UnsignedToFp:
+            return mExprBuilder.UnsignedToFp(
+                ops[0], llvm::cast<FloatType>(this->importType(expr->getType())),
+                llvm::cast<UnsignedToFpExpr>(expr)->getRoundingMode()
+            );
+        case Expr::FpToSigned:
+            return mExprBuilder.FpToSigned(
+                ops[0], llvm::cast<BvType>(this->importType(expr->getType())),
+                llvm::cast<FpToSignedExpr>(expr)->getRoundingMode()
+            );
+        case Expr::FpToUnsigned:
+            return mExprBuilder.FpToUnsigned(
+                ops[0], llvm::cast<BvType>(this->importType(expr->getType())),
+                llvm::cast<FpToUnsignedExpr>(expr)->getRoundingMode()
+            );
+        default:
+            break;
+    }
+
+    return this->rewriteNonNullary(expr, ops);
+}
+
+bool ExprImporter::shouldSkip(const ExprPtr& expr, ExprPtr* ret)
+{
+    auto it = mCache.find(expr.get());
+    if (it != mCache.end()) {
+        *ret = it->second.second;
+        return true;
+    }
+
+    return false;
+}
+
+void ExprImporter::handleResult(const ExprPtr& expr, ExprPtr& ret)
+{
+    mCache[expr.get()] = { expr, ret };
+}
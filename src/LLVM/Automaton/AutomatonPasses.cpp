@@ -22,10 +22,15 @@
 
 #include "FunctionToCfa.h"
 
+#include "gazer/Automaton/CfaSerialization.h"
 #include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/LiteralExpr.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
 #include "gazer/LLVM/Automaton/SpecialFunctions.h"
+#include "gazer/LLVM/Instrumentation/Check.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
+#include "gazer/Support/Stopwatch.h"
 
 using namespace gazer;
 using namespace gazer::llvm2cfa;
@@ -38,7 +43,8 @@ std::unique_ptr<AutomataSystem> gazer::translateModuleToAutomata(
     MemoryModel& memoryModel,
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
     CfaToLLVMTrace& blockEntries,
-    const SpecialFunctions* specialFunctions)
+    const SpecialFunctions* specialFunctions,
+    std::vector<AbstractedOperation>* abstractedFloats)
 {
     if (specialFunctions == nullptr) {
         specialFunctions = &SpecialFunctions::empty();
@@ -46,7 +52,7 @@ std::unique_ptr<AutomataSystem> gazer::translateModuleToAutomata(
 
     LLVMTypeTranslator types(memoryModel.getMemoryTypeTranslator(), settings);
     ModuleToCfa transformer(module, std::move(loopInfos), context, memoryModel, types, *specialFunctions, settings);
-    return transformer.generate(variables, blockEntries);
+    return transformer.generate(variables, blockEntries, abstractedFloats);
 }
 
 // LLVM pass implementation
@@ -64,21 +70,21 @@ void ModuleToAutomataPass::getAnalysisUsage(llvm::AnalysisUsage& au) const
 bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
 {
     // We need to save loop information here as a on-the-fly LoopInfo pass would delete
-    // the acquired loop information when the lambda function exits.
+    // the acquired loop information when the lambda function exits. The loop information
+    // is only calculated for the functions which are actually translated.
     llvm::DenseMap<const llvm::Function*, std::unique_ptr<llvm::LoopInfo>> loopInfos;
-    for (const llvm::Function& function : module) {
-        if (!function.isDeclaration()) {
+    auto loops = [this, &loopInfos](const llvm::Function* function) -> llvm::LoopInfo* {
+        assert(!function->isDeclaration() && "Loop information is only available for function definitions!");
+
+        auto& result = loopInfos[function];
+        if (result == nullptr) {
             // The const_cast is needed here as getAnalysis expects a non-const function.
             // However, it should be safe as DominatorTreeWrapper does not modify the function.
             auto& dt =
-                getAnalysis<llvm::DominatorTreeWrapperPass>(*const_cast<llvm::Function*>(&function)).getDomTree();
-            loopInfos.try_emplace(&function, std::make_unique<llvm::LoopInfo>(dt));
+                getAnalysis<llvm::DominatorTreeWrapperPass>(*const_cast<llvm::Function*>(function)).getDomTree();
+            result = std::make_unique<llvm::LoopInfo>(dt);
         }
-    }
 
-    auto loops = [&loopInfos](const llvm::Function* function) -> llvm::LoopInfo* {
-        auto& result = loopInfos[function];
-        assert(result != nullptr);
         return result.get();
     };
 
@@ -86,7 +92,62 @@ bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
     auto specialFunctions = SpecialFunctions::get();
 
     mSystem = translateModuleToAutomata(
-        module, mSettings, loops, mContext, memoryModel, mVariables, mTraceInfo, specialFunctions.get());
+        module, mSettings, loops, mContext, memoryModel, mVariables, mTraceInfo, specialFunctions.get(),
+        &mAbstractedFloats);
+
+    // Loop acceleration rewrites the loop bodies, which would invalidate the
+    // precise semantics recorded for the abstracted float operations.
+    if (mSettings.accelerateLoops && mSettings.floats != FloatRepresentation::Refine) {
+        // Loop acceleration works on the recursive representation, thus it
+        // must precede the optional recursive-to-cyclic transformation.
+        AccelerateLoops(*mSystem);
+    }
+
+    // The narrowed variables would invalidate the precise semantics of the
+    // abstracted float operations as well.
+    if (mSettings.reduceBitWidths && mSettings.floats != FloatRepresentation::Refine) {
+        auto reduction = ReduceBitWidths(*mSystem);
+        if (!reduction.replacements.empty()) {
+            auto builder = CreateExprBuilder(mContext);
+            mTraceInfo.replaceVariables(reduction.replacements, *builder);
+        }
+
+        llvm::outs() << "Bit-width reduction narrowed " << reduction.replacements.size() << " variables, "
+            << "from " << reduction.originalBits << " to " << reduction.reducedBits << " bits.\n";
+    }
+
+    if (mSettings.dischargeErrors) {
+        Stopwatch<> sw;
+        sw.start();
+        auto discharge = DischargeUnreachableErrors(*mSystem);
+        sw.stop();
+
+        llvm::outs() << "Abstract interpretation discharged " << discharge.getNumDischarged()
+            << " of " << discharge.numErrors << " error locations in ";
+        sw.format(llvm::outs(), "ms");
+        llvm::outs() << ".\n";
+    }
+
+    // The abstracted float operations refer to the variables and transitions of the automata.
+    if (mSettings.coneOfInfluence && mSettings.floats != FloatRepresentation::Refine) {
+        auto coi = RemoveIrrelevantVariables(*mSystem);
+
+        llvm::outs() << "Cone-of-influence reduction removed " << coi.numRemovedVariables
+            << " of " << coi.numVariables << " variables and " << coi.numRemovedAssignments << " assignments.\n";
+    }
+
+    if (mSettings.largeBlockEncoding && mSettings.floats != FloatRepresentation::Refine) {
+        // Block entry locations are needed to reconstruct the LLVM trace.
+        auto keep = [this](Location* loc) {
+            return mTraceInfo.getBlockFromLocation(loc).kind == CfaToLLVMTrace::Location_Entry;
+        };
+
+        auto encoding = mSettings.trace ? EncodeLargeBlocks(*mSystem, keep) : EncodeLargeBlocks(*mSystem);
+
+        llvm::outs() << "Large-block encoding reduced the automata from "
+            << encoding.originalLocations << " to " << encoding.remainingLocations << " locations and from "
+            << encoding.originalTransitions << " to " << encoding.remainingTransitions << " transitions.\n";
+    }
 
     if (mSettings.loops == LoopRepresentation::Cycle) {
         // Transform the main automaton into a cyclic CFA if requested.
@@ -127,6 +188,48 @@ class PrintCfaPass : public llvm::ModulePass
     }
 };
 
+class WriteCfaPass : public llvm::ModulePass
+{
+    public:
+    static char ID;
+
+    WriteCfaPass(llvm::raw_ostream& os, const CheckRegistry* checks)
+        : ModulePass(ID), mOS(os), mChecks(checks)
+    {}
+
+    void getAnalysisUsage(llvm::AnalysisUsage& au) const override
+    {
+        au.addRequired<ModuleToAutomataPass>();
+        au.setPreservesAll();
+    }
+
+    bool runOnModule(llvm::Module& module) override
+    {
+        auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
+        AutomataSystem& system = moduleToCfa.getSystem();
+
+        std::map<unsigned, std::string> messages;
+        if (mChecks != nullptr) {
+            for (Cfa& cfa : system) {
+                for (auto& [location, errorCode] : cfa.errors()) {
+                    if (auto code = llvm::dyn_cast<BvLiteralExpr>(errorCode)) {
+                        unsigned value = code->getValue().getLimitedValue();
+                        messages.try_emplace(value, mChecks->messageForCode(value));
+                    }
+                }
+            }
+        }
+
+        WriteAutomataSystem(system, mOS, messages);
+
+        return false;
+    }
+
+private:
+    llvm::raw_ostream& mOS;
+    const CheckRegistry* mChecks;
+};
+
 class ViewCfaPass : public llvm::ModulePass
 {
     public:
@@ -156,12 +259,17 @@ class ViewCfaPass : public llvm::ModulePass
 } // end anonymous namespace
 
 char PrintCfaPass::ID;
+char WriteCfaPass::ID;
 char ViewCfaPass::ID;
 
 llvm::Pass* gazer::createCfaPrinterPass()
 {
     return new PrintCfaPass();
 }
+llvm::Pass* gazer::createCfaWriterPass(llvm::raw_ostream& os, const CheckRegistry* checks)
+{
+    return new WriteCfaPass(os, checks);
+}
 llvm::Pass* gazer::createCfaViewerPass()
 {
     return new ViewCfaPass();
@@ -190,4 +298,19 @@ Variable* CfaToLLVMTrace::getVariableForValue(const Cfa* parent, const llvm::Val
     }
 
     return nullptr;
+}
+
+void CfaToLLVMTrace::replaceVariables(
+    const llvm::DenseMap<Variable*, ExprPtr>& replacements, ExprBuilder& builder)
+{
+    VariableExprRewrite rewrite(builder);
+    for (auto& [variable, expr] : replacements) {
+        rewrite[variable] = expr;
+    }
+
+    for (auto& [cfa, info] : mValueMaps) {
+        for (auto& [value, expr] : info.values) {
+            expr = rewrite.walk(expr);
+        }
+    }
 }
\ No newline at end of file
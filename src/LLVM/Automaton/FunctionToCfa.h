@@ -225,6 +225,11 @@ public:
         }
     }
 
+    void addAbstractedFloatOperation(Cfa* cfa, Variable* variable, ExprPtr precise)
+    {
+        mAbstractedFloats.push_back({ cfa, variable, std::move(precise) });
+    }
+
     CfaGenInfo& getLoopCfa(llvm::Loop* loop) { return getInfoFor(loop); }
     CfaGenInfo& getFunctionCfa(llvm::Function* function) { return getInfoFor(function); }
 
@@ -245,6 +250,7 @@ public:
     LLVMTypeTranslator& getTypes() const { return mTypes; }
     const LLVMFrontendSettings& getSettings() { return mSettings; }
     CfaToLLVMTrace& getTraceInfo() { return mTraceInfo; }
+    std::vector<AbstractedOperation>& getAbstractedFloats() { return mAbstractedFloats; }
     const SpecialFunctions& getSpecialFunctions() const { return mSpecialFunctions; }
 
 private:
@@ -265,6 +271,7 @@ private:
     const LLVMFrontendSettings& mSettings;
     std::unordered_map<VariantT, CfaGenInfo> mProcedures;
     CfaToLLVMTrace mTraceInfo;
+    std::vector<AbstractedOperation> mAbstractedFloats;
     unsigned mTmp = 0;
 };
 
@@ -286,7 +293,8 @@ public:
 
     std::unique_ptr<AutomataSystem> generate(
         llvm::DenseMap<llvm::Value*, Variable*>& variables,
-        CfaToLLVMTrace& cfaToLlvmTrace
+        CfaToLLVMTrace& cfaToLlvmTrace,
+        std::vector<AbstractedOperation>* abstractedFloats
     );
 
 protected:
@@ -314,6 +322,10 @@ private:
     // Generation helpers
     std::unordered_map<llvm::Function*, Cfa*> mFunctionMap;
     std::unordered_map<llvm::Loop*, Cfa*> mLoopMap;
+
+    /// The procedures in the order their bodies are encoded: the functions
+    /// in the order of the module, each preceded by its loops, innermost first.
+    std::vector<CfaGenInfo*> mEncodingOrder;
 };
 
 class BlocksToCfa : public InstToExpr
@@ -361,6 +373,7 @@ public:
 protected:
     Variable* getVariable(ValueOrMemoryObject value) override;
     ExprPtr lookupInlinedVariable(ValueOrMemoryObject value) override;
+    void abstractedFloatOperation(const llvm::Instruction& inst, const ExprPtr& precise) override;
 
 private:
     GazerContext& getContext() const { return mGenCtx.getSystem().getContext(); }
@@ -26,14 +26,55 @@
 using namespace gazer;
 using namespace llvm;
 
+/// Returns true if \p inst is a floating-point operation which may be abstracted.
+/// Comparisons are always kept precise, as they are cheap to decide even on
+/// abstracted operands.
+static bool isFloatOperation(const llvm::Instruction& inst)
+{
+    switch (inst.getOpcode()) {
+        case Instruction::FAdd:
+        case Instruction::FSub:
+        case Instruction::FMul:
+        case Instruction::FDiv:
+        case Instruction::FPExt:
+        case Instruction::FPTrunc:
+        case Instruction::SIToFP:
+        case Instruction::UIToFP:
+        case Instruction::FPToSI:
+        case Instruction::FPToUI:
+            return true;
+        default:
+            return false;
+    }
+}
+
 ExprPtr InstToExpr::transform(const llvm::Instruction &inst, Type &expectedType)
 {
     ExprPtr result = this->doTransform(inst, expectedType);
     assert(result->getType() == expectedType && "Result must have the expected type!");
 
+    if (isFloatOperation(inst) && !llvm::isa<LiteralExpr>(result) && !this->isPreciseFloatOperation(inst)) {
+        this->abstractedFloatOperation(inst, result);
+        return mExprBuilder.Undef(expectedType);
+    }
+
     return result;
 }
 
+bool InstToExpr::isPreciseFloatOperation(const llvm::Instruction& inst)
+{
+    switch (mSettings.floats) {
+        case FloatRepresentation::Fpa:
+        case FloatRepresentation::Real:
+            return true;
+        case FloatRepresentation::Undef:
+        case FloatRepresentation::Refine:
+            return false;
+    }
+
+    llvm_unreachable("Unknown float representation!");
+}
+
 ExprPtr InstToExpr::doTransform(const llvm::Instruction& inst, Type& expectedType)
 {
     LLVM_DEBUG(llvm::dbgs() << "  Transforming instruction " << inst << "\n");
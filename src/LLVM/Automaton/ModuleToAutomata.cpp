@@ -218,6 +218,40 @@ static std::string getLoopName(llvm::Loop* loop, unsigned& loopCount, llvm::Stri
     return name;
 }
 
+/// Returns the function definitions which may be called from the given entry
+/// function, including the entry function itself.
+static llvm::DenseSet<llvm::Function*> findReachableFunctions(llvm::Module& module, llvm::StringRef entry)
+{
+    llvm::DenseSet<llvm::Function*> reachable;
+    llvm::Function* entryFunction = module.getFunction(entry);
+    if (entryFunction == nullptr || entryFunction->isDeclaration()) {
+        return reachable;
+    }
+
+    std::vector<llvm::Function*> worklist = { entryFunction };
+    reachable.insert(entryFunction);
+
+    while (!worklist.empty()) {
+        llvm::Function* function = worklist.back();
+        worklist.pop_back();
+
+        for (Instruction& inst : llvm::instructions(function)) {
+            auto call = llvm::dyn_cast<CallInst>(&inst);
+            if (call == nullptr) {
+                continue;
+            }
+
+            // Indirect calls are not supported by the translation.
+            llvm::Function* callee = call->getCalledFunction();
+            if (callee != nullptr && !callee->isDeclaration() && reachable.insert(callee).second) {
+                worklist.push_back(callee);
+            }
+        }
+    }
+
+    return reachable;
+}
+
 ModuleToCfa::ModuleToCfa(
     llvm::Module& module,
     LoopInfoFuncTy loops,
@@ -242,16 +276,18 @@ ModuleToCfa::ModuleToCfa(
 
 std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
-    CfaToLLVMTrace& cfaToLlvmTrace
+    CfaToLLVMTrace& cfaToLlvmTrace,
+    std::vector<AbstractedOperation>* abstractedFloats
 ) {
     // Create all automata and interfaces.
     this->createAutomata();
 
-    // Encode all loops and functions
-    for (auto& [source, genInfo] : mGenCtx.procedures()) {
-        LLVM_DEBUG(llvm::dbgs() << "Encoding function CFA " << genInfo.Automaton->getName() << "\n");
+    // Encode all loops and functions. The procedures are encoded in a fixed order,
+    // thus the generated automata do not depend on the layout of the procedure map.
+    for (CfaGenInfo* genInfo : mEncodingOrder) {
+        LLVM_DEBUG(llvm::dbgs() << "Encoding function CFA " << genInfo->Automaton->getName() << "\n");
 
-        BlocksToCfa blocksToCfa(mGenCtx, genInfo, *mExprBuilder);
+        BlocksToCfa blocksToCfa(mGenCtx, *genInfo, *mExprBuilder);
 
         // Do the actual encoding.
         blocksToCfa.encode();
@@ -273,18 +309,30 @@ std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
     mSystem->setMainAutomaton(main);
 
     cfaToLlvmTrace = std::move(mGenCtx.getTraceInfo());
+    if (abstractedFloats != nullptr) {
+        *abstractedFloats = std::move(mGenCtx.getAbstractedFloats());
+    }
 
     return std::move(mSystem);
 }
 
 void ModuleToCfa::createAutomata()
 {
+    // Functions which cannot be called from the entry function are never
+    // needed by the backends, thus neither they nor their loops are translated.
+    llvm::DenseSet<llvm::Function*> reachable = findReachableFunctions(mModule, mSettings.function);
+
     // Create an automaton for each function definition and set the interfaces.
     for (llvm::Function& function : mModule.functions()) {
         if (function.isDeclaration()) {
             continue;
         }
 
+        if (reachable.count(&function) == 0) {
+            LLVM_DEBUG(llvm::dbgs() << "Skipping unreachable function " << function.getName() << "\n");
+            continue;
+        }
+
         auto& memoryInstHandler = mMemoryModel.getMemoryInstructionHandler(function);
 
         Cfa* cfa = mSystem->createCfa(function.getName());
@@ -349,11 +397,13 @@ void ModuleToCfa::createAutomata()
             }
 
             visitedBlocks.insert(loop->getBlocks().begin(), loop->getBlocks().end());
+            mEncodingOrder.push_back(&loopGenInfo);
         }
 
         // Now that all loops in this function have been dealt with, translate the function itself.
         CfaGenInfo& genInfo = mGenCtx.createFunctionCfaInfo(cfa, &function);
         VariableDeclExtensionPoint functionVarDecl(genInfo);
+        mEncodingOrder.push_back(&genInfo);
 
         // Add function input and output parameters
         for (llvm::Argument& argument : function.args()) {
@@ -945,6 +995,11 @@ ExprPtr BlocksToCfa::lookupInlinedVariable(ValueOrMemoryObject value)
     return mInlinedVars.lookup(value);
 }
 
+void BlocksToCfa::abstractedFloatOperation(const llvm::Instruction& inst, const ExprPtr& precise)
+{
+    mGenCtx.addAbstractedFloatOperation(mCfa, getVariable(&inst), precise);
+}
+
 Variable* BlocksToCfa::getVariable(ValueOrMemoryObject value)
 {
     auto result = mGenInfo.findVariable(value);
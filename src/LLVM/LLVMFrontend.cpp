@@ -16,10 +16,13 @@
 //
 //===----------------------------------------------------------------------===//
 #include "gazer/LLVM/LLVMFrontend.h"
+#include "gazer/Automaton/CfaSerialization.h"
 #include "gazer/LLVM/Instrumentation/DefaultChecks.h"
 #include "gazer/LLVM/InstrumentationPasses.h"
 #include "gazer/LLVM/Transform/Passes.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
+#include "gazer/Verifier/FloatRefinement.h"
+#include "gazer/Verifier/VerdictCache.h"
 #include "gazer/LLVM/Transform/UndefToNondet.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
 #include "gazer/Trace/TraceWriter.h"
@@ -47,6 +50,8 @@
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_sha1_ostream.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 
 using namespace gazer;
@@ -76,8 +81,10 @@ namespace
         RunVerificationBackendPass(
             const CheckRegistry& checks,
             VerificationAlgorithm& algorithm,
+            llvm::StringRef description,
             const LLVMFrontendSettings& settings
-        ) : ModulePass(ID), mChecks(checks), mAlgorithm(algorithm), mSettings(settings)
+        ) : ModulePass(ID), mChecks(checks), mAlgorithm(algorithm),
+            mDescription(description), mSettings(settings)
         {}
 
         void getAnalysisUsage(llvm::AnalysisUsage& au) const override
@@ -95,6 +102,7 @@ namespace
     private:
         const CheckRegistry& mChecks;
         VerificationAlgorithm& mAlgorithm;
+        std::string mDescription;
         const LLVMFrontendSettings& mSettings;
         std::unique_ptr<VerificationResult> mResult;
     };
@@ -193,56 +201,41 @@ void LLVMFrontend::registerVerificationPipeline()
 
     // Execute the verifier backend if there is one.
     if (mBackendAlgorithm != nullptr) {
-        mPassManager.add(new RunVerificationBackendPass(mChecks, *mBackendAlgorithm, mSettings));
+        mPassManager.add(new RunVerificationBackendPass(
+            mChecks, *mBackendAlgorithm, mBackendDescription, mSettings
+        ));
     }
 }
 
-bool RunVerificationBackendPass::runOnModule(llvm::Module& module)
+static void printFailure(
+    const FailResult& fail, llvm::function_ref<std::string(unsigned)> messageForCode, bool trace)
 {
-    auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
-
-    AutomataSystem& system = moduleToCfa.getSystem();
-    CfaToLLVMTrace cfaToLlvmTrace = moduleToCfa.getTraceInfo();
-    LLVMTraceBuilder traceBuilder{system.getContext(), cfaToLlvmTrace};
+    std::string msg = messageForCode(fail.getErrorID());
+    llvm::outs() << "  " << msg << "\n";
+
+    if (trace) {
+        auto writer = trace::CreateTextWriter(llvm::outs(), true);
+        llvm::outs() << "Error trace:\n";
+        llvm::outs() << "------------\n";
+        if (fail.hasTrace()) {
+            writer->write(fail.getTrace());
+        } else {
+            llvm::outs() << "Error trace is unavailable.\n";
+        }
+    }
+}
 
-    mResult = mAlgorithm.check(system, traceBuilder);
-    switch (mResult->getStatus()) {
+static void printVerificationResult(
+    const VerificationResult& result, llvm::function_ref<std::string(unsigned)> messageForCode, bool trace)
+{
+    switch (result.getStatus()) {
         case VerificationResult::Fail: {
-            auto fail = llvm::cast<FailResult>(mResult.get());
-            unsigned ec = fail->getErrorID();
-            std::string msg = mChecks.messageForCode(ec);
+            auto fail = llvm::cast<FailResult>(&result);
 
             llvm::outs() << "Verification FAILED.\n";
-            llvm::outs() << "  " << msg << "\n";
-
-            if (mSettings.trace) {
-                auto writer = trace::CreateTextWriter(llvm::outs(), true);
-                llvm::outs() << "Error trace:\n";
-                llvm::outs() << "------------\n";
-                if (fail->hasTrace()) {
-                    writer->write(fail->getTrace());
-                } else {
-                    llvm::outs() << "Error trace is unavailable.\n";
-                }
-            }
-
-            if (!mSettings.testHarnessFile.empty() && fail->hasTrace()) {
-                llvm::outs() << "Generating test harness.\n";
-                auto test = GenerateTestHarnessModuleFromTrace(
-                    fail->getTrace(), 
-                    module.getContext(),
-                    module
-                );
-
-                llvm::StringRef filename(mSettings.testHarnessFile);
-                std::error_code osError;
-                llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
-
-                if (filename.endswith("ll")) {
-                    testOS << *test;
-                } else {
-                    llvm::WriteBitcodeToFile(*test, testOS);
-                }
+            printFailure(*fail, messageForCode, trace);
+            for (const FailResult& other : fail->other_failures()) {
+                printFailure(other, messageForCode, trace);
             }
             break;
         }
@@ -257,16 +250,123 @@ bool RunVerificationBackendPass::runOnModule(llvm::Module& module)
             break;
         case VerificationResult::InternalError:
             llvm::outs() << "Verification INTERNAL ERROR.\n";
-            llvm::outs() << "  " << mResult->getMessage() << "\n";
+            llvm::outs() << "  " << result.getMessage() << "\n";
             break;
         case VerificationResult::Unknown:
             llvm::outs() << "Verification UNKNOWN.\n";
             break;
     }
+}
+
+/// Builds the key of the verdict of \p module in the verdict cache.
+static std::string getVerdictCacheKey(
+    llvm::Module& module, const LLVMFrontendSettings& settings, llvm::StringRef backend)
+{
+    // The module may have been compiled into a temporary file, thus
+    // its name is left out so that equal modules have equal keys.
+    std::string identifier = module.getModuleIdentifier();
+    std::string sourceFile = module.getSourceFileName();
+    module.setModuleIdentifier("");
+    module.setSourceFileName("");
+
+    llvm::raw_sha1_ostream hash;
+    module.print(hash, nullptr);
+
+    module.setModuleIdentifier(identifier);
+    module.setSourceFileName(sourceFile);
+
+    return llvm::toHex(hash.sha1()) + "\n" + settings.toString() + "\n" + backend.str();
+}
+
+bool RunVerificationBackendPass::runOnModule(llvm::Module& module)
+{
+    auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
+
+    AutomataSystem& system = moduleToCfa.getSystem();
+    CfaToLLVMTrace cfaToLlvmTrace = moduleToCfa.getTraceInfo();
+    LLVMTraceBuilder traceBuilder{system.getContext(), cfaToLlvmTrace};
+
+    VerificationAlgorithm* algorithm = &mAlgorithm;
+
+    std::unique_ptr<FloatAbstractionRefinement> refinement;
+    if (mSettings.floats == FloatRepresentation::Refine) {
+        refinement = std::make_unique<FloatAbstractionRefinement>(
+            mAlgorithm, moduleToCfa.getAbstractedFloats(), mSettings.trace
+        );
+        algorithm = refinement.get();
+    }
+
+    std::unique_ptr<VerdictCache> cache;
+    if (!mSettings.verdictCache.empty() && !mDescription.empty()) {
+        VerdictCacheSettings cacheSettings;
+        cacheSettings.directory = mSettings.verdictCache;
+        cacheSettings.maxSize = static_cast<uint64_t>(mSettings.verdictCacheSize) * 1024 * 1024;
+
+        cache = std::make_unique<VerdictCache>(
+            *algorithm, getVerdictCacheKey(module, mSettings, mDescription), cacheSettings
+        );
+        algorithm = cache.get();
+    }
+
+    mResult = algorithm->check(system, traceBuilder);
+
+    printVerificationResult(*mResult, [this](unsigned ec) { return mChecks.messageForCode(ec); }, mSettings.trace);
+
+    if (auto fail = llvm::dyn_cast<FailResult>(mResult.get())) {
+        if (!mSettings.testHarnessFile.empty() && fail->hasTrace()) {
+            llvm::outs() << "Generating test harness.\n";
+            auto test = GenerateTestHarnessModuleFromTrace(
+                fail->getTrace(), 
+                module.getContext(),
+                module
+            );
+
+            llvm::StringRef filename(mSettings.testHarnessFile);
+            std::error_code osError;
+            llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
+
+            if (filename.endswith("ll")) {
+                testOS << *test;
+            } else {
+                llvm::WriteBitcodeToFile(*test, testOS);
+            }
+        }
+    }
 
     return false;
 }
 
+bool gazer::VerifyAutomataSystemFile(
+    llvm::StringRef filename, GazerContext& context, VerificationAlgorithm& algorithm, bool trace)
+{
+    auto serialized = ReadAutomataSystemFile(filename, context);
+    if (serialized.system == nullptr) {
+        emit_error("could not load '%s': %s", filename.str().c_str(), serialized.error.c_str());
+        return false;
+    }
+
+    // The system is not mapped to an LLVM module, thus only the locations
+    // of the counterexamples are known, but not their LLVM-level trace.
+    CfaTraceRecorder traceBuilder;
+    auto result = algorithm.check(*serialized.system, traceBuilder);
+
+    auto messageForCode = [&serialized](unsigned ec) -> std::string {
+        if (ec == VerificationResult::GeneralFailureCode) {
+            return "Unknown failure: a property violation was found, but I could not create an error trace.\n";
+        }
+
+        auto it = serialized.messages.find(ec);
+        if (it == serialized.messages.end()) {
+            return "Error code " + std::to_string(ec);
+        }
+        return it->second;
+    };
+
+    printVerificationResult(*result, messageForCode, trace);
+
+    return true;
+}
+
 void LLVMFrontend::registerEnabledChecks()
 {
     mChecks.registerPasses(mPassManager);
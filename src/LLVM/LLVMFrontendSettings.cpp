@@ -57,6 +57,14 @@ namespace
     cl::opt<bool> NoSlice(
         "no-slicing", cl::desc("Do not run program slicing pass"), cl::cat(LLVMFrontendCategory)
     );
+    cl::opt<std::string> VerdictCache(
+        "verdict-cache", cl::desc("Store verdicts in the given directory and reuse them in later runs"),
+        cl::value_desc("directory"), cl::cat(LLVMFrontendCategory)
+    );
+    cl::opt<unsigned> VerdictCacheSize(
+        "verdict-cache-size", cl::desc("Maximum size of the verdict cache in megabytes (0 means unlimited)"),
+        cl::init(256), cl::cat(LLVMFrontendCategory)
+    );
 
     // LLVM IR to CFA translation options
     cl::opt<ElimVarsLevel> ElimVarsLevelOpt("elim-vars", cl::desc("Level for variable elimination:"),
@@ -71,6 +79,16 @@ namespace
     cl::opt<bool> ArithInts(
         "math-int", cl::desc("Use mathematical unbounded integers instead of bitvectors"),
         cl::cat(IrToCfaCategory));
+    cl::opt<FloatRepresentation> FloatsOpt("floats", cl::desc("Representation of floating-point operations:"),
+        cl::values(
+            clEnumValN(FloatRepresentation::Fpa, "fpa", "Use precise IEEE-754 semantics"),
+            clEnumValN(FloatRepresentation::Undef, "undef", "Abstract float operations into undef values"),
+            clEnumValN(FloatRepresentation::Refine, "refine",
+                "Abstract float operations, make them precise on spurious counterexamples")
+        ),
+        cl::init(FloatRepresentation::Fpa),
+        cl::cat(IrToCfaCategory)
+    );
     cl::opt<bool> NoSimplifyExpr(
         "no-simplify-expr", cl::desc("Do not simplify expressions"),
         cl::cat(IrToCfaCategory)
@@ -80,6 +98,26 @@ namespace
     cl::opt<bool> Strict(
         "strict", cl::desc("Use stricter transformation rules for undefined behavior"), cl::cat(IrToCfaCategory)
     );
+    cl::opt<bool> AccelerateLoops(
+        "accelerate-loops", cl::desc("Replace simple counting loops with their closed-form summaries"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> ReduceBitWidths(
+        "reduce-bit-widths", cl::desc("Narrow bit-vector variables whose values fit into fewer bits"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> DischargeErrors(
+        "discharge-errors", cl::desc("Remove error locations proven unreachable by abstract interpretation"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> ConeOfInfluence(
+        "cone-of-influence", cl::desc("Remove the variables which cannot influence the reachability of errors"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> LargeBlockEncoding(
+        "large-block-encoding", cl::desc("Merge chains and parallel transitions of the automata into larger blocks"),
+        cl::cat(IrToCfaCategory)
+    );
 
     // Memory models
     cl::opt<bool> DebugDumpMemorySSA(
@@ -140,6 +178,11 @@ LLVMFrontendSettings LLVMFrontendSettings::initFromCommandLine()
     settings.simplifyExpr = !NoSimplifyExpr;
 
     settings.strict = Strict;
+    settings.accelerateLoops = AccelerateLoops;
+    settings.reduceBitWidths = ReduceBitWidths;
+    settings.dischargeErrors = DischargeErrors;
+    settings.coneOfInfluence = ConeOfInfluence;
+    settings.largeBlockEncoding = LargeBlockEncoding;
 
     settings.inlineLevel = InlineLevelOpt;
     settings.elimVars = ElimVarsLevelOpt;
@@ -156,11 +199,16 @@ LLVMFrontendSettings LLVMFrontendSettings::initFromCommandLine()
         settings.ints = IntRepresentation::BitVectors;
     }
 
+    settings.floats = FloatsOpt;
+
     settings.debugDumpMemorySSA = DebugDumpMemorySSA;
 
     settings.trace = PrintTrace;
     settings.testHarnessFile = TestHarnessFile;
 
+    settings.verdictCache = VerdictCache;
+    settings.verdictCacheSize = VerdictCacheSize;
+
     return settings;
 }
 
@@ -194,8 +242,35 @@ std::string LLVMFrontendSettings::toString() const
         case FloatRepresentation::Fpa:     str += "fpa";   break;
         case FloatRepresentation::Real:    str += "real";  break;
         case FloatRepresentation::Undef:   str += "undef"; break;
+        case FloatRepresentation::Refine:  str += "refine"; break;
+    }
+
+    str += R"(", "memory_model": ")";
+
+    switch (memoryModel) {
+        case MemoryModelSetting::Havoc:  str += "havoc"; break;
+        case MemoryModelSetting::Flat:   str += "flat"; break;
     }
 
+    str += "\"";
+
+    auto addFlag = [&str](const char* name, bool value) {
+        str += ", \"";
+        str += name;
+        str += value ? "\": true" : "\": false";
+    };
+
+    addFlag("simplify_expr", simplifyExpr);
+    addFlag("strict", strict);
+    addFlag("accelerate_loops", accelerateLoops);
+    addFlag("reduce_bit_widths", reduceBitWidths);
+    addFlag("discharge_errors", dischargeErrors);
+    addFlag("cone_of_influence", coneOfInfluence);
+    addFlag("large_block_encoding", largeBlockEncoding);
+    addFlag("trace", trace);
+
+    str += R"(, "function": ")";
+    str += function;
     str += "\"}";
 
     return str;
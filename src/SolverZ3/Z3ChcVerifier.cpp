@@ -0,0 +1,712 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Z3Solver/Z3ChcVerifier.h"
+#include "Z3SolverImpl.h"
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+
+using namespace gazer;
+
+namespace
+{
+
+/// Exposes the sort translation of the Z3 solver.
+class ChcExprTransformer : public Z3ExprTransformer
+{
+public:
+    using Z3ExprTransformer::Z3ExprTransformer;
+    using Z3ExprTransformer::typeToSort;
+};
+
+struct PredicateInfo
+{
+    enum Kind { Pred_Location, Pred_Summary, Pred_Failure, Pred_Error };
+
+    Kind kind;
+    Cfa* cfa;
+    Location* location;
+};
+
+/// A location along a counterexample, with the values of the variables of
+/// its automaton. The valuation is empty if it is not known.
+struct ChcTraceState
+{
+    Location* location;
+    std::vector<ExprRef<AtomicExpr>> values;
+};
+
+class Z3ChcVerifierImpl
+{
+    using PredicateHandle = Z3Handle<Z3_func_decl>;
+public:
+    Z3ChcVerifierImpl(AutomataSystem& system, CfaTraceBuilder& traceBuilder, ChcSettings settings);
+
+    Z3ChcVerifierImpl(const Z3ChcVerifierImpl&) = delete;
+    Z3ChcVerifierImpl& operator=(const Z3ChcVerifierImpl&) = delete;
+
+    std::unique_ptr<VerificationResult> check();
+
+    ~Z3ChcVerifierImpl();
+
+private:
+    void encodeCfa(Cfa& cfa);
+
+    PredicateHandle createPredicate(const std::string& name, llvm::ArrayRef<Z3_sort> domain, PredicateInfo info);
+    Z3AstHandle apply(const PredicateHandle& predicate, llvm::ArrayRef<Z3AstHandle> args);
+    Z3AstHandle translate(const ExprPtr& expr) { return mTransformer.walk(expr); }
+    Z3AstHandle createFreshConstant(Type& type);
+
+    /// Adds the rule 'body => head' universally quantified over all of its constants.
+    void addRule(llvm::ArrayRef<Z3AstHandle> body, Z3AstHandle head);
+    void collectConstants(Z3_ast ast, llvm::DenseSet<Z3_ast>& visited, std::vector<Z3_app>& constants);
+
+    std::unique_ptr<VerificationResult> createFailResult();
+
+    const PredicateInfo* lookupAtom(Z3_ast ast);
+    Z3_ast getConclusion(Z3_ast proof);
+    void walkProof(Z3_ast proof, std::vector<ChcTraceState>& states, ExprRef<AtomicExpr>& errorCode);
+    ExprRef<AtomicExpr> getValue(const ChcTraceState& state, Variable* variable);
+    std::vector<VariableAssignment> getAction(const ChcTraceState& prev, const ChcTraceState& curr, const ChcTraceState* next);
+
+private:
+    AutomataSystem& mSystem;
+    CfaTraceBuilder& mTraceBuilder;
+    ChcSettings mSettings;
+
+    Z3_config mConfig;
+    Z3_context mZ3Context;
+    Z3_fixedpoint mFixedpoint;
+    unsigned mTmpCount = 0;
+    Z3CacheMapTy mCache;
+    Z3DeclMapTy mDecls;
+    ChcExprTransformer mTransformer;
+
+    Type* mErrorType = nullptr;
+
+    llvm::DenseMap<Cfa*, std::vector<Variable*>> mStateVariables;
+    llvm::DenseMap<Variable*, size_t> mStateIndices;
+
+    llvm::DenseMap<Location*, PredicateHandle> mLocationPredicates;
+    llvm::DenseMap<Cfa*, PredicateHandle> mSummaryPredicates;
+    llvm::DenseMap<Cfa*, PredicateHandle> mFailurePredicates;
+    PredicateHandle mErrorPredicate;
+    llvm::DenseMap<Z3_func_decl, PredicateInfo> mPredicateInfo;
+
+    unsigned mNumRules = 0;
+};
+
+} // end anonymous namespace
+
+auto Z3ChcVerifier::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    Z3ChcVerifierImpl impl{system, traceBuilder, mSettings};
+    return impl.check();
+}
+
+Z3ChcVerifierImpl::Z3ChcVerifierImpl(
+    AutomataSystem& system, CfaTraceBuilder& traceBuilder, ChcSettings settings
+) : mSystem(system), mTraceBuilder(traceBuilder), mSettings(settings),
+    mTransformer(mZ3Context, mTmpCount, mCache, mDecls)
+{
+    mConfig = Z3_mk_config();
+    mZ3Context = Z3_mk_context_rc(mConfig);
+    mFixedpoint = Z3_mk_fixedpoint(mZ3Context);
+    Z3_fixedpoint_inc_ref(mZ3Context, mFixedpoint);
+
+    Z3_params params = Z3_mk_params(mZ3Context);
+    Z3_params_inc_ref(mZ3Context, params);
+
+    auto symbol = [this](const char* str) { return Z3_mk_string_symbol(mZ3Context, str); };
+
+    Z3_params_set_symbol(mZ3Context, params, symbol("engine"), symbol("spacer"));
+
+    // The preprocessing steps of Z3 may eliminate or merge location predicates,
+    // making the derivation impossible to map back to the automata.
+    for (const char* xform : {
+        "xform.slice", "xform.inline_linear", "xform.inline_eager",
+        "xform.inline_linear_branch", "xform.compress_unbound", "xform.coi",
+        "xform.subsumption_checker"
+    }) {
+        Z3_params_set_bool(mZ3Context, params, symbol(xform), false);
+    }
+
+    Z3_fixedpoint_set_params(mZ3Context, mFixedpoint, params);
+    Z3_params_dec_ref(mZ3Context, params);
+}
+
+Z3ChcVerifierImpl::~Z3ChcVerifierImpl()
+{
+    // Every handle must be released before the context is deleted.
+    mLocationPredicates.clear();
+    mSummaryPredicates.clear();
+    mFailurePredicates.clear();
+    mErrorPredicate = PredicateHandle();
+    mCache.clear();
+    mDecls.clear();
+    mTransformer.clear();
+    Z3_fixedpoint_dec_ref(mZ3Context, mFixedpoint);
+    Z3_del_context(mZ3Context);
+    Z3_del_config(mConfig);
+}
+
+auto Z3ChcVerifierImpl::check() -> std::unique_ptr<VerificationResult>
+{
+    for (Cfa& cfa : mSystem) {
+        if (cfa.getNumErrors() != 0) {
+            mErrorType = &cfa.error_begin()->second->getType();
+            break;
+        }
+    }
+
+    if (mErrorType == nullptr) {
+        llvm::outs() << "No error location is present or it was discarded by the frontend.\n";
+        return VerificationResult::CreateSuccess();
+    }
+
+    // Declare the predicates of each automaton first, as calls may refer to
+    // the summary of any other automaton.
+    Z3Handle<Z3_sort> errorSort = mTransformer.typeToSort(*mErrorType);
+    for (Cfa& cfa : mSystem) {
+        auto& variables = mStateVariables[&cfa];
+        llvm::DenseSet<Variable*> seen;
+        for (Variable& input : cfa.inputs()) {
+            if (seen.insert(&input).second) {
+                variables.push_back(&input);
+            }
+        }
+        for (Variable& local : cfa.locals()) {
+            if (seen.insert(&local).second) {
+                variables.push_back(&local);
+            }
+        }
+
+        std::vector<Z3Handle<Z3_sort>> sortHandles;
+        std::vector<Z3_sort> stateSorts;
+        for (size_t i = 0; i < variables.size(); ++i) {
+            mStateIndices[variables[i]] = i;
+            sortHandles.push_back(mTransformer.typeToSort(variables[i]->getType()));
+            stateSorts.push_back(sortHandles.back().getNode());
+        }
+
+        std::vector<Z3_sort> summarySorts;
+        std::vector<Z3_sort> failureSorts;
+        for (Variable& input : cfa.inputs()) {
+            sortHandles.push_back(mTransformer.typeToSort(input.getType()));
+            summarySorts.push_back(sortHandles.back().getNode());
+            failureSorts.push_back(sortHandles.back().getNode());
+        }
+        for (Variable& output : cfa.outputs()) {
+            sortHandles.push_back(mTransformer.typeToSort(output.getType()));
+            summarySorts.push_back(sortHandles.back().getNode());
+        }
+        failureSorts.push_back(errorSort.getNode());
+
+        std::string name = cfa.getName().str();
+        for (Location* loc : cfa.nodes()) {
+            mLocationPredicates[loc] = this->createPredicate(
+                name + "/" + std::to_string(loc->getId()), stateSorts,
+                { PredicateInfo::Pred_Location, &cfa, loc }
+            );
+        }
+
+        mSummaryPredicates[&cfa] = this->createPredicate(
+            name + "/summary", summarySorts, { PredicateInfo::Pred_Summary, &cfa, nullptr }
+        );
+        mFailurePredicates[&cfa] = this->createPredicate(
+            name + "/fail", failureSorts, { PredicateInfo::Pred_Failure, &cfa, nullptr }
+        );
+    }
+
+    mErrorPredicate = this->createPredicate(
+        "__gazer_error", {}, { PredicateInfo::Pred_Error, nullptr, nullptr }
+    );
+
+    for (Cfa& cfa : mSystem) {
+        this->encodeCfa(cfa);
+    }
+
+    // An error is reachable if the main automaton may fail.
+    Cfa* main = mSystem.getMainAutomaton();
+    std::vector<Z3AstHandle> failArgs;
+    for (Variable& input : main->inputs()) {
+        failArgs.push_back(this->translate(input.getRefExpr()));
+    }
+    failArgs.push_back(this->createFreshConstant(*mErrorType));
+    this->addRule({ this->apply(mFailurePredicates[main], failArgs) }, this->apply(mErrorPredicate, {}));
+
+    if (mSettings.dumpRules) {
+        llvm::errs() << Z3_fixedpoint_to_string(mZ3Context, mFixedpoint, 0, nullptr) << "\n";
+    }
+
+    llvm::outs() << "Solving " << mNumRules << " Horn clauses...\n";
+
+    Z3_func_decl query = mErrorPredicate.getNode();
+    Z3_lbool status = Z3_fixedpoint_query_relations(mZ3Context, mFixedpoint, 1, &query);
+
+    if (mSettings.printSolverStats) {
+        auto stats = Z3_fixedpoint_get_statistics(mZ3Context, mFixedpoint);
+        Z3_stats_inc_ref(mZ3Context, stats);
+        llvm::outs() << Z3_stats_to_string(mZ3Context, stats) << "\n";
+        Z3_stats_dec_ref(mZ3Context, stats);
+    }
+
+    switch (status) {
+        case Z3_L_FALSE: return VerificationResult::CreateSuccess();
+        case Z3_L_TRUE:  return this->createFailResult();
+        case Z3_L_UNDEF:
+            llvm::outs() << "Solver returned unknown: "
+                << Z3_fixedpoint_get_reason_unknown(mZ3Context, mFixedpoint) << "\n";
+            return VerificationResult::CreateUnknown();
+    }
+
+    llvm_unreachable("Unknown solver status encountered.");
+}
+
+void Z3ChcVerifierImpl::encodeCfa(Cfa& cfa)
+{
+    std::vector<Z3AstHandle> state;
+    for (Variable* variable : mStateVariables[&cfa]) {
+        state.push_back(this->translate(variable->getRefExpr()));
+    }
+
+    std::vector<Z3AstHandle> inputs;
+    for (Variable& input : cfa.inputs()) {
+        inputs.push_back(this->translate(input.getRefExpr()));
+    }
+
+    // Procedure summaries are context-insensitive: the entry location is
+    // reachable with any valuation.
+    this->addRule({}, this->apply(mLocationPredicates[cfa.getEntry()], state));
+
+    for (Transition* edge : cfa.edges()) {
+        if (auto lit = llvm::dyn_cast<BoolLiteralExpr>(edge->getGuard().get()); lit && lit->isFalse()) {
+            continue;
+        }
+
+        Z3AstHandle target = this->apply(mLocationPredicates[edge->getTarget()], state);
+        std::vector<Z3AstHandle> body = {
+            this->apply(mLocationPredicates[edge->getSource()], state),
+            this->translate(edge->getGuard())
+        };
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            // The automata are in SSA form, thus each assignment may be
+            // represented as a constraint over the same state variables.
+            for (const VariableAssignment& assignment : *assign) {
+                if (llvm::isa<UndefExpr>(assignment.getValue())) {
+                    continue;
+                }
+
+                body.push_back(Z3AstHandle(mZ3Context, Z3_mk_eq(
+                    mZ3Context,
+                    this->translate(assignment.getVariable()->getRefExpr()),
+                    this->translate(assignment.getValue())
+                )));
+            }
+
+            this->addRule(body, target);
+            continue;
+        }
+
+        auto call = llvm::cast<CallTransition>(edge);
+        Cfa* callee = call->getCalledAutomaton();
+
+        std::vector<Z3AstHandle> args;
+        for (Variable& input : callee->inputs()) {
+            auto arg = call->getInputArgument(input);
+            args.push_back(arg.has_value()
+                ? this->translate(arg->getValue())
+                : this->createFreshConstant(input.getType()));
+        }
+
+        std::vector<Z3AstHandle> failArgs = args;
+
+        for (Variable& output : callee->outputs()) {
+            auto arg = call->getOutputArgument(output);
+            args.push_back(arg.has_value()
+                ? this->translate(arg->getVariable()->getRefExpr())
+                : this->createFreshConstant(output.getType()));
+        }
+
+        body.push_back(this->apply(mSummaryPredicates[callee], args));
+        this->addRule(body, target);
+        body.pop_back();
+
+        // Failures of the callee are failures of the caller as well.
+        Z3AstHandle errorCode = this->createFreshConstant(*mErrorType);
+        failArgs.push_back(errorCode);
+        body.push_back(this->apply(mFailurePredicates[callee], failArgs));
+
+        std::vector<Z3AstHandle> headArgs = inputs;
+        headArgs.push_back(errorCode);
+        this->addRule(body, this->apply(mFailurePredicates[&cfa], headArgs));
+    }
+
+    std::vector<Z3AstHandle> summaryArgs = inputs;
+    for (Variable& output : cfa.outputs()) {
+        summaryArgs.push_back(this->translate(output.getRefExpr()));
+    }
+    this->addRule(
+        { this->apply(mLocationPredicates[cfa.getExit()], state) },
+        this->apply(mSummaryPredicates[&cfa], summaryArgs)
+    );
+
+    for (auto& [location, errorExpr] : cfa.errors()) {
+        std::vector<Z3AstHandle> failArgs = inputs;
+        failArgs.push_back(this->translate(errorExpr));
+        this->addRule(
+            { this->apply(mLocationPredicates[location], state) },
+            this->apply(mFailurePredicates[&cfa], failArgs)
+        );
+    }
+}
+
+auto Z3ChcVerifierImpl::createPredicate(
+    const std::string& name, llvm::ArrayRef<Z3_sort> domain, PredicateInfo info) -> PredicateHandle
+{
+    Z3_func_decl decl = Z3_mk_func_decl(
+        mZ3Context, Z3_mk_string_symbol(mZ3Context, name.c_str()),
+        domain.size(), domain.data(), Z3_mk_bool_sort(mZ3Context)
+    );
+    PredicateHandle handle(mZ3Context, decl);
+
+    Z3_fixedpoint_register_relation(mZ3Context, mFixedpoint, decl);
+    mPredicateInfo[decl] = info;
+
+    return handle;
+}
+
+auto Z3ChcVerifierImpl::apply(const PredicateHandle& predicate, llvm::ArrayRef<Z3AstHandle> args)
+    -> Z3AstHandle
+{
+    std::vector<Z3_ast> rawArgs;
+    for (const Z3AstHandle& arg : args) {
+        rawArgs.push_back(arg.getNode());
+    }
+
+    return Z3AstHandle(mZ3Context, Z3_mk_app(
+        mZ3Context, predicate.getNode(), rawArgs.size(), rawArgs.data()
+    ));
+}
+
+auto Z3ChcVerifierImpl::createFreshConstant(Type& type) -> Z3AstHandle
+{
+    return Z3AstHandle(mZ3Context, Z3_mk_fresh_const(
+        mZ3Context, "", mTransformer.typeToSort(type)
+    ));
+}
+
+void Z3ChcVerifierImpl::addRule(llvm::ArrayRef<Z3AstHandle> body, Z3AstHandle head)
+{
+    std::vector<Z3_ast> conjuncts;
+    for (const Z3AstHandle& formula : body) {
+        conjuncts.push_back(formula.getNode());
+    }
+
+    Z3AstHandle rule(mZ3Context, conjuncts.empty()
+        ? head.getNode()
+        : Z3_mk_implies(
+            mZ3Context, Z3_mk_and(mZ3Context, conjuncts.size(), conjuncts.data()), head
+        ));
+
+    // Every constant occurring in a rule is universally quantified, including
+    // the ones introduced for undefined values.
+    llvm::DenseSet<Z3_ast> visited;
+    std::vector<Z3_app> constants;
+    this->collectConstants(rule, visited, constants);
+
+    if (!constants.empty()) {
+        rule = Z3AstHandle(mZ3Context, Z3_mk_forall_const(
+            mZ3Context, 0, constants.size(), constants.data(), 0, nullptr, rule
+        ));
+    }
+
+    Z3_fixedpoint_add_rule(mZ3Context, mFixedpoint, rule, Z3_mk_int_symbol(mZ3Context, mNumRules++));
+}
+
+void Z3ChcVerifierImpl::collectConstants(
+    Z3_ast ast, llvm::DenseSet<Z3_ast>& visited, std::vector<Z3_app>& constants)
+{
+    if (Z3_get_ast_kind(mZ3Context, ast) != Z3_APP_AST || !visited.insert(ast).second) {
+        return;
+    }
+
+    Z3_app app = Z3_to_app(mZ3Context, ast);
+    Z3_func_decl decl = Z3_get_app_decl(mZ3Context, app);
+    unsigned numArgs = Z3_get_app_num_args(mZ3Context, app);
+
+    if (numArgs == 0) {
+        if (Z3_get_decl_kind(mZ3Context, decl) == Z3_OP_UNINTERPRETED && mPredicateInfo.count(decl) == 0) {
+            constants.push_back(app);
+        }
+        return;
+    }
+
+    for (unsigned i = 0; i < numArgs; ++i) {
+        this->collectConstants(Z3_get_app_arg(mZ3Context, app, i), visited, constants);
+    }
+}
+
+// Counterexample reconstruction
+//===----------------------------------------------------------------------===//
+
+const PredicateInfo* Z3ChcVerifierImpl::lookupAtom(Z3_ast ast)
+{
+    if (ast == nullptr || Z3_get_ast_kind(mZ3Context, ast) != Z3_APP_AST) {
+        return nullptr;
+    }
+
+    auto result = mPredicateInfo.find(Z3_get_app_decl(mZ3Context, Z3_to_app(mZ3Context, ast)));
+    if (result == mPredicateInfo.end()) {
+        return nullptr;
+    }
+
+    return &result->second;
+}
+
+Z3_ast Z3ChcVerifierImpl::getConclusion(Z3_ast proof)
+{
+    if (Z3_get_ast_kind(mZ3Context, proof) != Z3_APP_AST) {
+        return nullptr;
+    }
+
+    Z3_app app = Z3_to_app(mZ3Context, proof);
+    unsigned numArgs = Z3_get_app_num_args(mZ3Context, app);
+    if (numArgs == 0) {
+        return nullptr;
+    }
+
+    // The last argument of a proof step is the fact it proves.
+    return Z3_get_app_arg(mZ3Context, app, numArgs - 1);
+}
+
+void Z3ChcVerifierImpl::walkProof(
+    Z3_ast proof, std::vector<ChcTraceState>& states, ExprRef<AtomicExpr>& errorCode)
+{
+    if (Z3_get_ast_kind(mZ3Context, proof) != Z3_APP_AST) {
+        return;
+    }
+
+    Z3_app app = Z3_to_app(mZ3Context, proof);
+    Z3_decl_kind kind = Z3_get_decl_kind(mZ3Context, Z3_get_app_decl(mZ3Context, app));
+    unsigned numArgs = Z3_get_app_num_args(mZ3Context, app);
+
+    switch (kind) {
+        case Z3_OP_PR_HYPER_RESOLVE:
+        case Z3_OP_PR_ASSERTED:
+        case Z3_OP_PR_MODUS_PONENS:
+            break;
+        default:
+            // Not a proof step, or one which cannot contribute to the trace.
+            return;
+    }
+
+    if (numArgs == 0) {
+        return;
+    }
+
+    Z3_ast fact = Z3_get_app_arg(mZ3Context, app, numArgs - 1);
+    const PredicateInfo* info = lookupAtom(fact);
+
+    // The first argument of a hyper-resolution step is the rule itself,
+    // followed by the derivations of the atoms in its body.
+    std::vector<Z3_ast> premises;
+    for (unsigned i = (kind == Z3_OP_PR_HYPER_RESOLVE ? 1 : 0); i < numArgs - 1; ++i) {
+        premises.push_back(Z3_get_app_arg(mZ3Context, app, i));
+    }
+
+    bool isDerived = kind == Z3_OP_PR_HYPER_RESOLVE || kind == Z3_OP_PR_ASSERTED;
+
+    auto isSameAutomaton = [this, info](Z3_ast premise) {
+        const PredicateInfo* premiseInfo = lookupAtom(getConclusion(premise));
+        return premiseInfo != nullptr
+            && premiseInfo->kind == PredicateInfo::Pred_Location
+            && premiseInfo->cfa == info->cfa;
+    };
+
+    if (info != nullptr && isDerived) {
+        // The locations of the same automaton precede the derivations of
+        // procedure summaries in the execution.
+        std::stable_partition(premises.begin(), premises.end(), isSameAutomaton);
+
+        if (info->kind == PredicateInfo::Pred_Location
+            && info->location != info->cfa->getEntry()
+            && (premises.empty() || !isSameAutomaton(premises.front()))
+        ) {
+            // Facts may be eliminated from the derivation by the solver, in
+            // which case the entry location must be added explicitly.
+            states.push_back({ info->cfa->getEntry(), {} });
+        }
+    }
+
+    for (Z3_ast premise : premises) {
+        this->walkProof(premise, states, errorCode);
+    }
+
+    if (info == nullptr || !isDerived) {
+        return;
+    }
+
+    Z3_app atom = Z3_to_app(mZ3Context, fact);
+    unsigned numAtomArgs = Z3_get_app_num_args(mZ3Context, atom);
+
+    auto valueOf = [&](unsigned i) {
+        return z3_ground_term_to_literal(
+            mSystem.getContext(), mZ3Context, mDecls, mTransformer,
+            Z3AstHandle(mZ3Context, Z3_get_app_arg(mZ3Context, atom, i))
+        );
+    };
+
+    if (info->kind == PredicateInfo::Pred_Location) {
+        ChcTraceState state{ info->location, {} };
+        for (unsigned i = 0; i < numAtomArgs; ++i) {
+            state.values.push_back(valueOf(i));
+        }
+        states.push_back(std::move(state));
+    } else if (info->kind == PredicateInfo::Pred_Failure
+        && info->cfa == mSystem.getMainAutomaton()
+    ) {
+        errorCode = valueOf(numAtomArgs - 1);
+    }
+}
+
+auto Z3ChcVerifierImpl::getValue(const ChcTraceState& state, Variable* variable)
+    -> ExprRef<AtomicExpr>
+{
+    auto idx = mStateIndices.find(variable);
+    if (state.values.empty() || idx == mStateIndices.end()) {
+        return UndefExpr::Get(variable->getType());
+    }
+
+    return state.values[idx->second];
+}
+
+auto Z3ChcVerifierImpl::getAction(
+    const ChcTraceState& prev, const ChcTraceState& curr, const ChcTraceState* next
+) -> std::vector<VariableAssignment>
+{
+    std::vector<VariableAssignment> action;
+    Cfa* cfa = curr.location->getAutomaton();
+
+    if (prev.location->getAutomaton() == cfa) {
+        auto edge = std::find_if(
+            prev.location->outgoing_begin(), prev.location->outgoing_end(),
+            [&curr](Transition* e) { return e->getTarget() == curr.location; }
+        );
+
+        if (edge == prev.location->outgoing_end()) {
+            return action;
+        }
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(*edge)) {
+            for (const VariableAssignment& assignment : *assign) {
+                Variable* variable = assignment.getVariable();
+                action.emplace_back(variable, this->getValue(curr, variable));
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(*edge)) {
+            for (const VariableAssignment& assignment : call->outputs()) {
+                Variable* variable = assignment.getVariable();
+                action.emplace_back(variable, this->getValue(curr, variable));
+            }
+        }
+
+        return action;
+    }
+
+    if (curr.location == cfa->getEntry()) {
+        // Entering a procedure: the inputs are never modified, thus their
+        // values may be taken from the next state if the entry has no valuation.
+        const ChcTraceState& valued = curr.values.empty()
+            && next != nullptr && next->location->getAutomaton() == cfa ? *next : curr;
+
+        for (Variable& input : cfa->inputs()) {
+            action.emplace_back(&input, this->getValue(valued, &input));
+        }
+
+        return action;
+    }
+
+    // Returning from a procedure.
+    Cfa* callee = prev.location->getAutomaton();
+    for (Transition* edge : curr.location->incoming()) {
+        auto call = llvm::dyn_cast<CallTransition>(edge);
+        if (call == nullptr || call->getCalledAutomaton() != callee) {
+            continue;
+        }
+
+        for (const VariableAssignment& assignment : call->outputs()) {
+            Variable* variable = assignment.getVariable();
+            action.emplace_back(variable, this->getValue(curr, variable));
+        }
+        break;
+    }
+
+    return action;
+}
+
+auto Z3ChcVerifierImpl::createFailResult() -> std::unique_ptr<VerificationResult>
+{
+    Z3AstHandle answer(mZ3Context, Z3_fixedpoint_get_answer(mZ3Context, mFixedpoint));
+
+    std::vector<ChcTraceState> traceStates;
+    ExprRef<AtomicExpr> errorExpr;
+    this->walkProof(answer, traceStates, errorExpr);
+
+    if (errorExpr == nullptr) {
+        // The query is reachable, but the failure of the main automaton could
+        // not be found in the derivation. Report it without a trace.
+        return VerificationResult::CreateFail(VerificationResult::GeneralFailureCode);
+    }
+
+    std::unique_ptr<Trace> trace;
+    Cfa* main = mSystem.getMainAutomaton();
+    if (mSettings.trace && !traceStates.empty() && traceStates.front().location == main->getEntry()) {
+        std::vector<Location*> states;
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        states.push_back(traceStates.front().location);
+        for (size_t i = 1; i < traceStates.size(); ++i) {
+            const ChcTraceState* next = i + 1 < traceStates.size() ? &traceStates[i + 1] : nullptr;
+            states.push_back(traceStates[i].location);
+            actions.push_back(this->getAction(traceStates[i - 1], traceStates[i], next));
+        }
+
+        trace = mTraceBuilder.build(states, actions);
+    } else {
+        trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    switch (errorExpr->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return VerificationResult::CreateFail(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue(), std::move(trace));
+        case Type::IntTypeID:
+            return VerificationResult::CreateFail(llvm::cast<IntLiteralExpr>(errorExpr)->getValue(), std::move(trace));
+        default:
+            break;
+    }
+
+    llvm_unreachable("Invalid error field type!");
+}
@@ -48,8 +48,8 @@ public:
         Z3_model_dec_ref(mZ3Context, mModel);
     }
 
-private:
     ExprRef<AtomicExpr> evalAst(Z3AstHandle ast);
+
 private:
     ExprRef<BoolLiteralExpr> evalBoolean(Z3AstHandle ast);
     ExprRef<BvLiteralExpr> evalBv(Z3AstHandle ast, unsigned width);
@@ -77,6 +77,16 @@ auto Z3Solver::getModel() -> std::unique_ptr<Model>
         mContext, mZ3Context, Z3_solver_get_model(mZ3Context, mSolver), mDecls, mTransformer);
 }
 
+auto gazer::z3_ground_term_to_literal(
+    GazerContext& context, Z3_context& z3Context,
+    Z3DeclMapTy& decls, Z3ExprTransformer& transformer, Z3AstHandle ast) -> ExprRef<AtomicExpr>
+{
+    // Ground terms do not refer to any constants, thus they can be evaluated
+    // in an empty model.
+    Z3Model model(context, z3Context, Z3_mk_model(z3Context), decls, transformer);
+    return model.evalAst(ast);
+}
+
 auto Z3Model::evaluate(const ExprPtr& expr) -> ExprRef<AtomicExpr>
 {
     auto ast = mExprTransformer.walk(expr);
@@ -110,6 +110,11 @@ void Z3Solver::pop()
     Z3_solver_pop(mZ3Context, mSolver, 1);
 }
 
+void Z3Solver::interrupt()
+{
+    Z3_interrupt(mZ3Context);
+}
+
 void Z3Solver::printStats(llvm::raw_ostream& os)
 {
     auto stats = Z3_solver_get_statistics(mZ3Context, mSolver);
@@ -426,6 +426,8 @@ public:
     void push() override;
     void pop() override;
 
+    void interrupt() override;
+
     ~Z3Solver();
 
 protected:
@@ -441,6 +443,11 @@ protected:
     Z3ExprTransformer mTransformer;
 };
 
+/// Converts the ground Z3 term \p ast (e.g. a numeral) into a literal expression.
+ExprRef<AtomicExpr> z3_ground_term_to_literal(
+    GazerContext& context, Z3_context& z3Context,
+    Z3DeclMapTy& decls, Z3ExprTransformer& transformer, Z3AstHandle ast);
+
 } // end namespace gazer
 
 #endif
\ No newline at end of file
@@ -0,0 +1,123 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "BmcInlineScheduler.h"
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Debug.h>
+
+#include <cmath>
+
+#define DEBUG_TYPE "BmcInlineScheduler"
+
+using namespace gazer;
+
+void InlineScheduler::schedule(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth)
+{
+    this->rank(calls, depth);
+
+    if (mBudget != 0 && calls.size() > mBudget) {
+        // Keep the calls at the back, these would be inlined first.
+        calls.erase(calls.begin(), calls.end() - mBudget);
+    }
+}
+
+static void countExprNodes(const ExprPtr& expr, llvm::DenseSet<Expr*>& visited)
+{
+    if (!visited.insert(expr.get()).second) {
+        return;
+    }
+
+    if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr.get())) {
+        for (auto& op : nn->operands()) {
+            countExprNodes(op, visited);
+        }
+    }
+}
+
+unsigned CostModelInlineScheduler::getCalleeSize(Cfa* cfa)
+{
+    auto result = mCalleeSizes.find(cfa);
+    if (result != mCalleeSizes.end()) {
+        return result->second;
+    }
+
+    llvm::DenseSet<Expr*> visited;
+    for (Transition* edge : cfa->edges()) {
+        countExprNodes(edge->getGuard(), visited);
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            for (auto& assignment : *assign) {
+                countExprNodes(assignment.getValue(), visited);
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            for (auto& input : call->inputs()) {
+                countExprNodes(input.getValue(), visited);
+            }
+        }
+    }
+
+    unsigned size = cfa->getNumLocations() + cfa->getNumTransitions() + visited.size();
+    mCalleeSizes[cfa] = size;
+
+    return size;
+}
+
+void CostModelInlineScheduler::rank(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth)
+{
+    // Older observations lose half of their weight with each new counterexample.
+    for (auto& entry : mFrequency) {
+        entry.second /= 2;
+    }
+
+    for (CallTransition* call : calls) {
+        mFrequency[call] += 1;
+    }
+
+    llvm::DenseMap<CallTransition*, double> costs;
+    for (CallTransition* call : calls) {
+        double size = std::log2(1 + this->getCalleeSize(call->getCalledAutomaton()));
+        double cost = mSizeWeight * size
+            + mDepthWeight * depth(call)
+            - mFrequencyWeight * mFrequency[call];
+
+        LLVM_DEBUG(llvm::dbgs() << "Inline cost of " << *call << " is " << cost << "\n");
+        costs[call] = cost;
+    }
+
+    std::stable_sort(calls.begin(), calls.end(), [&costs](CallTransition* a, CallTransition* b) {
+        return costs[a] > costs[b];
+    });
+}
+
+std::unique_ptr<InlineScheduler> gazer::CreateInlineScheduler(const BmcSettings& settings)
+{
+    switch (settings.inlineStrategy) {
+        case BmcInlineStrategy::CexOrder:
+            return std::make_unique<CexOrderInlineScheduler>(settings.inlineBudget);
+        case BmcInlineStrategy::CostModel:
+            return std::make_unique<CostModelInlineScheduler>(
+                settings.inlineBudget,
+                settings.inlineSizeWeight,
+                settings.inlineDepthWeight,
+                settings.inlineFrequencyWeight
+            );
+    }
+
+    llvm_unreachable("Unknown inline strategy!");
+}
@@ -0,0 +1,116 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares the schedulers which decide which open calls
+/// of a BMC counterexample should be inlined.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_SRC_VERIFIER_BMCINLINESCHEDULER_H
+#define GAZER_SRC_VERIFIER_BMCINLINESCHEDULER_H
+
+#include "gazer/Verifier/BoundedModelChecker.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+
+namespace gazer
+{
+
+class Cfa;
+class CallTransition;
+
+class InlineScheduler
+{
+public:
+    using DepthFn = llvm::function_ref<unsigned(CallTransition*)>;
+
+    explicit InlineScheduler(unsigned budget)
+        : mBudget(budget)
+    {}
+
+    /// Selects the calls to inline from the open calls of a counterexample.
+    /// The worklist is processed from the back, so on return the call to be
+    /// inlined first is the last element of \p calls. Calls removed from
+    /// \p calls remain open, and may be selected again if they appear in a
+    /// later counterexample.
+    void schedule(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth);
+
+    /// Notifies the scheduler that \p call was inlined and no longer exists.
+    virtual void callInlined(CallTransition* call) {}
+
+    /// Returns the maximum number of calls to be inlined in one step.
+    /// Zero means that there is no limit.
+    unsigned getBudget() const { return mBudget; }
+
+    virtual ~InlineScheduler() = default;
+
+protected:
+    /// Orders \p calls so that the most preferable ones come last.
+    virtual void rank(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth) = 0;
+
+private:
+    unsigned mBudget;
+};
+
+/// Keeps the counterexample order of calls, the last call found in the
+/// counterexample is inlined first.
+class CexOrderInlineScheduler : public InlineScheduler
+{
+public:
+    using InlineScheduler::InlineScheduler;
+
+protected:
+    void rank(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth) override {}
+};
+
+/// Ranks calls using a weighted cost model of the callee size, the depth
+/// of the call in the inlining tree and how often the call appeared
+/// in recent counterexamples.
+class CostModelInlineScheduler : public InlineScheduler
+{
+public:
+    CostModelInlineScheduler(
+        unsigned budget, double sizeWeight, double depthWeight, double frequencyWeight
+    ) : InlineScheduler(budget), mSizeWeight(sizeWeight),
+        mDepthWeight(depthWeight), mFrequencyWeight(frequencyWeight)
+    {}
+
+    /// Returns the estimated size of a procedure: the number of its locations,
+    /// transitions and the size of the expression DAG on its transitions.
+    unsigned getCalleeSize(Cfa* cfa);
+
+    void callInlined(CallTransition* call) override { mFrequency.erase(call); }
+
+protected:
+    void rank(llvm::SmallVectorImpl<CallTransition*>& calls, DepthFn depth) override;
+
+private:
+    double mSizeWeight;
+    double mDepthWeight;
+    double mFrequencyWeight;
+
+    llvm::DenseMap<Cfa*, unsigned> mCalleeSizes;
+    llvm::DenseMap<CallTransition*, double> mFrequency;
+};
+
+std::unique_ptr<InlineScheduler> CreateInlineScheduler(const BmcSettings& settings);
+
+} // end namespace gazer
+
+#endif
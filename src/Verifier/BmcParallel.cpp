@@ -0,0 +1,311 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the parallel mode of the bounded model checker.
+///
+/// Each round checks an under-approximation and several over-approximations
+/// of the main automaton, with increasing bounds, on separate solver instances.
+/// Formula construction and translation happens on the calling thread, as the
+/// expression infrastructure is not thread-safe; only the solver queries run
+/// concurrently. If a query turns out to be decisive (a real counterexample
+/// or a safety proof), the remaining queries are interrupted.
+///
+/// As an over-approximation with bound B is weaker than the one with bound
+/// B' < B, an UNSAT result for B proves every lower bound UNSAT as well,
+/// allowing the algorithm to skip them. The open calls of the counterexamples
+/// returned by the satisfiable over-approximations are inlined together.
+//
+//===----------------------------------------------------------------------===//
+#include "BoundedModelCheckerImpl.h"
+
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/SetVector.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using namespace gazer;
+using namespace gazer::bmc;
+
+static llvm::StringRef statusToString(Solver::SolverStatus status)
+{
+    switch (status) {
+        case Solver::SAT: return "SAT";
+        case Solver::UNSAT: return "UNSAT";
+        case Solver::UNKNOWN: return "UNKNOWN";
+    }
+
+    llvm_unreachable("Unknown solver status.");
+}
+
+auto BoundedModelCheckerImpl::checkParallel(unsigned startBound)
+    -> std::unique_ptr<VerificationResult>
+{
+    // The first worker is always the under-approximation, the others
+    // over-approximate with bounds starting from the current one.
+    for (unsigned i = 0; i < mSettings.numWorkers; ++i) {
+        mWorkers.emplace_back(std::make_unique<BmcWorker>(
+            mSolverFactory.createSolver(mSystem.getContext())
+        ));
+    }
+    mWorkers[0]->underApprox = true;
+
+    // A single calculator is used for all queries, so predecessor
+    // discriminator variables stay unique between workers.
+    BmcWorker* current = nullptr;
+    PathConditionCalculator pathConditions(
+        mTopo, mExprBuilder,
+        this->createLocNumberFunc(),
+        [this, &current](CallTransition* call) -> ExprPtr {
+            if (current->openCalls.count(call) != 0) {
+                return this->getCallSummary(call);
+            }
+            return mExprBuilder.False();
+        },
+        [&current](Location* l, ExprPtr e) {
+            current->preds.insert(l, e);
+        }
+    );
+    pathConditions.setEncoding(mSettings.encoding);
+
+    llvm::ThreadPool pool(mSettings.numWorkers);
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done = false;
+    unsigned numPending = 0;
+
+    auto runWorker = [&mutex, &changed, &done, &numPending](BmcWorker* worker) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done) {
+                worker->status = Solver::UNKNOWN;
+                --numPending;
+                changed.notify_all();
+                return;
+            }
+            worker->running = true;
+        }
+
+        auto status = worker->solver->run();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        worker->running = false;
+        worker->status = status;
+        --numPending;
+
+        bool decisive = (worker->underApprox && status == Solver::SAT)
+            || (!worker->underApprox && status == Solver::UNSAT && worker->numUnhandledCallSites == 0);
+
+        if (decisive) {
+            done = true;
+        }
+        changed.notify_all();
+    };
+
+    unsigned bound = startBound;
+    while (bound <= mSettings.maxBound) {
+        llvm::outs() << "Iteration " << bound << "\n";
+
+        // Set up the queries of this round.
+        unsigned numActive = 0;
+        for (auto& worker : mWorkers) {
+            worker->openCalls.clear();
+            worker->numUnhandledCallSites = 0;
+            worker->status = Solver::UNKNOWN;
+            worker->active = false;
+
+            if (!worker->underApprox) {
+                worker->bound = bound + numActive - 1;
+                if (worker->bound > mSettings.maxBound) {
+                    // There is no point in going over the maximum bound.
+                    continue;
+                }
+
+                for (auto& [call, info] : mCalls) {
+                    if (info.getCost() > worker->bound) {
+                        ++worker->numUnhandledCallSites;
+                        continue;
+                    }
+
+                    // Calls which never return need not be inlined.
+                    auto lit = llvm::dyn_cast<BoolLiteralExpr>(this->getCallSummary(call).get());
+                    if (lit == nullptr || !lit->isFalse()) {
+                        worker->openCalls.insert(call);
+                    }
+                }
+            }
+
+            current = worker.get();
+            worker->solver->push();
+            worker->preds.push();
+            ExprPtr formula = pathConditions.encode(mRoot->getEntry(), mError);
+            if (mSettings.dumpFormula) {
+                formula->print(llvm::errs());
+            }
+            worker->solver->add(formula);
+            worker->active = true;
+            ++numActive;
+        }
+
+        llvm::outs() << "  Running " << numActive << " queries in parallel...\n";
+        done = false;
+        numPending = numActive;
+        mTimer.start();
+        for (auto& worker : mWorkers) {
+            if (worker->active) {
+                pool.async(runWorker, worker.get());
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&done, &numPending] { return done || numPending == 0; });
+
+            // An interrupt issued before a solver enters its search is lost,
+            // thus the remaining queries are interrupted until they all return.
+            while (numPending != 0) {
+                for (auto& worker : mWorkers) {
+                    if (worker->running) {
+                        worker->solver->interrupt();
+                    }
+                }
+                changed.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+        pool.wait();
+        mTimer.stop();
+        mStats.SolverTime += mTimer.elapsed();
+
+        BmcWorker* lastUnsat = nullptr;
+        llvm::SmallVector<BmcWorker*, 8> satWorkers;
+        for (auto& worker : mWorkers) {
+            if (!worker->active) {
+                continue;
+            }
+
+            if (worker->underApprox) {
+                llvm::outs() << "    Under-approximation: ";
+            } else {
+                llvm::outs() << "    Over-approximation (bound " << worker->bound << "): ";
+            }
+            llvm::outs() << statusToString(worker->status) << "\n";
+
+            if (worker->underApprox) {
+                continue;
+            }
+
+            if (worker->status == Solver::UNSAT) {
+                lastUnsat = worker.get();
+            } else if (worker->status == Solver::SAT) {
+                satWorkers.push_back(worker.get());
+            }
+        }
+
+        std::unique_ptr<VerificationResult> result;
+        llvm::SetVector<CallTransition*> callsToInline;
+        BmcWorker* underApprox = mWorkers[0].get();
+
+        if (underApprox->status == Solver::SAT) {
+            result = this->createFailResult(*underApprox->solver->getModel(), underApprox->preds);
+        } else if (lastUnsat == nullptr || lastUnsat->numUnhandledCallSites != 0) {
+            // Each satisfiable over-approximation may give a different counterexample,
+            // inline the open calls of all of them.
+            for (BmcWorker* worker : satWorkers) {
+                llvm::SmallVector<CallTransition*, 16> callsInCex;
+                auto model = worker->solver->getModel();
+                this->findOpenCallsInCex(*model, worker->preds, worker->openCalls, callsInCex);
+                callsToInline.insert(callsInCex.begin(), callsInCex.end());
+            }
+        }
+
+        for (auto& worker : mWorkers) {
+            if (worker->active) {
+                worker->preds.pop();
+                worker->solver->pop();
+            }
+        }
+
+        if (result != nullptr) {
+            llvm::outs() << "  Under-approximated formula is SAT.\n";
+            if (!mSettings.findAllErrors) {
+                return result;
+            }
+
+            unsigned ec = llvm::cast<FailResult>(*result).getErrorID();
+            llvm::outs() << "    Found error code " << ec << ", continuing search.\n";
+            mFoundErrors.emplace_back(llvm::cast<FailResult>(result.release()));
+            mStats.NumErrorsFound++;
+
+            this->blockErrorCode(ec);
+            continue;
+        }
+
+        if (lastUnsat != nullptr) {
+            if (lastUnsat->numUnhandledCallSites == 0) {
+                llvm::outs() << "  Over-approximated formula is UNSAT.\n";
+                mStats.NumEndLocs = mRoot->getNumLocations();
+                mStats.NumEndLocals = mRoot->getNumLocals();
+
+                return this->finalizeResult(VerificationResult::CreateSuccess());
+            }
+
+            if (lastUnsat->bound == mSettings.maxBound) {
+                llvm::outs() << "Maximum bound is reached.\n";
+                mStats.NumEndLocs = mRoot->getNumLocations();
+                mStats.NumEndLocals = mRoot->getNumLocals();
+
+                return this->finalizeResult(VerificationResult::CreateBoundReached());
+            }
+        }
+
+        if (satWorkers.empty() && lastUnsat == nullptr) {
+            // None of the queries were conclusive.
+            llvm::outs() << "  Could not decide any of the queries.\n";
+            return this->finalizeResult(VerificationResult::CreateUnknown());
+        }
+
+        if (!callsToInline.empty()) {
+            llvm::outs() << "    Inlining calls...\n";
+            llvm::SmallVector<CallTransition*, 16> calls(callsToInline.begin(), callsToInline.end());
+            mInlineScheduler->schedule(calls, [this](CallTransition* call) {
+                return mCalls[call].callChain.size();
+            });
+            this->inlineCalls(calls, bound);
+
+            mStats.NumEndLocs = mRoot->getNumLocations();
+            mStats.NumEndLocals = mRoot->getNumLocals();
+            if (mSettings.debugDumpCfa) {
+                mRoot->view();
+            }
+        }
+
+        if (lastUnsat != nullptr) {
+            // Inlining only strengthens the over-approximation, thus every bound
+            // up to the highest UNSAT one will remain UNSAT.
+            llvm::outs() << "    Open call sites still present. Increasing bound.\n";
+            bound = lastUnsat->bound + 1;
+        }
+    }
+
+    return this->finalizeResult(VerificationResult::CreateBoundReached());
+}
@@ -0,0 +1,200 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "BmcSummaries.h"
+
+#include "gazer/Automaton/CallGraph.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Solver/Model.h"
+
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "BmcSummaries"
+
+using namespace gazer;
+
+void SummaryStore::computeSummaries(Cfa* main)
+{
+    CallGraph cg(mSystem);
+    auto solver = mSolverFactory.createSolver(mSystem.getContext());
+
+    // SCCs are visited in a reverse topological order, that is, callees
+    // are always summarized before their callers.
+    CallGraph::Node* root = cg.lookupNode(main);
+    for (auto it = llvm::scc_begin(root), ie = llvm::scc_end(root); it != ie; ++it) {
+        const std::vector<CallGraph::Node*>& scc = *it;
+
+        bool isRecursive = scc.size() != 1;
+        bool mayFail = false;
+        for (CallGraph::Node* node : scc) {
+            mayFail |= node->getCfa()->getNumErrors() != 0;
+            for (auto& [call, callee] : *node) {
+                isRecursive |= callee == node;
+                mayFail |= mMayFail.count(callee->getCfa()) != 0;
+            }
+        }
+
+        if (isRecursive) {
+            // Recursive procedures are not summarized. As we do not know
+            // anything about them, assume that they may fail.
+            for (CallGraph::Node* node : scc) {
+                mMayFail.insert(node->getCfa());
+            }
+            continue;
+        }
+
+        Cfa* cfa = scc.front()->getCfa();
+        if (mayFail) {
+            mMayFail.insert(cfa);
+        }
+
+        if (cfa == main) {
+            continue;
+        }
+
+        solver->push();
+        ExprPtr summary = this->computeSummary(cfa, *solver);
+        solver->pop();
+
+        if (auto lit = llvm::dyn_cast<BoolLiteralExpr>(summary.get())) {
+            // A procedure which never returns may still reach an error location,
+            // which is only visible to the checker once the call is inlined.
+            if (lit->isTrue() || mayFail) {
+                continue;
+            }
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "Summary of " << cfa->getName() << ": " << *summary << "\n");
+        mSummaries[cfa] = summary;
+    }
+}
+
+ExprPtr SummaryStore::computeSummary(Cfa* cfa, Solver& solver)
+{
+    for (Variable& input : cfa->inputs()) {
+        if (cfa->isOutput(&input)) {
+            // Summaries cannot distinguish between the entry and exit value
+            // of such variables.
+            return mExprBuilder.True();
+        }
+    }
+
+    auto& topo = mTopoSorts[cfa];
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    for (size_t i = 0; i < topo.size(); ++i) {
+        locNumbers[topo[i]] = i;
+    }
+
+    PathConditionCalculator pathConditions(
+        topo, mExprBuilder,
+        [&locNumbers](Location* loc) { return locNumbers[loc]; },
+        [this](CallTransition* call) { return this->instantiate(call); }
+    );
+    pathConditions.setEncoding(mEncoding);
+
+    solver.add(pathConditions.encode(cfa->getEntry(), cfa->getExit()));
+
+    auto status = solver.run();
+    if (status == Solver::UNSAT) {
+        // The exit location is unreachable: the procedure never returns.
+        return mExprBuilder.False();
+    }
+
+    if (status != Solver::SAT) {
+        return mExprBuilder.True();
+    }
+
+    // Propose candidate facts for each output: equalities with inputs and
+    // with the value found in an arbitrary model. Keep the ones which hold
+    // for every execution.
+    auto model = solver.getModel();
+    ExprVector candidates;
+    for (Variable& output : cfa->outputs()) {
+        for (Variable& input : cfa->inputs()) {
+            if (input.getType() == output.getType()) {
+                candidates.push_back(mExprBuilder.Eq(output.getRefExpr(), input.getRefExpr()));
+            }
+        }
+
+        auto value = model->evaluate(output.getRefExpr());
+        if (value != nullptr && !value->isUndef()) {
+            candidates.push_back(mExprBuilder.Eq(output.getRefExpr(), value));
+        }
+    }
+
+    ExprVector facts;
+    for (ExprPtr& candidate : candidates) {
+        if (this->isImplied(solver, candidate)) {
+            facts.push_back(candidate);
+        }
+    }
+
+    if (facts.empty()) {
+        return mExprBuilder.True();
+    }
+
+    return mExprBuilder.And(facts);
+}
+
+bool SummaryStore::isImplied(Solver& solver, const ExprPtr& fact)
+{
+    solver.push();
+    solver.add(mExprBuilder.Not(fact));
+    auto status = solver.run();
+    solver.pop();
+
+    return status == Solver::UNSAT;
+}
+
+ExprPtr SummaryStore::getSummary(Cfa* cfa) const
+{
+    auto result = mSummaries.find(cfa);
+    if (result == mSummaries.end()) {
+        return mExprBuilder.True();
+    }
+
+    return result->second;
+}
+
+ExprPtr SummaryStore::instantiate(CallTransition* call)
+{
+    Cfa* callee = call->getCalledAutomaton();
+    ExprPtr summary = this->getSummary(callee);
+
+    if (llvm::isa<BoolLiteralExpr>(summary.get())) {
+        return summary;
+    }
+
+    VariableExprRewrite rewrite(mExprBuilder);
+    for (Variable& input : callee->inputs()) {
+        auto arg = call->getInputArgument(input);
+        assert(arg.has_value()
+            && "Each call input assignment must map to an input variable in callee!");
+        rewrite[&input] = arg->getValue();
+    }
+
+    for (Variable& output : callee->outputs()) {
+        auto arg = call->getOutputArgument(output);
+        assert(arg.has_value() && "Every callee output should be assigned in a call transition!");
+        rewrite[&output] = arg->getVariable()->getRefExpr();
+    }
+
+    return rewrite.walk(summary);
+}
@@ -0,0 +1,91 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares the procedure summary store of the bounded
+/// model checker.
+///
+/// A summary of a procedure is a formula over its input and output variables,
+/// which holds for every execution reaching the exit location of the
+/// procedure. Summaries are used as over-approximations of call sites,
+/// instead of the trivial 'True'.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_SRC_VERIFIER_BMCSUMMARIES_H
+#define GAZER_SRC_VERIFIER_BMCSUMMARIES_H
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Solver/Solver.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include <unordered_map>
+
+namespace gazer
+{
+
+class SummaryStore
+{
+public:
+    SummaryStore(
+        AutomataSystem& system,
+        ExprBuilder& builder,
+        SolverFactory& solverFactory,
+        std::unordered_map<Cfa*, std::vector<Location*>>& topoSorts,
+        PathConditionEncoding encoding = PathConditionEncoding::Nested
+    ) : mSystem(system), mExprBuilder(builder),
+        mSolverFactory(solverFactory), mTopoSorts(topoSorts), mEncoding(encoding)
+    {}
+
+    /// Computes the summary of each procedure called from \p main, in a
+    /// bottom-up order of the call graph. Recursive procedures are not
+    /// summarized, and procedures which may reach an error location are
+    /// never summarized as 'False'.
+    void computeSummaries(Cfa* main);
+
+    /// Returns the summary of \p cfa, or 'True' if no summary is known.
+    ExprPtr getSummary(Cfa* cfa) const;
+
+    /// Returns the summary of the callee of \p call, with the inputs and
+    /// outputs of the callee substituted with the actual arguments of the call.
+    ExprPtr instantiate(CallTransition* call);
+
+    unsigned getNumSummaries() const { return mSummaries.size(); }
+
+private:
+    ExprPtr computeSummary(Cfa* cfa, Solver& solver);
+
+    /// Returns true if the formulas asserted in \p solver imply \p fact.
+    bool isImplied(Solver& solver, const ExprPtr& fact);
+
+private:
+    AutomataSystem& mSystem;
+    ExprBuilder& mExprBuilder;
+    SolverFactory& mSolverFactory;
+    std::unordered_map<Cfa*, std::vector<Location*>>& mTopoSorts;
+    PathConditionEncoding mEncoding;
+
+    llvm::DenseMap<Cfa*, ExprPtr> mSummaries;
+    llvm::DenseSet<Cfa*> mMayFail;
+};
+
+} // end namespace gazer
+
+#endif
@@ -57,11 +57,16 @@ void bmc::cex_iterator::advance()
 
 // FIXME: Move this to BoundedModelChecker.cpp?
 std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
-{               
+{
     auto model = mSolver->getModel();
+    return this->createFailResult(*model, mPredecessors);
+}
 
+std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult(
+    Model& model, bmc::PredecessorMapT& preds)
+{
     if (mSettings.dumpSolverModel) {
-        model->dump(llvm::errs());
+        model.dump(llvm::errs());
     }
 
     std::unique_ptr<Trace> trace;
@@ -69,7 +74,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
         std::vector<Location*> states;
         std::vector<std::vector<VariableAssignment>> actions;
 
-        bmc::BmcCex cex{mError, *mRoot, *model, mPredecessors};
+        bmc::BmcCex cex{mError, *mRoot, model, preds};
         for (auto state : cex) {
             Location* loc = state.getLocation();
             Transition* edge = state.getOutgoingTransition();
@@ -95,7 +100,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
                 }
 
                 ExprRef<AtomicExpr> value;
-                if (auto lit = model->evaluate(assignment.getVariable()->getRefExpr())) {
+                if (auto lit = model.evaluate(assignment.getVariable()->getRefExpr())) {
                     value = lit;
                 } else {
                     value = UndefExpr::Get(variable->getType());
@@ -115,7 +120,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
         trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
     }
 
-    ExprRef<AtomicExpr> errorExpr = model->evaluate(mErrorFieldVariable->getRefExpr());
+    ExprRef<AtomicExpr> errorExpr = model.evaluate(mErrorFieldVariable->getRefExpr());
     assert(!errorExpr->isUndef() && "The error field must be present in the model as a literal expression!");
 
     switch (errorExpr->getType().getTypeID()) {
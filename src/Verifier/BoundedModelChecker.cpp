@@ -20,6 +20,8 @@
 #include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Expr/ExprUtils.h"
 #include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Verifier/KInduction.h"
 
 #include "gazer/Support/Stopwatch.h"
 
@@ -47,6 +49,21 @@ namespace
 auto BoundedModelChecker::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
     -> std::unique_ptr<VerificationResult>
 {
+    if (mSettings.cyclicUnroll) {
+        // The time frame expansion of k-induction is a bounded model checker
+        // for cyclic automata if its inductive step is left out.
+        KInductionSettings kindSettings;
+        kindSettings.trace = mSettings.trace;
+        kindSettings.dumpFormula = mSettings.dumpFormula;
+        kindSettings.printSolverStats = mSettings.printSolverStats;
+        kindSettings.maxBound = mSettings.maxBound;
+        kindSettings.simplifyExpr = mSettings.simplifyExpr;
+        kindSettings.encoding = mSettings.encoding;
+        kindSettings.inductiveStep = false;
+
+        return KInduction(mSolverFactory, kindSettings).check(system, traceBuilder);
+    }
+
     std::unique_ptr<ExprBuilder> builder;
 
     if (mSettings.simplifyExpr) {
@@ -71,9 +88,11 @@ BoundedModelCheckerImpl::BoundedModelCheckerImpl(
     BmcSettings settings
 ) : mSystem(system),
     mExprBuilder(builder),
+    mSolverFactory(solverFactory),
     mSolver(solverFactory.createSolver(system.getContext())),
     mTraceBuilder(traceBuilder),
-    mSettings(settings)
+    mSettings(settings),
+    mInlineScheduler(CreateInlineScheduler(settings))
 {
     // TODO: Clone the main automaton instead of modifying the original.
     mRoot = mSystem.getMainAutomaton();
@@ -187,6 +206,15 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
     // Create the topological sorts
     this->createTopologicalSorts();
 
+    if (mSettings.useSummaries) {
+        llvm::outs() << "Computing procedure summaries...\n";
+        mSummaries = std::make_unique<SummaryStore>(
+            mSystem, mExprBuilder, mSolverFactory, mTopoSortMap, mSettings.encoding
+        );
+        mSummaries->computeSummaries(mRoot);
+        mStats.NumSummaries = mSummaries->getNumSummaries();
+    }
+
     // Insert initial call approximations.
     for (Transition* edge : mRoot->edges()) {
         if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
@@ -210,6 +238,7 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
             mPredecessors.insert(l, e);
         }
     );
+    pathConditions.setEncoding(mSettings.encoding);
 
     // Do eager unrolling, if requested
     if (mSettings.eagerUnroll > mSettings.maxBound) {
@@ -217,7 +246,6 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
         return VerificationResult::CreateUnknown();
     }
 
-    unsigned tmp = 0;
     for (size_t bound = 1; bound <= mSettings.eagerUnroll; ++bound) {
         llvm::outs() << "Eager iteration " << bound << "\n";
         mOpenCalls.clear();
@@ -229,7 +257,7 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
 
         llvm::SmallVector<CallTransition*, 16> callsToInline;
         for (CallTransition* call : mOpenCalls) {
-            inlineCallIntoRoot(call, mInlinedVariables, "_call" + llvm::Twine(tmp++), callsToInline);
+            inlineCallIntoRoot(call, mInlinedVariables, "_call" + llvm::Twine(mTmp++), callsToInline);
             mCalls.erase(call);
         }
     }    
@@ -237,6 +265,10 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
     mStats.NumBeginLocs = mRoot->getNumLocations();
     mStats.NumBeginLocals = mRoot->getNumLocals();
 
+    if (mSettings.numWorkers > 1) {
+        return this->checkParallel(mSettings.eagerUnroll + 1);
+    }
+
     Location* top = mRoot->getEntry();
     Location* bottom = mError;
 
@@ -276,7 +308,21 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
 
                 if (status == Solver::SAT) {
                     llvm::outs() << "  Under-approximated formula is SAT.\n";
-                    return this->createFailResult();
+                    if (!mSettings.findAllErrors) {
+                        return this->createFailResult();
+                    }
+
+                    // Record this counterexample, then exclude its error code and
+                    // try again in the same solver session.
+                    auto fail = this->createFailResult();
+                    unsigned ec = llvm::cast<FailResult>(*fail).getErrorID();
+                    llvm::outs() << "    Found error code " << ec << ", continuing search.\n";
+                    mFoundErrors.emplace_back(llvm::cast<FailResult>(fail.release()));
+                    mStats.NumErrorsFound++;
+
+                    this->pop();
+                    this->blockErrorCode(ec);
+                    continue;
                 }
 
                 this->pop();
@@ -308,7 +354,7 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
     
                 if (status == Solver::UNSAT) {
                     llvm::outs() << "    Start and target points are inconsitent, no errors are reachable.\n";
-                    return VerificationResult::CreateSuccess();
+                    return this->finalizeResult(VerificationResult::CreateSuccess());
                 }
 
             } else {
@@ -332,7 +378,13 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
                     continue;
                 }
 
-                info.overApprox = mExprBuilder.True();
+                info.overApprox = this->getCallSummary(call);
+                auto lit = llvm::dyn_cast<BoolLiteralExpr>(info.overApprox.get());
+                if (lit != nullptr && lit->isFalse()) {
+                    // The callee never returns, there is nothing to inline.
+                    continue;
+                }
+
                 mOpenCalls.insert(call);
             }
 
@@ -362,30 +414,12 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
 
                 llvm::SmallVector<CallTransition*, 16> callsToInline;
                 this->findOpenCallsInCex(*model, callsToInline);
+                mInlineScheduler->schedule(callsToInline, [this](CallTransition* call) {
+                    return mCalls[call].callChain.size();
+                });
 
                 llvm::outs() << "    Inlining calls...\n";
-                while (!callsToInline.empty()) {
-                    CallTransition* call = callsToInline.pop_back_val();
-                    llvm::outs() << "      Inlining " << call->getSource()->getId() << " --> "
-                        << call->getTarget()->getId() << " "
-                        << call->getCalledAutomaton()->getName() << "\n";
-                    mStats.NumInlined++;
-
-                    llvm::SmallVector<CallTransition*, 4> newCalls;
-                    this->inlineCallIntoRoot(
-                        call, mInlinedVariables, "_call" + llvm::Twine(tmp++), newCalls
-                    );
-                    mCalls.erase(call);
-                    mOpenCalls.erase(call);
-
-                    for (CallTransition* newCall : newCalls) {
-                        if (mCalls[newCall].getCost() <= bound) {
-                            callsToInline.push_back(newCall);
-                        }
-                    }
-                }
-
-                mRoot->clearDisconnectedElements();
+                this->inlineCalls(callsToInline, bound);
 
                 mStats.NumEndLocs = mRoot->getNumLocations();
                 mStats.NumEndLocals = mRoot->getNumLocals();
@@ -404,7 +438,7 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
                     mStats.NumEndLocs = mRoot->getNumLocations();
                     mStats.NumEndLocals = mRoot->getNumLocals();
 
-                    return VerificationResult::CreateSuccess();
+                    return this->finalizeResult(VerificationResult::CreateSuccess());
                 }
                 
                 if (bound == mSettings.maxBound) {
@@ -414,7 +448,7 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
                     mStats.NumEndLocs = mRoot->getNumLocations();
                     mStats.NumEndLocals = mRoot->getNumLocals();
 
-                    return VerificationResult::CreateBoundReached();
+                    return this->finalizeResult(VerificationResult::CreateBoundReached());
                 }
 
                 // Try with an increased bound.
@@ -429,12 +463,71 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
                 skipUnderApprox = true;
                 break;
             } else {
-                llvm_unreachable("Unknown solver status.");
+                // The solver gave up or was interrupted.
+                llvm::outs() << "  Over-approximated formula is UNKNOWN.\n";
+                return this->finalizeResult(VerificationResult::CreateUnknown());
             }
         }
     }
 
-    return VerificationResult::CreateBoundReached();
+    return this->finalizeResult(VerificationResult::CreateBoundReached());
+}
+
+ExprPtr BoundedModelCheckerImpl::getCallSummary(CallTransition* call)
+{
+    if (mSummaries == nullptr) {
+        return mExprBuilder.True();
+    }
+
+    CallInfo& info = mCalls[call];
+    if (info.summary == nullptr) {
+        info.summary = mSummaries->instantiate(call);
+    }
+
+    return info.summary;
+}
+
+void BoundedModelCheckerImpl::blockErrorCode(unsigned ec)
+{
+    Type& type = mErrorFieldVariable->getType();
+
+    ExprPtr codeLit;
+    switch (type.getTypeID()) {
+        case Type::BvTypeID:
+            codeLit = mExprBuilder.BvLit(ec, llvm::cast<BvType>(type).getWidth());
+            break;
+        case Type::IntTypeID:
+            codeLit = mExprBuilder.IntLit(ec);
+            break;
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+
+    ExprPtr constraint = mExprBuilder.NotEq(mErrorFieldVariable->getRefExpr(), codeLit);
+    mSolver->add(constraint);
+    for (auto& worker : mWorkers) {
+        worker->solver->add(constraint);
+    }
+}
+
+auto BoundedModelCheckerImpl::finalizeResult(std::unique_ptr<VerificationResult> result)
+    -> std::unique_ptr<VerificationResult>
+{
+    if (mFoundErrors.empty()) {
+        return result;
+    }
+
+    if (result->getStatus() == VerificationResult::BoundReached) {
+        llvm::outs() << "Maximum bound is reached, the list of errors may be incomplete.\n";
+    }
+
+    std::unique_ptr<FailResult> first = std::move(mFoundErrors.front());
+    for (size_t i = 1; i < mFoundErrors.size(); ++i) {
+        first->addFailure(std::move(mFoundErrors[i]));
+    }
+    mFoundErrors.clear();
+
+    return first;
 }
 
 auto BoundedModelCheckerImpl::createLocNumberFunc()
@@ -478,13 +571,22 @@ auto BoundedModelCheckerImpl::findCommonCallAncestor(Location* fwd, Location* bw
 
 void BoundedModelCheckerImpl::findOpenCallsInCex(Model& model, llvm::SmallVectorImpl<CallTransition*>& callsInCex)
 {
-    auto cex = bmc::BmcCex{mError, *mRoot, model, mPredecessors};
+    this->findOpenCallsInCex(model, mPredecessors, mOpenCalls, callsInCex);
+}
+
+void BoundedModelCheckerImpl::findOpenCallsInCex(
+    Model& model,
+    bmc::PredecessorMapT& preds,
+    const llvm::DenseSet<CallTransition*>& openCalls,
+    llvm::SmallVectorImpl<CallTransition*>& callsInCex
+) {
+    auto cex = bmc::BmcCex{mError, *mRoot, model, preds};
 
     for (auto state : cex) {
         auto call = llvm::dyn_cast_or_null<CallTransition>(state.getOutgoingTransition());
-        if (call != nullptr && mOpenCalls.count(call) != 0) {
+        if (call != nullptr && openCalls.count(call) != 0) {
             callsInCex.push_back(call);
-            if (callsInCex.size() == mOpenCalls.size()) {
+            if (callsInCex.size() == openCalls.size()) {
                 // All possible calls were encountered, no point in iterating further.
                 break;
             }
@@ -492,6 +594,39 @@ void BoundedModelCheckerImpl::findOpenCallsInCex(Model& model, llvm::SmallVector
     }
 }
 
+void BoundedModelCheckerImpl::inlineCalls(
+    llvm::SmallVectorImpl<CallTransition*>& callsToInline, unsigned bound)
+{
+    unsigned budget = mInlineScheduler->getBudget();
+    unsigned numInlined = 0;
+
+    while (!callsToInline.empty()) {
+        CallTransition* call = callsToInline.pop_back_val();
+        llvm::outs() << "      Inlining " << call->getSource()->getId() << " --> "
+            << call->getTarget()->getId() << " "
+            << call->getCalledAutomaton()->getName() << "\n";
+        mStats.NumInlined++;
+
+        llvm::SmallVector<CallTransition*, 4> newCalls;
+        this->inlineCallIntoRoot(
+            call, mInlinedVariables, "_call" + llvm::Twine(mTmp++), newCalls
+        );
+        mCalls.erase(call);
+        mOpenCalls.erase(call);
+        mInlineScheduler->callInlined(call);
+        ++numInlined;
+
+        for (CallTransition* newCall : newCalls) {
+            bool withinBudget = budget == 0 || numInlined + callsToInline.size() < budget;
+            if (mCalls[newCall].getCost() <= bound && withinBudget) {
+                callsToInline.push_back(newCall);
+            }
+        }
+    }
+
+    mRoot->clearDisconnectedElements();
+}
+
 void BoundedModelCheckerImpl::inlineCallIntoRoot(
     CallTransition* call,
     llvm::DenseMap<Variable*, Variable*>& vmap,
@@ -508,51 +643,19 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
     CallInfo& info = mCalls[call];
     auto callee = call->getCalledAutomaton();
 
-    llvm::DenseMap<Location*, Location*> locToLocMap;
-    llvm::DenseMap<Variable*, Variable*> oldVarToNew;
-
-    llvm::DenseMap<Transition*, Transition*> edgeToEdgeMap;
-
-    VariableExprRewrite rewrite(mExprBuilder);
-
-    // Clone all local variables into the parent
-    for (Variable& local : callee->locals()) {
-        LLVM_DEBUG(llvm::dbgs() << "Callee local " << local.getName() << "\n"); 
-        if (!callee->isOutput(&local)) {
-            auto varname = (local.getName() + suffix).str();
-            auto newLocal = mRoot->createLocal(varname, local.getType());
-            oldVarToNew[&local] = newLocal;
-            vmap[newLocal] = &local;
-            rewrite[&local] = newLocal->getRefExpr();
-        }
-    }
-
-    for (Variable& input : callee->inputs()) {
-        LLVM_DEBUG(llvm::dbgs() << "Callee input " << input.getName() << "\n");
-        if (!callee->isOutput(&input)) {
-            auto varname = (input.getName() + suffix).str();
-            auto newInput = mRoot->createLocal(varname, input.getType());
-            oldVarToNew[&input] = newInput;
-            vmap[newInput] = &input;
-
-            auto arg = call->getInputArgument(input);
-            assert(arg.has_value()
-                && "Each call input assignment must map to an input variable in callee!");
-            rewrite[&input] = arg->getValue();
-            //rewrite[&input] = newInput->getRefExpr();
-        }
-    }
+    bmc::InlineFrame frame(mExprBuilder, callee, mRoot, suffix.str(), vmap);
 
     for (Variable& output : callee->outputs()) {
         auto argument = call->getOutputArgument(output);
         assert(argument.has_value() && "Every callee output should be assigned in a call transition!");
 
-        auto newOutput = argument->getVariable();
-        oldVarToNew[&output] = newOutput;
+        Variable* newOutput = argument->getVariable();
+        frame.bind(&output, newOutput);
         vmap[newOutput] = &output;
-        rewrite[&output] = newOutput->getRefExpr();
     }
 
+    llvm::DenseMap<Location*, Location*> locToLocMap;
+
     // Insert the locations
     for (Location* origLoc : callee->nodes()) {
         auto newLoc = mRoot->createLocation();
@@ -561,70 +664,50 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
 
         if (origLoc->isError()) {
             mRoot->createAssignTransition(newLoc, mError, mExprBuilder.True(), {
-                { mErrorFieldVariable, callee->getErrorFieldExpr(origLoc) }
+                { mErrorFieldVariable, frame.instantiate(callee->getErrorFieldExpr(origLoc)) }
             });
         }
     }
 
     // Transform the edges
     for (auto origEdge : callee->edges()) {
-        Transition* newEdge = nullptr;
         Location* source = locToLocMap[origEdge->getSource()];
         Location* target = locToLocMap[origEdge->getTarget()];
 
         if (auto assign = llvm::dyn_cast<AssignTransition>(origEdge)) {
             // Transform the assignments of this edge to use the new variables.
             std::vector<VariableAssignment> newAssigns;
-            std::transform(
-                assign->begin(), assign->end(), std::back_inserter(newAssigns),
-                [&oldVarToNew, &rewrite] (const VariableAssignment& origAssign) {
-                    return VariableAssignment {
-                        oldVarToNew[origAssign.getVariable()],
-                        rewrite.walk(origAssign.getValue())
-                    };
-                }
-            );
+            for (const VariableAssignment& origAssign : *assign) {
+                newAssigns.emplace_back(
+                    frame.getInstance(origAssign.getVariable()),
+                    frame.instantiate(origAssign.getValue())
+                );
+            }
 
-            newEdge = mRoot->createAssignTransition(
-                source, target, rewrite.walk(assign->getGuard()), newAssigns
+            mRoot->createAssignTransition(
+                source, target, frame.instantiate(assign->getGuard()), newAssigns
             );
         } else if (auto nestedCall = llvm::dyn_cast<CallTransition>(origEdge)) {
+            // The inputs and outputs of the nested callee are left untouched,
+            // they are instantiated when the nested call is inlined.
             std::vector<VariableAssignment> newArgs;
-            std::vector<VariableAssignment> newOuts;
+            for (const VariableAssignment& arg : nestedCall->inputs()) {
+                newArgs.emplace_back(arg.getVariable(), frame.instantiate(arg.getValue()));
+            }
 
-            std::transform(
-                nestedCall->input_begin(), nestedCall->input_end(),
-                std::back_inserter(newArgs),
-                [&rewrite](const VariableAssignment& assign) {
-                    return VariableAssignment{assign.getVariable(), rewrite.walk(assign.getValue())};
-                }
-            );
-            std::transform(
-                nestedCall->output_begin(), nestedCall->output_end(),
-                std::back_inserter(newOuts),
-                [&oldVarToNew](const VariableAssignment& origAssign) {
-                    //llvm::errs() << origAssign.getVariable()->getName() << "\n";
-
-                    Variable* newVar = oldVarToNew.lookup(origAssign.getVariable());
-                    assert(newVar != nullptr && "All variables should be present in the variable map!");
-
-                    return VariableAssignment{
-                        newVar,
-                        //rewrite.visit(origAssign.getValue())
-                        origAssign.getValue()
-                    };
-                }
-            );
+            std::vector<VariableAssignment> newOuts;
+            for (const VariableAssignment& out : nestedCall->outputs()) {
+                newOuts.emplace_back(frame.getInstance(out.getVariable()), out.getValue());
+            }
 
             auto callEdge = mRoot->createCallTransition(
                 source, target,
-                rewrite.walk(nestedCall->getGuard()),
+                frame.instantiate(nestedCall->getGuard()),
                 nestedCall->getCalledAutomaton(),
                 newArgs,
                 newOuts
             );
 
-            newEdge = callEdge;
             mCalls[callEdge].callChain = info.callChain;
             mCalls[callEdge].callChain.push_back(callEdge->getCalledAutomaton());
             mCalls[callEdge].overApprox = mExprBuilder.False();
@@ -632,8 +715,6 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
         } else {
             llvm_unreachable("Unknown transition kind!");
         }
-
-        edgeToEdgeMap[origEdge] = newEdge;
     }
 
     Location* before = call->getSource();
@@ -641,9 +722,9 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
 
     std::vector<VariableAssignment> inputAssigns;
     for (auto& input : call->inputs()) {
-        VariableAssignment inputAssignment(oldVarToNew[input.getVariable()], input.getValue());
+        VariableAssignment inputAssignment(frame.getInstance(input.getVariable()), input.getValue());
         LLVM_DEBUG(llvm::dbgs() << "Added input assignment " << inputAssignment <<
-            " for variable " << *input.getVariable() << "n");
+            " for variable " << *input.getVariable() << "\n");
         inputAssigns.push_back(inputAssignment);
     }
 
@@ -674,6 +755,60 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
     mRoot->disconnectEdge(call);
 }
 
+bmc::InlineFrame::InlineFrame(
+    ExprBuilder& builder, Cfa* callee, Cfa* root, std::string suffix,
+    llvm::DenseMap<Variable*, Variable*>& vmap
+) : ExprRewrite(builder), mRoot(root), mSuffix(std::move(suffix)), mVariableMap(vmap)
+{
+    for (Variable& input : callee->inputs()) {
+        mVariables[&input] = nullptr;
+    }
+
+    for (Variable& local : callee->locals()) {
+        mVariables[&local] = nullptr;
+    }
+}
+
+Variable* bmc::InlineFrame::getInstance(Variable* variable)
+{
+    auto result = mVariables.find(variable);
+    assert(result != mVariables.end() && "The variable must belong to the callee!");
+
+    if (result->second == nullptr) {
+        result->second = mRoot->createLocal(variable->getName() + mSuffix, variable->getType());
+        mVariableMap[result->second] = variable;
+    }
+
+    return result->second;
+}
+
+ExprPtr bmc::InlineFrame::visitVarRef(const ExprRef<VarRefExpr>& expr)
+{
+    Variable* variable = &expr->getVariable();
+    if (mVariables.count(variable) == 0) {
+        // Variables of the root automaton, such as the error field.
+        return expr;
+    }
+
+    return this->getInstance(variable)->getRefExpr();
+}
+
+bool bmc::InlineFrame::shouldSkip(const ExprPtr& expr, ExprPtr* ret)
+{
+    auto result = mCache.find(expr.get());
+    if (result != mCache.end()) {
+        *ret = result->second.second;
+        return true;
+    }
+
+    return false;
+}
+
+void bmc::InlineFrame::handleResult(const ExprPtr& expr, ExprPtr& ret)
+{
+    mCache[expr.get()] = { expr, ret };
+}
+
 auto BoundedModelCheckerImpl::runSolver() -> Solver::SolverStatus
 {
     llvm::outs() << "    Running solver...\n";
@@ -700,9 +835,18 @@ void BoundedModelCheckerImpl::printStats(llvm::raw_ostream& os)
     os << "Number of locations on finish: " << mStats.NumEndLocs << "\n";
     os << "Number of variables on start: " << mStats.NumBeginLocals << "\n";
     os << "Number of variables on finish: " << mStats.NumEndLocals << "\n";
+    if (mSettings.findAllErrors) {
+        os << "Number of errors found: " << mStats.NumErrorsFound << "\n";
+    }
+    if (mSettings.useSummaries) {
+        os << "Number of procedure summaries: " << mStats.NumSummaries << "\n";
+    }
     os << "------------------------------\n";
     if (mSettings.printSolverStats) {
         mSolver->printStats(os);
+        for (auto& worker : mWorkers) {
+            worker->solver->printStats(os);
+        }
     }
     os << "\n";
 }
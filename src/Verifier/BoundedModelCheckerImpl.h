@@ -19,8 +19,11 @@
 #define GAZER_SRC_VERIFIER_BOUNDEDMODELCHECKERIMPL_H
 
 #include "gazer/Verifier/BoundedModelChecker.h"
+#include "BmcInlineScheduler.h"
+#include "BmcSummaries.h"
 #include "gazer/Core/Expr/ExprEvaluator.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Solver/Solver.h"
 #include "gazer/Core/Solver/Model.h"
 #include "gazer/Automaton/Cfa.h"
@@ -110,6 +113,67 @@ namespace bmc
         ExprEvaluator& mEval;
         PredecessorMapT& mPredecessors;
     };
+
+    /// Rewrites the transitions of a callee into an inlined instance of it.
+    ///
+    /// The variables of the callee are mapped to the variables of this instance,
+    /// which are created in the root automaton on first use and recorded in the
+    /// inlined variable map. Instantiated expressions are memoized, so shared
+    /// subexpressions of the callee are only rewritten once per instance.
+    class InlineFrame : public ExprRewrite<InlineFrame>
+    {
+        friend class ExprWalker<InlineFrame, ExprPtr>;
+    public:
+        InlineFrame(
+            ExprBuilder& builder, Cfa* callee, Cfa* root, std::string suffix,
+            llvm::DenseMap<Variable*, Variable*>& vmap
+        );
+
+        /// Binds the callee variable \p variable to \p instance.
+        void bind(Variable* variable, Variable* instance) { mVariables[variable] = instance; }
+
+        /// Returns the instance of the callee variable \p variable, creating
+        /// it if it does not exist yet.
+        Variable* getInstance(Variable* variable);
+
+        ExprPtr instantiate(const ExprPtr& expr) { return this->walk(expr); }
+
+    protected:
+        ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr);
+
+        bool shouldSkip(const ExprPtr& expr, ExprPtr* ret);
+        void handleResult(const ExprPtr& expr, ExprPtr& ret);
+
+    private:
+        Cfa* mRoot;
+        std::string mSuffix;
+        llvm::DenseMap<Variable*, Variable*>& mVariableMap;
+
+        // Contains every variable of the callee, mapped to nullptr
+        // until their instance is created.
+        llvm::DenseMap<Variable*, Variable*> mVariables;
+
+        // The key is also stored in the value to keep it alive.
+        llvm::DenseMap<Expr*, std::pair<ExprPtr, ExprPtr>> mCache;
+    };
+
+    /// A query which is checked on its own solver instance in parallel mode.
+    struct BmcWorker
+    {
+        explicit BmcWorker(std::unique_ptr<Solver> solver)
+            : solver(std::move(solver))
+        {}
+
+        std::unique_ptr<Solver> solver;
+        PredecessorMapT preds;
+        llvm::DenseSet<CallTransition*> openCalls;
+        unsigned bound = 0;
+        unsigned numUnhandledCallSites = 0;
+        bool underApprox = false;
+        bool active = false;
+        bool running = false;
+        Solver::SolverStatus status = Solver::UNKNOWN;
+    };
 }
 
 class BoundedModelCheckerImpl
@@ -117,6 +181,7 @@ class BoundedModelCheckerImpl
     struct CallInfo
     {
         ExprPtr overApprox = nullptr;
+        ExprPtr summary = nullptr;
         std::vector<Cfa*> callChain;
 
         unsigned getCost() const {
@@ -132,6 +197,8 @@ public:
         unsigned NumEndLocs = 0;
         unsigned NumBeginLocals = 0;
         unsigned NumEndLocals = 0;
+        unsigned NumErrorsFound = 0;
+        unsigned NumSummaries = 0;
     };
 
     BoundedModelCheckerImpl(
@@ -165,8 +232,37 @@ private:
     std::function<size_t(Location*)> createLocNumberFunc();
 
     void findOpenCallsInCex(Model& model, llvm::SmallVectorImpl<CallTransition*>& callsInCex);
+    void findOpenCallsInCex(
+        Model& model,
+        bmc::PredecessorMapT& preds,
+        const llvm::DenseSet<CallTransition*>& openCalls,
+        llvm::SmallVectorImpl<CallTransition*>& callsInCex
+    );
+
+    /// Inlines all calls in \p callsToInline, along with the newly created
+    /// calls whose cost does not exceed \p bound, while the inlining budget
+    /// allows it.
+    void inlineCalls(llvm::SmallVectorImpl<CallTransition*>& callsToInline, unsigned bound);
+
+    /// Checks the system by running an under-approximating and several
+    /// over-approximating queries with increasing bounds concurrently,
+    /// each on its own solver instance.
+    std::unique_ptr<VerificationResult> checkParallel(unsigned startBound);
 
     std::unique_ptr<VerificationResult> createFailResult();
+    std::unique_ptr<VerificationResult> createFailResult(Model& model, bmc::PredecessorMapT& preds);
+
+    /// Returns the instantiated summary of the callee of \p call, or 'True'
+    /// if procedure summaries are disabled.
+    ExprPtr getCallSummary(CallTransition* call);
+
+    /// Adds a constraint to the current solver scope which excludes every
+    /// counterexample with the error code \p ec.
+    void blockErrorCode(unsigned ec);
+
+    /// In all-errors mode, replaces \p result with the list of failures found
+    /// so far, if there were any. Returns \p result unchanged otherwise.
+    std::unique_ptr<VerificationResult> finalizeResult(std::unique_ptr<VerificationResult> result);
 
     void push() {
         mSolver->push();
@@ -183,6 +279,7 @@ private:
 private:
     AutomataSystem& mSystem;
     ExprBuilder& mExprBuilder;
+    SolverFactory& mSolverFactory;
     std::unique_ptr<Solver> mSolver;
     TraceBuilder<Location*, std::vector<VariableAssignment>>& mTraceBuilder;
     BmcSettings mSettings;
@@ -207,6 +304,11 @@ private:
     Stats mStats;
     Stopwatch<> mTimer;
     Variable* mErrorFieldVariable = nullptr;
+
+    std::vector<std::unique_ptr<FailResult>> mFoundErrors;
+    std::vector<std::unique_ptr<bmc::BmcWorker>> mWorkers;
+    std::unique_ptr<InlineScheduler> mInlineScheduler;
+    std::unique_ptr<SummaryStore> mSummaries;
 };
 
 std::unique_ptr<Trace> buildBmcTrace(
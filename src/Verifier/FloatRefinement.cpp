@@ -0,0 +1,208 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/FloatRefinement.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/GazerContext.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace gazer;
+
+/// Returns true if the precise value of an operation matches the value
+/// it has in the counterexample.
+static bool isSameValue(const ExprRef<AtomicExpr>& precise, const ExprPtr& actual)
+{
+    if (precise->isUndef()) {
+        // We could not compute the precise value, thus we cannot confirm
+        // the counterexample either.
+        return false;
+    }
+
+    auto preciseFlt = llvm::dyn_cast<FloatLiteralExpr>(precise);
+    auto actualFlt = llvm::dyn_cast<FloatLiteralExpr>(actual);
+    if (preciseFlt != nullptr && actualFlt != nullptr) {
+        // The solver and APFloat may use different NaN representations.
+        if (preciseFlt->getValue().isNaN() && actualFlt->getValue().isNaN()) {
+            return true;
+        }
+
+        return preciseFlt->getValue().bitwiseIsEqual(actualFlt->getValue());
+    }
+
+    return precise == actual;
+}
+
+auto FloatAbstractionRefinement::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    for (unsigned iteration = 1; ; ++iteration) {
+        llvm::outs() << "Float refinement iteration " << iteration << ", "
+            << mAbstractions.size() << " abstracted operations.\n";
+
+        // Algorithms may modify the system they check, and we will need the
+        // original one for refinement. Run the backend on a clone.
+        GazerContext context;
+        auto clone = CloneAutomataSystem(system, context);
+
+        CfaTraceRecorder recorder;
+        auto result = mBackend.check(*clone.system, recorder);
+
+        // Every other result is final: the abstraction over-approximates the
+        // precise semantics, thus a successful verification is sound.
+        auto fail = llvm::dyn_cast<FailResult>(result.get());
+        if (fail == nullptr) {
+            return result;
+        }
+
+        if (!recorder.isRecorded()) {
+            if (mAbstractions.empty()) {
+                return VerificationResult::CreateFail(fail->getErrorID());
+            }
+
+            llvm::outs() << "The counterexample is unavailable, cannot validate it.\n";
+            return VerificationResult::CreateUnknown();
+        }
+
+        auto& states = recorder.mStates;
+        auto& actions = recorder.mActions;
+        TranslateClonedTrace(clone, system.getContext(), states, actions);
+
+        std::vector<size_t> spurious = this->findSpuriousOperations(actions);
+        if (spurious.empty()) {
+            std::unique_ptr<Trace> trace = nullptr;
+            if (mTrace) {
+                trace = traceBuilder.build(states, actions);
+            }
+
+            auto genuine = VerificationResult::CreateFail(fail->getErrorID(), std::move(trace));
+            for (FailResult& other : fail->other_failures()) {
+                llvm::cast<FailResult>(*genuine).addFailure(std::make_unique<FailResult>(other.getErrorID()));
+            }
+
+            return genuine;
+        }
+
+        llvm::outs() << "The counterexample is spurious, refining "
+            << spurious.size() << " operations.\n";
+
+        if (!this->refine(spurious)) {
+            llvm::outs() << "The spurious operations are no longer present in the system.\n";
+            return VerificationResult::CreateUnknown();
+        }
+    }
+}
+
+std::vector<size_t> FloatAbstractionRefinement::findSpuriousOperations(
+    const std::vector<std::vector<VariableAssignment>>& actions)
+{
+    llvm::DenseMap<Variable*, size_t> abstractedVars;
+    for (size_t i = 0; i < mAbstractions.size(); ++i) {
+        abstractedVars[mAbstractions[i].variable] = i;
+    }
+
+    Valuation valuation;
+    ValuationExprEvaluator evaluator(valuation);
+
+    std::vector<size_t> result;
+    llvm::DenseSet<size_t> visited;
+
+    for (auto& action : actions) {
+        for (const VariableAssignment& assign : action) {
+            Variable* variable = assign.getVariable();
+            const ExprPtr& value = assign.getValue();
+
+            auto it = abstractedVars.find(variable);
+            if (it != abstractedVars.end() && !value->isUndef() && visited.count(it->second) == 0) {
+                auto precise = evaluator.evaluate(mAbstractions[it->second].precise);
+                if (!isSameValue(precise, value)) {
+                    result.push_back(it->second);
+                    visited.insert(it->second);
+                }
+            }
+
+            // Values of loop variables change between iterations, do not
+            // keep a stale value if the new one is unknown.
+            if (auto lit = llvm::dyn_cast<LiteralExpr>(value)) {
+                valuation[variable] = lit;
+            } else {
+                valuation.erase(variable);
+            }
+        }
+    }
+
+    return result;
+}
+
+bool FloatAbstractionRefinement::refine(const std::vector<size_t>& operations)
+{
+    bool changed = false;
+    llvm::DenseSet<size_t> refined(operations.begin(), operations.end());
+
+    for (size_t idx : operations) {
+        AbstractedOperation& op = mAbstractions[idx];
+
+        std::vector<AssignTransition*> edges;
+        for (Transition* edge : op.automaton->edges()) {
+            auto assign = llvm::dyn_cast<AssignTransition>(edge);
+            if (assign == nullptr) {
+                continue;
+            }
+
+            bool isAbstracted = std::any_of(assign->begin(), assign->end(), [&op](const VariableAssignment& va) {
+                return va.getVariable() == op.variable && va.getValue()->isUndef();
+            });
+
+            if (isAbstracted) {
+                edges.push_back(assign);
+            }
+        }
+
+        for (AssignTransition* edge : edges) {
+            std::vector<VariableAssignment> newAssigns;
+            for (const VariableAssignment& va : *edge) {
+                if (va.getVariable() == op.variable) {
+                    newAssigns.emplace_back(op.variable, op.precise);
+                } else {
+                    newAssigns.push_back(va);
+                }
+            }
+
+            op.automaton->createAssignTransition(
+                edge->getSource(), edge->getTarget(), edge->getGuard(), newAssigns
+            );
+            op.automaton->disconnectEdge(edge);
+            changed = true;
+        }
+
+        op.automaton->clearDisconnectedElements();
+    }
+
+    std::vector<AbstractedOperation> remaining;
+    for (size_t i = 0; i < mAbstractions.size(); ++i) {
+        if (refined.count(i) == 0) {
+            remaining.push_back(mAbstractions[i]);
+        }
+    }
+    mAbstractions = std::move(remaining);
+
+    return changed;
+}
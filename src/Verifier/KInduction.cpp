@@ -0,0 +1,908 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The transition relation of the k-induction engine is built from the cyclic
+// form of the main automaton. Each loop head h is split into h and h_in: all
+// incoming edges of h are redirected into h_in, and their assignments are
+// moved into 'next' shadow variables. This way the automaton becomes acyclic,
+// and the paths between two cut points form a single step of the transition
+// relation, which can be encoded by the usual path condition calculator.
+// Within step k, shadow variables refer to the k-th instance of their
+// variable, while the variables assigned on the edges into h (the loop
+// variables) are read from the previous instance.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/KInduction.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Core/Solver/Model.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using namespace gazer;
+
+namespace
+{
+
+/// Replaces each variable of an expression with its instance in a given step.
+class StepInstantiation : public ExprRewrite<StepInstantiation>
+{
+    friend class ExprWalker<StepInstantiation, ExprPtr>;
+public:
+    StepInstantiation(ExprBuilder& builder, std::function<Variable*(Variable*)> lookup)
+        : ExprRewrite(builder), mLookup(std::move(lookup))
+    {}
+
+protected:
+    ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr)
+    {
+        return mLookup(&expr->getVariable())->getRefExpr();
+    }
+
+    bool shouldSkip(const ExprPtr& expr, ExprPtr* ret)
+    {
+        auto result = mCache.find(expr.get());
+        if (result != mCache.end()) {
+            *ret = result->second.second;
+            return true;
+        }
+
+        return false;
+    }
+
+    void handleResult(const ExprPtr& expr, ExprPtr& ret)
+    {
+        mCache[expr.get()] = { expr, ret };
+    }
+
+private:
+    std::function<Variable*(Variable*)> mLookup;
+    llvm::DenseMap<Expr*, std::pair<ExprPtr, ExprPtr>> mCache;
+};
+
+/// A set of paths between two cut points, forming a single step.
+struct KindSegment
+{
+    Location* source;
+    Location* target;
+    unsigned sourceId;
+    unsigned targetId;
+
+    /// Variables which are assigned on at least one path of this segment.
+    llvm::DenseSet<Variable*> assigned;
+};
+
+class KInductionImpl
+{
+public:
+    KInductionImpl(
+        AutomataSystem& system,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        KInductionSettings settings
+    );
+
+    std::unique_ptr<VerificationResult> check();
+
+private:
+    /// Splits the loop heads of the root automaton, making it acyclic.
+    bool splitLoopHeads();
+    void createSegments();
+    void findInvariants();
+
+    Variable* getInstance(Variable* variable, unsigned step);
+    Variable* getProgramCounter(unsigned step);
+
+    /// Returns the variable instance read or written in a given step.
+    Variable* lookupStepVariable(Variable* variable, unsigned step);
+
+    ExprPtr encodeStep(unsigned step);
+    ExprPtr instantiateInvariants(unsigned step);
+
+    std::unique_ptr<VerificationResult> createFailResult(Model& model, unsigned bound);
+    Location* getOriginalLocation(Location* loc);
+
+private:
+    AutomataSystem& mSystem;
+    SolverFactory& mSolverFactory;
+    CfaTraceBuilder& mTraceBuilder;
+    KInductionSettings mSettings;
+    std::unique_ptr<ExprBuilder> mExprBuilder;
+
+    Cfa* mRoot = nullptr;
+    Location* mError = nullptr;
+    Variable* mErrorFieldVariable = nullptr;
+    llvm::DenseMap<Location*, Location*> mInlinedLocations;
+    llvm::DenseMap<Variable*, Variable*> mInlinedVariables;
+
+    // Loop heads and their split counterparts
+    std::vector<Location*> mLoopHeads;
+    llvm::DenseMap<Location*, Location*> mHeadInputs;
+    llvm::DenseMap<Location*, Location*> mSplitHeads;
+
+    // Variables
+    std::vector<Variable*> mStateVariables;
+    llvm::DenseSet<Variable*> mLoopVariables;
+    llvm::DenseMap<Variable*, Variable*> mNextVariables;
+    llvm::DenseMap<Variable*, Variable*> mBaseVariables;
+
+    // Topological sort of the acyclic automaton
+    std::vector<Location*> mTopo;
+    llvm::DenseMap<Location*, size_t> mLocNumbers;
+
+    llvm::DenseMap<Location*, unsigned> mCutPointIds;
+    std::vector<KindSegment> mSegments;
+    llvm::DenseMap<Location*, llvm::DenseSet<Location*>> mCanReach;
+
+    std::vector<llvm::DenseMap<Variable*, Variable*>> mInstances;
+    std::vector<Variable*> mProgramCounters;
+    llvm::DenseMap<Location*, ExprVector> mInvariants;
+    llvm::DenseMap<Location*, ExprVector> mAbstractInvariants;
+};
+
+} // end anonymous namespace
+
+KInductionImpl::KInductionImpl(
+    AutomataSystem& system,
+    SolverFactory& solverFactory,
+    CfaTraceBuilder& traceBuilder,
+    KInductionSettings settings
+) : mSystem(system), mSolverFactory(solverFactory),
+    mTraceBuilder(traceBuilder), mSettings(settings)
+{
+    if (mSettings.simplifyExpr) {
+        mExprBuilder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        mExprBuilder = CreateExprBuilder(system.getContext());
+    }
+}
+
+static llvm::StringRef statusToString(Solver::SolverStatus status)
+{
+    switch (status) {
+        case Solver::SAT: return "SAT";
+        case Solver::UNSAT: return "UNSAT";
+        case Solver::UNKNOWN: return "UNKNOWN";
+    }
+
+    llvm_unreachable("Unknown solver status.");
+}
+
+auto KInductionImpl::check() -> std::unique_ptr<VerificationResult>
+{
+    mRoot = mSystem.getMainAutomaton();
+    assert(mRoot != nullptr && "The main automaton must exist!");
+
+    auto result = TransformRecursiveToCyclic(mRoot);
+    mError = result.errorLocation;
+    mErrorFieldVariable = result.errorFieldVariable;
+    mInlinedLocations = std::move(result.inlinedLocations);
+    mInlinedVariables = std::move(result.inlinedVariables);
+
+    for (Transition* edge : mRoot->edges()) {
+        if (llvm::isa<CallTransition>(edge)) {
+            if (mSettings.inductiveStep) {
+                llvm::outs() << "Cannot run k-induction on automata with non-tail-recursive calls.\n";
+            } else {
+                llvm::outs() << "Cannot unroll automata with non-tail-recursive calls in time frames.\n";
+            }
+            return VerificationResult::CreateUnknown();
+        }
+    }
+
+    if (mSettings.useInvariants && mSettings.inductiveStep) {
+        // The abstract interpretation needs the loops, run it before they are cut.
+        mAbstractInvariants = ComputeLocationInvariants(mSystem, *mExprBuilder);
+    }
+
+    if (!this->splitLoopHeads()) {
+        llvm::outs() << "Loop variables must be assigned only on the edges entering their loop head.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    this->createSegments();
+    llvm::outs() << "Found " << mLoopHeads.size() << " loop heads and "
+        << mSegments.size() << " segments.\n";
+
+    if (mSettings.useInvariants && mSettings.inductiveStep) {
+        this->findInvariants();
+    }
+
+    auto base = mSolverFactory.createSolver(mSystem.getContext());
+    auto step = mSolverFactory.createSolver(mSystem.getContext());
+
+    unsigned errorId = mCutPointIds[mError];
+    auto isError = [this, errorId](unsigned k) {
+        return mExprBuilder->Eq(getProgramCounter(k)->getRefExpr(), mExprBuilder->IntLit(errorId));
+    };
+
+    base->add(mExprBuilder->Eq(
+        getProgramCounter(0)->getRefExpr(), mExprBuilder->IntLit(mCutPointIds[mRoot->getEntry()])
+    ));
+
+    // The base case and the inductive step are solved concurrently, but every
+    // formula is built on this thread, as expressions are not thread-safe.
+    llvm::ThreadPool pool(2);
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done = false;
+    unsigned numPending = 0;
+    bool baseRunning = false;
+    bool stepRunning = false;
+    Solver::SolverStatus baseStatus;
+    Solver::SolverStatus stepStatus;
+
+    auto runSolver = [&](Solver* solver, Solver::SolverStatus* status, Solver::SolverStatus decisive, bool* running) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done) {
+                *status = Solver::UNKNOWN;
+                --numPending;
+                changed.notify_all();
+                return;
+            }
+            *running = true;
+        }
+
+        auto result = solver->run();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        *running = false;
+        *status = result;
+        --numPending;
+        if (result == decisive) {
+            done = true;
+        }
+        changed.notify_all();
+    };
+
+    for (unsigned k = 1; k <= mSettings.maxBound; ++k) {
+        llvm::outs() << "Iteration " << k << "\n";
+
+        ExprPtr transition = this->encodeStep(k);
+        if (mSettings.dumpFormula) {
+            transition->print(llvm::errs());
+        }
+
+        base->add(transition);
+        base->push();
+        base->add(isError(k));
+
+        if (mSettings.inductiveStep) {
+            step->add(transition);
+            step->add(mExprBuilder->Not(isError(k - 1)));
+            if (mSettings.useInvariants) {
+                step->add(this->instantiateInvariants(k - 1));
+            }
+
+            step->push();
+            step->add(isError(k));
+
+            done = false;
+            numPending = 2;
+            pool.async(runSolver, base.get(), &baseStatus, Solver::SAT, &baseRunning);
+            pool.async(runSolver, step.get(), &stepStatus, Solver::UNSAT, &stepRunning);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&done, &numPending] { return done || numPending == 0; });
+
+                // An interrupt issued before a solver enters its search is lost,
+                // thus the other query is interrupted until it returns.
+                while (numPending != 0) {
+                    if (baseRunning) {
+                        base->interrupt();
+                    }
+                    if (stepRunning) {
+                        step->interrupt();
+                    }
+                    changed.wait_for(lock, std::chrono::milliseconds(10));
+                }
+            }
+            pool.wait();
+        } else {
+            baseStatus = base->run();
+        }
+
+        llvm::outs() << "  Base case: " << statusToString(baseStatus) << "\n";
+        if (mSettings.inductiveStep) {
+            llvm::outs() << "  Inductive step: " << statusToString(stepStatus) << "\n";
+        }
+
+        if (baseStatus == Solver::SAT) {
+            auto model = base->getModel();
+            if (mSettings.printSolverStats) {
+                base->printStats(llvm::outs());
+            }
+            return this->createFailResult(*model, k);
+        }
+
+        base->pop();
+
+        if (mSettings.inductiveStep) {
+            step->pop();
+
+            if (stepStatus == Solver::UNSAT) {
+                // The base case was unsatisfiable for all lower bounds.
+                llvm::outs() << "  Property is " << k << "-inductive.\n";
+                if (mSettings.printSolverStats) {
+                    step->printStats(llvm::outs());
+                }
+                return VerificationResult::CreateSuccess();
+            }
+        }
+
+        if (baseStatus != Solver::UNSAT) {
+            return VerificationResult::CreateUnknown();
+        }
+
+        // The error is unreachable in k steps, which also helps later queries.
+        base->add(mExprBuilder->Not(isError(k)));
+
+        if (!mSettings.inductiveStep && base->run() == Solver::UNSAT) {
+            // Without the inductive step, safety follows if the unrolling is
+            // complete: there is no execution with k steps.
+            llvm::outs() << "  No execution is longer than " << (k - 1) << " steps.\n";
+            if (mSettings.printSolverStats) {
+                base->printStats(llvm::outs());
+            }
+            return VerificationResult::CreateSuccess();
+        }
+    }
+
+    llvm::outs() << "Maximum bound is reached.\n";
+    return VerificationResult::CreateBoundReached();
+}
+
+bool KInductionImpl::splitLoopHeads()
+{
+    mRoot->removeUnreachableLocations();
+
+    // Find the targets of back edges with an iterative depth-first search.
+    llvm::DenseSet<Location*> visited;
+    llvm::DenseSet<Location*> onStack;
+    llvm::SetVector<Location*> heads;
+    std::vector<std::pair<Location*, size_t>> stack;
+
+    stack.emplace_back(mRoot->getEntry(), 0);
+    visited.insert(mRoot->getEntry());
+    onStack.insert(mRoot->getEntry());
+
+    while (!stack.empty()) {
+        auto& [loc, idx] = stack.back();
+        if (idx == loc->getNumOutgoing()) {
+            onStack.erase(loc);
+            stack.pop_back();
+            continue;
+        }
+
+        Location* target = (*std::next(loc->outgoing_begin(), idx++))->getTarget();
+        if (onStack.count(target) != 0) {
+            heads.insert(target);
+        } else if (visited.insert(target).second) {
+            onStack.insert(target);
+            stack.emplace_back(target, 0);
+        }
+    }
+
+    mLoopHeads.assign(heads.begin(), heads.end());
+
+    for (Variable& input : mRoot->inputs()) {
+        mStateVariables.push_back(&input);
+    }
+    for (Variable& local : mRoot->locals()) {
+        mStateVariables.push_back(&local);
+    }
+
+    for (Location* head : mLoopHeads) {
+        for (Transition* edge : head->incoming()) {
+            for (auto& assignment : *llvm::cast<AssignTransition>(edge)) {
+                mLoopVariables.insert(assignment.getVariable());
+            }
+        }
+    }
+
+    for (Transition* edge : mRoot->edges()) {
+        if (heads.count(edge->getTarget()) != 0) {
+            continue;
+        }
+
+        for (auto& assignment : *llvm::cast<AssignTransition>(edge)) {
+            if (mLoopVariables.count(assignment.getVariable()) != 0) {
+                return false;
+            }
+        }
+    }
+
+    std::string prefix = (mRoot->getName() + "/").str();
+    for (Variable* variable : mLoopVariables) {
+        llvm::StringRef name = variable->getName();
+        name.consume_front(prefix);
+
+        Variable* next = mRoot->createLocal((name + "_next").str(), variable->getType());
+        mNextVariables[variable] = next;
+        mBaseVariables[next] = variable;
+    }
+
+    for (Location* head : mLoopHeads) {
+        Location* input = mRoot->createLocation();
+        mHeadInputs[head] = input;
+        mSplitHeads[input] = head;
+
+        // Loop variables which are not assigned on an edge keep their value.
+        llvm::SetVector<Variable*> headVariables;
+        for (Transition* edge : head->incoming()) {
+            for (auto& assignment : *llvm::cast<AssignTransition>(edge)) {
+                headVariables.insert(assignment.getVariable());
+            }
+        }
+
+        std::vector<Transition*> incoming(head->incoming_begin(), head->incoming_end());
+        for (Transition* edge : incoming) {
+            auto assign = llvm::cast<AssignTransition>(edge);
+            llvm::DenseMap<Variable*, ExprPtr> values;
+            for (auto& assignment : *assign) {
+                values[assignment.getVariable()] = assignment.getValue();
+            }
+
+            std::vector<VariableAssignment> newAssigns;
+            for (Variable* variable : headVariables) {
+                ExprPtr value = values.lookup(variable);
+                newAssigns.emplace_back(
+                    mNextVariables[variable], value != nullptr ? value : variable->getRefExpr()
+                );
+            }
+
+            mRoot->createAssignTransition(edge->getSource(), input, edge->getGuard(), newAssigns);
+            mRoot->disconnectEdge(edge);
+        }
+    }
+
+    mRoot->clearDisconnectedElements();
+
+    return true;
+}
+
+void KInductionImpl::createSegments()
+{
+    // Calculate a topological sort of the now acyclic automaton. As loop heads
+    // have no incoming edges anymore, they cannot be reached from the entry.
+    llvm::DenseMap<Location*, size_t> numPreds;
+    std::vector<Location*> worklist;
+    for (Location* loc : mRoot->nodes()) {
+        numPreds[loc] = loc->getNumIncoming();
+        if (loc->getNumIncoming() == 0) {
+            worklist.push_back(loc);
+        }
+    }
+
+    while (!worklist.empty()) {
+        Location* loc = worklist.back();
+        worklist.pop_back();
+
+        mLocNumbers[loc] = mTopo.size();
+        mTopo.push_back(loc);
+
+        for (Transition* edge : loc->outgoing()) {
+            if (--numPreds[edge->getTarget()] == 0) {
+                worklist.push_back(edge->getTarget());
+            }
+        }
+    }
+
+    assert(mTopo.size() == mRoot->getNumLocations() && "The split automaton must be acyclic!");
+
+    std::vector<Location*> sources;
+    std::vector<Location*> targets;
+
+    sources.push_back(mRoot->getEntry());
+    mCutPointIds[mRoot->getEntry()] = 0;
+    for (Location* head : mLoopHeads) {
+        mCutPointIds[head] = sources.size();
+        mCutPointIds[mHeadInputs[head]] = sources.size();
+        sources.push_back(head);
+        targets.push_back(mHeadInputs[head]);
+    }
+    mCutPointIds[mError] = sources.size();
+    targets.push_back(mError);
+
+    // Find the locations from which each target is reachable.
+    for (Location* target : targets) {
+        auto& canReach = mCanReach[target];
+        std::vector<Location*> stack = { target };
+        canReach.insert(target);
+
+        while (!stack.empty()) {
+            Location* loc = stack.back();
+            stack.pop_back();
+            for (Transition* edge : loc->incoming()) {
+                if (canReach.insert(edge->getSource()).second) {
+                    stack.push_back(edge->getSource());
+                }
+            }
+        }
+    }
+
+    for (Location* source : sources) {
+        for (Location* target : targets) {
+            if (mCanReach[target].count(source) == 0) {
+                continue;
+            }
+
+            KindSegment segment{source, target, mCutPointIds[source], mCutPointIds[target], {}};
+
+            // Collect the assignments of the edges which lie on a path between
+            // the source and the target.
+            llvm::DenseSet<Location*> visited;
+            std::vector<Location*> stack = { source };
+            visited.insert(source);
+            while (!stack.empty()) {
+                Location* loc = stack.back();
+                stack.pop_back();
+                for (Transition* edge : loc->outgoing()) {
+                    if (mCanReach[target].count(edge->getTarget()) == 0) {
+                        continue;
+                    }
+
+                    for (auto& assignment : *llvm::cast<AssignTransition>(edge)) {
+                        Variable* variable = assignment.getVariable();
+                        Variable* base = mBaseVariables.lookup(variable);
+                        segment.assigned.insert(base != nullptr ? base : variable);
+                    }
+
+                    if (visited.insert(edge->getTarget()).second) {
+                        stack.push_back(edge->getTarget());
+                    }
+                }
+            }
+
+            mSegments.emplace_back(std::move(segment));
+        }
+    }
+}
+
+Variable* KInductionImpl::getInstance(Variable* variable, unsigned step)
+{
+    if (mInstances.size() <= step) {
+        mInstances.resize(step + 1);
+    }
+
+    Variable*& instance = mInstances[step][variable];
+    if (instance == nullptr) {
+        auto& ctx = mSystem.getContext();
+        std::string base = variable->getName() + "@" + std::to_string(step);
+        std::string name = base;
+        unsigned cnt = 0;
+        while (ctx.getVariable(name) != nullptr) {
+            name = base + "_" + std::to_string(cnt++);
+        }
+
+        instance = ctx.createVariable(name, variable->getType());
+    }
+
+    return instance;
+}
+
+Variable* KInductionImpl::getProgramCounter(unsigned step)
+{
+    while (mProgramCounters.size() <= step) {
+        auto& ctx = mSystem.getContext();
+        std::string base = "__gazer_kind_pc@" + std::to_string(mProgramCounters.size());
+        std::string name = base;
+        unsigned cnt = 0;
+        while (ctx.getVariable(name) != nullptr) {
+            name = base + "_" + std::to_string(cnt++);
+        }
+
+        mProgramCounters.push_back(ctx.createVariable(name, IntType::Get(ctx)));
+    }
+
+    return mProgramCounters[step];
+}
+
+Variable* KInductionImpl::lookupStepVariable(Variable* variable, unsigned step)
+{
+    if (Variable* base = mBaseVariables.lookup(variable)) {
+        return this->getInstance(base, step);
+    }
+
+    if (mLoopVariables.count(variable) != 0) {
+        return this->getInstance(variable, step - 1);
+    }
+
+    return this->getInstance(variable, step);
+}
+
+ExprPtr KInductionImpl::encodeStep(unsigned step)
+{
+    StepInstantiation rewrite(*mExprBuilder, [this, step](Variable* variable) {
+        return this->lookupStepVariable(variable, step);
+    });
+
+    PathConditionCalculator pathConditions(
+        mTopo, *mExprBuilder,
+        [this](Location* loc) { return mLocNumbers.lookup(loc); },
+        [](CallTransition*) -> ExprPtr {
+            llvm_unreachable("Call transitions are not supported by k-induction!");
+        },
+        nullptr,
+        [&rewrite](Transition*, const ExprPtr& expr) {
+            return rewrite.walk(expr);
+        }
+    );
+    pathConditions.setEncoding(mSettings.encoding);
+
+    ExprPtr prevPc = this->getProgramCounter(step - 1)->getRefExpr();
+    ExprPtr currPc = this->getProgramCounter(step)->getRefExpr();
+
+    ExprVector segments;
+    for (KindSegment& segment : mSegments) {
+        ExprVector formula = {
+            mExprBuilder->Eq(prevPc, mExprBuilder->IntLit(segment.sourceId)),
+            mExprBuilder->Eq(currPc, mExprBuilder->IntLit(segment.targetId)),
+            pathConditions.encode(segment.source, segment.target)
+        };
+
+        // Variables not assigned in this segment keep their previous values.
+        for (Variable* variable : mStateVariables) {
+            if (segment.assigned.count(variable) == 0) {
+                formula.push_back(mExprBuilder->Eq(
+                    this->getInstance(variable, step)->getRefExpr(),
+                    this->getInstance(variable, step - 1)->getRefExpr()
+                ));
+            }
+        }
+
+        segments.push_back(mExprBuilder->And(formula));
+    }
+
+    return mExprBuilder->Or(segments);
+}
+
+ExprPtr KInductionImpl::instantiateInvariants(unsigned step)
+{
+    StepInstantiation rewrite(*mExprBuilder, [this, step](Variable* variable) {
+        return this->getInstance(variable, step);
+    });
+
+    ExprPtr pc = this->getProgramCounter(step)->getRefExpr();
+
+    ExprVector result;
+    for (auto& [head, invariants] : mInvariants) {
+        if (invariants.empty()) {
+            continue;
+        }
+
+        ExprVector instances;
+        for (const ExprPtr& invariant : invariants) {
+            instances.push_back(rewrite.walk(invariant));
+        }
+
+        result.push_back(mExprBuilder->Imply(
+            mExprBuilder->Eq(pc, mExprBuilder->IntLit(mCutPointIds[head])),
+            mExprBuilder->And(instances)
+        ));
+    }
+
+    return mExprBuilder->And(result);
+}
+
+void KInductionImpl::findInvariants()
+{
+    // Candidates are the facts proven by the abstract interpretation, and the
+    // lower and upper bounds of loop variables given by the constants they
+    // are assigned to. Those which are not inductive are removed until a
+    // fixpoint is reached.
+    for (Location* head : mLoopHeads) {
+        auto& candidates = mInvariants[head];
+        candidates = mAbstractInvariants.lookup(head);
+
+        for (Transition* edge : mHeadInputs[head]->incoming()) {
+            for (auto& assignment : *llvm::cast<AssignTransition>(edge)) {
+                ExprPtr lhs = mBaseVariables[assignment.getVariable()]->getRefExpr();
+                ExprPtr value = assignment.getValue();
+
+                if (llvm::isa<BvLiteralExpr>(value)) {
+                    candidates.push_back(mExprBuilder->BvSGtEq(lhs, value));
+                    candidates.push_back(mExprBuilder->BvSLtEq(lhs, value));
+                } else if (llvm::isa<IntLiteralExpr>(value)) {
+                    candidates.push_back(mExprBuilder->GtEq(lhs, value));
+                    candidates.push_back(mExprBuilder->LtEq(lhs, value));
+                }
+            }
+        }
+    }
+
+    auto solver = mSolverFactory.createSolver(mSystem.getContext());
+    solver->add(this->encodeStep(1));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        solver->push();
+        solver->add(this->instantiateInvariants(0));
+
+        StepInstantiation rewrite(*mExprBuilder, [this](Variable* variable) {
+            return this->getInstance(variable, 1);
+        });
+
+        for (Location* head : mLoopHeads) {
+            auto& candidates = mInvariants[head];
+            for (auto it = candidates.begin(); it != candidates.end();) {
+                solver->push();
+                solver->add(mExprBuilder->Eq(
+                    this->getProgramCounter(1)->getRefExpr(), mExprBuilder->IntLit(mCutPointIds[head])
+                ));
+                solver->add(mExprBuilder->Not(rewrite.walk(*it)));
+                auto status = solver->run();
+                solver->pop();
+
+                if (status != Solver::UNSAT) {
+                    it = candidates.erase(it);
+                    changed = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        solver->pop();
+    }
+
+    unsigned numInvariants = 0;
+    for (auto& [head, invariants] : mInvariants) {
+        numInvariants += invariants.size();
+    }
+    llvm::outs() << "Found " << numInvariants << " inductive invariants.\n";
+}
+
+Location* KInductionImpl::getOriginalLocation(Location* loc)
+{
+    if (Location* head = mSplitHeads.lookup(loc)) {
+        loc = head;
+    }
+
+    Location* origLoc = mInlinedLocations.lookup(loc);
+    return origLoc != nullptr ? origLoc : loc;
+}
+
+static bool isTrueInModel(Model& model, const ExprPtr& expr)
+{
+    auto lit = llvm::dyn_cast_or_null<BoolLiteralExpr>(model.evaluate(expr).get());
+    return lit != nullptr && lit->isTrue();
+}
+
+auto KInductionImpl::createFailResult(Model& model, unsigned bound)
+    -> std::unique_ptr<VerificationResult>
+{
+    std::unique_ptr<Trace> trace;
+    if (mSettings.trace) {
+        std::vector<Location*> states;
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        states.push_back(this->getOriginalLocation(mRoot->getEntry()));
+
+        for (unsigned k = 1; k <= bound; ++k) {
+            auto source = llvm::cast<IntLiteralExpr>(model.evaluate(getProgramCounter(k - 1)->getRefExpr()));
+            auto target = llvm::cast<IntLiteralExpr>(model.evaluate(getProgramCounter(k)->getRefExpr()));
+
+            auto segment = std::find_if(mSegments.begin(), mSegments.end(), [&](KindSegment& s) {
+                return s.sourceId == source->getValue() && s.targetId == target->getValue();
+            });
+            assert(segment != mSegments.end() && "The model must follow an existing segment!");
+
+            StepInstantiation rewrite(*mExprBuilder, [this, k](Variable* variable) {
+                return this->lookupStepVariable(variable, k);
+            });
+
+            // Follow the edges whose guard and assignments hold in the model.
+            Location* loc = segment->source;
+            while (loc != segment->target) {
+                AssignTransition* next = nullptr;
+                for (Transition* edge : loc->outgoing()) {
+                    if (mCanReach[segment->target].count(edge->getTarget()) == 0
+                        || !isTrueInModel(model, rewrite.walk(edge->getGuard()))
+                    ) {
+                        continue;
+                    }
+
+                    auto assign = llvm::cast<AssignTransition>(edge);
+                    bool holds = std::all_of(assign->begin(), assign->end(), [&](auto& assignment) {
+                        return assignment.getValue()->getKind() == Expr::Undef
+                            || isTrueInModel(model, rewrite.walk(mExprBuilder->Eq(
+                                assignment.getVariable()->getRefExpr(), assignment.getValue()
+                            )));
+                    });
+
+                    if (holds) {
+                        next = assign;
+                        break;
+                    }
+                }
+
+                assert(next != nullptr && "The model must satisfy a path of the segment!");
+
+                std::vector<VariableAssignment> traceAction;
+                for (const VariableAssignment& assignment : *next) {
+                    Variable* variable = assignment.getVariable();
+                    if (Variable* base = mBaseVariables.lookup(variable)) {
+                        if (assignment.getValue() == base->getRefExpr()) {
+                            // Skip the copies added for unchanged loop variables.
+                            continue;
+                        }
+                        variable = base;
+                    }
+
+                    Variable* origVariable = mInlinedVariables.lookup(variable);
+                    if (origVariable == nullptr) {
+                        origVariable = variable;
+                    }
+
+                    ExprRef<AtomicExpr> value = model.evaluate(
+                        rewrite.walk(assignment.getVariable()->getRefExpr())
+                    );
+                    if (value == nullptr) {
+                        value = UndefExpr::Get(variable->getType());
+                    }
+
+                    traceAction.emplace_back(origVariable, value);
+                }
+
+                actions.push_back(traceAction);
+                loc = next->getTarget();
+                states.push_back(this->getOriginalLocation(loc));
+            }
+        }
+
+        trace = mTraceBuilder.build(states, actions);
+    } else {
+        trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    ExprRef<AtomicExpr> errorExpr = model.evaluate(getInstance(mErrorFieldVariable, bound)->getRefExpr());
+    assert(!errorExpr->isUndef() && "The error field must be present in the model as a literal expression!");
+
+    switch (errorExpr->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return VerificationResult::CreateFail(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue(), std::move(trace));
+        case Type::IntTypeID:
+            return VerificationResult::CreateFail(llvm::cast<IntLiteralExpr>(errorExpr)->getValue(), std::move(trace));
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+}
+
+auto KInduction::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    KInductionImpl impl(system, mSolverFactory, traceBuilder, mSettings);
+    return impl.check();
+}
@@ -0,0 +1,345 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the verification portfolio.
+///
+/// Each engine gets its own context, system clone and solver factory, and runs
+/// on its own thread. Solvers are created through a factory which can be
+/// cancelled: after cancellation, running queries are interrupted and new
+/// ones return UNKNOWN immediately, which makes the in-process engines return
+/// an inconclusive result without any engine-specific support. Engines which
+/// do not (only) rely on solvers are stopped through their interrupt() method.
+///
+/// Counterexamples are recorded in terms of the clone, and translated back to
+/// the original system on the calling thread after the race is over.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/Portfolio.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/GazerContext.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Core/Solver/Model.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <condition_variable>
+
+using namespace gazer;
+
+namespace
+{
+
+class CancellableSolverFactory;
+
+/// Forwards each request to a solver created by the wrapped factory.
+class CancellableSolver : public Solver
+{
+public:
+    CancellableSolver(std::unique_ptr<Solver> solver, CancellableSolverFactory& factory)
+        : Solver(solver->getContext()), mSolver(std::move(solver)), mFactory(factory)
+    {}
+
+    void printStats(llvm::raw_ostream& os) override { mSolver->printStats(os); }
+    void dump(llvm::raw_ostream& os) override { mSolver->dump(os); }
+
+    SolverStatus run() override;
+    std::unique_ptr<Model> getModel() override { return mSolver->getModel(); }
+
+    void reset() override { mSolver->reset(); }
+
+    void push() override { mSolver->push(); }
+    void pop() override { mSolver->pop(); }
+
+    void interrupt() override { mSolver->interrupt(); }
+
+protected:
+    void addConstraint(ExprPtr expr) override { mSolver->add(expr); }
+
+private:
+    std::unique_ptr<Solver> mSolver;
+    CancellableSolverFactory& mFactory;
+};
+
+class CancellableSolverFactory : public SolverFactory
+{
+public:
+    CancellableSolverFactory(SolverFactory& factory, std::mutex& createMutex)
+        : mFactory(factory), mCreateMutex(createMutex)
+    {}
+
+    std::unique_ptr<Solver> createSolver(GazerContext& context) override
+    {
+        std::lock_guard<std::mutex> lock(mCreateMutex);
+        return std::make_unique<CancellableSolver>(mFactory.createSolver(context), *this);
+    }
+
+    /// Interrupts the running queries and makes future ones return UNKNOWN.
+    void cancel()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCancelled = true;
+
+        // An interrupt issued before a solver enters its search is lost,
+        // thus the running queries are interrupted until they all return.
+        while (!mRunning.empty()) {
+            for (Solver* solver : mRunning) {
+                solver->interrupt();
+            }
+            mRunEnded.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    bool beginRun(Solver* solver)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mCancelled) {
+            return false;
+        }
+
+        mRunning.insert(solver);
+        return true;
+    }
+
+    void endRun(Solver* solver)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning.erase(solver);
+        mRunEnded.notify_all();
+    }
+
+private:
+    SolverFactory& mFactory;
+    std::mutex& mCreateMutex;
+
+    std::mutex mMutex;
+    std::condition_variable mRunEnded;
+    bool mCancelled = false;
+    llvm::SmallPtrSet<Solver*, 4> mRunning;
+};
+
+Solver::SolverStatus CancellableSolver::run()
+{
+    if (!mFactory.beginRun(mSolver.get())) {
+        return UNKNOWN;
+    }
+
+    auto status = mSolver->run();
+    mFactory.endRun(mSolver.get());
+
+    return status;
+}
+
+struct EngineRun
+{
+    EngineRun(std::string name, SolverFactory& factory, std::mutex& createMutex)
+        : name(std::move(name)), solverFactory(factory, createMutex)
+    {}
+
+    std::string name;
+    GazerContext context;
+    CloneSystemResult clone;
+    CancellableSolverFactory solverFactory;
+    std::unique_ptr<VerificationAlgorithm> engine;
+    CfaTraceRecorder traceBuilder;
+
+    std::unique_ptr<VerificationResult> result;
+    std::chrono::milliseconds time{0};
+    bool cancelled = false;
+};
+
+bool isConclusive(const VerificationResult& result)
+{
+    return result.isSuccess() || result.isFail();
+}
+
+/// Ranks inconclusive results, the most informative one has the lowest rank.
+unsigned getInconclusiveRank(VerificationResult::Status status)
+{
+    switch (status) {
+        case VerificationResult::BoundReached: return 0;
+        case VerificationResult::Timeout: return 1;
+        case VerificationResult::Unknown: return 2;
+        case VerificationResult::InternalError: return 3;
+        case VerificationResult::Success:
+        case VerificationResult::Fail:
+            break;
+    }
+
+    llvm_unreachable("Conclusive results have no rank!");
+}
+
+llvm::StringRef getStatusName(VerificationResult::Status status)
+{
+    switch (status) {
+        case VerificationResult::Success: return "Success";
+        case VerificationResult::Fail: return "Fail";
+        case VerificationResult::Timeout: return "Timeout";
+        case VerificationResult::Unknown: return "Unknown";
+        case VerificationResult::BoundReached: return "BoundReached";
+        case VerificationResult::InternalError: return "InternalError";
+    }
+
+    llvm_unreachable("Unknown verification result status!");
+}
+
+} // end anonymous namespace
+
+void Portfolio::addEngine(std::string name, EngineBuilder builder)
+{
+    mEngines.emplace_back(std::move(name), std::move(builder));
+}
+
+void Portfolio::interrupt()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mInterrupt) {
+        mInterrupt();
+    }
+}
+
+auto Portfolio::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    if (mEngines.empty()) {
+        return VerificationResult::CreateInternalError("The verification portfolio is empty.");
+    }
+
+    // Clone the system for each engine. This is the only step touching the
+    // expressions of the input system until the race is over.
+    std::mutex createMutex;
+    std::vector<std::unique_ptr<EngineRun>> runs;
+    for (auto& [name, builder] : mEngines) {
+        auto run = std::make_unique<EngineRun>(name, mSolverFactory, createMutex);
+        run->clone = CloneAutomataSystem(system, run->context);
+        run->engine = builder(run->solverFactory);
+        runs.push_back(std::move(run));
+    }
+
+    std::mutex mutex;
+    EngineRun* winner = nullptr;
+
+    auto cancelAll = [&runs](EngineRun* except) {
+        for (auto& other : runs) {
+            if (other.get() != except && other->result == nullptr) {
+                other->cancelled = true;
+                other->engine->interrupt();
+                other->solverFactory.cancel();
+            }
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mInterrupt = [&mutex, &cancelAll]() {
+            std::lock_guard<std::mutex> runLock(mutex);
+            cancelAll(nullptr);
+        };
+    }
+
+    llvm::outs() << "Running a portfolio of " << runs.size() << " engines.\n";
+
+    // The engines report their progress on the standard output. Make it
+    // unbuffered, so the messages of different engines are not torn apart
+    // in the middle of the buffer.
+    llvm::outs().flush();
+    llvm::outs().SetUnbuffered();
+
+    llvm::ThreadPool pool(runs.size());
+    for (auto& run : runs) {
+        pool.async([&mutex, &winner, &cancelAll](EngineRun* current) {
+            Stopwatch<> sw;
+            sw.start();
+            auto result = current->engine->check(*current->clone.system, current->traceBuilder);
+            sw.stop();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            current->time = sw.elapsed();
+            current->result = std::move(result);
+
+            if (winner == nullptr && !current->cancelled && isConclusive(*current->result)) {
+                winner = current;
+                cancelAll(current);
+            }
+        }, run.get());
+    }
+    pool.wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mInterrupt = nullptr;
+    }
+
+    llvm::outs().SetBuffered();
+
+    if (mSettings.printTimes) {
+        llvm::outs() << "--------- Portfolio ---------\n";
+        for (auto& run : runs) {
+            llvm::outs() << "  " << llvm::left_justify(run->name, 24) << " "
+                << llvm::left_justify(getStatusName(run->result->getStatus()), 14) << " "
+                << llvm::format_decimal(run->time.count(), 8) << "ms";
+            if (run.get() == winner) {
+                llvm::outs() << "  (winner)";
+            } else if (run->cancelled) {
+                llvm::outs() << "  (cancelled)";
+            }
+            llvm::outs() << "\n";
+        }
+    }
+
+    if (winner == nullptr) {
+        // Return the most informative inconclusive result.
+        EngineRun* best = runs.front().get();
+        for (auto& run : runs) {
+            if (getInconclusiveRank(run->result->getStatus()) < getInconclusiveRank(best->result->getStatus())) {
+                best = run.get();
+            }
+        }
+
+        return std::move(best->result);
+    }
+
+    llvm::outs() << "Verdict found by engine '" << winner->name << "'.\n";
+
+    auto fail = llvm::dyn_cast<FailResult>(winner->result.get());
+    if (fail == nullptr) {
+        return std::move(winner->result);
+    }
+
+    // The counterexample refers to the clone, rebuild it for the original system.
+    std::unique_ptr<Trace> trace = nullptr;
+    if (mSettings.trace && winner->traceBuilder.isRecorded()) {
+        auto& states = winner->traceBuilder.mStates;
+        auto& actions = winner->traceBuilder.mActions;
+
+        TranslateClonedTrace(winner->clone, system.getContext(), states, actions);
+        trace = traceBuilder.build(states, actions);
+    }
+
+    auto result = VerificationResult::CreateFail(fail->getErrorID(), std::move(trace));
+    for (FailResult& other : fail->other_failures()) {
+        llvm::cast<FailResult>(*result).addFailure(std::make_unique<FailResult>(other.getErrorID()));
+    }
+
+    return result;
+}
@@ -0,0 +1,651 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Abstract states are conjunctions of predicate literals. The successor of a
+// state is computed with Cartesian abstraction: a predicate is true (false)
+// in the successor if the state and the transition imply it (its negation).
+//
+// Refinement computes the weakest precondition of 'False' backwards along an
+// infeasible abstract path. Havocs are handled by replacing the havoced
+// variable with a fresh symbol, which is universally quantified in the
+// predicate: when an abstract post is computed over the same havoc edge,
+// these symbols are instantiated with the new value of the variable. As the
+// negation of such a predicate is existential, negative literals containing
+// havoc symbols are not used as assumptions.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/PredicateAbstraction.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Core/Solver/Model.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <deque>
+
+using namespace gazer;
+
+namespace
+{
+
+/// A node of the abstract reachability graph.
+struct ArgNode
+{
+    unsigned id;
+    Location* location;
+
+    /// Sorted literals of the abstract state. Predicate i is encoded
+    /// as i + 1 if it holds, and as -(i + 1) if it does not.
+    llvm::SmallVector<int, 8> literals;
+
+    ArgNode* parent;
+    AssignTransition* edge;
+
+    /// Returns true if the concrete states of this node contain those of \p other.
+    bool covers(const ArgNode& other) const
+    {
+        return std::includes(
+            other.literals.begin(), other.literals.end(), literals.begin(), literals.end()
+        );
+    }
+};
+
+struct CegarStats
+{
+    unsigned Iterations = 0;
+    unsigned NumArgNodes = 0;
+    unsigned NumCoveredNodes = 0;
+    unsigned NumSolverCalls = 0;
+};
+
+class PredicateAbstractionImpl
+{
+public:
+    PredicateAbstractionImpl(
+        AutomataSystem& system,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        CegarSettings settings
+    );
+
+    std::unique_ptr<VerificationResult> check();
+
+private:
+    /// Explores the abstract state space with the current precision.
+    /// Returns the first abstract error node, or nullptr if none is reachable.
+    ArgNode* buildArg();
+
+    std::unique_ptr<ArgNode> computePost(ArgNode* node, AssignTransition* edge);
+
+    /// Checks the feasibility of the abstract path ending in \p errorNode.
+    std::unique_ptr<VerificationResult> checkCounterexample(const std::vector<ArgNode*>& path);
+
+    /// Adds new predicates to rule out the given infeasible path.
+    /// Returns false if no new predicates were found.
+    bool refine(const std::vector<ArgNode*>& path);
+    bool addPredicate(const ExprPtr& expr, Location* loc);
+    void collectAtoms(const ExprPtr& expr, llvm::SmallVectorImpl<ExprPtr>& atoms);
+    bool hasHavocSymbol(const ExprPtr& expr);
+
+    llvm::ArrayRef<unsigned> getPrecision(Location* loc);
+    ExprPtr getLiteralExpr(int literal);
+    Variable* getPrimed(Variable* variable);
+    Variable* getHavocSymbol(Transition* edge, Variable* variable);
+    Variable* createVariable(const std::string& base, Type& type);
+
+    Location* getOriginalLocation(Location* loc);
+    Solver::SolverStatus runSolver(Solver& solver);
+
+private:
+    AutomataSystem& mSystem;
+    SolverFactory& mSolverFactory;
+    CfaTraceBuilder& mTraceBuilder;
+    CegarSettings mSettings;
+    std::unique_ptr<ExprBuilder> mExprBuilder;
+
+    Cfa* mRoot = nullptr;
+    Location* mError = nullptr;
+    Variable* mErrorFieldVariable = nullptr;
+    llvm::DenseMap<Location*, Location*> mInlinedLocations;
+    llvm::DenseMap<Variable*, Variable*> mInlinedVariables;
+
+    // Precision
+    ExprVector mPredicates;
+    std::vector<bool> mQuantified;
+    llvm::DenseMap<Expr*, unsigned> mPredicateIds;
+    std::vector<unsigned> mGlobalPrecision;
+    llvm::DenseMap<Location*, std::vector<unsigned>> mLocalPrecision;
+
+    /// Symbols standing for the values of a havoced variable on a given edge.
+    llvm::DenseMap<Transition*, std::vector<std::pair<Variable*, Variable*>>> mHavocSymbols;
+    llvm::DenseSet<Variable*> mHavocSymbolSet;
+    llvm::DenseMap<Variable*, Variable*> mPrimedVariables;
+
+    // Abstract reachability graph
+    std::vector<std::unique_ptr<ArgNode>> mNodes;
+    std::unique_ptr<Solver> mSolver;
+
+    CegarStats mStats;
+};
+
+} // end anonymous namespace
+
+PredicateAbstractionImpl::PredicateAbstractionImpl(
+    AutomataSystem& system,
+    SolverFactory& solverFactory,
+    CfaTraceBuilder& traceBuilder,
+    CegarSettings settings
+) : mSystem(system), mSolverFactory(solverFactory),
+    mTraceBuilder(traceBuilder), mSettings(settings)
+{
+    if (mSettings.simplifyExpr) {
+        mExprBuilder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        mExprBuilder = CreateExprBuilder(system.getContext());
+    }
+}
+
+auto PredicateAbstractionImpl::check() -> std::unique_ptr<VerificationResult>
+{
+    mRoot = mSystem.getMainAutomaton();
+    assert(mRoot != nullptr && "The main automaton must exist!");
+
+    auto result = TransformRecursiveToCyclic(mRoot);
+    mError = result.errorLocation;
+    mErrorFieldVariable = result.errorFieldVariable;
+    mInlinedLocations = std::move(result.inlinedLocations);
+    mInlinedVariables = std::move(result.inlinedVariables);
+
+    for (Transition* edge : mRoot->edges()) {
+        if (llvm::isa<CallTransition>(edge)) {
+            llvm::outs() << "Cannot run predicate abstraction on automata with non-tail-recursive calls.\n";
+            return VerificationResult::CreateUnknown();
+        }
+    }
+
+    mSolver = mSolverFactory.createSolver(mSystem.getContext());
+
+    std::unique_ptr<VerificationResult> verdict;
+    while (verdict == nullptr) {
+        mStats.Iterations++;
+        if (mSettings.maxIterations != 0 && mStats.Iterations > mSettings.maxIterations) {
+            llvm::outs() << "Maximum number of iterations is reached.\n";
+            verdict = VerificationResult::CreateUnknown();
+            break;
+        }
+
+        llvm::outs() << "Iteration " << mStats.Iterations << "\n";
+        llvm::outs() << "  Building abstract reachability graph with "
+            << mPredicates.size() << " predicates...\n";
+
+        ArgNode* errorNode = this->buildArg();
+        llvm::outs() << "    Nodes: " << mNodes.size() << "\n";
+
+        if (errorNode == nullptr) {
+            llvm::outs() << "  Error location is unreachable in the abstraction.\n";
+            verdict = VerificationResult::CreateSuccess();
+            break;
+        }
+
+        std::vector<ArgNode*> path;
+        for (ArgNode* node = errorNode; node != nullptr; node = node->parent) {
+            path.push_back(node);
+        }
+        std::reverse(path.begin(), path.end());
+
+        llvm::outs() << "  Checking abstract counterexample of length " << path.size() - 1 << "...\n";
+        verdict = this->checkCounterexample(path);
+        if (verdict != nullptr) {
+            break;
+        }
+
+        llvm::outs() << "  Counterexample is spurious, refining the precision.\n";
+        if (!this->refine(path)) {
+            llvm::outs() << "  Refinement could not find new predicates.\n";
+            verdict = VerificationResult::CreateUnknown();
+        }
+    }
+
+    if (mSettings.printSolverStats) {
+        llvm::outs() << "--------- Statistics ---------\n";
+        llvm::outs() << "Iterations: " << mStats.Iterations << "\n";
+        llvm::outs() << "Predicates: " << mPredicates.size() << "\n";
+        llvm::outs() << "Total ARG nodes: " << mStats.NumArgNodes << "\n";
+        llvm::outs() << "Covered ARG nodes: " << mStats.NumCoveredNodes << "\n";
+        llvm::outs() << "Solver calls: " << mStats.NumSolverCalls << "\n";
+        llvm::outs() << "------------------------------\n";
+    }
+
+    return verdict;
+}
+
+auto PredicateAbstractionImpl::buildArg() -> ArgNode*
+{
+    mNodes.clear();
+
+    auto root = std::make_unique<ArgNode>();
+    root->id = 0;
+    root->location = mRoot->getEntry();
+    root->parent = nullptr;
+    root->edge = nullptr;
+
+    std::deque<ArgNode*> worklist = { root.get() };
+    mNodes.emplace_back(std::move(root));
+
+    // Expanded nodes at each location, these may cover later ones.
+    llvm::DenseMap<Location*, std::vector<ArgNode*>> expanded;
+
+    while (!worklist.empty()) {
+        ArgNode* node;
+        if (mSettings.search == CegarSearch::Bfs) {
+            node = worklist.front();
+            worklist.pop_front();
+        } else {
+            node = worklist.back();
+            worklist.pop_back();
+        }
+
+        auto& candidates = expanded[node->location];
+        bool covered = std::any_of(candidates.begin(), candidates.end(), [node](ArgNode* other) {
+            return other->covers(*node);
+        });
+
+        if (covered) {
+            mStats.NumCoveredNodes++;
+            continue;
+        }
+        candidates.push_back(node);
+
+        for (Transition* edge : node->location->outgoing()) {
+            auto child = this->computePost(node, llvm::cast<AssignTransition>(edge));
+            if (child == nullptr) {
+                continue;
+            }
+
+            child->id = mNodes.size();
+            ArgNode* ptr = child.get();
+            mNodes.emplace_back(std::move(child));
+            mStats.NumArgNodes++;
+
+            if (ptr->location == mError) {
+                return ptr;
+            }
+
+            worklist.push_back(ptr);
+        }
+    }
+
+    return nullptr;
+}
+
+auto PredicateAbstractionImpl::computePost(ArgNode* node, AssignTransition* edge)
+    -> std::unique_ptr<ArgNode>
+{
+    // Predicates containing havoc symbols are universally quantified over
+    // them. Negated, they would be existential, so such literals are dropped.
+    ExprVector state;
+    for (int literal : node->literals) {
+        if (literal < 0 && mQuantified[-literal - 1]) {
+            continue;
+        }
+        state.push_back(this->getLiteralExpr(literal));
+    }
+
+    // Havoc symbols of this edge may stand for the new value of the variable,
+    // so each of them is instantiated with it, one at a time.
+    for (auto& [symbol, variable] : mHavocSymbols.lookup(edge)) {
+        VariableExprRewrite instantiate(*mExprBuilder);
+        instantiate[symbol] = this->getPrimed(variable)->getRefExpr();
+
+        for (int literal : node->literals) {
+            if (literal > 0 && mQuantified[literal - 1]) {
+                state.push_back(instantiate.walk(mPredicates[literal - 1]));
+            }
+        }
+    }
+
+    // The assignments of an edge are sequential, later assignments may read
+    // the values set by earlier ones. Thus each value is rewritten to use the
+    // current values of the variables, and each assignment gets a primed copy.
+    VariableExprRewrite next(*mExprBuilder);
+    ExprVector transition = { edge->getGuard() };
+    for (const VariableAssignment& assignment : *edge) {
+        ExprPtr primed = this->getPrimed(assignment.getVariable())->getRefExpr();
+
+        if (assignment.getValue()->getKind() != Expr::Undef) {
+            transition.push_back(mExprBuilder->Eq(primed, next.walk(assignment.getValue())));
+        }
+
+        next[assignment.getVariable()] = primed;
+    }
+
+    mSolver->push();
+    mSolver->add(mExprBuilder->And(state));
+    mSolver->add(mExprBuilder->And(transition));
+
+    if (this->runSolver(*mSolver) == Solver::UNSAT) {
+        mSolver->pop();
+        return nullptr;
+    }
+
+    auto child = std::make_unique<ArgNode>();
+    child->location = edge->getTarget();
+    child->parent = node;
+    child->edge = edge;
+
+    for (unsigned predIdx : this->getPrecision(edge->getTarget())) {
+        ExprPtr pred = next.walk(mPredicates[predIdx]);
+
+        mSolver->push();
+        mSolver->add(mExprBuilder->Not(pred));
+        auto status = this->runSolver(*mSolver);
+        mSolver->pop();
+
+        if (status == Solver::UNSAT) {
+            child->literals.push_back(predIdx + 1);
+            continue;
+        }
+
+        mSolver->push();
+        mSolver->add(pred);
+        status = this->runSolver(*mSolver);
+        mSolver->pop();
+
+        if (status == Solver::UNSAT) {
+            child->literals.push_back(-static_cast<int>(predIdx + 1));
+        }
+    }
+
+    mSolver->pop();
+
+    llvm::sort(child->literals);
+    return child;
+}
+
+auto PredicateAbstractionImpl::checkCounterexample(const std::vector<ArgNode*>& path)
+    -> std::unique_ptr<VerificationResult>
+{
+    // Build the path formula in SSA form.
+    VariableExprRewrite current(*mExprBuilder);
+    ExprVector formula;
+    std::vector<std::vector<std::pair<Variable*, Variable*>>> instances;
+
+    for (size_t i = 1; i < path.size(); ++i) {
+        AssignTransition* edge = path[i]->edge;
+        formula.push_back(current.walk(edge->getGuard()));
+
+        // Assignments are sequential, so each one reads the instances
+        // created by the previous assignments of the same edge.
+        auto& stepInstances = instances.emplace_back();
+        for (const VariableAssignment& assignment : *edge) {
+            Variable* variable = assignment.getVariable();
+            Variable* instance = this->createVariable(
+                variable->getName() + "@" + std::to_string(i), variable->getType()
+            );
+
+            if (assignment.getValue()->getKind() != Expr::Undef) {
+                formula.push_back(mExprBuilder->Eq(
+                    instance->getRefExpr(), current.walk(assignment.getValue())
+                ));
+            }
+            stepInstances.emplace_back(variable, instance);
+            current[variable] = instance->getRefExpr();
+        }
+    }
+
+    auto solver = mSolverFactory.createSolver(mSystem.getContext());
+    solver->add(mExprBuilder->And(formula));
+
+    auto status = this->runSolver(*solver);
+    if (status == Solver::UNSAT) {
+        return nullptr;
+    }
+
+    if (status == Solver::UNKNOWN) {
+        return VerificationResult::CreateUnknown();
+    }
+
+    llvm::outs() << "  Counterexample is feasible.\n";
+    auto model = solver->getModel();
+
+    std::unique_ptr<Trace> trace;
+    if (mSettings.trace) {
+        std::vector<Location*> states;
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        states.push_back(this->getOriginalLocation(path[0]->location));
+        for (size_t i = 1; i < path.size(); ++i) {
+            std::vector<VariableAssignment> traceAction;
+            for (auto& [variable, instance] : instances[i - 1]) {
+                Variable* origVariable = mInlinedVariables.lookup(variable);
+                if (origVariable == nullptr) {
+                    origVariable = variable;
+                }
+
+                ExprRef<AtomicExpr> value = model->evaluate(instance->getRefExpr());
+                if (value == nullptr) {
+                    value = UndefExpr::Get(variable->getType());
+                }
+
+                traceAction.emplace_back(origVariable, value);
+            }
+
+            actions.push_back(traceAction);
+            states.push_back(this->getOriginalLocation(path[i]->location));
+        }
+
+        trace = mTraceBuilder.build(states, actions);
+    } else {
+        trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    ExprRef<AtomicExpr> errorExpr = model->evaluate(current.walk(mErrorFieldVariable->getRefExpr()));
+    assert(!errorExpr->isUndef() && "The error field must be present in the model as a literal expression!");
+
+    switch (errorExpr->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return VerificationResult::CreateFail(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue(), std::move(trace));
+        case Type::IntTypeID:
+            return VerificationResult::CreateFail(llvm::cast<IntLiteralExpr>(errorExpr)->getValue(), std::move(trace));
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+}
+
+bool PredicateAbstractionImpl::refine(const std::vector<ArgNode*>& path)
+{
+    // Calculate wp(e_i ... e_n, False) for each position i of the path.
+    ExprPtr wp = mExprBuilder->False();
+    bool changed = false;
+
+    for (size_t i = path.size() - 1; i > 0; --i) {
+        AssignTransition* edge = path[i]->edge;
+
+        // The assignments are sequential, so they are substituted one at a time,
+        // starting with the last one.
+        for (const VariableAssignment& assignment : llvm::reverse(*edge)) {
+            Variable* variable = assignment.getVariable();
+
+            VariableExprRewrite substitute(*mExprBuilder);
+            if (assignment.getValue()->getKind() == Expr::Undef) {
+                substitute[variable] = this->getHavocSymbol(edge, variable)->getRefExpr();
+            } else {
+                substitute[variable] = assignment.getValue();
+            }
+
+            wp = substitute.walk(wp);
+        }
+
+        wp = mExprBuilder->Imply(edge->getGuard(), wp);
+
+        Location* loc = path[i - 1]->location;
+        if (mSettings.predSplit == CegarPredSplit::Whole) {
+            changed |= this->addPredicate(wp, loc);
+        } else {
+            llvm::SmallVector<ExprPtr, 8> atoms;
+            this->collectAtoms(wp, atoms);
+            for (const ExprPtr& atom : atoms) {
+                changed |= this->addPredicate(atom, loc);
+            }
+        }
+    }
+
+    return changed;
+}
+
+bool PredicateAbstractionImpl::addPredicate(const ExprPtr& expr, Location* loc)
+{
+    if (llvm::isa<BoolLiteralExpr>(expr)) {
+        return false;
+    }
+
+    auto [it, inserted] = mPredicateIds.try_emplace(expr.get(), mPredicates.size());
+    if (inserted) {
+        mPredicates.push_back(expr);
+        mQuantified.push_back(this->hasHavocSymbol(expr));
+    }
+
+    unsigned id = it->second;
+    if (mSettings.precision == CegarPrecision::Global) {
+        if (inserted) {
+            mGlobalPrecision.push_back(id);
+        }
+        return inserted;
+    }
+
+    auto& local = mLocalPrecision[loc];
+    if (llvm::is_contained(local, id)) {
+        return false;
+    }
+
+    local.push_back(id);
+    return true;
+}
+
+void PredicateAbstractionImpl::collectAtoms(const ExprPtr& expr, llvm::SmallVectorImpl<ExprPtr>& atoms)
+{
+    switch (expr->getKind()) {
+        case Expr::Not:
+        case Expr::And:
+        case Expr::Or:
+        case Expr::Imply:
+            for (const ExprPtr& op : llvm::cast<NonNullaryExpr>(expr)->operands()) {
+                this->collectAtoms(op, atoms);
+            }
+            break;
+        default:
+            atoms.push_back(expr);
+    }
+}
+
+bool PredicateAbstractionImpl::hasHavocSymbol(const ExprPtr& expr)
+{
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+        return mHavocSymbolSet.count(&varRef->getVariable()) != 0;
+    }
+
+    if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+        return llvm::any_of(nn->operands(), [this](const ExprPtr& op) {
+            return this->hasHavocSymbol(op);
+        });
+    }
+
+    return false;
+}
+
+llvm::ArrayRef<unsigned> PredicateAbstractionImpl::getPrecision(Location* loc)
+{
+    if (mSettings.precision == CegarPrecision::Global) {
+        return mGlobalPrecision;
+    }
+
+    return mLocalPrecision[loc];
+}
+
+ExprPtr PredicateAbstractionImpl::getLiteralExpr(int literal)
+{
+    if (literal > 0) {
+        return mPredicates[literal - 1];
+    }
+
+    return mExprBuilder->Not(mPredicates[-literal - 1]);
+}
+
+Variable* PredicateAbstractionImpl::getPrimed(Variable* variable)
+{
+    Variable*& primed = mPrimedVariables[variable];
+    if (primed == nullptr) {
+        primed = this->createVariable(variable->getName() + "'", variable->getType());
+    }
+
+    return primed;
+}
+
+Variable* PredicateAbstractionImpl::getHavocSymbol(Transition* edge, Variable* variable)
+{
+    auto& symbols = mHavocSymbols[edge];
+    for (auto& [symbol, havoced] : symbols) {
+        if (havoced == variable) {
+            return symbol;
+        }
+    }
+
+    Variable* symbol = this->createVariable("__gazer_havoc_" + variable->getName(), variable->getType());
+    symbols.emplace_back(symbol, variable);
+    mHavocSymbolSet.insert(symbol);
+
+    return symbol;
+}
+
+Variable* PredicateAbstractionImpl::createVariable(const std::string& base, Type& type)
+{
+    auto& ctx = mSystem.getContext();
+
+    std::string name = base;
+    unsigned cnt = 0;
+    while (ctx.getVariable(name) != nullptr) {
+        name = base + "_" + std::to_string(cnt++);
+    }
+
+    return ctx.createVariable(name, type);
+}
+
+Location* PredicateAbstractionImpl::getOriginalLocation(Location* loc)
+{
+    Location* origLoc = mInlinedLocations.lookup(loc);
+    return origLoc != nullptr ? origLoc : loc;
+}
+
+Solver::SolverStatus PredicateAbstractionImpl::runSolver(Solver& solver)
+{
+    mStats.NumSolverCalls++;
+    return solver.run();
+}
+
+auto PredicateAbstraction::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    PredicateAbstractionImpl impl(system, mSolverFactory, traceBuilder, mSettings);
+    return impl.check();
+}
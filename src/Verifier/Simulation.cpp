@@ -0,0 +1,712 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Expressions are not evaluated through the ExprEvaluator interface, as it
+// creates literal expressions in the (not thread-safe) GazerContext. Instead,
+// the system is compiled into an immutable program over APInt values first,
+// which may then be executed by several threads at once. Variables of each
+// automaton are numbered densely, so a stack frame is a plain vector.
+//
+// Mathematical integers are represented on 64 bits. As a simulation must
+// never report a spurious error, runs in which an integer operation
+// overflows or a division by zero occurs are discarded. Systems using
+// floating-point, array or tuple expressions are not simulated.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/Simulation.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <atomic>
+#include <mutex>
+#include <random>
+
+using namespace gazer;
+
+namespace
+{
+
+/// A compiled expression.
+struct SimNode
+{
+    Expr::ExprKind kind;
+    unsigned width;
+    bool isInt;
+
+    /// The variable index of references, or the offset of extractions.
+    unsigned index = 0;
+    llvm::APInt value;
+    llvm::SmallVector<const SimNode*, 2> operands;
+};
+
+/// A compiled assignment, a null value stands for a nondeterministic one.
+struct SimAssign
+{
+    Variable* variable;
+    unsigned index;
+    const SimNode* value;
+};
+
+struct SimCfa;
+
+struct SimEdge
+{
+    Location* target;
+    const SimNode* guard;
+    std::vector<SimAssign> assigns;
+
+    // Calls
+    const SimCfa* callee = nullptr;
+    std::vector<SimAssign> outputs;
+};
+
+struct SimVariable
+{
+    unsigned width;
+    bool isInt;
+};
+
+struct SimCfa
+{
+    Cfa* cfa;
+    llvm::DenseMap<Variable*, unsigned> indices;
+    std::vector<SimVariable> variables;
+    llvm::DenseMap<Location*, std::vector<SimEdge>> edges;
+    llvm::DenseMap<Location*, const SimNode*> errorCodes;
+};
+
+/// The automata system, compiled into a form which can be shared between threads.
+class SimProgram
+{
+public:
+    /// Compiles the given system. Returns false and sets \p reason if
+    /// the system contains unsupported constructs.
+    bool compile(AutomataSystem& system, std::string& reason);
+
+    const SimCfa* getCfa(Cfa* cfa) const { return mCfas.find(cfa)->second.get(); }
+
+private:
+    const SimNode* compileExpr(const ExprPtr& expr, SimCfa& cfa);
+    bool getTypeInfo(Type& type, unsigned& width, bool& isInt);
+
+private:
+    llvm::DenseMap<Cfa*, std::unique_ptr<SimCfa>> mCfas;
+    std::vector<std::unique_ptr<SimNode>> mNodes;
+    llvm::DenseMap<std::pair<Expr*, SimCfa*>, const SimNode*> mCache;
+    std::string mUnsupported;
+};
+
+/// A step of a simulation run, used to build counterexample traces.
+struct SimStep
+{
+    Location* target;
+    std::vector<std::pair<Variable*, llvm::APInt>> action;
+};
+
+struct SimFrame
+{
+    const SimCfa* cfa;
+    const SimEdge* call;
+    std::vector<llvm::APInt> values;
+};
+
+/// Executes simulation runs on a single thread.
+class SimRunner
+{
+public:
+    SimRunner(const SimProgram& program, const SimulationSettings& settings, unsigned seed)
+        : mProgram(program), mSettings(settings), mRandom(seed)
+    {}
+
+    /// Runs a single simulation. Returns true if an error location was reached.
+    bool run(Cfa* main);
+
+    std::vector<SimStep>& getPath() { return mPath; }
+    const llvm::APInt& getErrorCode() const { return mErrorCode; }
+
+private:
+    llvm::APInt eval(const SimNode* node, const std::vector<llvm::APInt>& frame);
+    llvm::APInt evalBinary(const SimNode* node, const llvm::APInt& left, const llvm::APInt& right);
+    llvm::APInt randomValue(unsigned width, bool isInt);
+    SimFrame createFrame(const SimCfa* cfa, const SimEdge* call);
+
+private:
+    const SimProgram& mProgram;
+    const SimulationSettings& mSettings;
+    std::mt19937_64 mRandom;
+
+    /// Set if the current run had to be discarded.
+    bool mDiscard = false;
+    std::vector<SimStep> mPath;
+    llvm::APInt mErrorCode;
+};
+
+} // end anonymous namespace
+
+bool SimProgram::getTypeInfo(Type& type, unsigned& width, bool& isInt)
+{
+    isInt = false;
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            width = 1;
+            return true;
+        case Type::BvTypeID:
+            width = llvm::cast<BvType>(type).getWidth();
+            return true;
+        case Type::IntTypeID:
+            width = 64;
+            isInt = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SimProgram::compile(AutomataSystem& system, std::string& reason)
+{
+    for (Cfa& cfa : system) {
+        auto simCfa = std::make_unique<SimCfa>();
+        simCfa->cfa = &cfa;
+
+        auto addVariable = [&](Variable& variable) {
+            if (simCfa->indices.count(&variable) != 0) {
+                return true;
+            }
+
+            SimVariable info;
+            if (!this->getTypeInfo(variable.getType(), info.width, info.isInt)) {
+                reason = "unsupported type of variable '" + variable.getName() + "'";
+                return false;
+            }
+
+            simCfa->indices[&variable] = simCfa->variables.size();
+            simCfa->variables.push_back(info);
+            return true;
+        };
+
+        for (Variable& variable : cfa.inputs()) {
+            if (!addVariable(variable)) { return false; }
+        }
+        for (Variable& variable : cfa.outputs()) {
+            if (!addVariable(variable)) { return false; }
+        }
+        for (Variable& variable : cfa.locals()) {
+            if (!addVariable(variable)) { return false; }
+        }
+
+        mCfas[&cfa] = std::move(simCfa);
+    }
+
+    for (auto& [cfa, simCfa] : mCfas) {
+        for (Transition* edge : cfa->edges()) {
+            SimEdge simEdge;
+            simEdge.target = edge->getTarget();
+            simEdge.guard = this->compileExpr(edge->getGuard(), *simCfa);
+
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                for (const VariableAssignment& assignment : *assign) {
+                    Variable* variable = assignment.getVariable();
+                    const SimNode* value = nullptr;
+                    if (assignment.getValue()->getKind() != Expr::Undef) {
+                        value = this->compileExpr(assignment.getValue(), *simCfa);
+                    }
+                    simEdge.assigns.push_back({ variable, simCfa->indices[variable], value });
+                }
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+                SimCfa& callee = *mCfas[call->getCalledAutomaton()];
+                simEdge.callee = &callee;
+
+                // Inputs are evaluated in the caller, outputs in the callee.
+                for (const VariableAssignment& input : call->inputs()) {
+                    Variable* variable = input.getVariable();
+                    simEdge.assigns.push_back({
+                        variable, callee.indices[variable], this->compileExpr(input.getValue(), *simCfa)
+                    });
+                }
+                for (const VariableAssignment& output : call->outputs()) {
+                    Variable* variable = output.getVariable();
+                    simEdge.outputs.push_back({
+                        variable, simCfa->indices[variable], this->compileExpr(output.getValue(), callee)
+                    });
+                }
+            }
+
+            simCfa->edges[edge->getSource()].push_back(std::move(simEdge));
+        }
+
+        for (auto& [location, errorCode] : llvm::make_range(cfa->error_begin(), cfa->error_end())) {
+            simCfa->errorCodes[location] = this->compileExpr(errorCode, *simCfa);
+        }
+    }
+
+    if (!mUnsupported.empty()) {
+        reason = mUnsupported;
+        return false;
+    }
+
+    return true;
+}
+
+const SimNode* SimProgram::compileExpr(const ExprPtr& expr, SimCfa& cfa)
+{
+    auto it = mCache.find({ expr.get(), &cfa });
+    if (it != mCache.end()) {
+        return it->second;
+    }
+
+    auto node = std::make_unique<SimNode>();
+    node->kind = expr->getKind();
+    if (!this->getTypeInfo(expr->getType(), node->width, node->isInt)) {
+        mUnsupported = "unsupported expression type";
+        node->width = 1;
+        node->isInt = false;
+    }
+
+    switch (expr->getKind()) {
+        case Expr::Undef:
+            break;
+        case Expr::Literal:
+            if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
+                node->value = llvm::APInt(1, boolLit->isTrue() ? 1 : 0);
+            } else if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(expr)) {
+                node->value = bvLit->getValue();
+            } else if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(expr)) {
+                node->value = llvm::APInt(64, intLit->getValue(), true);
+            } else {
+                mUnsupported = "unsupported literal expression";
+            }
+            break;
+        case Expr::VarRef: {
+            Variable* variable = &llvm::cast<VarRefExpr>(expr)->getVariable();
+            auto varIt = cfa.indices.find(variable);
+            if (varIt == cfa.indices.end()) {
+                mUnsupported = "reference to unknown variable '" + variable->getName() + "'";
+            } else {
+                node->index = varIt->second;
+            }
+            break;
+        }
+        case Expr::Extract:
+            node->index = llvm::cast<ExtractExpr>(expr)->getOffset();
+            break;
+        case Expr::Rem:
+            if (node->isInt) {
+                mUnsupported = "integer remainder";
+            }
+            break;
+        default:
+            if (expr->isFloatingPoint()
+                || expr->getKind() == Expr::ArrayRead || expr->getKind() == Expr::ArrayWrite
+                || expr->getKind() == Expr::TupleSelect || expr->getKind() == Expr::TupleConstruct
+            ) {
+                mUnsupported = "unsupported expression kind";
+            }
+            break;
+    }
+
+    if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+        for (const ExprPtr& op : nn->operands()) {
+            node->operands.push_back(this->compileExpr(op, cfa));
+        }
+    }
+
+    const SimNode* result = node.get();
+    mNodes.emplace_back(std::move(node));
+    mCache[{ expr.get(), &cfa }] = result;
+
+    return result;
+}
+
+bool SimRunner::run(Cfa* main)
+{
+    mPath.clear();
+    mDiscard = false;
+
+    std::vector<SimFrame> stack;
+    stack.push_back(this->createFrame(mProgram.getCfa(main), nullptr));
+    Location* loc = main->getEntry();
+
+    llvm::SmallVector<const SimEdge*, 4> enabled;
+    for (unsigned step = 0; step < mSettings.maxSteps; ++step) {
+        SimFrame& frame = stack.back();
+
+        if (loc->isError()) {
+            mErrorCode = this->eval(frame.cfa->errorCodes.lookup(loc), frame.values);
+            return !mDiscard;
+        }
+
+        if (loc == frame.cfa->cfa->getExit()) {
+            if (stack.size() == 1) {
+                return false;
+            }
+
+            const SimEdge* call = frame.call;
+            SimStep simStep{ call->target, {} };
+            for (const SimAssign& output : call->outputs) {
+                simStep.action.emplace_back(output.variable, this->eval(output.value, frame.values));
+            }
+
+            stack.pop_back();
+            for (size_t i = 0; i < call->outputs.size(); ++i) {
+                stack.back().values[call->outputs[i].index] = simStep.action[i].second;
+            }
+
+            loc = call->target;
+            mPath.emplace_back(std::move(simStep));
+            continue;
+        }
+
+        enabled.clear();
+        auto edgesIt = frame.cfa->edges.find(loc);
+        if (edgesIt != frame.cfa->edges.end()) {
+            for (const SimEdge& edge : edgesIt->second) {
+                if (this->eval(edge.guard, frame.values).getBoolValue()) {
+                    enabled.push_back(&edge);
+                }
+            }
+        }
+
+        if (mDiscard || enabled.empty()) {
+            // The run is blocked by an assumption.
+            return false;
+        }
+
+        const SimEdge* edge = enabled[mRandom() % enabled.size()];
+        SimStep simStep{ edge->target, {} };
+
+        if (edge->callee == nullptr) {
+            // Assignments are sequential, later values may read earlier ones.
+            for (const SimAssign& assign : edge->assigns) {
+                llvm::APInt value = assign.value != nullptr
+                    ? this->eval(assign.value, frame.values)
+                    : this->randomValue(frame.cfa->variables[assign.index].width, frame.cfa->variables[assign.index].isInt);
+                frame.values[assign.index] = value;
+                simStep.action.emplace_back(assign.variable, value);
+            }
+            loc = edge->target;
+        } else {
+            SimFrame calleeFrame = this->createFrame(edge->callee, edge);
+            for (const SimAssign& input : edge->assigns) {
+                llvm::APInt value = this->eval(input.value, frame.values);
+                calleeFrame.values[input.index] = value;
+                simStep.action.emplace_back(input.variable, value);
+            }
+
+            loc = edge->callee->cfa->getEntry();
+            simStep.target = loc;
+            stack.emplace_back(std::move(calleeFrame));
+        }
+
+        if (mDiscard) {
+            return false;
+        }
+
+        mPath.emplace_back(std::move(simStep));
+    }
+
+    return false;
+}
+
+SimFrame SimRunner::createFrame(const SimCfa* cfa, const SimEdge* call)
+{
+    // Uninitialized variables may hold any value.
+    SimFrame frame{ cfa, call, {} };
+    frame.values.reserve(cfa->variables.size());
+    for (const SimVariable& variable : cfa->variables) {
+        frame.values.push_back(this->randomValue(variable.width, variable.isInt));
+    }
+
+    return frame;
+}
+
+llvm::APInt SimRunner::randomValue(unsigned width, bool isInt)
+{
+    if (width == 1) {
+        return llvm::APInt(1, mRandom() & 1);
+    }
+
+    // Prefer boundary and small values, as they are more likely to hit corner cases.
+    switch (mRandom() % 8) {
+        case 0: {
+            unsigned bound = isInt ? 32 : width;
+            switch (mRandom() % 5) {
+                case 0: return llvm::APInt(width, 0);
+                case 1: return llvm::APInt(width, 1);
+                case 2: return llvm::APInt::getAllOnesValue(width);
+                case 3: return llvm::APInt::getSignedMaxValue(bound).sext(width);
+                default: return llvm::APInt::getSignedMinValue(bound).sext(width);
+            }
+        }
+        case 1:
+        case 2:
+            return llvm::APInt(width, static_cast<int64_t>(mRandom() % 33) - 16, true);
+        default:
+            break;
+    }
+
+    if (isInt) {
+        return llvm::APInt(64, static_cast<int32_t>(mRandom()), true);
+    }
+
+    llvm::SmallVector<uint64_t, 2> words;
+    for (unsigned i = 0; i < (width + 63) / 64; ++i) {
+        words.push_back(mRandom());
+    }
+
+    return llvm::APInt(width, words);
+}
+
+llvm::APInt SimRunner::eval(const SimNode* node, const std::vector<llvm::APInt>& frame)
+{
+    switch (node->kind) {
+        case Expr::Undef:
+            return this->randomValue(node->width, node->isInt);
+        case Expr::Literal:
+            return node->value;
+        case Expr::VarRef:
+            return frame[node->index];
+        case Expr::Not:
+            return ~this->eval(node->operands[0], frame);
+        case Expr::ZExt:
+            return this->eval(node->operands[0], frame).zext(node->width);
+        case Expr::SExt:
+            return this->eval(node->operands[0], frame).sext(node->width);
+        case Expr::Extract:
+            return this->eval(node->operands[0], frame).extractBits(node->width, node->index);
+        case Expr::And:
+            for (const SimNode* op : node->operands) {
+                if (!this->eval(op, frame).getBoolValue()) {
+                    return llvm::APInt(1, 0);
+                }
+            }
+            return llvm::APInt(1, 1);
+        case Expr::Or:
+            for (const SimNode* op : node->operands) {
+                if (this->eval(op, frame).getBoolValue()) {
+                    return llvm::APInt(1, 1);
+                }
+            }
+            return llvm::APInt(1, 0);
+        case Expr::Select:
+            return this->eval(node->operands[0], frame).getBoolValue()
+                ? this->eval(node->operands[1], frame)
+                : this->eval(node->operands[2], frame);
+        default:
+            break;
+    }
+
+    assert(node->operands.size() == 2 && "Remaining expressions must be binary!");
+    return this->evalBinary(
+        node, this->eval(node->operands[0], frame), this->eval(node->operands[1], frame)
+    );
+}
+
+llvm::APInt SimRunner::evalBinary(const SimNode* node, const llvm::APInt& left, const llvm::APInt& right)
+{
+    auto boolean = [](bool value) { return llvm::APInt(1, value ? 1 : 0); };
+    bool isInt = node->operands[0]->isInt;
+    bool overflow = false;
+
+    switch (node->kind) {
+        case Expr::Add: {
+            llvm::APInt result = isInt ? left.sadd_ov(right, overflow) : left + right;
+            mDiscard |= overflow;
+            return result;
+        }
+        case Expr::Sub: {
+            llvm::APInt result = isInt ? left.ssub_ov(right, overflow) : left - right;
+            mDiscard |= overflow;
+            return result;
+        }
+        case Expr::Mul: {
+            llvm::APInt result = isInt ? left.smul_ov(right, overflow) : left * right;
+            mDiscard |= overflow;
+            return result;
+        }
+        case Expr::Div:
+        case Expr::Mod: {
+            // Integer division and modulo are Euclidean, as in SMT-LIB.
+            if (right.isNullValue() || (left.isMinSignedValue() && right.isAllOnesValue())) {
+                mDiscard = true;
+                return left;
+            }
+            llvm::APInt quotient = left.sdiv(right);
+            llvm::APInt remainder = left.srem(right);
+            if (remainder.isNegative()) {
+                remainder += right.abs();
+                quotient = right.isNegative() ? quotient + 1 : quotient - 1;
+            }
+            return node->kind == Expr::Div ? quotient : remainder;
+        }
+        case Expr::BvSDiv:
+        case Expr::BvUDiv:
+        case Expr::BvSRem:
+        case Expr::BvURem:
+            if (right.isNullValue()) {
+                mDiscard = true;
+                return left;
+            }
+            switch (node->kind) {
+                case Expr::BvSDiv: return left.sdiv(right);
+                case Expr::BvUDiv: return left.udiv(right);
+                case Expr::BvSRem: return left.srem(right);
+                default: return left.urem(right);
+            }
+        case Expr::Shl:
+            return right.uge(left.getBitWidth()) ? llvm::APInt(left.getBitWidth(), 0) : left.shl(right);
+        case Expr::LShr:
+            return right.uge(left.getBitWidth()) ? llvm::APInt(left.getBitWidth(), 0) : left.lshr(right);
+        case Expr::AShr:
+            if (right.uge(left.getBitWidth())) {
+                return left.isNegative()
+                    ? llvm::APInt::getAllOnesValue(left.getBitWidth())
+                    : llvm::APInt(left.getBitWidth(), 0);
+            }
+            return left.ashr(right);
+        case Expr::BvAnd: return left & right;
+        case Expr::BvOr: return left | right;
+        case Expr::BvXor: return left ^ right;
+        case Expr::BvConcat:
+            return left.zext(node->width).shl(right.getBitWidth()) | right.zext(node->width);
+        case Expr::Imply: return boolean(!left.getBoolValue() || right.getBoolValue());
+        case Expr::Eq: return boolean(left == right);
+        case Expr::NotEq: return boolean(left != right);
+        case Expr::Lt: return boolean(left.slt(right));
+        case Expr::LtEq: return boolean(left.sle(right));
+        case Expr::Gt: return boolean(left.sgt(right));
+        case Expr::GtEq: return boolean(left.sge(right));
+        case Expr::BvSLt: return boolean(left.slt(right));
+        case Expr::BvSLtEq: return boolean(left.sle(right));
+        case Expr::BvSGt: return boolean(left.sgt(right));
+        case Expr::BvSGtEq: return boolean(left.sge(right));
+        case Expr::BvULt: return boolean(left.ult(right));
+        case Expr::BvULtEq: return boolean(left.ule(right));
+        case Expr::BvUGt: return boolean(left.ugt(right));
+        case Expr::BvUGtEq: return boolean(left.uge(right));
+        default:
+            llvm_unreachable("Unsupported expression in simulation!");
+    }
+}
+
+static ExprRef<AtomicExpr> toLiteral(Variable* variable, const llvm::APInt& value)
+{
+    Type& type = variable->getType();
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), value.getBoolValue());
+        case Type::BvTypeID:
+            return BvLiteralExpr::Get(llvm::cast<BvType>(type), value);
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), value.getSExtValue());
+        default:
+            llvm_unreachable("Unsupported variable type in simulation!");
+    }
+}
+
+auto SimulationPrePass::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    Cfa* main = system.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    SimProgram program;
+    std::string reason;
+    if (!program.compile(system, reason)) {
+        llvm::outs() << "Skipping random simulation: " << reason << ".\n";
+        return mBackend->check(system, traceBuilder);
+    }
+
+    llvm::outs() << "Running random simulation...\n";
+
+    Stopwatch<> sw;
+    sw.start();
+
+    std::atomic<unsigned> numRuns(0);
+    std::atomic<bool> found(false);
+    std::mutex mutex;
+    std::vector<SimStep> errorPath;
+    llvm::APInt errorCode;
+
+    auto simulate = [&](unsigned workerId) {
+        SimRunner runner(program, mSettings, mSettings.seed + workerId);
+        while (!found && sw.elapsed().count() < mSettings.timeBudget && numRuns++ < mSettings.numRuns) {
+            if (!runner.run(main)) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!found) {
+                found = true;
+                errorPath = std::move(runner.getPath());
+                errorCode = runner.getErrorCode();
+            }
+        }
+    };
+
+    unsigned numWorkers = std::max(mSettings.numWorkers, 1u);
+    if (numWorkers == 1) {
+        simulate(0);
+    } else {
+        llvm::ThreadPool pool(numWorkers);
+        for (unsigned i = 0; i < numWorkers; ++i) {
+            pool.async(simulate, i);
+        }
+        pool.wait();
+    }
+
+    sw.stop();
+    unsigned totalRuns = std::min<unsigned>(numRuns, mSettings.numRuns);
+
+    if (!found) {
+        llvm::outs() << "Random simulation found no errors in " << totalRuns << " runs (";
+        sw.format(llvm::outs(), "ms");
+        llvm::outs() << "), running the backend.\n";
+        return mBackend->check(system, traceBuilder);
+    }
+
+    llvm::outs() << "Random simulation found an error in " << totalRuns << " runs (";
+    sw.format(llvm::outs(), "ms");
+    llvm::outs() << ").\n";
+
+    std::unique_ptr<Trace> trace;
+    if (mSettings.trace) {
+        std::vector<Location*> states = { main->getEntry() };
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        for (SimStep& step : errorPath) {
+            std::vector<VariableAssignment> action;
+            for (auto& [variable, value] : step.action) {
+                action.emplace_back(variable, toLiteral(variable, value));
+            }
+            actions.emplace_back(std::move(action));
+            states.push_back(step.target);
+        }
+
+        trace = traceBuilder.build(states, actions);
+    } else {
+        trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    return VerificationResult::CreateFail(errorCode.getLimitedValue(), std::move(trace));
+}
@@ -0,0 +1,887 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Path conditions and execution steps are immutable linked lists, shared
+// between the states forked from a common ancestor.
+//
+// Successors which extend the path condition are checked for feasibility in
+// batches. Each worker owns a solver with one push frame for each conjunct of
+// the path condition it currently holds, so a query only has to pop the
+// frames which are not a prefix of the new path condition and push the rest.
+// Queries are assigned to the worker sharing the longest prefix with them.
+// As the expression infrastructure is not thread-safe, states are expanded
+// and formulas are added on the calling thread; only the solver runs happen
+// concurrently.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/SymbolicExecution.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Core/Solver/Model.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+using namespace gazer;
+
+namespace
+{
+
+struct PathCondition;
+using PathConditionPtr = std::shared_ptr<const PathCondition>;
+
+/// A conjunct of a path condition, along with the preceding ones.
+struct PathCondition
+{
+    ExprPtr expr;
+    PathConditionPtr parent;
+    unsigned length;
+};
+
+using SymbolicAction = std::vector<std::pair<Variable*, ExprPtr>>;
+
+/// An edge of a merged region, with the condition of traversing it.
+struct MergedEdge
+{
+    Transition* edge;
+    ExprPtr condition;
+    SymbolicAction action;
+};
+
+struct ExecStep;
+using ExecStepPtr = std::shared_ptr<const ExecStep>;
+
+/// A step of an execution path, used to build the trace of a counterexample.
+/// Steps over merged regions list the edges of the region instead of an action.
+struct ExecStep
+{
+    Location* location;
+    SymbolicAction action;
+    std::vector<MergedEdge> region;
+    ExecStepPtr parent;
+};
+
+using SymbolicStore = llvm::DenseMap<Variable*, ExprPtr>;
+
+struct StackFrame
+{
+    Cfa* cfa;
+    CallTransition* call;
+    SymbolicStore store;
+};
+
+struct ExecState
+{
+    Location* location;
+    std::vector<StackFrame> stack;
+    PathConditionPtr pathCondition;
+    ExecStepPtr steps;
+
+    /// The error code expression, if this state is at an error location.
+    ExprPtr errorCode;
+};
+
+/// A branch and the locations up to its immediate post-dominator.
+struct MergeRegion
+{
+    bool valid = false;
+    std::vector<Location*> locations;
+    Location* exit = nullptr;
+};
+
+struct SymExecWorker
+{
+    std::unique_ptr<Solver> solver;
+    std::vector<PathConditionPtr> asserted;
+};
+
+struct SymExecStats
+{
+    unsigned NumStates = 0;
+    unsigned NumMergedRegions = 0;
+    unsigned NumQueries = 0;
+    unsigned NumInfeasible = 0;
+    unsigned NumCutPaths = 0;
+};
+
+/// Evaluates an expression over a symbolic store.
+class StoreEvaluator : public ExprRewrite<StoreEvaluator>
+{
+    friend class ExprWalker<StoreEvaluator, ExprPtr>;
+public:
+    StoreEvaluator(ExprBuilder& builder, std::function<ExprPtr(Variable*)> lookup)
+        : ExprRewrite(builder), mLookup(std::move(lookup))
+    {}
+
+protected:
+    ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr)
+    {
+        return mLookup(&expr->getVariable());
+    }
+
+private:
+    std::function<ExprPtr(Variable*)> mLookup;
+};
+
+class SymbolicExecutionImpl
+{
+public:
+    SymbolicExecutionImpl(
+        AutomataSystem& system,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        SymExecSettings settings
+    );
+
+    std::unique_ptr<VerificationResult> check();
+
+private:
+    std::unique_ptr<ExecState> popState();
+    void expand(std::unique_ptr<ExecState> state);
+    void executeEdge(const ExecState& state, Transition* edge);
+    void executeRegion(const ExecState& state, const MergeRegion& region);
+    void addSuccessor(std::unique_ptr<ExecState> state, ExprPtr condition);
+
+    /// Checks the feasibility of the pending states. Returns a result if an
+    /// error state turned out to be reachable.
+    std::unique_ptr<VerificationResult> checkPending();
+    void syncSolver(SymExecWorker& worker, const PathConditionPtr& pc);
+
+    std::unique_ptr<VerificationResult> createFailResult(ExecState& state, Model& model);
+
+    ExprPtr evaluate(const ExprPtr& expr, StackFrame& frame);
+    SymbolicStore applyAssignments(AssignTransition* edge, StackFrame& frame, SymbolicAction& action);
+    ExprPtr lookup(Variable* variable, StackFrame& frame);
+    ExprPtr createSymbol(Variable* variable);
+
+    const MergeRegion& getRegion(Location* head);
+    bool hasDisjointBranches(const MergeRegion& region);
+    size_t getTopoIndex(Location* loc);
+
+private:
+    AutomataSystem& mSystem;
+    SolverFactory& mSolverFactory;
+    CfaTraceBuilder& mTraceBuilder;
+    SymExecSettings mSettings;
+    std::unique_ptr<ExprBuilder> mExprBuilder;
+
+    std::deque<std::unique_ptr<ExecState>> mFrontier;
+    std::vector<std::unique_ptr<ExecState>> mPending;
+    std::vector<SymExecWorker> mWorkers;
+
+    llvm::DenseMap<Location*, unsigned> mVisits;
+    llvm::DenseMap<Cfa*, llvm::DenseMap<Location*, size_t>> mTopoIndices;
+    llvm::DenseMap<Cfa*, std::vector<Location*>> mTopoSorts;
+    llvm::DenseMap<Location*, MergeRegion> mRegions;
+
+    unsigned mSymbolCount = 0;
+    bool mUnknown = false;
+
+    SymExecStats mStats;
+};
+
+} // end anonymous namespace
+
+SymbolicExecutionImpl::SymbolicExecutionImpl(
+    AutomataSystem& system,
+    SolverFactory& solverFactory,
+    CfaTraceBuilder& traceBuilder,
+    SymExecSettings settings
+) : mSystem(system), mSolverFactory(solverFactory),
+    mTraceBuilder(traceBuilder), mSettings(settings)
+{
+    if (mSettings.simplifyExpr) {
+        mExprBuilder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        mExprBuilder = CreateExprBuilder(system.getContext());
+    }
+}
+
+auto SymbolicExecutionImpl::check() -> std::unique_ptr<VerificationResult>
+{
+    Cfa* main = mSystem.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    for (unsigned i = 0; i < std::max(mSettings.numWorkers, 1u); ++i) {
+        mWorkers.push_back({ mSolverFactory.createSolver(mSystem.getContext()), {} });
+    }
+
+    auto initial = std::make_unique<ExecState>();
+    initial->location = main->getEntry();
+    initial->stack.push_back({ main, nullptr, SymbolicStore() });
+    initial->steps = std::make_shared<ExecStep>(ExecStep{ main->getEntry(), {}, {}, nullptr });
+    mFrontier.push_back(std::move(initial));
+
+    std::unique_ptr<VerificationResult> result;
+    while (result == nullptr && (!mFrontier.empty() || !mPending.empty())) {
+        if (!mFrontier.empty()) {
+            this->expand(this->popState());
+        }
+
+        if (mPending.size() >= mWorkers.size() || mFrontier.empty()) {
+            result = this->checkPending();
+        }
+    }
+
+    llvm::outs() << "Explored " << mStats.NumStates << " states.\n";
+    if (mSettings.printSolverStats) {
+        llvm::outs() << "Symbolic execution statistics:\n"
+            << "  States: " << mStats.NumStates << "\n"
+            << "  Merged regions: " << mStats.NumMergedRegions << "\n"
+            << "  Feasibility queries: " << mStats.NumQueries << "\n"
+            << "  Infeasible paths: " << mStats.NumInfeasible << "\n"
+            << "  Paths cut at the depth limit: " << mStats.NumCutPaths << "\n";
+    }
+
+    if (result != nullptr) {
+        return result;
+    }
+
+    if (mUnknown) {
+        return VerificationResult::CreateUnknown();
+    }
+
+    if (mStats.NumCutPaths != 0) {
+        return VerificationResult::CreateBoundReached();
+    }
+
+    return VerificationResult::CreateSuccess();
+}
+
+auto SymbolicExecutionImpl::popState() -> std::unique_ptr<ExecState>
+{
+    std::unique_ptr<ExecState> state;
+    switch (mSettings.search) {
+        case SymExecSearch::Dfs:
+            state = std::move(mFrontier.back());
+            mFrontier.pop_back();
+            break;
+        case SymExecSearch::Bfs:
+            state = std::move(mFrontier.front());
+            mFrontier.pop_front();
+            break;
+        case SymExecSearch::Coverage: {
+            // Prefer the least visited location, and the latest state between equals.
+            auto it = std::min_element(mFrontier.rbegin(), mFrontier.rend(), [this](auto& a, auto& b) {
+                return mVisits.lookup(a->location) < mVisits.lookup(b->location);
+            });
+            state = std::move(*it);
+            mFrontier.erase(std::next(it).base());
+            break;
+        }
+    }
+
+    return state;
+}
+
+void SymbolicExecutionImpl::expand(std::unique_ptr<ExecState> state)
+{
+    mStats.NumStates++;
+    mVisits[state->location]++;
+
+    StackFrame& frame = state->stack.back();
+
+    if (state->location == frame.cfa->getExit()) {
+        if (state->stack.size() == 1) {
+            // The main automaton has returned, the path is finished.
+            return;
+        }
+
+        // Return to the caller, binding the outputs of the call.
+        CallTransition* call = frame.call;
+        SymbolicAction action;
+        for (const VariableAssignment& output : call->outputs()) {
+            action.emplace_back(output.getVariable(), this->evaluate(output.getValue(), frame));
+        }
+
+        state->stack.pop_back();
+        for (auto& [variable, value] : action) {
+            state->stack.back().store[variable] = value;
+        }
+
+        state->location = call->getTarget();
+        state->steps = std::make_shared<ExecStep>(ExecStep{
+            state->location, std::move(action), {}, state->steps
+        });
+        mFrontier.push_back(std::move(state));
+        return;
+    }
+
+    if (mSettings.mergeLimit != 0 && state->location->getNumOutgoing() > 1) {
+        const MergeRegion& region = this->getRegion(state->location);
+        if (region.valid) {
+            this->executeRegion(*state, region);
+            return;
+        }
+    }
+
+    for (Transition* edge : state->location->outgoing()) {
+        this->executeEdge(*state, edge);
+    }
+}
+
+void SymbolicExecutionImpl::executeEdge(const ExecState& state, Transition* edge)
+{
+    auto succ = std::make_unique<ExecState>(state);
+    StackFrame& frame = succ->stack.back();
+
+    ExprPtr guard = this->evaluate(edge->getGuard(), frame);
+    if (guard == mExprBuilder->False()) {
+        return;
+    }
+
+    SymbolicAction action;
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        frame.store = this->applyAssignments(assign, frame, action);
+        succ->location = edge->getTarget();
+    } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+        if (succ->stack.size() >= mSettings.maxCallDepth) {
+            mStats.NumCutPaths++;
+            return;
+        }
+
+        Cfa* callee = call->getCalledAutomaton();
+        StackFrame calleeFrame = { callee, call, SymbolicStore() };
+        for (const VariableAssignment& input : call->inputs()) {
+            ExprPtr value = this->evaluate(input.getValue(), frame);
+            calleeFrame.store[input.getVariable()] = value;
+            action.emplace_back(input.getVariable(), value);
+        }
+
+        succ->stack.push_back(std::move(calleeFrame));
+        succ->location = callee->getEntry();
+    } else {
+        llvm_unreachable("Unknown transition kind!");
+    }
+
+    succ->steps = std::make_shared<ExecStep>(ExecStep{
+        succ->location, std::move(action), {}, succ->steps
+    });
+    this->addSuccessor(std::move(succ), guard);
+}
+
+void SymbolicExecutionImpl::executeRegion(const ExecState& state, const MergeRegion& region)
+{
+    struct RegionState
+    {
+        ExprPtr reach;
+        SymbolicStore store;
+    };
+
+    const StackFrame& origFrame = state.stack.back();
+    llvm::DenseMap<Location*, RegionState> states;
+    states[state.location] = { mExprBuilder->True(), origFrame.store };
+
+    std::vector<MergedEdge> edges;
+    for (Location* loc : region.locations) {
+        auto it = states.find(loc);
+        if (it == states.end()) {
+            // The location is unreachable in this state.
+            continue;
+        }
+
+        RegionState current = std::move(it->second);
+        states.erase(it);
+
+        for (Transition* edge : loc->outgoing()) {
+            StackFrame frame = { origFrame.cfa, origFrame.call, current.store };
+            ExprPtr condition = mExprBuilder->And(
+                current.reach, this->evaluate(edge->getGuard(), frame)
+            );
+            if (condition == mExprBuilder->False()) {
+                continue;
+            }
+
+            SymbolicAction action;
+            SymbolicStore store = this->applyAssignments(llvm::cast<AssignTransition>(edge), frame, action);
+            edges.push_back({ edge, condition, std::move(action) });
+
+            auto [target, inserted] = states.try_emplace(edge->getTarget(), RegionState{ condition, store });
+            if (inserted) {
+                continue;
+            }
+
+            // Merge the incoming state into the existing one.
+            RegionState& other = target->second;
+            for (auto& [variable, value] : store) {
+                ExprPtr& otherValue = other.store[variable];
+                if (otherValue == nullptr) {
+                    otherValue = this->createSymbol(variable);
+                }
+                if (otherValue != value) {
+                    otherValue = mExprBuilder->Select(condition, value, otherValue);
+                }
+            }
+            for (auto& [variable, otherValue] : other.store) {
+                if (store.count(variable) == 0) {
+                    otherValue = mExprBuilder->Select(condition, this->createSymbol(variable), otherValue);
+                }
+            }
+            other.reach = mExprBuilder->Or(other.reach, condition);
+        }
+    }
+
+    auto exitIt = states.find(region.exit);
+    if (exitIt == states.end()) {
+        return;
+    }
+
+    mStats.NumMergedRegions++;
+    for (Location* loc : region.locations) {
+        mVisits[loc]++;
+    }
+
+    auto succ = std::make_unique<ExecState>(state);
+    succ->location = region.exit;
+    succ->stack.back().store = std::move(exitIt->second.store);
+    succ->steps = std::make_shared<ExecStep>(ExecStep{
+        region.exit, {}, std::move(edges), succ->steps
+    });
+    this->addSuccessor(std::move(succ), exitIt->second.reach);
+}
+
+void SymbolicExecutionImpl::addSuccessor(std::unique_ptr<ExecState> state, ExprPtr condition)
+{
+    bool extended = condition != mExprBuilder->True();
+    if (extended) {
+        unsigned length = state->pathCondition != nullptr ? state->pathCondition->length + 1 : 1;
+        state->pathCondition = std::make_shared<PathCondition>(PathCondition{
+            condition, state->pathCondition, length
+        });
+    }
+
+    if (state->location->isError()) {
+        StackFrame& frame = state->stack.back();
+        state->errorCode = this->evaluate(frame.cfa->getErrorFieldExpr(state->location), frame);
+        mPending.push_back(std::move(state));
+    } else if (extended) {
+        mPending.push_back(std::move(state));
+    } else {
+        mFrontier.push_back(std::move(state));
+    }
+}
+
+auto SymbolicExecutionImpl::checkPending() -> std::unique_ptr<VerificationResult>
+{
+    while (!mPending.empty()) {
+        size_t batchSize = std::min(mPending.size(), mWorkers.size());
+        std::vector<std::unique_ptr<ExecState>> batch;
+        for (size_t i = 0; i < batchSize; ++i) {
+            batch.push_back(std::move(mPending.back()));
+            mPending.pop_back();
+        }
+
+        // Assign each query to the free worker with the longest common prefix.
+        std::vector<SymExecWorker*> assigned(batchSize, nullptr);
+        llvm::DenseSet<SymExecWorker*> busy;
+        for (size_t i = 0; i < batchSize; ++i) {
+            llvm::DenseSet<const PathCondition*> conjuncts;
+            for (auto pc = batch[i]->pathCondition.get(); pc != nullptr; pc = pc->parent.get()) {
+                conjuncts.insert(pc);
+            }
+
+            size_t bestPrefix = 0;
+            for (SymExecWorker& worker : mWorkers) {
+                if (busy.count(&worker) != 0) {
+                    continue;
+                }
+
+                size_t prefix = 0;
+                while (prefix < worker.asserted.size() && conjuncts.count(worker.asserted[prefix].get()) != 0) {
+                    ++prefix;
+                }
+
+                if (assigned[i] == nullptr || prefix > bestPrefix) {
+                    assigned[i] = &worker;
+                    bestPrefix = prefix;
+                }
+            }
+
+            busy.insert(assigned[i]);
+            this->syncSolver(*assigned[i], batch[i]->pathCondition);
+        }
+
+        mStats.NumQueries += batchSize;
+        std::vector<Solver::SolverStatus> status(batchSize, Solver::UNKNOWN);
+
+        if (batchSize == 1) {
+            status[0] = assigned[0]->solver->run();
+        } else {
+            llvm::ThreadPool pool(batchSize);
+            std::mutex mutex;
+            std::condition_variable changed;
+            bool done = false;
+            size_t numPending = batchSize;
+            std::vector<bool> running(batchSize, false);
+
+            auto runSolver = [&](size_t idx) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (done) {
+                        --numPending;
+                        changed.notify_all();
+                        return;
+                    }
+                    running[idx] = true;
+                }
+
+                auto result = assigned[idx]->solver->run();
+
+                // A reachable error state makes the other queries unnecessary.
+                std::lock_guard<std::mutex> lock(mutex);
+                running[idx] = false;
+                status[idx] = result;
+                --numPending;
+                if (result == Solver::SAT && batch[idx]->location->isError()) {
+                    done = true;
+                }
+                changed.notify_all();
+            };
+
+            for (size_t i = 0; i < batchSize; ++i) {
+                pool.async(runSolver, i);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&done, &numPending] { return done || numPending == 0; });
+
+                // An interrupt issued before a solver enters its search is lost,
+                // thus the remaining queries are interrupted until they all return.
+                while (numPending != 0) {
+                    for (size_t i = 0; i < batchSize; ++i) {
+                        if (running[i]) {
+                            assigned[i]->solver->interrupt();
+                        }
+                    }
+                    changed.wait_for(lock, std::chrono::milliseconds(10));
+                }
+            }
+            pool.wait();
+        }
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            if (status[i] == Solver::SAT && batch[i]->location->isError()) {
+                auto model = assigned[i]->solver->getModel();
+                return this->createFailResult(*batch[i], *model);
+            }
+        }
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            switch (status[i]) {
+                case Solver::SAT:
+                    mFrontier.push_back(std::move(batch[i]));
+                    break;
+                case Solver::UNSAT:
+                    mStats.NumInfeasible++;
+                    break;
+                case Solver::UNKNOWN:
+                    mUnknown = true;
+                    break;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void SymbolicExecutionImpl::syncSolver(SymExecWorker& worker, const PathConditionPtr& pc)
+{
+    std::vector<PathConditionPtr> conjuncts;
+    for (PathConditionPtr current = pc; current != nullptr; current = current->parent) {
+        conjuncts.push_back(current);
+    }
+    std::reverse(conjuncts.begin(), conjuncts.end());
+
+    size_t common = 0;
+    while (common < worker.asserted.size() && common < conjuncts.size()
+        && worker.asserted[common] == conjuncts[common]) {
+        ++common;
+    }
+
+    while (worker.asserted.size() > common) {
+        worker.solver->pop();
+        worker.asserted.pop_back();
+    }
+
+    for (size_t i = common; i < conjuncts.size(); ++i) {
+        worker.solver->push();
+        worker.solver->add(conjuncts[i]->expr);
+        worker.asserted.push_back(conjuncts[i]);
+    }
+}
+
+auto SymbolicExecutionImpl::createFailResult(ExecState& state, Model& model)
+    -> std::unique_ptr<VerificationResult>
+{
+    std::unique_ptr<Trace> trace;
+    if (mSettings.trace) {
+        std::vector<const ExecStep*> steps;
+        for (const ExecStep* step = state.steps.get(); step != nullptr; step = step->parent.get()) {
+            steps.push_back(step);
+        }
+        std::reverse(steps.begin(), steps.end());
+
+        auto evaluateAction = [&model](const SymbolicAction& action) {
+            std::vector<VariableAssignment> result;
+            for (auto& [variable, expr] : action) {
+                ExprRef<AtomicExpr> value = model.evaluate(expr);
+                if (value == nullptr) {
+                    value = UndefExpr::Get(variable->getType());
+                }
+                result.emplace_back(variable, value);
+            }
+            return result;
+        };
+
+        std::vector<Location*> states = { steps[0]->location };
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        for (size_t i = 1; i < steps.size(); ++i) {
+            const ExecStep* step = steps[i];
+            if (step->region.empty()) {
+                actions.push_back(evaluateAction(step->action));
+                states.push_back(step->location);
+                continue;
+            }
+
+            // Follow the edges of the merged region taken in the model.
+            Location* current = states.back();
+            while (current != step->location) {
+                auto edge = std::find_if(step->region.begin(), step->region.end(), [&](const MergedEdge& me) {
+                    auto value = model.evaluate(me.condition);
+                    return me.edge->getSource() == current
+                        && llvm::isa<BoolLiteralExpr>(value)
+                        && llvm::cast<BoolLiteralExpr>(value)->isTrue();
+                });
+                assert(edge != step->region.end() && "A merged region must have a path in the model!");
+
+                actions.push_back(evaluateAction(edge->action));
+                current = edge->edge->getTarget();
+                states.push_back(current);
+            }
+        }
+
+        trace = mTraceBuilder.build(states, actions);
+    } else {
+        trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    ExprRef<AtomicExpr> errorExpr = model.evaluate(state.errorCode);
+    assert(!errorExpr->isUndef() && "The error field must be present in the model as a literal expression!");
+
+    switch (errorExpr->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return VerificationResult::CreateFail(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue(), std::move(trace));
+        case Type::IntTypeID:
+            return VerificationResult::CreateFail(llvm::cast<IntLiteralExpr>(errorExpr)->getValue(), std::move(trace));
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+}
+
+ExprPtr SymbolicExecutionImpl::evaluate(const ExprPtr& expr, StackFrame& frame)
+{
+    StoreEvaluator evaluator(*mExprBuilder, [this, &frame](Variable* variable) {
+        return this->lookup(variable, frame);
+    });
+
+    return evaluator.walk(expr);
+}
+
+SymbolicStore SymbolicExecutionImpl::applyAssignments(
+    AssignTransition* edge, StackFrame& frame, SymbolicAction& action)
+{
+    // Assignments are sequential, each value is evaluated in the store
+    // updated by the previous assignments of the edge.
+    SymbolicStore assigned;
+    StoreEvaluator evaluator(*mExprBuilder, [this, &frame, &assigned](Variable* variable) {
+        auto result = assigned.find(variable);
+        if (result != assigned.end()) {
+            return result->second;
+        }
+
+        return this->lookup(variable, frame);
+    });
+
+    for (const VariableAssignment& assignment : *edge) {
+        Variable* variable = assignment.getVariable();
+        ExprPtr value = assignment.getValue()->getKind() == Expr::Undef
+            ? this->createSymbol(variable)
+            : evaluator.walk(assignment.getValue());
+
+        action.emplace_back(variable, value);
+        assigned[variable] = value;
+    }
+
+    SymbolicStore store = frame.store;
+    for (auto& [variable, value] : assigned) {
+        store[variable] = value;
+    }
+
+    return store;
+}
+
+ExprPtr SymbolicExecutionImpl::lookup(Variable* variable, StackFrame& frame)
+{
+    // Variables read before being assigned may hold any value.
+    ExprPtr& value = frame.store[variable];
+    if (value == nullptr) {
+        value = this->createSymbol(variable);
+    }
+
+    return value;
+}
+
+ExprPtr SymbolicExecutionImpl::createSymbol(Variable* variable)
+{
+    auto& ctx = mSystem.getContext();
+
+    std::string name;
+    do {
+        name = variable->getName() + "@sym" + std::to_string(mSymbolCount++);
+    } while (ctx.getVariable(name) != nullptr);
+
+    return ctx.createVariable(name, variable->getType())->getRefExpr();
+}
+
+const MergeRegion& SymbolicExecutionImpl::getRegion(Location* head)
+{
+    auto [it, inserted] = mRegions.try_emplace(head);
+    MergeRegion& region = it->second;
+    if (!inserted) {
+        return region;
+    }
+
+    // As automata are acyclic, the immediate post-dominator of the head is
+    // the first location in topological order where every open path meets.
+    size_t headIdx = this->getTopoIndex(head);
+    const auto& topo = mTopoSorts[head->getAutomaton()];
+    llvm::DenseMap<Location*, unsigned> openEdges;
+    unsigned numOpen = 0;
+
+    auto addEdges = [&](Location* loc) {
+        for (Transition* edge : loc->outgoing()) {
+            if (!llvm::isa<AssignTransition>(edge)) {
+                return false;
+            }
+            openEdges[edge->getTarget()]++;
+            numOpen++;
+        }
+        return true;
+    };
+
+    region.locations.push_back(head);
+    if (!addEdges(head)) {
+        return region;
+    }
+
+    for (size_t i = headIdx + 1; i < topo.size(); ++i) {
+        Location* loc = topo[i];
+        unsigned count = openEdges.lookup(loc);
+        if (count == 0) {
+            continue;
+        }
+
+        if (count == numOpen) {
+            region.exit = loc;
+            region.valid = this->hasDisjointBranches(region);
+            return region;
+        }
+
+        if (loc->isError() || region.locations.size() >= mSettings.mergeLimit) {
+            return region;
+        }
+
+        region.locations.push_back(loc);
+        numOpen -= count;
+        if (!addEdges(loc)) {
+            return region;
+        }
+    }
+
+    return region;
+}
+
+bool SymbolicExecutionImpl::hasDisjointBranches(const MergeRegion& region)
+{
+    // The values of a merged state are selected by the conditions of the
+    // paths reaching it, which is only correct if at most one path of the
+    // region may be taken. This holds if the guards of each branch are
+    // pairwise disjoint, which does not depend on the state executing it.
+    std::unique_ptr<Solver> solver;
+    for (Location* loc : region.locations) {
+        std::vector<ExprPtr> guards;
+        for (Transition* edge : loc->outgoing()) {
+            guards.push_back(edge->getGuard());
+        }
+
+        for (size_t i = 0; i < guards.size(); ++i) {
+            for (size_t j = i + 1; j < guards.size(); ++j) {
+                ExprPtr both = mExprBuilder->And(guards[i], guards[j]);
+                if (both == mExprBuilder->False()) {
+                    continue;
+                }
+
+                if (solver == nullptr) {
+                    solver = mSolverFactory.createSolver(mSystem.getContext());
+                }
+
+                solver->push();
+                solver->add(both);
+                auto status = solver->run();
+                solver->pop();
+
+                if (status != Solver::UNSAT) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+size_t SymbolicExecutionImpl::getTopoIndex(Location* loc)
+{
+    Cfa* cfa = loc->getAutomaton();
+    auto it = mTopoIndices.find(cfa);
+    if (it == mTopoIndices.end()) {
+        it = mTopoIndices.try_emplace(cfa).first;
+        createTopologicalSort(*cfa, mTopoSorts[cfa], &it->second);
+    }
+
+    return it->second[loc];
+}
+
+auto SymbolicExecution::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    SymbolicExecutionImpl impl(system, mSolverFactory, traceBuilder, mSettings);
+    return impl.check();
+}
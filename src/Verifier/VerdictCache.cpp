@@ -0,0 +1,679 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the persistent verdict cache.
+///
+/// Integers are written as ULEB128 (or SLEB128) values. An entry looks like:
+///
+///     magic, version, key
+///     verdict:         status, { error code, trace kind, counterexample }
+///     counterexamples: count, { states, actions }
+///
+/// States are referred to by the name of their automaton and their identifier,
+/// variables by their name. Entries are written into a temporary file first
+/// and then renamed, thus readers never observe partially written entries.
+/// Writers of the same entry are serialized with a lock file.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/VerdictCache.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/CachePruning.h>
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/LockFileManager.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+
+using namespace gazer;
+
+static constexpr char VerdictCacheMagic[] = { 'G', 'Z', 'V', 'C' };
+static constexpr unsigned VerdictCacheVersion = 1;
+
+namespace
+{
+
+enum class TraceKind : unsigned
+{
+    None = 0,
+    Empty = 1,
+    Counterexample = 2
+};
+
+struct Counterexample
+{
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+};
+
+/// Forwards the counterexamples of the backend to the actual trace builder,
+/// remembering which counterexample each trace was built from.
+class RecordingTraceBuilder : public CfaTraceBuilder
+{
+public:
+    explicit RecordingTraceBuilder(CfaTraceBuilder& builder)
+        : mBuilder(builder)
+    {}
+
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        auto trace = mBuilder.build(states, actions);
+        if (trace != nullptr) {
+            // Traces of spurious counterexamples may have been freed since,
+            // thus a later trace at the same address replaces the earlier one.
+            mTraces[trace.get()] = mCounterexamples.size();
+            mCounterexamples.push_back({ states, actions });
+        }
+
+        return trace;
+    }
+
+    llvm::DenseMap<const Trace*, size_t> mTraces;
+    std::vector<Counterexample> mCounterexamples;
+
+private:
+    CfaTraceBuilder& mBuilder;
+};
+
+class EntryWriter
+{
+public:
+    EntryWriter(llvm::raw_ostream& os, const RecordingTraceBuilder& recorder)
+        : mOS(os), mRecorder(recorder)
+    {}
+
+    /// Writes \p result into the stream. Returns false if the result
+    /// cannot be represented in the cache.
+    bool write(llvm::StringRef key, const VerificationResult& result);
+
+private:
+    bool writeFailure(const FailResult& fail);
+    bool writeCounterexample(const Counterexample& cex);
+    bool writeValue(const ExprPtr& value);
+    void writeString(llvm::StringRef str);
+    void writeAPInt(const llvm::APInt& value);
+
+private:
+    llvm::raw_ostream& mOS;
+    const RecordingTraceBuilder& mRecorder;
+    std::vector<size_t> mUsedCounterexamples;
+};
+
+class EntryReader
+{
+public:
+    EntryReader(llvm::StringRef buffer, AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+        : mPtr(buffer.bytes_begin()), mEnd(buffer.bytes_end()),
+        mSystem(system), mTraceBuilder(traceBuilder)
+    {}
+
+    /// Reads the entry stored for \p key. Returns nullptr if the input is
+    /// malformed, belongs to a different key or does not match the system.
+    std::unique_ptr<VerificationResult> read(llvm::StringRef key);
+
+private:
+    struct FailureRecord
+    {
+        unsigned errorCode;
+        TraceKind traceKind;
+    };
+
+    bool readFailure(FailureRecord& record);
+    std::unique_ptr<FailResult> buildFailure(const FailureRecord& record, std::vector<Counterexample>& cexs);
+    bool readCounterexample(Counterexample& cex);
+    ExprPtr readValue(Type& type);
+
+    uint64_t readULEB128();
+    int64_t readSLEB128();
+    llvm::StringRef readString();
+    llvm::APInt readAPInt(unsigned width);
+
+    bool fail()
+    {
+        mFailed = true;
+        mPtr = mEnd;
+        return false;
+    }
+
+private:
+    const uint8_t* mPtr;
+    const uint8_t* mEnd;
+    AutomataSystem& mSystem;
+    CfaTraceBuilder& mTraceBuilder;
+    bool mFailed = false;
+    size_t mNumCounterexamples = 0;
+};
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+void EntryWriter::writeString(llvm::StringRef str)
+{
+    llvm::encodeULEB128(str.size(), mOS);
+    mOS << str;
+}
+
+void EntryWriter::writeAPInt(const llvm::APInt& value)
+{
+    for (unsigned i = 0; i < value.getNumWords(); ++i) {
+        llvm::encodeULEB128(value.getRawData()[i], mOS);
+    }
+}
+
+bool EntryWriter::write(llvm::StringRef key, const VerificationResult& result)
+{
+    switch (result.getStatus()) {
+        case VerificationResult::Success:
+        case VerificationResult::Fail:
+        case VerificationResult::BoundReached:
+            break;
+        default:
+            // Inconclusive verdicts may change in later runs.
+            return false;
+    }
+
+    mOS.write(VerdictCacheMagic, sizeof(VerdictCacheMagic));
+    llvm::encodeULEB128(VerdictCacheVersion, mOS);
+    this->writeString(key);
+    llvm::encodeULEB128(result.getStatus(), mOS);
+
+    if (auto fail = llvm::dyn_cast<FailResult>(&result)) {
+        llvm::encodeULEB128(fail->getNumFailures(), mOS);
+        if (!this->writeFailure(*fail)) {
+            return false;
+        }
+        for (const FailResult& other : fail->other_failures()) {
+            if (!this->writeFailure(other)) {
+                return false;
+            }
+        }
+    }
+
+    llvm::encodeULEB128(mUsedCounterexamples.size(), mOS);
+    for (size_t index : mUsedCounterexamples) {
+        if (!this->writeCounterexample(mRecorder.mCounterexamples[index])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EntryWriter::writeFailure(const FailResult& fail)
+{
+    llvm::encodeULEB128(fail.getErrorID(), mOS);
+
+    if (!fail.hasTrace()) {
+        llvm::encodeULEB128(static_cast<unsigned>(TraceKind::None), mOS);
+        return true;
+    }
+
+    auto it = mRecorder.mTraces.find(&fail.getTrace());
+    if (it == mRecorder.mTraces.end()) {
+        // Algorithms create empty traces if traces were not requested.
+        // Other traces were not built from a counterexample, thus they
+        // cannot be rebuilt later.
+        if (fail.getTrace().begin() != fail.getTrace().end()) {
+            return false;
+        }
+
+        llvm::encodeULEB128(static_cast<unsigned>(TraceKind::Empty), mOS);
+        return true;
+    }
+
+    llvm::encodeULEB128(static_cast<unsigned>(TraceKind::Counterexample), mOS);
+    llvm::encodeULEB128(mUsedCounterexamples.size(), mOS);
+    mUsedCounterexamples.push_back(it->second);
+
+    return true;
+}
+
+bool EntryWriter::writeCounterexample(const Counterexample& cex)
+{
+    llvm::encodeULEB128(cex.states.size(), mOS);
+    for (Location* loc : cex.states) {
+        this->writeString(loc->getAutomaton()->getName());
+        llvm::encodeULEB128(loc->getId(), mOS);
+    }
+
+    llvm::encodeULEB128(cex.actions.size(), mOS);
+    for (auto& action : cex.actions) {
+        llvm::encodeULEB128(action.size(), mOS);
+        for (const VariableAssignment& assignment : action) {
+            this->writeString(assignment.getVariable()->getName());
+            if (!this->writeValue(assignment.getValue())) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool EntryWriter::writeValue(const ExprPtr& value)
+{
+    if (value->getKind() == Expr::Undef) {
+        llvm::encodeULEB128(0, mOS);
+        return true;
+    }
+
+    if (value->getKind() != Expr::Literal) {
+        return false;
+    }
+
+    llvm::encodeULEB128(1, mOS);
+    switch (value->getType().getTypeID()) {
+        case Type::BoolTypeID:
+            llvm::encodeULEB128(llvm::cast<BoolLiteralExpr>(value)->getValue(), mOS);
+            return true;
+        case Type::IntTypeID:
+            llvm::encodeSLEB128(llvm::cast<IntLiteralExpr>(value)->getValue(), mOS);
+            return true;
+        case Type::RealTypeID: {
+            auto real = llvm::cast<RealLiteralExpr>(value)->getValue();
+            llvm::encodeSLEB128(real.numerator(), mOS);
+            llvm::encodeSLEB128(real.denominator(), mOS);
+            return true;
+        }
+        case Type::BvTypeID:
+            this->writeAPInt(llvm::cast<BvLiteralExpr>(value)->getValue());
+            return true;
+        case Type::FloatTypeID:
+            this->writeAPInt(llvm::cast<FloatLiteralExpr>(value)->getValue().bitcastToAPInt());
+            return true;
+        default:
+            // Array values are not stored.
+            return false;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+uint64_t EntryReader::readULEB128()
+{
+    unsigned length = 0;
+    const char* error = nullptr;
+    uint64_t value = llvm::decodeULEB128(mPtr, &length, mEnd, &error);
+    if (error != nullptr) {
+        this->fail();
+        return 0;
+    }
+
+    mPtr += length;
+    return value;
+}
+
+int64_t EntryReader::readSLEB128()
+{
+    unsigned length = 0;
+    const char* error = nullptr;
+    int64_t value = llvm::decodeSLEB128(mPtr, &length, mEnd, &error);
+    if (error != nullptr) {
+        this->fail();
+        return 0;
+    }
+
+    mPtr += length;
+    return value;
+}
+
+llvm::StringRef EntryReader::readString()
+{
+    uint64_t length = this->readULEB128();
+    if (length > static_cast<uint64_t>(mEnd - mPtr)) {
+        this->fail();
+        return "";
+    }
+
+    llvm::StringRef result(reinterpret_cast<const char*>(mPtr), length);
+    mPtr += length;
+
+    return result;
+}
+
+llvm::APInt EntryReader::readAPInt(unsigned width)
+{
+    llvm::SmallVector<uint64_t, 2> words;
+    for (unsigned i = 0; i < llvm::APInt::getNumWords(width); ++i) {
+        words.push_back(this->readULEB128());
+    }
+
+    return llvm::APInt(width, words);
+}
+
+std::unique_ptr<VerificationResult> EntryReader::read(llvm::StringRef key)
+{
+    if (static_cast<size_t>(mEnd - mPtr) < sizeof(VerdictCacheMagic)
+        || std::memcmp(mPtr, VerdictCacheMagic, sizeof(VerdictCacheMagic)) != 0
+    ) {
+        return nullptr;
+    }
+    mPtr += sizeof(VerdictCacheMagic);
+
+    if (this->readULEB128() != VerdictCacheVersion || this->readString() != key) {
+        return nullptr;
+    }
+
+    uint64_t status = this->readULEB128();
+    std::vector<FailureRecord> failures;
+    switch (status) {
+        case VerificationResult::Success:
+        case VerificationResult::BoundReached:
+            break;
+        case VerificationResult::Fail: {
+            uint64_t numFailures = this->readULEB128();
+            if (numFailures == 0 || numFailures > static_cast<uint64_t>(mEnd - mPtr)) {
+                return nullptr;
+            }
+
+            failures.resize(numFailures);
+            for (FailureRecord& record : failures) {
+                if (!this->readFailure(record)) {
+                    return nullptr;
+                }
+            }
+            break;
+        }
+        default:
+            return nullptr;
+    }
+
+    uint64_t numCounterexamples = this->readULEB128();
+    if (numCounterexamples != mNumCounterexamples) {
+        return nullptr;
+    }
+
+    std::vector<Counterexample> counterexamples(numCounterexamples);
+    for (Counterexample& cex : counterexamples) {
+        if (!this->readCounterexample(cex)) {
+            return nullptr;
+        }
+    }
+
+    if (mFailed || mPtr != mEnd) {
+        return nullptr;
+    }
+
+    // The traces are only rebuilt once the whole entry is known to be valid.
+    switch (status) {
+        case VerificationResult::Success:
+            return VerificationResult::CreateSuccess();
+        case VerificationResult::BoundReached:
+            return VerificationResult::CreateBoundReached();
+        default:
+            break;
+    }
+
+    mNumCounterexamples = 0;
+    std::unique_ptr<FailResult> result = this->buildFailure(failures[0], counterexamples);
+    for (size_t i = 1; i < failures.size(); ++i) {
+        result->addFailure(this->buildFailure(failures[i], counterexamples));
+    }
+
+    return result;
+}
+
+bool EntryReader::readFailure(FailureRecord& record)
+{
+    uint64_t errorCode = this->readULEB128();
+    uint64_t kind = this->readULEB128();
+    if (mFailed || errorCode > std::numeric_limits<unsigned>::max()) {
+        return this->fail();
+    }
+
+    record.errorCode = errorCode;
+    record.traceKind = static_cast<TraceKind>(kind);
+
+    switch (record.traceKind) {
+        case TraceKind::None:
+        case TraceKind::Empty:
+            return true;
+        case TraceKind::Counterexample:
+            // Counterexamples are stored in the order of the failures using them.
+            if (this->readULEB128() != mNumCounterexamples++) {
+                return this->fail();
+            }
+            return !mFailed;
+    }
+
+    return this->fail();
+}
+
+std::unique_ptr<FailResult> EntryReader::buildFailure(
+    const FailureRecord& record, std::vector<Counterexample>& cexs)
+{
+    switch (record.traceKind) {
+        case TraceKind::None:
+            return std::make_unique<FailResult>(record.errorCode);
+        case TraceKind::Empty:
+            return std::make_unique<FailResult>(
+                record.errorCode, std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>())
+            );
+        case TraceKind::Counterexample: {
+            Counterexample& cex = cexs[mNumCounterexamples++];
+            return std::make_unique<FailResult>(record.errorCode, mTraceBuilder.build(cex.states, cex.actions));
+        }
+    }
+
+    llvm_unreachable("Unknown trace kind!");
+}
+
+bool EntryReader::readCounterexample(Counterexample& cex)
+{
+    GazerContext& context = mSystem.getContext();
+
+    uint64_t numStates = this->readULEB128();
+    for (uint64_t i = 0; i < numStates && !mFailed; ++i) {
+        Cfa* cfa = mSystem.getAutomatonByName(this->readString());
+        uint64_t id = this->readULEB128();
+
+        Location* loc = cfa != nullptr ? cfa->findLocationById(id) : nullptr;
+        if (loc == nullptr) {
+            return this->fail();
+        }
+        cex.states.push_back(loc);
+    }
+
+    uint64_t numActions = this->readULEB128();
+    for (uint64_t i = 0; i < numActions && !mFailed; ++i) {
+        auto& action = cex.actions.emplace_back();
+
+        uint64_t numAssigns = this->readULEB128();
+        for (uint64_t j = 0; j < numAssigns && !mFailed; ++j) {
+            Variable* variable = context.getVariable(this->readString());
+            if (variable == nullptr) {
+                return this->fail();
+            }
+
+            ExprPtr value = this->readValue(variable->getType());
+            if (value == nullptr) {
+                return this->fail();
+            }
+            action.emplace_back(variable, value);
+        }
+    }
+
+    return !mFailed;
+}
+
+ExprPtr EntryReader::readValue(Type& type)
+{
+    if (this->readULEB128() == 0) {
+        return UndefExpr::Get(type);
+    }
+
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), this->readULEB128() != 0);
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), this->readSLEB128());
+        case Type::RealTypeID: {
+            int64_t numerator = this->readSLEB128();
+            int64_t denominator = this->readSLEB128();
+            if (denominator <= 0) {
+                return nullptr;
+            }
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), numerator, denominator);
+        }
+        case Type::BvTypeID: {
+            auto& bvTy = llvm::cast<BvType>(type);
+            return BvLiteralExpr::Get(bvTy, this->readAPInt(bvTy.getWidth()));
+        }
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            llvm::APFloat value(fltTy.getLLVMSemantics(), this->readAPInt(fltTy.getWidth()));
+            return FloatLiteralExpr::Get(fltTy, value);
+        }
+        default:
+            return nullptr;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Cache
+//===----------------------------------------------------------------------===//
+
+static std::string getKeyHash(llvm::StringRef key)
+{
+    llvm::SHA1 hasher;
+    hasher.update(key);
+
+    return llvm::toHex(hasher.final());
+}
+
+/// Returns the path of a file in the cache directory.
+static std::string getCachePath(llvm::StringRef directory, const llvm::Twine& filename)
+{
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, filename);
+
+    return path.str().str();
+}
+
+static std::unique_ptr<llvm::MemoryBuffer> openEntry(llvm::StringRef path)
+{
+    int fd;
+    if (llvm::sys::fs::openFileForRead(path, fd)) {
+        return nullptr;
+    }
+
+    auto buffer = llvm::MemoryBuffer::getOpenFile(fd, path, /*FileSize=*/-1);
+
+    // Mark the entry as recently used, the least recently used
+    // entries are removed first when the cache is pruned.
+    if (buffer) {
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+    }
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+
+    if (!buffer) {
+        return nullptr;
+    }
+
+    return std::move(*buffer);
+}
+
+static void storeEntry(
+    const VerdictCacheSettings& settings, llvm::StringRef hash,
+    llvm::StringRef key, const VerificationResult& result, const RecordingTraceBuilder& recorder)
+{
+    std::string data;
+    llvm::raw_string_ostream rso(data);
+    if (!EntryWriter(rso, recorder).write(key, result)) {
+        return;
+    }
+    rso.flush();
+
+    if (llvm::sys::fs::create_directories(settings.directory)) {
+        return;
+    }
+
+    // If another process is writing the same entry, it will store the same verdict.
+    // Only the entries are named with the prefix recognized by the pruning,
+    // so that the lock and temporary files of other processes are left alone.
+    llvm::LockFileManager lock(getCachePath(settings.directory, hash));
+    if (lock.getState() != llvm::LockFileManager::LFS_Owned) {
+        return;
+    }
+
+    int fd;
+    llvm::SmallString<128> tempPath;
+    if (llvm::sys::fs::createUniqueFile(getCachePath(settings.directory, hash + ".tmp-%%%%%%%%"), fd, tempPath)) {
+        return;
+    }
+
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+        os << data;
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            return;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tempPath, getCachePath(settings.directory, "llvmcache-" + hash))) {
+        llvm::sys::fs::remove(tempPath);
+        return;
+    }
+
+    llvm::CachePruningPolicy policy;
+    policy.Interval = std::chrono::seconds(0);
+    policy.MaxSizeBytes = settings.maxSize;
+    llvm::pruneCache(settings.directory, policy);
+}
+
+auto VerdictCache::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+    -> std::unique_ptr<VerificationResult>
+{
+    // The pruning of LLVM's caches only considers files with this prefix.
+    std::string hash = getKeyHash(mKey);
+
+    if (auto buffer = openEntry(getCachePath(mSettings.directory, "llvmcache-" + hash))) {
+        EntryReader reader(buffer->getBuffer(), system, traceBuilder);
+        if (auto result = reader.read(mKey)) {
+            llvm::outs() << "Loaded verdict from cache.\n";
+            return result;
+        }
+    }
+
+    RecordingTraceBuilder recorder(traceBuilder);
+    auto result = mBackend.check(system, recorder);
+
+    storeEntry(mSettings, hash, mKey, *result, recorder);
+
+    return result;
+}
@@ -0,0 +1,36 @@
+; RUN: %cfa -memory=havoc "%s" | FileCheck "%s"
+
+; Functions which cannot be called from main are not translated, nor are their loops.
+; CHECK-NOT: unused
+; CHECK: procedure called(
+; CHECK-NOT: unused
+; CHECK: procedure main(
+; CHECK-NOT: unused
+
+declare i32 @__VERIFIER_nondet_int()
+
+define i32 @called(i32 %x) {
+    %y = add nsw i32 %x, 1
+    ret i32 %y
+}
+
+define i32 @unused(i32 %n) {
+entry:
+    br label %loop.header
+loop.header:
+    %i = phi i32 [ 0, %entry ], [ %i1, %loop.body ]
+    %cond = icmp slt i32 %i, %n
+    br i1 %cond, label %loop.body, label %loop.end
+loop.body:
+    %i1 = add nsw i32 %i, 1
+    br label %loop.header
+loop.end:
+    ret i32 %i
+}
+
+define i32 @main() {
+entry:
+    %a = call i32 @__VERIFIER_nondet_int()
+    %b = call i32 @called(i32 %a)
+    ret i32 %b
+}
@@ -0,0 +1,21 @@
+// RUN: %chc "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        if (x < 100) {
+            ++x;
+        }
+    }
+
+    assert(x <= 100);
+
+    return 0;
+}
\ No newline at end of file
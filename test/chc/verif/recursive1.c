@@ -0,0 +1,23 @@
+// RUN: %chc "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int f(int x)
+{
+    if (x > 10) {
+        return 10;
+    }
+
+    return f(x + 1);
+}
+
+int main(void)
+{
+    int r = f(__VERIFIER_nondet_int());
+    assert(r == 10);
+
+    return 0;
+}
\ No newline at end of file
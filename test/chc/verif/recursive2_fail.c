@@ -0,0 +1,24 @@
+// RUN: %chc "%s" | FileCheck "%s"
+// RUN: %chc -trace "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int f(int x)
+{
+    if (x > 10) {
+        return x;
+    }
+
+    return f(x + 1);
+}
+
+int main(void)
+{
+    int r = f(__VERIFIER_nondet_int());
+    assert(r != 11);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+// RUN: %bmc -discharge-errors -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Abstract interpretation discharged {{[0-9]+}} of {{[0-9]+}} error locations
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = a & 0xF;
+
+    // The first assertion always holds, the second one may fail.
+    assert(b < 16);
+    assert(a < 100);
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+// RUN: %bmc -discharge-errors -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Abstract interpretation discharged {{[0-9]+}} of {{[0-9]+}} error locations
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+int main(void)
+{
+    // The loop is not unrolled enough for BMC, but the error location is
+    // proven unreachable by the congruence of the counter.
+    for (int i = 0; i < 100; i += 2) {
+        assert(i != 51);
+    }
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+// RUN: %bmc -accelerate-loops -bound 1 "%s" | FileCheck "%s"
+// RUN: %bmc -accelerate-loops -bmc-encoding=block -bound 1 "%s" | FileCheck "%s"
+
+// The loop is replaced by its closed-form summary, thus a single unwinding is enough.
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int n = __VERIFIER_nondet_int();
+    if (n < 0 || n > 100000) {
+        return 0;
+    }
+
+    int x = 0;
+    for (int i = 0; i < n; ++i) {
+        x += 3;
+    }
+
+    assert(x == 3 * n);
+
+    return 0;
+}
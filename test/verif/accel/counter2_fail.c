@@ -0,0 +1,19 @@
+// RUN: %bmc -accelerate-loops -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int n = __VERIFIER_nondet_int();
+    int x = 0;
+    for (int i = n; i > 0; --i) {
+        x += 2;
+    }
+
+    assert(x != 2000);
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+// RUN: %bmc -bound 1 -all-errors "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+// CHECK-DAG: Assertion failure in {{.*}} at line 21
+// CHECK-DAG: Divison by zero in {{.*}} at line 24
+// CHECK-DAG: Assertion failure in {{.*}} at line 26
+// CHECK-NOT: at line 28
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = __VERIFIER_nondet_int();
+    int c = 0;
+
+    if (a > 10) {
+        c = 1;
+    }
+    assert(b != 5);
+
+    if (b <= 0) {
+        c = a / b;
+    }
+    assert(c != 1);
+
+    assert(a + a != 3);
+
+    return 0;
+}
@@ -1,4 +1,7 @@
 // RUN: %bmc -bound 10 "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -bmc-workers 4 "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -bmc-summaries "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -bmc-encoding=block "%s" | FileCheck "%s"
 
 // CHECK: Verification {{(SUCCESSFUL|BOUND REACHED)}}
 extern int __VERIFIER_nondet_int(void);
@@ -0,0 +1,20 @@
+// RUN: %bmc -reduce-bit-widths -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Bit-width reduction narrowed
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int flag = a > 10;
+    int code = flag ? 5 : 3;
+    int masked = a & 0xFF;
+
+    assert(code + masked <= 260);
+    assert(flag == 0 || code == 5);
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+// RUN: %bmc -reduce-bit-widths -bound 1 -trace "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int low = a % 16;
+    int flag = low > 7;
+    int code = flag ? 5 : 3;
+
+    assert(code + low != 17);
+
+    return 0;
+}
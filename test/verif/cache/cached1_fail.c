@@ -0,0 +1,24 @@
+// RUN: rm -rf "%t" && %bmc -verdict-cache="%t" -bound 1 -trace "%s" | FileCheck "%s" --check-prefix=MISS
+// RUN: %bmc -verdict-cache="%t" -bound 1 -trace "%s" | FileCheck "%s" --check-prefix=HIT
+// RUN: %bmc -verdict-cache="%t" -bound 2 -trace "%s" | FileCheck "%s" --check-prefix=MISS
+
+// MISS-NOT: Loaded verdict from cache.
+// MISS: Verification FAILED
+// MISS: Error trace:
+
+// HIT: Loaded verdict from cache.
+// HIT-NEXT: Verification FAILED
+// HIT: Error trace:
+// HIT: x := 5
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+
+    assert(x != 5);
+
+    return 0;
+}
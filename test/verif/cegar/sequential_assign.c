@@ -0,0 +1,21 @@
+// RUN: %cegar -no-optimize -elim-vars=off "%s" | FileCheck "%s"
+// RUN: %cegar -no-optimize -elim-vars=off -predsplit ATOMS "%s" | FileCheck "%s"
+
+// The assignments of y and z are placed on the same transition, and z
+// must read the value of y set by the preceding assignment.
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = x + 1;
+    int z = y - x;
+
+    assert(z == 1);
+
+    return 0;
+}
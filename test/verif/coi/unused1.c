@@ -0,0 +1,28 @@
+// RUN: %bmc -cone-of-influence -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Cone-of-influence reduction removed {{[0-9]+}} of {{[0-9]+}} variables
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int sum(int a, int b, int* out)
+{
+    *out = a * b;
+    return a + b;
+}
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = __VERIFIER_nondet_int();
+    int product;
+
+    // Only the range of 'x' matters for the assertion.
+    int s = sum(x, y, &product);
+    int c = x & 0xF;
+
+    assert(c < 16);
+
+    return s == product;
+}
@@ -0,0 +1,22 @@
+// RUN: %bmc -cone-of-influence -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int inc(int a, int b)
+{
+    int unused = a * b;
+    return a + 1;
+}
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = __VERIFIER_nondet_int();
+
+    assert(inc(x, y) != 5);
+
+    return 0;
+}
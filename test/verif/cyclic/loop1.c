@@ -0,0 +1,18 @@
+// RUN: %bmc -bmc-cyclic -bound 20 "%s" | FileCheck "%s"
+
+// The loop terminates within the bound, thus the unrolling is complete.
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+int main(void)
+{
+    int sum = 0;
+
+    for (int i = 0; i < 5; ++i) {
+        sum = sum + i;
+    }
+
+    assert(sum == 10);
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+// RUN: %bmc -bmc-cyclic -bound 20 "%s" | FileCheck "%s"
+
+// Mutually tail-recursive functions are unrolled as a single cycle.
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern unsigned __VERIFIER_nondet_uint(void);
+
+static int is_odd(unsigned n);
+
+static int is_even(unsigned n)
+{
+    if (n == 0) {
+        return 1;
+    }
+
+    return is_odd(n - 1);
+}
+
+static int is_odd(unsigned n)
+{
+    if (n == 0) {
+        return 0;
+    }
+
+    return is_even(n - 1);
+}
+
+int main(void)
+{
+    unsigned n = __VERIFIER_nondet_uint();
+    if (n > 6) {
+        return 0;
+    }
+
+    assert(!is_even(n) || n != 4);
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+// RUN: %bmc -bmc-cyclic -bound 30 "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int n = __VERIFIER_nondet_int();
+    int count = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < n && j < 3; ++j) {
+            count = count + 1;
+        }
+    }
+
+    assert(count < 6);
+
+    return 0;
+}
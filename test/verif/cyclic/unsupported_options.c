@@ -0,0 +1,13 @@
+// RUN: not %bmc -bmc-cyclic -all-errors -bmc-workers=2 "%s" 2>&1 | FileCheck "%s"
+// RUN: not %bmc -k-induction -bmc-summaries -bmc-inline-budget=2 "%s" 2>&1 | FileCheck "%s" --check-prefix=KIND
+
+// CHECK: ERROR: -all-errors cannot be used together with -bmc-cyclic.
+// CHECK: ERROR: -bmc-workers cannot be used together with -bmc-cyclic.
+
+// KIND: ERROR: -bmc-summaries cannot be used together with -k-induction.
+// KIND: ERROR: -bmc-inline-* cannot be used together with -k-induction.
+
+int main(void)
+{
+    return 0;
+}
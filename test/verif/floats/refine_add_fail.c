@@ -0,0 +1,17 @@
+// RUN: %bmc -bound 1 -floats=refine "%s" | FileCheck "%s"
+// RUN: %bmc -bound 1 -floats=undef "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+float __VERIFIER_nondet_float(void);
+
+int main(void)
+{
+    float x = __VERIFIER_nondet_float();
+    float y = x + 1.0f;
+
+    assert(y != x);
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+// RUN: %bmc -bound 1 -floats=refine "%s" | FileCheck "%s"
+
+// CHECK: The counterexample is spurious
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+float __VERIFIER_nondet_float(void);
+
+int main(void)
+{
+    float x = __VERIFIER_nondet_float();
+
+    if (x >= 0.0f && x <= 100.0f) {
+        float y = x * 2.0f;
+        assert(y <= 200.0f);
+    }
+
+    return 0;
+}
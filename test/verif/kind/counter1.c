@@ -0,0 +1,25 @@
+// RUN: %bmc -k-induction -bound 10 "%s" | FileCheck "%s"
+// RUN: %bmc -k-induction -kind-invariants -bound 10 "%s" | FileCheck "%s"
+// RUN: %bmc -k-induction -bmc-encoding=block -bound 10 "%s" | FileCheck "%s"
+
+// Plain bounded model checking can only reach the bound on this program.
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        i = i + 1;
+        if (i > 100) {
+            i = 0;
+        }
+    }
+
+    assert(i <= 100);
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+// RUN: %bmc -k-induction -bound 20 "%s" | FileCheck "%s"
+// RUN: %bmc -k-induction -kind-invariants -bound 20 "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        i = i + 1;
+        if (i > 100) {
+            i = 0;
+        }
+    }
+
+    assert(i < 5);
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+// RUN: %bmc -k-induction -bound 10 "%s" | FileCheck "%s"
+
+// CHECK: Verification {{(SUCCESSFUL|BOUND REACHED)}}
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+    int n = __VERIFIER_nondet_int();
+
+    while (i < n) {
+        int j = 0;
+        while (j < i) {
+            ++j;
+        }
+        assert(j == i || i < 0);
+        ++i;
+    }
+
+    return 0;
+}
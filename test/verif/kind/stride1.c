@@ -0,0 +1,24 @@
+// RUN: %bmc -k-induction -kind-invariants -bound 10 "%s" | FileCheck "%s"
+
+// The parity of 'i' is not k-inductive for any k on its own, but it is
+// found by the abstract interpretation of the loop.
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        i = i + 2;
+        if (i > 100) {
+            i = 0;
+        }
+    }
+
+    assert(i != 51);
+
+    return 0;
+}
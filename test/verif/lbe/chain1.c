@@ -0,0 +1,24 @@
+// RUN: %bmc -large-block-encoding -bound 1 "%s" | FileCheck "%s"
+
+// CHECK: Large-block encoding reduced the automata from {{[0-9]+}} to {{[0-9]+}} locations
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = a & 0xFF;
+    int c = b + 1;
+
+    if (c > 0) {
+        c = c * 2;
+    } else {
+        c = 1;
+    }
+
+    assert(c > 0);
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+// RUN: %bmc -large-block-encoding -bound 1 -trace "%s" | FileCheck "%s"
+
+// CHECK: Large-block encoding reduced the automata
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = a % 16;
+
+    if (b > 7) {
+        b = b - 8;
+    }
+
+    assert(b != 5);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+// RUN: %portfolio "%s" | FileCheck "%s"
+// RUN: %portfolio -trace "%s" | FileCheck "%s"
+
+// CHECK: Verdict found by engine
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        i = i + 1;
+        if (i > 100) {
+            i = 0;
+        }
+    }
+
+    assert(i < 5);
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+// RUN: %portfolio "%s" | FileCheck "%s"
+
+// CHECK: Verdict found by engine 'native'
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        if (x < 100) {
+            ++x;
+        }
+    }
+
+    assert(x <= 100);
+
+    return 0;
+}
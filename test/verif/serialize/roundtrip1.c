@@ -0,0 +1,22 @@
+// RUN: %cfa -run-pipeline -o %t "%s" && %bmc -bound 10 %t | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int sum = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        sum += 2;
+    }
+
+    if (x > 0) {
+        assert(sum == 8);
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+// RUN: %cfa -run-pipeline -o %t "%s" && %bmc -bound 1 %t | FileCheck "%s"
+
+// CHECK: Verification FAILED
+// CHECK-NEXT: Assertion failure
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int inc(int a)
+{
+    return a + 1;
+}
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+
+    assert(inc(x) != 5);
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+// RUN: %bmc -simulate -simulate-runs 100 -bound 10 "%s" | FileCheck "%s"
+
+// CHECK: Random simulation found no errors
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = __VERIFIER_nondet_int();
+
+    // Random values are unlikely to satisfy this condition.
+    if (x == 123456789 && y == x * 7) {
+        assert(0);
+    }
+
+    return 0;
+}
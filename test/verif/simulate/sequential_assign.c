@@ -0,0 +1,21 @@
+// RUN: %bmc -no-optimize -elim-vars=off -simulate -simulate-runs 100 "%s" | FileCheck "%s"
+
+// The assignments of y and z are placed on the same transition. If z read
+// a stale value of y, the simulation would report a spurious error.
+
+// CHECK: Random simulation found no errors
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = x + 1;
+    int z = y - x;
+
+    assert(z == 1);
+
+    return 0;
+}
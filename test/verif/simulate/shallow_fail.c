@@ -0,0 +1,23 @@
+// RUN: %bmc -simulate "%s" | FileCheck "%s"
+// RUN: %bmc -simulate -trace "%s" | FileCheck "%s"
+// RUN: %bmc -simulate -bmc-workers 4 "%s" | FileCheck "%s"
+
+// CHECK: Random simulation found an error
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int sum = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        sum += x;
+    }
+
+    assert(sum != 0);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 // RUN: %bmc -bound 10 -math-int "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -math-int -bmc-inline-strategy=cost -bmc-inline-budget=2 "%s" | FileCheck "%s"
 
 // CHECK: Verification FAILED
 
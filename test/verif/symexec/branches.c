@@ -0,0 +1,25 @@
+// RUN: %bmc -symbolic-execution "%s" | FileCheck "%s"
+// RUN: %bmc -symbolic-execution -symexec-search=bfs -bmc-workers 2 "%s" | FileCheck "%s"
+// RUN: %bmc -symbolic-execution -symexec-merge-limit=0 "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = __VERIFIER_nondet_int();
+    int max;
+
+    if (a > b) {
+        max = a;
+    } else {
+        max = b;
+    }
+
+    assert(max >= a && max >= b);
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+// RUN: %bmc -symbolic-execution -bound 100 "%s" | FileCheck "%s"
+// RUN: %bmc -symbolic-execution -bound 100 -trace "%s" | FileCheck "%s"
+// RUN: %bmc -symbolic-execution -bound 100 -symexec-search=coverage "%s" | FileCheck "%s"
+// RUN: %bmc -symbolic-execution -bound 100 -bmc-workers 4 "%s" | FileCheck "%s"
+
+// The error is only reachable after 40 iterations of the loop. Merging the
+// branches of the loop body keeps the number of paths linear.
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+    int x = 0;
+
+    while (__VERIFIER_nondet_int()) {
+        if (__VERIFIER_nondet_int()) {
+            x = x + 2;
+        } else {
+            x = x + 1;
+        }
+        ++i;
+        if (i > 40) {
+            assert(x != 80);
+        }
+    }
+
+    return 0;
+}
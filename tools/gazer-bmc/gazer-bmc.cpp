@@ -15,6 +15,7 @@
 // limitations under the License.
 //
 //===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaSerialization.h"
 #include "gazer/LLVM/Instrumentation/DefaultChecks.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
 #include "gazer/LLVM/LLVMFrontend.h"
@@ -22,6 +23,9 @@
 
 #include "gazer/Z3Solver/Z3Solver.h"
 #include "gazer/Verifier/BoundedModelChecker.h"
+#include "gazer/Verifier/KInduction.h"
+#include "gazer/Verifier/SymbolicExecution.h"
+#include "gazer/Verifier/Simulation.h"
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Verifier.h>
@@ -49,6 +53,80 @@ namespace
     cl::opt<unsigned> EagerUnroll("eager-unroll", cl::desc("Eager unrolling bound"), cl::init(0),
         cl::cat(BmcAlgorithmCategory));
 
+    cl::opt<PathConditionEncoding> Encoding("bmc-encoding",
+        cl::desc("Shape of the path condition formulas"),
+        cl::values(
+            clEnumValN(PathConditionEncoding::Nested, "nested", "Inline location conditions into their successors"),
+            clEnumValN(PathConditionEncoding::Reachability, "reach", "Use a reachability variable for each location"),
+            clEnumValN(PathConditionEncoding::Block, "block", "Use reachability variables at block boundaries")
+        ),
+        cl::init(PathConditionEncoding::Nested), cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<BmcInlineStrategy> InlineStrategy("bmc-inline-strategy",
+        cl::desc("Order in which the open calls of a counterexample are inlined"),
+        cl::values(
+            clEnumValN(BmcInlineStrategy::CexOrder, "cex", "Inline calls in counterexample order"),
+            clEnumValN(BmcInlineStrategy::CostModel, "cost", "Rank calls using an inlining cost model")
+        ),
+        cl::init(BmcInlineStrategy::CexOrder), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> InlineBudget("bmc-inline-budget",
+        cl::desc("Maximum number of calls to inline in one step (0 means unlimited)"),
+        cl::init(0), cl::cat(BmcAlgorithmCategory));
+    cl::opt<double> InlineSizeWeight("bmc-inline-size-weight",
+        cl::desc("Weight of the callee size in the inlining cost model"),
+        cl::init(1.0), cl::cat(BmcAlgorithmCategory));
+    cl::opt<double> InlineDepthWeight("bmc-inline-depth-weight",
+        cl::desc("Weight of the call depth in the inlining cost model"),
+        cl::init(1.0), cl::cat(BmcAlgorithmCategory));
+    cl::opt<double> InlineFrequencyWeight("bmc-inline-freq-weight",
+        cl::desc("Weight of the call frequency in counterexamples in the inlining cost model"),
+        cl::init(1.0), cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<unsigned> NumWorkers("bmc-workers",
+        cl::desc("Number of solver instances to run in parallel (1 means sequential)"),
+        cl::init(1), cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> AllErrors("all-errors",
+        cl::desc("Continue the search after a counterexample to find every reachable error"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> UseSummaries("bmc-summaries",
+        cl::desc("Over-approximate call sites with precomputed procedure summaries"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> CyclicUnroll("bmc-cyclic",
+        cl::desc("Unroll loops as cycles in time frames instead of inlining each iteration"),
+        cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<bool> KInductionOpt("k-induction",
+        cl::desc("Prove safety with k-induction, using the bound as the maximum k"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> KInductionInvariants("kind-invariants",
+        cl::desc("Strengthen the inductive step with abstract interpretation facts and initial bounds of loop variables"),
+        cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<bool> SymbolicExecutionOpt("symbolic-execution",
+        cl::desc("Search for errors with symbolic execution, using the bound as the maximum call depth"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<SymExecSearch> SymExecSearchOpt("symexec-search",
+        cl::desc("Search heuristic of symbolic execution"),
+        cl::values(
+            clEnumValN(SymExecSearch::Dfs, "dfs", "Depth-first search"),
+            clEnumValN(SymExecSearch::Bfs, "bfs", "Breadth-first search"),
+            clEnumValN(SymExecSearch::Coverage, "coverage", "Prefer states at the least visited locations")
+        ),
+        cl::init(SymExecSearch::Dfs), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> SymExecMergeLimit("symexec-merge-limit",
+        cl::desc("Maximum number of locations in a region merged by symbolic execution (0 disables merging)"),
+        cl::init(8), cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<bool> Simulate("simulate",
+        cl::desc("Look for shallow errors with random simulation before running the backend"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> SimulateRuns("simulate-runs",
+        cl::desc("Maximum number of random simulation runs"),
+        cl::init(10000), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> SimulateBudget("simulate-budget",
+        cl::desc("Maximum time spent in random simulation, in milliseconds"),
+        cl::init(2000), cl::cat(BmcAlgorithmCategory));
+
     cl::opt<bool> DumpCfa("debug-dump-cfa", cl::desc("Dump the generated CFA after each inlining step"),
         cl::cat(BmcAlgorithmCategory));
     cl::opt<bool> DumpFormula("dump-formula", cl::desc("Dump the solver formula to stderr"),
@@ -73,7 +151,9 @@ namespace gazer
     extern cl::OptionCategory ChecksCategory;
 } // end namespace gazer
 
+static bool checkBackendOptions();
 static BmcSettings initBmcSettingsFromCommandLine();
+static std::string describeBackendFromCommandLine();
 
 int main(int argc, char* argv[])
 {
@@ -91,20 +171,79 @@ int main(int argc, char* argv[])
     llvm::EnableDebugBuffering = true;
     #endif
 
-    // Create the frontend object
-    FrontendConfigWrapper config;
-    auto frontend = config.buildFrontend(InputFilenames);
-    if (frontend == nullptr) {
+    if (!checkBackendOptions()) {
         return 1;
     }
 
+    FrontendConfigWrapper config;
+
+    // K-induction and the cyclic unrolling work on a single cyclic automaton,
+    // inline all procedures.
+    if (KInductionOpt || CyclicUnroll) {
+        config.getSettings().inlineLevel = InlineLevel::All;
+    }
+
+    // Automata systems written by gazer-cfa are verified directly, without the frontend.
+    bool isSerialized = InputFilenames.size() == 1 && IsAutomataSystemFile(InputFilenames[0]);
+
+    // Create the frontend object
+    std::unique_ptr<LLVMFrontend> frontend;
+    if (!isSerialized) {
+        frontend = config.buildFrontend(InputFilenames);
+        if (frontend == nullptr) {
+            return 1;
+        }
+    }
+
     Z3SolverFactory solverFactory;
 
     auto bmcSettings = initBmcSettingsFromCommandLine();
-    bmcSettings.simplifyExpr = frontend->getSettings().simplifyExpr;
-    bmcSettings.trace = frontend->getSettings().trace;
+    bmcSettings.simplifyExpr = config.getSettings().simplifyExpr;
+    bmcSettings.trace = config.getSettings().isTraceRequired();
+
+    std::unique_ptr<VerificationAlgorithm> backend;
+    if (KInductionOpt) {
+        KInductionSettings kindSettings;
+        kindSettings.trace = bmcSettings.trace;
+        kindSettings.dumpFormula = bmcSettings.dumpFormula;
+        kindSettings.printSolverStats = bmcSettings.printSolverStats;
+        kindSettings.maxBound = bmcSettings.maxBound;
+        kindSettings.simplifyExpr = bmcSettings.simplifyExpr;
+        kindSettings.encoding = bmcSettings.encoding;
+        kindSettings.useInvariants = KInductionInvariants;
+
+        backend = std::make_unique<KInduction>(solverFactory, kindSettings);
+    } else if (SymbolicExecutionOpt) {
+        SymExecSettings symSettings;
+        symSettings.trace = bmcSettings.trace;
+        symSettings.printSolverStats = bmcSettings.printSolverStats;
+        symSettings.simplifyExpr = bmcSettings.simplifyExpr;
+        symSettings.search = SymExecSearchOpt;
+        symSettings.maxCallDepth = bmcSettings.maxBound;
+        symSettings.mergeLimit = SymExecMergeLimit;
+        symSettings.numWorkers = bmcSettings.numWorkers;
 
-    frontend->setBackendAlgorithm(new BoundedModelChecker(solverFactory, bmcSettings));
+        backend = std::make_unique<SymbolicExecution>(solverFactory, symSettings);
+    } else {
+        backend = std::make_unique<BoundedModelChecker>(solverFactory, bmcSettings);
+    }
+
+    if (Simulate) {
+        SimulationSettings simSettings;
+        simSettings.trace = bmcSettings.trace;
+        simSettings.numRuns = SimulateRuns;
+        simSettings.timeBudget = SimulateBudget;
+        simSettings.numWorkers = bmcSettings.numWorkers;
+
+        backend = std::make_unique<SimulationPrePass>(std::move(backend), simSettings);
+    }
+
+    if (isSerialized) {
+        bool loaded = VerifyAutomataSystemFile(InputFilenames[0], config.context, *backend, config.getSettings().trace);
+        return loaded ? 0 : 1;
+    }
+
+    frontend->setBackendAlgorithm(backend.release(), describeBackendFromCommandLine());
     frontend->registerVerificationPipeline();
 
     frontend->run();
@@ -112,6 +251,51 @@ int main(int argc, char* argv[])
     return 0;
 }
 
+bool checkBackendOptions()
+{
+    if (!KInductionOpt && !CyclicUnroll) {
+        return true;
+    }
+
+    // K-induction and the cyclic unrolling do not inline lazily, and they
+    // stop at the first counterexample on a single solver instance.
+    llvm::StringRef algorithm = KInductionOpt ? "-k-induction" : "-bmc-cyclic";
+    llvm::SmallVector<llvm::StringRef, 4> unsupported;
+
+    if (KInductionOpt && CyclicUnroll) {
+        unsupported.push_back("-bmc-cyclic");
+    }
+
+    if (AllErrors) {
+        unsupported.push_back("-all-errors");
+    }
+
+    if (NumWorkers > 1) {
+        unsupported.push_back("-bmc-workers");
+    }
+
+    if (UseSummaries) {
+        unsupported.push_back("-bmc-summaries");
+    }
+
+    if (EagerUnroll != 0) {
+        unsupported.push_back("-eager-unroll");
+    }
+
+    if (InlineStrategy.getNumOccurrences() != 0 || InlineBudget.getNumOccurrences() != 0
+        || InlineSizeWeight.getNumOccurrences() != 0 || InlineDepthWeight.getNumOccurrences() != 0
+        || InlineFrequencyWeight.getNumOccurrences() != 0
+    ) {
+        unsupported.push_back("-bmc-inline-*");
+    }
+
+    for (llvm::StringRef option : unsupported) {
+        llvm::errs() << "ERROR: " << option << " cannot be used together with " << algorithm << ".\n";
+    }
+
+    return unsupported.empty();
+}
+
 BmcSettings initBmcSettingsFromCommandLine()
 {
     BmcSettings settings;
@@ -123,6 +307,64 @@ BmcSettings initBmcSettingsFromCommandLine()
 
     settings.maxBound = MaxBound;
     settings.eagerUnroll = EagerUnroll;
+    settings.encoding = Encoding;
+    settings.inlineStrategy = InlineStrategy;
+    settings.inlineBudget = InlineBudget;
+    settings.inlineSizeWeight = InlineSizeWeight;
+    settings.inlineDepthWeight = InlineDepthWeight;
+    settings.inlineFrequencyWeight = InlineFrequencyWeight;
+    settings.findAllErrors = AllErrors;
+    settings.numWorkers = NumWorkers;
+    settings.useSummaries = UseSummaries;
+    settings.cyclicUnroll = CyclicUnroll;
 
     return settings;
 }
+
+std::string describeBackendFromCommandLine()
+{
+    // Only the options which may change the verdict are listed,
+    // debugging and statistics options are left out.
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+
+    rso << "gazer-bmc"
+        << " bound=" << MaxBound
+        << " eager-unroll=" << EagerUnroll;
+
+    rso << " encoding=";
+    switch (Encoding) {
+        case PathConditionEncoding::Nested:        rso << "nested"; break;
+        case PathConditionEncoding::Reachability:  rso << "reach"; break;
+        case PathConditionEncoding::Block:         rso << "block"; break;
+    }
+
+    rso << " inline-strategy=";
+    switch (InlineStrategy) {
+        case BmcInlineStrategy::CexOrder:   rso << "cex"; break;
+        case BmcInlineStrategy::CostModel:  rso << "cost"; break;
+    }
+
+    rso << " inline-budget=" << InlineBudget
+        << " inline-weights=" << InlineSizeWeight << "," << InlineDepthWeight << "," << InlineFrequencyWeight
+        << " all-errors=" << AllErrors
+        << " summaries=" << UseSummaries
+        << " cyclic=" << CyclicUnroll
+        << " k-induction=" << KInductionOpt
+        << " kind-invariants=" << KInductionInvariants
+        << " symbolic-execution=" << SymbolicExecutionOpt;
+
+    rso << " symexec-search=";
+    switch (SymExecSearchOpt) {
+        case SymExecSearch::Dfs:       rso << "dfs"; break;
+        case SymExecSearch::Bfs:       rso << "bfs"; break;
+        case SymExecSearch::Coverage:  rso << "coverage"; break;
+    }
+
+    rso << " symexec-merge-limit=" << SymExecMergeLimit
+        << " simulate=" << Simulate
+        << " simulate-runs=" << SimulateRuns
+        << " simulate-budget=" << SimulateBudget;
+
+    return rso.str();
+}
@@ -42,6 +42,9 @@ namespace
     cl::opt<bool> ViewCfa("view", cl::desc("View the CFA in the system's GraphViz viewier."));
     cl::opt<bool> CyclicCfa("cyclic", cl::desc("Represent LoopRep as cycles instead of recursive calls."));
     cl::opt<bool> RunPipeline("run-pipeline", cl::desc("Run the early stages of the verification pipeline, such as instrumentation."));
+    cl::opt<std::string> OutputFilename("o",
+        cl::desc("Write the automata system into a binary file, which may be verified by gazer-bmc and gazer-theta"),
+        cl::value_desc("filename"));
 }
 
 int main(int argc, char* argv[])
@@ -77,7 +80,26 @@ int main(int argc, char* argv[])
         frontend->registerPass(gazer::createCfaViewerPass());
     }
 
+    std::unique_ptr<llvm::ToolOutputFile> output;
+    if (!OutputFilename.empty()) {
+        std::error_code ec;
+        output = std::make_unique<llvm::ToolOutputFile>(OutputFilename, ec, llvm::sys::fs::F_None);
+        if (ec) {
+            llvm::errs() << "ERROR: Could not open '" << OutputFilename << "': " << ec.message() << "\n";
+            return 1;
+        }
+
+        // Error codes are only registered by the instrumentation of the pipeline.
+        frontend->registerPass(gazer::createCfaWriterPass(
+            output->os(), RunPipeline ? &frontend->getChecks() : nullptr
+        ));
+    }
+
     frontend->run();
 
+    if (output != nullptr) {
+        output->keep();
+    }
+
     llvm::llvm_shutdown();
 }
@@ -0,0 +1,98 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Instrumentation/DefaultChecks.h"
+#include "gazer/LLVM/Automaton/ModuleToAutomata.h"
+#include "gazer/LLVM/LLVMFrontend.h"
+#include "gazer/LLVM/ClangFrontend.h"
+
+#include "gazer/Z3Solver/Z3ChcVerifier.h"
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+
+#ifndef NDEBUG
+#include <llvm/Support/PrettyStackTrace.h>
+#include <llvm/Support/Signals.h>
+#include <llvm/Support/Debug.h>
+#endif
+
+#include <string>
+
+using namespace gazer;
+using namespace llvm;
+
+namespace
+{
+    cl::list<std::string> InputFilenames(cl::Positional, cl::OneOrMore, cl::desc("<input files>"));
+
+    cl::OptionCategory ChcAlgorithmCategory("Horn clause verifier settings");
+
+    cl::opt<bool> DumpRules("dump-rules", cl::desc("Dump the generated Horn clauses to stderr"),
+        cl::cat(ChcAlgorithmCategory));
+
+    llvm::cl::opt<bool> PrintSolverStats("print-solver-stats",
+        llvm::cl::desc("Print solver statistics information"),
+        cl::cat(ChcAlgorithmCategory)
+    );
+}
+
+namespace gazer
+{
+    extern cl::OptionCategory ClangFrontendCategory;
+    extern cl::OptionCategory LLVMFrontendCategory;
+    extern cl::OptionCategory IrToCfaCategory;
+    extern cl::OptionCategory TraceCategory;
+    extern cl::OptionCategory ChecksCategory;
+} // end namespace gazer
+
+int main(int argc, char* argv[])
+{
+    cl::HideUnrelatedOptions({
+        &ClangFrontendCategory, &LLVMFrontendCategory, &IrToCfaCategory,
+        &TraceCategory, &ChecksCategory, &ChcAlgorithmCategory
+    });
+
+    cl::SetVersionPrinter(&FrontendConfigWrapper::PrintVersion);
+    cl::ParseCommandLineOptions(argc, argv);
+
+    #ifndef NDEBUG
+    llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+    llvm::PrettyStackTraceProgram(argc, argv);
+    llvm::EnableDebugBuffering = true;
+    #endif
+
+    // Create the frontend object
+    FrontendConfigWrapper config;
+    auto frontend = config.buildFrontend(InputFilenames);
+    if (frontend == nullptr) {
+        return 1;
+    }
+
+    ChcSettings settings;
+    settings.dumpRules = DumpRules;
+    settings.printSolverStats = PrintSolverStats;
+    settings.trace = frontend->getSettings().isTraceRequired();
+
+    frontend->setBackendAlgorithm(new Z3ChcVerifier(settings));
+    frontend->registerVerificationPipeline();
+
+    frontend->run();
+
+    return 0;
+}
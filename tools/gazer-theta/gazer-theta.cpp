@@ -18,8 +18,14 @@
 #include "lib/ThetaVerifier.h"
 #include "lib/ThetaCfaGenerator.h"
 
+#include "gazer/Automaton/CfaSerialization.h"
 #include "gazer/LLVM/LLVMFrontend.h"
 #include "gazer/Core/GazerContext.h"
+#include "gazer/Verifier/PredicateAbstraction.h"
+#include "gazer/Verifier/BoundedModelChecker.h"
+#include "gazer/Verifier/SymbolicExecution.h"
+#include "gazer/Verifier/Portfolio.h"
+#include "gazer/Z3Solver/Z3Solver.h"
 
 #include <llvm/IR/Module.h>
 #include <boost/dll/runtime_symbol_info.hpp>
@@ -49,6 +55,11 @@ namespace
         cl::desc("Do not run the verification engine, just write the theta CFA"),
         cl::cat(ThetaEnvironmentCategory)
     );
+    cl::opt<bool> Native("native",
+        cl::desc("Use gazer's in-process predicate abstraction engine instead of running theta."
+                 " Refinement is always based on weakest preconditions"),
+        cl::cat(ThetaEnvironmentCategory)
+    );
 
     cl::opt<std::string> ThetaPath("theta-path",
         cl::desc("Full path to the theta-cfa jar file. Defaults to '<path_to_this_binary>/theta/theta-cfa-cli.jar'"),
@@ -73,6 +84,32 @@ namespace
     cl::opt<std::string> Encoding("encoding", cl::desc("Block encoding"), cl::init("LBE"), cl::cat(ThetaAlgorithmCategory));
     cl::opt<int> MaxEnum("maxenum", cl::desc("Maximal number of explicitly enumerated successors"), cl::init(0), cl::cat(ThetaAlgorithmCategory));
     cl::opt<std::string> InitPrec("initPrec", cl::desc("Initial precision of abstraction"), cl::init("EMPTY"), cl::cat(ThetaAlgorithmCategory));
+
+    // Portfolio options
+    cl::OptionCategory PortfolioCategory("Portfolio settings");
+
+    enum class PortfolioEngine { ThetaPred, ThetaExpl, Native, Bmc, BmcEager, SymExec };
+
+    cl::opt<bool> PortfolioOpt("portfolio",
+        cl::desc("Run several verification engines concurrently and report the first conclusive verdict"),
+        cl::cat(PortfolioCategory));
+    cl::list<PortfolioEngine> PortfolioEngines("portfolio-engines",
+        cl::desc("Engines of the portfolio (defaults to all)"),
+        cl::values(
+            clEnumValN(PortfolioEngine::ThetaPred, "theta-pred", "Theta with the PRED_CART domain"),
+            clEnumValN(PortfolioEngine::ThetaExpl, "theta-expl", "Theta with the EXPL domain"),
+            clEnumValN(PortfolioEngine::Native, "native", "Gazer's in-process predicate abstraction engine"),
+            clEnumValN(PortfolioEngine::Bmc, "bmc", "Bounded model checking"),
+            clEnumValN(PortfolioEngine::BmcEager, "bmc-eager", "Bounded model checking with eager unrolling"),
+            clEnumValN(PortfolioEngine::SymExec, "symexec", "Symbolic execution")
+        ),
+        cl::CommaSeparated, cl::cat(PortfolioCategory));
+    cl::opt<unsigned> PortfolioBound("portfolio-bound",
+        cl::desc("Maximum bound of the BMC engines and maximum call depth of symbolic execution"),
+        cl::init(100), cl::cat(PortfolioCategory));
+    cl::opt<unsigned> PortfolioEagerUnroll("portfolio-eager-unroll",
+        cl::desc("Eager unrolling bound of the bmc-eager engine"),
+        cl::init(5), cl::cat(PortfolioCategory));
 } // end anonymous namespace
 
 namespace gazer
@@ -85,13 +122,17 @@ namespace gazer
 } // end namespace gazer
 
 static theta::ThetaSettings initSettingsFromCommandLine();
+static bool initNativeSettingsFromCommandLine(CegarSettings& settings);
+static void addPortfolioEngines(
+    Portfolio& portfolio, const theta::ThetaSettings& thetaSettings, const CegarSettings& nativeSettings);
+static std::string describeBackendFromCommandLine();
 
 int main(int argc, char* argv[])
 {
     cl::HideUnrelatedOptions({
         &ClangFrontendCategory, &LLVMFrontendCategory,
         &IrToCfaCategory, &TraceCategory, &ChecksCategory,
-        &ThetaEnvironmentCategory, &ThetaAlgorithmCategory
+        &ThetaEnvironmentCategory, &ThetaAlgorithmCategory, &PortfolioCategory
     });
 
     cl::SetVersionPrinter(&FrontendConfigWrapper::PrintVersion);
@@ -107,7 +148,7 @@ int main(int argc, char* argv[])
     FrontendConfigWrapper config;
     theta::ThetaSettings backendSettings = initSettingsFromCommandLine();
 
-    if (backendSettings.thetaCfaPath.empty() || backendSettings.thetaLibPath.empty()) {
+    if ((!Native || PortfolioOpt) && (backendSettings.thetaCfaPath.empty() || backendSettings.thetaLibPath.empty())) {
         // Find the current program location
         boost::dll::fs::error_code ec;
         auto pathToBinary = boost::dll::program_location(ec);
@@ -126,19 +167,65 @@ int main(int argc, char* argv[])
         }
     }
 
-    // Force -math-int
+    // Force -math-int, the native engine uses it as well to give comparable results.
     config.getSettings().ints = IntRepresentation::Integers;
 
+    // Automata systems written by gazer-cfa are verified directly, without the frontend.
+    bool isSerialized = InputFilenames.size() == 1 && IsAutomataSystemFile(InputFilenames[0]);
+
     // Create the frontend object
-    auto frontend = config.buildFrontend(InputFilenames);
-    if (frontend == nullptr) {
-        return 1;
+    std::unique_ptr<LLVMFrontend> frontend;
+    if (!isSerialized) {
+        frontend = config.buildFrontend(InputFilenames);
+        if (frontend == nullptr) {
+            return 1;
+        }
     }
 
-    if (!ModelOnly) {
-        frontend->setBackendAlgorithm(new theta::ThetaVerifier(backendSettings));
+    Z3SolverFactory solverFactory;
+
+    // Runs the given backend algorithm and takes its ownership.
+    auto runBackend = [&](VerificationAlgorithm* algorithm) {
+        if (isSerialized) {
+            std::unique_ptr<VerificationAlgorithm> backend(algorithm);
+            bool loaded = VerifyAutomataSystemFile(InputFilenames[0], config.context, *backend, config.getSettings().trace);
+            return loaded ? 0 : 1;
+        }
+
+        frontend->setBackendAlgorithm(algorithm, describeBackendFromCommandLine());
         frontend->registerVerificationPipeline();
         frontend->run();
+        return 0;
+    };
+
+    if (!ModelOnly && PortfolioOpt) {
+        // The native engine follows the theta settings where possible,
+        // fall back to its defaults otherwise.
+        CegarSettings nativeSettings;
+        if (Domain != "PRED_CART" || !initNativeSettingsFromCommandLine(nativeSettings)) {
+            nativeSettings = CegarSettings();
+        }
+        nativeSettings.simplifyExpr = config.getSettings().simplifyExpr;
+        nativeSettings.trace = config.getSettings().isTraceRequired();
+
+        PortfolioSettings portfolioSettings;
+        portfolioSettings.trace = config.getSettings().isTraceRequired();
+
+        auto portfolio = new Portfolio(solverFactory, portfolioSettings);
+        addPortfolioEngines(*portfolio, backendSettings, nativeSettings);
+
+        return runBackend(portfolio);
+    } else if (!ModelOnly && Native) {
+        CegarSettings nativeSettings;
+        if (!initNativeSettingsFromCommandLine(nativeSettings)) {
+            return 1;
+        }
+        nativeSettings.simplifyExpr = config.getSettings().simplifyExpr;
+        nativeSettings.trace = config.getSettings().isTraceRequired();
+
+        return runBackend(new PredicateAbstraction(solverFactory, nativeSettings));
+    } else if (!ModelOnly) {
+        return runBackend(new theta::ThetaVerifier(backendSettings));
     } else {
         if (ModelPath.empty()) {
             llvm::errs() << "ERROR: -model-only must be supplied together with -o <path>!\n";
@@ -153,6 +240,19 @@ int main(int argc, char* argv[])
             return 1;
         }
 
+        if (isSerialized) {
+            auto serialized = ReadAutomataSystemFile(InputFilenames[0], config.context);
+            if (serialized.system == nullptr) {
+                llvm::errs() << "ERROR: " << serialized.error << "\n";
+                return 1;
+            }
+
+            theta::ThetaNameMapping mapping;
+            theta::ThetaCfaGenerator generator{*serialized.system};
+            generator.write(rfo, mapping);
+            return 0;
+        }
+
         // Do not run theta, just generate the model.
         frontend->registerVerificationPipeline();
         frontend->registerPass(theta::createThetaCfaWriterPass(rfo));
@@ -181,3 +281,144 @@ theta::ThetaSettings initSettingsFromCommandLine()
 
     return settings;
 }
+
+bool initNativeSettingsFromCommandLine(CegarSettings& settings)
+{
+    if (Domain != "PRED_CART") {
+        llvm::errs() << "ERROR: The native engine only supports the PRED_CART domain.\n";
+        return false;
+    }
+
+    if (Search == "BFS") {
+        settings.search = CegarSearch::Bfs;
+    } else if (Search == "DFS") {
+        settings.search = CegarSearch::Dfs;
+    } else {
+        llvm::errs() << "ERROR: Unsupported search strategy for the native engine: " << Search << "\n";
+        return false;
+    }
+
+    if (PrecGranularity == "GLOBAL") {
+        settings.precision = CegarPrecision::Global;
+    } else if (PrecGranularity == "LOCAL") {
+        settings.precision = CegarPrecision::Local;
+    } else {
+        llvm::errs() << "ERROR: Unsupported precision granularity for the native engine: " << PrecGranularity << "\n";
+        return false;
+    }
+
+    if (PredSplit == "WHOLE") {
+        settings.predSplit = CegarPredSplit::Whole;
+    } else if (PredSplit == "ATOMS") {
+        settings.predSplit = CegarPredSplit::Atoms;
+    } else {
+        llvm::errs() << "ERROR: Unsupported predicate splitting for the native engine: " << PredSplit << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void addPortfolioEngines(
+    Portfolio& portfolio, const theta::ThetaSettings& thetaSettings, const CegarSettings& nativeSettings)
+{
+    std::vector<PortfolioEngine> engines(PortfolioEngines.begin(), PortfolioEngines.end());
+    if (engines.empty()) {
+        engines = {
+            PortfolioEngine::ThetaPred, PortfolioEngine::ThetaExpl, PortfolioEngine::Native,
+            PortfolioEngine::Bmc, PortfolioEngine::BmcEager, PortfolioEngine::SymExec
+        };
+    }
+
+    BmcSettings bmcSettings{};
+    bmcSettings.trace = nativeSettings.trace;
+    bmcSettings.simplifyExpr = nativeSettings.simplifyExpr;
+    bmcSettings.maxBound = PortfolioBound;
+    bmcSettings.encoding = PathConditionEncoding::Nested;
+    bmcSettings.inlineStrategy = BmcInlineStrategy::CexOrder;
+    bmcSettings.inlineSizeWeight = 1.0;
+    bmcSettings.inlineDepthWeight = 1.0;
+    bmcSettings.inlineFrequencyWeight = 1.0;
+    bmcSettings.numWorkers = 1;
+
+    for (PortfolioEngine engine : engines) {
+        switch (engine) {
+            case PortfolioEngine::ThetaPred:
+            case PortfolioEngine::ThetaExpl: {
+                theta::ThetaSettings settings = thetaSettings;
+                settings.domain = engine == PortfolioEngine::ThetaPred ? "PRED_CART" : "EXPL";
+                portfolio.addEngine(
+                    engine == PortfolioEngine::ThetaPred ? "theta-pred" : "theta-expl",
+                    [settings](SolverFactory&) { return std::make_unique<theta::ThetaVerifier>(settings); }
+                );
+                break;
+            }
+            case PortfolioEngine::Native:
+                portfolio.addEngine("native", [nativeSettings](SolverFactory& solverFactory) {
+                    return std::make_unique<PredicateAbstraction>(solverFactory, nativeSettings);
+                });
+                break;
+            case PortfolioEngine::Bmc:
+            case PortfolioEngine::BmcEager: {
+                BmcSettings settings = bmcSettings;
+                if (engine == PortfolioEngine::BmcEager) {
+                    settings.eagerUnroll = std::min<unsigned>(PortfolioEagerUnroll, PortfolioBound);
+                }
+                portfolio.addEngine(
+                    engine == PortfolioEngine::Bmc ? "bmc" : "bmc-eager",
+                    [settings](SolverFactory& solverFactory) {
+                        return std::make_unique<BoundedModelChecker>(solverFactory, settings);
+                    }
+                );
+                break;
+            }
+            case PortfolioEngine::SymExec: {
+                SymExecSettings settings;
+                settings.trace = nativeSettings.trace;
+                settings.simplifyExpr = nativeSettings.simplifyExpr;
+                settings.maxCallDepth = PortfolioBound;
+                portfolio.addEngine("symexec", [settings](SolverFactory& solverFactory) {
+                    return std::make_unique<SymbolicExecution>(solverFactory, settings);
+                });
+                break;
+            }
+        }
+    }
+}
+
+std::string describeBackendFromCommandLine()
+{
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+
+    rso << "gazer-theta"
+        << " portfolio=" << PortfolioOpt
+        << " native=" << Native
+        << " domain=" << Domain
+        << " refinement=" << Refinement
+        << " search=" << Search
+        << " precgranularity=" << PrecGranularity
+        << " predsplit=" << PredSplit
+        << " encoding=" << Encoding
+        << " maxenum=" << MaxEnum
+        << " initprec=" << InitPrec;
+
+    if (PortfolioOpt) {
+        rso << " engines=";
+        for (PortfolioEngine engine : PortfolioEngines) {
+            switch (engine) {
+                case PortfolioEngine::ThetaPred:  rso << "theta-pred"; break;
+                case PortfolioEngine::ThetaExpl:  rso << "theta-expl"; break;
+                case PortfolioEngine::Native:     rso << "native"; break;
+                case PortfolioEngine::Bmc:        rso << "bmc"; break;
+                case PortfolioEngine::BmcEager:   rso << "bmc-eager"; break;
+                case PortfolioEngine::SymExec:    rso << "symexec"; break;
+            }
+            rso << ",";
+        }
+        rso << " portfolio-bound=" << PortfolioBound
+            << " portfolio-eager-unroll=" << PortfolioEagerUnroll;
+    }
+
+    return rso.str();
+}
@@ -21,6 +21,7 @@
 #include "gazer/Automaton/Cfa.h"
 #include "gazer/Support/SExpr.h"
 #include "gazer/Core/LiteralExpr.h"
+#include "gazer/Support/Stopwatch.h"
 
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/APInt.h>
@@ -30,6 +31,10 @@
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/CommandLine.h>
 
+#include <thread>
+
+#include <signal.h>
+
 using namespace gazer;
 using namespace gazer::theta;
 
@@ -44,8 +49,10 @@ llvm::cl::opt<bool> PrintRawCex("print-raw-cex", llvm::cl::desc("Print the raw c
 class ThetaVerifierImpl
 {
 public:
-    explicit ThetaVerifierImpl(AutomataSystem& system, ThetaSettings settings, CfaTraceBuilder& traceBuilder)
-        : mSystem(system), mSettings(settings), mTraceBuilder(traceBuilder)
+    explicit ThetaVerifierImpl(
+        AutomataSystem& system, ThetaSettings settings, CfaTraceBuilder& traceBuilder,
+        const std::atomic<bool>& interrupted
+    ) : mSystem(system), mSettings(settings), mTraceBuilder(traceBuilder), mInterrupted(interrupted)
     {}
 
     void writeSystem(llvm::raw_ostream& os);
@@ -60,6 +67,7 @@ private:
     AutomataSystem& mSystem;
     ThetaSettings mSettings;
     CfaTraceBuilder& mTraceBuilder;
+    const std::atomic<bool>& mInterrupted;
     ThetaNameMapping mNameMapping;
 };
 
@@ -154,16 +162,50 @@ auto ThetaVerifierImpl::execute(llvm::StringRef input) -> std::unique_ptr<Verifi
     llvm::outs() << "  Built command: '" << llvm::join(args, " ") << "'.\n";
     llvm::outs() << "  Running theta...\n";
     std::string thetaErrors;
-    int returnCode = llvm::sys::ExecuteAndWait(
+    bool executionFailed = false;
+    llvm::sys::ProcessInfo process = llvm::sys::ExecuteNoWait(
         *java,
         args,
         env,
         redirects,
-        mSettings.timeout,
         /*memoryLimit=*/0,
-        &thetaErrors
+        &thetaErrors,
+        &executionFailed
     );
 
+    if (executionFailed) {
+        return VerificationResult::CreateInternalError("Theta execution failed. " + thetaErrors);
+    }
+
+    // Poll the process instead of blocking on it, so we can kill it when
+    // the timeout expires or the verification is interrupted.
+    Stopwatch<std::chrono::seconds> stopwatch;
+    stopwatch.start();
+
+    llvm::sys::ProcessInfo waitResult;
+    while (true) {
+        waitResult = llvm::sys::Wait(process, /*SecondsToWait=*/0, /*WaitUntilTerminates=*/false, &thetaErrors);
+        if (waitResult.Pid != 0) {
+            break;
+        }
+
+        bool timedOut = mSettings.timeout != 0 && stopwatch.elapsed().count() >= mSettings.timeout;
+        if (timedOut || mInterrupted) {
+            ::kill(process.Pid, SIGKILL);
+            llvm::sys::Wait(process, /*SecondsToWait=*/0, /*WaitUntilTerminates=*/true);
+
+            if (timedOut) {
+                return VerificationResult::CreateTimeout();
+            }
+
+            llvm::outs() << "  Theta was interrupted.\n";
+            return VerificationResult::CreateUnknown();
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    int returnCode = waitResult.ReturnCode;
     if (returnCode == -1) {
         return VerificationResult::CreateInternalError("Theta execution failed. " + thetaErrors);
     }
@@ -368,7 +410,7 @@ auto ThetaVerifier::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
     llvm::outs() << "Running theta verification backend.\n";
 
     std::error_code errors;
-    ThetaVerifierImpl impl(system, mSettings, traceBuilder);
+    ThetaVerifierImpl impl(system, mSettings, traceBuilder, mInterrupted);
 
     // Create a temporary file to write into.
     llvm::SmallString<128> outputFile;
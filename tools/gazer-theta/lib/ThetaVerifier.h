@@ -21,6 +21,8 @@
 #include "gazer/Automaton/Cfa.h"
 #include "gazer/Verifier/VerificationAlgorithm.h"
 
+#include <atomic>
+
 namespace gazer::theta
 {
 
@@ -51,8 +53,12 @@ public:
     {}
 
     std::unique_ptr<VerificationResult> check(AutomataSystem& system, CfaTraceBuilder& traceBuilder) override;
+
+    /// Kills the running theta process.
+    void interrupt() override { mInterrupted = true; }
 private:
     ThetaSettings mSettings;
+    std::atomic<bool> mInterrupted = false;
 };
 
 } // end namespace gazer
@@ -138,4 +138,43 @@ TEST(GraphTest, testDisconnect)
     ASSERT_TRUE(sameGraph(*graph, { "A", "E" }, { {"A", "E" }}));
 }
 
+TEST(GraphTest, testDisconnectEdges)
+{
+    auto graph = std::make_unique<TestGraph>();
+    auto a = graph->createNode("A");
+    auto b = graph->createNode("B");
+
+    std::vector<TestEdge*> edges;
+    for (unsigned i = 0; i < 5; ++i) {
+        edges.push_back(graph->createEdge(a, b));
+    }
+    auto loop = graph->createEdge(b, b);
+
+    // Remove edges from the front, the middle and the back of the adjacency lists.
+    graph->disconnectEdge(edges[0]);
+    graph->disconnectEdge(edges[4]);
+    graph->disconnectEdge(edges[2]);
+
+    EXPECT_EQ(a->getNumOutgoing(), 2u);
+    EXPECT_EQ(b->getNumIncoming(), 3u);
+    std::vector<TestEdge*> remaining = { edges[1], edges[3] };
+    EXPECT_TRUE(std::is_permutation(a->outgoing_begin(), a->outgoing_end(), remaining.begin(), remaining.end()));
+    EXPECT_TRUE(llvm::is_contained(b->incoming(), loop));
+
+    // The remaining edges must still be removable.
+    graph->disconnectEdge(edges[3]);
+    EXPECT_EQ(a->getNumOutgoing(), 1u);
+    EXPECT_EQ(*a->outgoing_begin(), edges[1]);
+
+    // Tombstones are kept until the next compaction.
+    EXPECT_EQ(graph->edge_size(), 6u);
+    graph->clearDisconnectedElements();
+    ASSERT_TRUE(sameGraph(*graph, { "A", "B" }, { {"A", "B"}, {"B", "B"} }));
+
+    graph->disconnectNode("B");
+    EXPECT_EQ(a->getNumOutgoing(), 0u);
+    graph->clearDisconnectedElements();
+    ASSERT_TRUE(sameGraph(*graph, {}, {}));
+}
+
 }
\ No newline at end of file
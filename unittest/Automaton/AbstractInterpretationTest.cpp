@@ -0,0 +1,254 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class AbstractInterpretationTest : public AutomatonTestFixture {};
+
+TEST_F(AbstractInterpretationTest, DischargeConstantGuard)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+    Variable* y = main->createLocal("y", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+    Location* err1 = main->createErrorLocation();
+    Location* err2 = main->createErrorLocation();
+    main->addErrorCode(err1, lit(1));
+    main->addErrorCode(err2, lit(2));
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { x, lit(5) },
+        { y, builder->Undef(bv32) }
+    });
+
+    // The first check always holds, while the second one depends on an unknown value.
+    main->createAssignTransition(l1, l2, builder->BvSLtEq(x->getRefExpr(), lit(10)));
+    main->createAssignTransition(l1, err1, builder->BvSGt(x->getRefExpr(), lit(10)));
+    main->createAssignTransition(l2, main->getExit(), builder->BvSLtEq(y->getRefExpr(), lit(10)));
+    main->createAssignTransition(l2, err2, builder->BvSGt(y->getRefExpr(), lit(10)));
+    system.setMainAutomaton(main);
+
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numErrors, 2u);
+    EXPECT_EQ(result.numRemaining, 1u);
+    EXPECT_EQ(result.getNumDischarged(), 1u);
+    EXPECT_EQ(main->getNumErrors(), 1u);
+    EXPECT_EQ(main->getErrorFieldExpr(err2), lit(2));
+    EXPECT_EQ(l1->getNumOutgoing(), 1u);
+}
+
+TEST_F(AbstractInterpretationTest, RemoveConeOfDischargedError)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+    Variable* z = main->createLocal("z", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { x, builder->BvAnd(builder->Undef(bv32), lit(7)) }
+    });
+    main->createAssignTransition(l1, main->getExit(), builder->BvULt(x->getRefExpr(), lit(8)));
+
+    // This branch is infeasible, and the location after it may only lead to the error.
+    main->createAssignTransition(l1, l2, builder->BvUGtEq(x->getRefExpr(), lit(8)), {
+        { z, builder->Add(x->getRefExpr(), lit(1)) }
+    });
+    main->createAssignTransition(l2, err, builder->True());
+    system.setMainAutomaton(main);
+
+    size_t numLocs = main->getNumLocations();
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numRemaining, 0u);
+    EXPECT_EQ(main->getNumErrors(), 0u);
+    EXPECT_EQ(main->getNumLocations(), numLocs - 2);
+    EXPECT_EQ(main->getExit()->getNumIncoming(), 1u);
+}
+
+TEST_F(AbstractInterpretationTest, UseCongruenceInLoops)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", bv32);
+    Variable* i1 = loop->createLocal("i1", bv32);
+
+    Location* body = loop->createLocation();
+    Location* call = loop->createLocation();
+    Location* err = loop->createErrorLocation();
+    loop->addErrorCode(err, lit(1));
+
+    // loop(i) { if (i < 100) { assert(i != 51); loop(i + 2); } }
+    loop->createAssignTransition(loop->getEntry(), body, builder->BvSLt(i->getRefExpr(), lit(100)));
+    loop->createAssignTransition(loop->getEntry(), loop->getExit(), builder->BvSGtEq(i->getRefExpr(), lit(100)));
+    loop->createAssignTransition(body, err, builder->Eq(i->getRefExpr(), lit(51)));
+    loop->createAssignTransition(body, call, builder->NotEq(i->getRefExpr(), lit(51)), {
+        { i1, builder->Add(i->getRefExpr(), lit(2)) }
+    });
+    loop->createCallTransition(call, loop->getExit(), loop, {{ i, i1->getRefExpr() }}, {});
+
+    main->createCallTransition(main->getEntry(), main->getExit(), loop, {{ i, lit(0) }}, {});
+    system.setMainAutomaton(main);
+
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numRemaining, 0u);
+    EXPECT_EQ(loop->getNumErrors(), 0u);
+
+    // The recursive call must be kept.
+    EXPECT_EQ(call->getNumOutgoing(), 1u);
+}
+
+TEST_F(AbstractInterpretationTest, KeepReachableErrorsInLoops)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", bv32);
+    Variable* i1 = loop->createLocal("i1", bv32);
+
+    Location* body = loop->createLocation();
+    Location* err = loop->createErrorLocation();
+    loop->addErrorCode(err, lit(1));
+
+    // The error is only reachable after several iterations.
+    loop->createAssignTransition(loop->getEntry(), body, builder->BvSLt(i->getRefExpr(), lit(100)), {
+        { i1, builder->Add(i->getRefExpr(), lit(3)) }
+    });
+    loop->createAssignTransition(loop->getEntry(), loop->getExit(), builder->BvSGtEq(i->getRefExpr(), lit(100)));
+    loop->createAssignTransition(body, err, builder->Eq(i1->getRefExpr(), lit(51)));
+    loop->createCallTransition(body, loop->getExit(), builder->NotEq(i1->getRefExpr(), lit(51)), loop, {
+        { i, i1->getRefExpr() }
+    }, {});
+
+    main->createCallTransition(main->getEntry(), main->getExit(), loop, {{ i, lit(0) }}, {});
+    system.setMainAutomaton(main);
+
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numRemaining, 1u);
+    EXPECT_EQ(err->getNumIncoming(), 1u);
+}
+
+TEST_F(AbstractInterpretationTest, UseCalleeSummaries)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* inc = system.createCfa("inc");
+    Variable* a = inc->createInput("a", bv32);
+    Variable* b = inc->createLocal("b", bv32);
+    inc->addOutput(b);
+    inc->createAssignTransition(inc->getEntry(), inc->getExit(), {
+        { b, builder->Add(a->getRefExpr(), lit(1)) }
+    });
+
+    Variable* r = main->createLocal("r", bv32);
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createCallTransition(main->getEntry(), l1, inc, {{ a, lit(5) }}, {{ r, b->getRefExpr() }});
+    main->createAssignTransition(l1, err, builder->NotEq(r->getRefExpr(), lit(6)));
+    main->createAssignTransition(l1, main->getExit(), builder->Eq(r->getRefExpr(), lit(6)));
+    system.setMainAutomaton(main);
+
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numRemaining, 0u);
+    EXPECT_EQ(main->getEntry()->getNumOutgoing(), 1u);
+}
+
+TEST_F(AbstractInterpretationTest, RefineThroughBooleanDefinitions)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+    Variable* c = main->createLocal("c", BoolType::Get(context));
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { x, builder->Undef(bv32) },
+        { c, builder->BvSLt(x->getRefExpr(), lit(5)) }
+    });
+    main->createAssignTransition(l1, l2, c->getRefExpr());
+    main->createAssignTransition(l1, main->getExit(), builder->Not(c->getRefExpr()));
+    main->createAssignTransition(l2, err, builder->BvSGt(x->getRefExpr(), lit(10)));
+    main->createAssignTransition(l2, main->getExit(), builder->BvSLtEq(x->getRefExpr(), lit(10)));
+    system.setMainAutomaton(main);
+
+    auto result = DischargeUnreachableErrors(system);
+
+    EXPECT_EQ(result.numRemaining, 0u);
+}
+
+TEST_F(AbstractInterpretationTest, ComputeInvariantsOfCyclicAutomaton)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* i = main->createLocal("i", bv32);
+
+    Location* head = main->createLocation();
+    Location* body = main->createLocation();
+    Location* dead = main->createLocation();
+
+    // for (i = 0; i < 100; i += 2) { if (i == 51) { ... } }
+    main->createAssignTransition(main->getEntry(), head, builder->True(), {{ i, lit(0) }});
+    main->createAssignTransition(head, body, builder->BvSLt(i->getRefExpr(), lit(100)));
+    main->createAssignTransition(head, main->getExit(), builder->BvSGtEq(i->getRefExpr(), lit(100)));
+    main->createAssignTransition(body, dead, builder->Eq(i->getRefExpr(), lit(51)));
+    main->createAssignTransition(body, head, builder->NotEq(i->getRefExpr(), lit(51)), {
+        { i, builder->Add(i->getRefExpr(), lit(2)) }
+    });
+    main->createAssignTransition(dead, head, builder->True());
+    system.setMainAutomaton(main);
+
+    auto invariants = ComputeLocationInvariants(system, *builder);
+
+    // The analysis does not modify the system.
+    EXPECT_EQ(body->getNumOutgoing(), 2u);
+
+    EXPECT_EQ(invariants.count(main->getEntry()), 0u);
+
+    auto& headFacts = invariants[head];
+    auto contains = [&headFacts](const ExprPtr& expr) {
+        return std::find(headFacts.begin(), headFacts.end(), expr) != headFacts.end();
+    };
+    EXPECT_TRUE(contains(builder->BvSGtEq(i->getRefExpr(), lit(0))));
+    EXPECT_TRUE(contains(builder->Eq(builder->BvURem(i->getRefExpr(), lit(2)), lit(0))));
+
+    ASSERT_EQ(invariants[dead].size(), 1u);
+    EXPECT_EQ(invariants[dead][0], builder->False());
+}
+
+} // end anonymous namespace
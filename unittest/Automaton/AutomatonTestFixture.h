@@ -0,0 +1,47 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file defines the common fixture of the automaton unit tests,
+/// which build their automata from scratch.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_UNITTEST_AUTOMATON_AUTOMATONTESTFIXTURE_H
+#define GAZER_UNITTEST_AUTOMATON_AUTOMATONTESTFIXTURE_H
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <gtest/gtest.h>
+
+namespace gazer
+{
+
+class AutomatonTestFixture : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    std::unique_ptr<ExprBuilder> builder{CreateExprBuilder(context)};
+    BvType& bv32 = BvType::Get(context, 32);
+
+    ExprPtr lit(uint64_t value) { return builder->BvLit(value, 32); }
+};
+
+} // end namespace gazer
+
+#endif
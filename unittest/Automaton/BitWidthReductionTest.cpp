@@ -0,0 +1,233 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class BitWidthReductionTest : public AutomatonTestFixture
+{
+protected:
+    static unsigned getWidth(Variable* variable) {
+        return llvm::cast<BvType>(variable->getType()).getWidth();
+    }
+
+    /// Returns the variable which replaced \p variable.
+    static Variable* getNarrowed(BitWidthReductionResult& result, Variable* variable)
+    {
+        auto zext = llvm::dyn_cast_or_null<ZExtExpr>(result.replacements.lookup(variable));
+        if (zext == nullptr) {
+            return nullptr;
+        }
+
+        return &llvm::cast<VarRefExpr>(zext->getOperand(0))->getVariable();
+    }
+};
+
+TEST_F(BitWidthReductionTest, NarrowFlagsAndConstants)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* c = main->createLocal("c", BoolType::Get(context));
+    Variable* flag = main->createLocal("flag", bv32);
+    Variable* code = main->createLocal("code", bv32);
+    Variable* any = main->createLocal("any", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, code->getRefExpr());
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { c, builder->Undef(BoolType::Get(context)) },
+        { any, builder->Undef(bv32) },
+        { flag, builder->Select(c->getRefExpr(), builder->BvLit(1, 32), builder->BvLit(0, 32)) },
+        { code, builder->Select(c->getRefExpr(), builder->BvLit(5, 32), builder->BvLit(3, 32)) }
+    });
+    main->createAssignTransition(l1, err, builder->Eq(flag->getRefExpr(), builder->BvLit(1, 32)));
+    main->createAssignTransition(l1, main->getExit(), builder->NotEq(flag->getRefExpr(), builder->BvLit(1, 32)));
+    system.setMainAutomaton(main);
+
+    auto result = ReduceBitWidths(system);
+
+    EXPECT_EQ(result.replacements.size(), 2u);
+    EXPECT_EQ(result.originalBits, 96u);
+    EXPECT_EQ(result.reducedBits, 32u + 1u + 3u);
+
+    Variable* newFlag = getNarrowed(result, flag);
+    Variable* newCode = getNarrowed(result, code);
+    ASSERT_NE(newFlag, nullptr);
+    ASSERT_NE(newCode, nullptr);
+    EXPECT_EQ(getWidth(newFlag), 1u);
+    EXPECT_EQ(getWidth(newCode), 3u);
+
+    // The narrowed variables take the place of the original ones.
+    EXPECT_EQ(main->findLocalByName("flag"), nullptr);
+    EXPECT_EQ(main->findLocalByName("any"), any);
+    EXPECT_TRUE(llvm::any_of(main->locals(), [newFlag](Variable& v) { return &v == newFlag; }));
+
+    EXPECT_EQ(result.replacements[flag], builder->ZExt(newFlag->getRefExpr(), bv32));
+
+    // The comparisons are performed on the narrowed width.
+    auto errorEdge = *err->incoming_begin();
+    EXPECT_EQ(errorEdge->getGuard(), builder->Eq(newFlag->getRefExpr(), builder->BvLit(1, 1)));
+    EXPECT_EQ(main->getErrorFieldExpr(err), builder->ZExt(newCode->getRefExpr(), bv32));
+}
+
+TEST_F(BitWidthReductionTest, NarrowArithmeticPreservesSemantics)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* f = system.createCfa("f");
+    Variable* a = f->createInput("a", bv32);
+    Variable* m = f->createLocal("m", bv32);
+    Variable* s = f->createLocal("s", bv32);
+    Variable* o = f->createLocal("o", bv32);
+    f->addOutput(o);
+
+    Location* l1 = f->createLocation();
+    f->createAssignTransition(f->getEntry(), l1, {
+        { m, builder->BvAnd(a->getRefExpr(), builder->BvLit(15, 32)) },
+        { s, builder->Add(m->getRefExpr(), m->getRefExpr()) }
+    });
+    f->createAssignTransition(l1, f->getExit(), {
+        { o, builder->Mul(s->getRefExpr(), builder->BvLit(2, 32)) }
+    });
+    system.setMainAutomaton(main);
+
+    auto result = ReduceBitWidths(system);
+
+    // The input of 'f' is never assigned, thus it cannot be narrowed.
+    EXPECT_EQ(f->getInput(0), a);
+    ASSERT_NE(getNarrowed(result, m), nullptr);
+    ASSERT_NE(getNarrowed(result, s), nullptr);
+    EXPECT_EQ(getWidth(getNarrowed(result, m)), 4u);
+    EXPECT_EQ(getWidth(getNarrowed(result, s)), 5u);
+    EXPECT_EQ(f->getOutput(0), getNarrowed(result, o));
+    EXPECT_EQ(getWidth(f->getOutput(0)), 6u);
+
+    Valuation valuation;
+    valuation[a] = builder->BvLit(0xFFFF7, 32);
+
+    Location* current = f->getEntry();
+    while (current != f->getExit()) {
+        ASSERT_EQ(current->getNumOutgoing(), 1u);
+        auto edge = llvm::cast<AssignTransition>(*current->outgoing_begin());
+        for (const VariableAssignment& assign : *edge) {
+            auto value = ValuationExprEvaluator(valuation).evaluate(assign.getValue());
+            valuation[assign.getVariable()] = llvm::cast<LiteralExpr>(value);
+        }
+        current = edge->getTarget();
+    }
+
+    EXPECT_EQ(valuation[f->getOutput(0)], builder->BvLit(28, 6));
+}
+
+TEST_F(BitWidthReductionTest, NarrowCallArguments)
+{
+    Cfa* callee = system.createCfa("callee");
+    Variable* x = callee->createInput("x", bv32);
+    Variable* y = callee->createLocal("y", bv32);
+    callee->addOutput(y);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { y, builder->Add(x->getRefExpr(), builder->BvLit(1, 32)) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* b = main->createLocal("b", bv32);
+    main->createCallTransition(main->getEntry(), main->getExit(), callee, {
+        { x, builder->BvLit(10, 32) }
+    }, {
+        { b, y->getRefExpr() }
+    });
+    system.setMainAutomaton(main);
+
+    auto result = ReduceBitWidths(system);
+
+    Variable* newX = callee->getInput(0);
+    EXPECT_EQ(newX, getNarrowed(result, x));
+    EXPECT_EQ(getWidth(newX), 4u);
+    EXPECT_EQ(getWidth(callee->getOutput(0)), 4u);
+    ASSERT_NE(getNarrowed(result, b), nullptr);
+    EXPECT_EQ(getWidth(getNarrowed(result, b)), 4u);
+
+    auto call = llvm::cast<CallTransition>(*main->getEntry()->outgoing_begin());
+    EXPECT_EQ(call->getInputArgument(*newX)->getValue(), builder->BvLit(10, 4));
+}
+
+TEST_F(BitWidthReductionTest, DoNotNarrowDivisionByUnknown)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* a = main->createLocal("a", bv32);
+    Variable* d = main->createLocal("d", bv32);
+    Variable* m = main->createLocal("m", bv32);
+    Variable* q = main->createLocal("q", bv32);
+    Variable* p = main->createLocal("p", bv32);
+
+    Location* l1 = main->createLocation();
+    main->createAssignTransition(main->getEntry(), l1, {
+        { a, builder->Undef(bv32) },
+        { d, builder->Undef(bv32) },
+        { m, builder->BvAnd(a->getRefExpr(), builder->BvLit(15, 32)) }
+    });
+    main->createAssignTransition(l1, main->getExit(), {
+        // If 'd' is zero, 'q' is all ones regardless of 'm'.
+        { q, builder->BvUDiv(m->getRefExpr(), d->getRefExpr()) },
+        { p, builder->BvUDiv(m->getRefExpr(), builder->BvLit(4, 32)) }
+    });
+    system.setMainAutomaton(main);
+
+    auto result = ReduceBitWidths(system);
+
+    EXPECT_EQ(main->findLocalByName("q"), q);
+    EXPECT_EQ(getNarrowed(result, q), nullptr);
+    ASSERT_NE(getNarrowed(result, p), nullptr);
+    EXPECT_EQ(getWidth(getNarrowed(result, p)), 2u);
+}
+
+TEST_F(BitWidthReductionTest, DoNotNarrowUnboundedCounters)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", bv32);
+    Variable* i1 = loop->createLocal("i1", bv32);
+    Location* l1 = loop->createLocation();
+
+    loop->createAssignTransition(loop->getEntry(), l1, {
+        { i1, builder->Add(i->getRefExpr(), builder->BvLit(1, 32)) }
+    });
+    loop->createCallTransition(l1, loop->getExit(), loop, {{ i, i1->getRefExpr() }}, {});
+
+    main->createCallTransition(main->getEntry(), main->getExit(), loop, {{ i, builder->BvLit(0, 32) }}, {});
+    system.setMainAutomaton(main);
+
+    auto result = ReduceBitWidths(system);
+
+    EXPECT_TRUE(result.replacements.empty());
+    EXPECT_EQ(result.originalBits, result.reducedBits);
+    EXPECT_EQ(loop->getInput(0), i);
+    EXPECT_EQ(loop->findLocalByName("i1"), i1);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,200 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+std::string printSystem(AutomataSystem& system)
+{
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    system.print(rso);
+
+    return rso.str();
+}
+
+std::string writeSystem(AutomataSystem& system, const std::map<unsigned, std::string>& messages = {})
+{
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    WriteAutomataSystem(system, rso, messages);
+
+    return rso.str();
+}
+
+SerializedAutomataSystem readSystem(llvm::StringRef data, GazerContext& context)
+{
+    return ReadAutomataSystem(llvm::MemoryBufferRef(data, "test"), context);
+}
+
+class CfaSerializationTest : public AutomatonTestFixture {};
+
+TEST_F(CfaSerializationTest, RoundTripIntoDifferentContext)
+{
+    auto& bv64 = BvType::Get(context, 64);
+    auto& fp32 = FloatType::Get(context, FloatType::Single);
+
+    Cfa* callee = system.createCfa("callee");
+    Variable* x = callee->createInput("x", bv32);
+    Variable* y = callee->createLocal("y", bv64);
+    callee->addOutput(y);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { y, builder->ZExt(x->getRefExpr(), bv64) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* a = main->createLocal("a", bv32);
+    Variable* b = main->createLocal("b", bv64);
+    Variable* f = main->createLocal("f", fp32);
+    Variable* c = main->createLocal("c", bv32);
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, builder->BvLit(2, 16));
+
+    // The sum is shared by two users, it must be written only once.
+    ExprPtr sum = builder->Add(a->getRefExpr(), builder->BvLit(1, 32));
+    main->createAssignTransition(main->getEntry(), l1, {
+        { a, builder->Undef(bv32) },
+        { f, builder->FAdd(f->getRefExpr(), builder->FloatLit(llvm::APFloat(1.5f)), llvm::APFloat::rmTowardZero) },
+        { c, builder->Mul(sum, builder->Extract(b->getRefExpr(), 8, 32)) }
+    });
+    main->createCallTransition(l1, main->getExit(), builder->BvSLt(sum, builder->BvLit(10, 32)), callee, {
+        { x, sum }
+    }, {
+        { b, y->getRefExpr() }
+    });
+    main->createAssignTransition(l1, err, builder->BvSGtEq(sum, builder->BvLit(10, 32)));
+    system.setMainAutomaton(main);
+
+    std::string data = writeSystem(system, {{ 2, "Assertion failure" }});
+    EXPECT_TRUE(IsSerializedAutomataSystem(data));
+
+    GazerContext newContext;
+    auto result = readSystem(data, newContext);
+
+    ASSERT_NE(result.system, nullptr) << result.error;
+    EXPECT_EQ(&result.system->getContext(), &newContext);
+    EXPECT_EQ(printSystem(system), printSystem(*result.system));
+    EXPECT_EQ(result.messages.size(), 1u);
+    EXPECT_EQ(result.messages[2], "Assertion failure");
+
+    Cfa* newMain = result.system->getMainAutomaton();
+    ASSERT_NE(newMain, nullptr);
+    EXPECT_EQ(newMain->getName(), "main");
+    EXPECT_EQ(newMain->getNumTransitions(), main->getNumTransitions());
+    EXPECT_EQ(newMain->getNumErrors(), 1u);
+
+    // Shared nodes are materialized once.
+    ExprPtr newSum;
+    for (Transition* edge : newMain->edges()) {
+        if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            EXPECT_EQ(call->getCalledAutomaton(), result.system->getAutomatonByName("callee"));
+            newSum = call->getInputArgument(*call->getCalledAutomaton()->getInput(0))->getValue();
+        }
+    }
+    ASSERT_NE(newSum, nullptr);
+    for (Transition* edge : newMain->edges()) {
+        if (edge->getTarget()->isError()) {
+            EXPECT_EQ(llvm::cast<NonNullaryExpr>(edge->getGuard())->getOperand(0), newSum);
+        }
+    }
+}
+
+TEST_F(CfaSerializationTest, RoundTripLiterals)
+{
+    auto& arrTy = ArrayType::Get(bv32, bv32);
+    auto& intTy = IntType::Get(context);
+    auto& realTy = RealType::Get(context);
+    auto& fp64 = FloatType::Get(context, FloatType::Double);
+
+    Cfa* main = system.createCfa("main");
+    Variable* m = main->createLocal("m", arrTy);
+    Variable* i = main->createLocal("i", intTy);
+    Variable* r = main->createLocal("r", realTy);
+    Variable* f = main->createLocal("f", fp64);
+    Variable* b = main->createLocal("b", BvType::Get(context, 128));
+
+    ArrayLiteralExpr::Builder array(arrTy);
+    array.addValue(BvLiteralExpr::Get(bv32, 1), BvLiteralExpr::Get(bv32, 2));
+    array.setDefault(BvLiteralExpr::Get(bv32, 0));
+
+    llvm::APInt wide = llvm::APInt::getHighBitsSet(128, 3) | 5;
+    main->createAssignTransition(main->getEntry(), main->getExit(), {
+        { m, array.build() },
+        { i, IntLiteralExpr::Get(intTy, -42) },
+        { r, RealLiteralExpr::Get(realTy, -3, 4) },
+        { f, FloatLiteralExpr::Get(fp64, llvm::APFloat(-0.1)) },
+        { b, BvLiteralExpr::Get(llvm::cast<BvType>(b->getType()), wide) }
+    });
+    system.setMainAutomaton(main);
+
+    GazerContext newContext;
+    auto result = readSystem(writeSystem(system), newContext);
+    ASSERT_NE(result.system, nullptr) << result.error;
+
+    Cfa* newMain = result.system->getMainAutomaton();
+    ASSERT_EQ(newMain->getNumTransitions(), 1u);
+    auto edge = llvm::cast<AssignTransition>(*newMain->getEntry()->outgoing_begin());
+    ASSERT_EQ(edge->getNumAssignments(), 5u);
+
+    auto newArray = llvm::dyn_cast<ArrayLiteralExpr>(edge->begin()[0].getValue());
+    ASSERT_NE(newArray, nullptr);
+    EXPECT_EQ(newArray->getMap().size(), 1u);
+    ASSERT_TRUE(newArray->hasDefault());
+    EXPECT_EQ(llvm::cast<BvLiteralExpr>(newArray->getDefault())->getValue(), 0u);
+
+    EXPECT_EQ(llvm::cast<IntLiteralExpr>(edge->begin()[1].getValue())->getValue(), -42);
+    EXPECT_EQ(llvm::cast<RealLiteralExpr>(edge->begin()[2].getValue())->getValue(), boost::rational<long long>(-3, 4));
+    EXPECT_TRUE(llvm::cast<FloatLiteralExpr>(edge->begin()[3].getValue())->getValue().bitwiseIsEqual(llvm::APFloat(-0.1)));
+    EXPECT_EQ(llvm::cast<BvLiteralExpr>(edge->begin()[4].getValue())->getValue(), wide);
+}
+
+TEST_F(CfaSerializationTest, RejectMalformedInput)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createInput("x", bv32);
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->Eq(x->getRefExpr(), builder->BvLit(1, 32)));
+    system.setMainAutomaton(main);
+
+    std::string data = writeSystem(system);
+
+    GazerContext newContext;
+    EXPECT_EQ(readSystem("not a system", newContext).system, nullptr);
+
+    // Every proper prefix of the input must be rejected.
+    for (size_t i = 0; i < data.size(); ++i) {
+        auto result = readSystem(llvm::StringRef(data).take_front(i), newContext);
+        EXPECT_EQ(result.system, nullptr);
+        EXPECT_FALSE(result.error.empty());
+    }
+
+    EXPECT_NE(readSystem(data, newContext).system, nullptr);
+}
+
+} // end anonymous namespace
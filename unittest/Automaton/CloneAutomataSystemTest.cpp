@@ -0,0 +1,107 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+std::string printSystem(AutomataSystem& system)
+{
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    system.print(rso);
+
+    return rso.str();
+}
+
+TEST(CloneAutomataSystem, CloneIntoDifferentContext)
+{
+    GazerContext context;
+    AutomataSystem system(context);
+
+    auto& bv32 = BvType::Get(context, 32);
+
+    Cfa* callee = system.createCfa("callee");
+    Variable* x = callee->createInput("x", bv32);
+    Variable* y = callee->createLocal("y", BvType::Get(context, 64));
+    callee->addOutput(y);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { y, ZExtExpr::Create(x->getRefExpr(), BvType::Get(context, 64)) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* a = main->createLocal("a", bv32);
+    Variable* b = main->createLocal("b", BvType::Get(context, 64));
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, BvLiteralExpr::Get(BvType::Get(context, 16), 1));
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { a, UndefExpr::Get(bv32) }
+    });
+    main->createCallTransition(l1, main->getExit(), callee, {{ x, a->getRefExpr() }}, {{ b, y->getRefExpr() }});
+    main->createAssignTransition(l1, err, EqExpr::Create(a->getRefExpr(), BvLiteralExpr::Get(bv32, 5)));
+    system.setMainAutomaton(main);
+
+    GazerContext cloneContext;
+    auto result = CloneAutomataSystem(system, cloneContext);
+
+    ASSERT_NE(result.system, nullptr);
+    EXPECT_EQ(&result.system->getContext(), &cloneContext);
+    EXPECT_EQ(printSystem(system), printSystem(*result.system));
+
+    Cfa* newMain = result.system->getMainAutomaton();
+    ASSERT_NE(newMain, nullptr);
+    EXPECT_EQ(newMain->getName(), "main");
+    EXPECT_EQ(newMain->getNumLocations(), main->getNumLocations());
+    EXPECT_EQ(newMain->getNumTransitions(), main->getNumTransitions());
+    EXPECT_EQ(newMain->getNumErrors(), 1u);
+
+    EXPECT_EQ(result.locations.lookup(newMain->getEntry()), main->getEntry());
+    EXPECT_EQ(result.locations.lookup(newMain->getExit()), main->getExit());
+
+    // Every expression of the clone must belong to the new context.
+    for (Cfa& cfa : *result.system) {
+        for (Transition* edge : cfa.edges()) {
+            EXPECT_EQ(&edge->getGuard()->getContext(), &cloneContext);
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                for (const VariableAssignment& va : *assign) {
+                    EXPECT_EQ(&va.getVariable()->getContext(), &cloneContext);
+                    EXPECT_EQ(&va.getValue()->getContext(), &cloneContext);
+                }
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+                EXPECT_EQ(call->getCalledAutomaton(), result.system->getAutomatonByName("callee"));
+            }
+        }
+    }
+
+    Variable* newA = newMain->findLocalByName("a");
+    ASSERT_NE(newA, nullptr);
+    EXPECT_EQ(result.variables.lookup(newA), a);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,163 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class ConeOfInfluenceTest : public AutomatonTestFixture {};
+
+TEST_F(ConeOfInfluenceTest, RemoveIrrelevantLocals)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+    Variable* y = main->createLocal("y", bv32);
+    Variable* z = main->createLocal("z", bv32);
+    Variable* w = main->createLocal("w", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createAssignTransition(main->getEntry(), l1, {
+        { x, builder->Undef(bv32) },
+        { y, builder->Add(x->getRefExpr(), lit(1)) },
+        { z, builder->Undef(bv32) },
+        { w, builder->Mul(z->getRefExpr(), y->getRefExpr()) }
+    });
+    main->createAssignTransition(l1, err, builder->Eq(y->getRefExpr(), lit(5)));
+    main->createAssignTransition(l1, main->getExit(), builder->NotEq(y->getRefExpr(), lit(5)));
+    system.setMainAutomaton(main);
+
+    auto result = RemoveIrrelevantVariables(system);
+
+    EXPECT_EQ(result.numVariables, 4u);
+    EXPECT_EQ(result.numRemovedVariables, 2u);
+    EXPECT_EQ(result.numRemovedAssignments, 2u);
+    EXPECT_EQ(main->getNumLocals(), 2u);
+    EXPECT_EQ(main->findLocalByName("z"), nullptr);
+    EXPECT_EQ(main->findLocalByName("w"), nullptr);
+
+    ASSERT_EQ(main->getEntry()->getNumOutgoing(), 1u);
+    auto edge = llvm::cast<AssignTransition>(*main->getEntry()->outgoing_begin());
+    ASSERT_EQ(edge->getNumAssignments(), 2u);
+    EXPECT_EQ(edge->begin()->getVariable(), x);
+    EXPECT_EQ(std::next(edge->begin())->getVariable(), y);
+    EXPECT_EQ(main->getNumTransitions(), 3u);
+}
+
+TEST_F(ConeOfInfluenceTest, RemoveUnusedCallArguments)
+{
+    Cfa* callee = system.createCfa("callee");
+    Variable* a = callee->createInput("a", bv32);
+    Variable* b = callee->createInput("b", bv32);
+    Variable* r1 = callee->createLocal("r1", bv32);
+    Variable* r2 = callee->createLocal("r2", bv32);
+    callee->addOutput(r1);
+    callee->addOutput(r2);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { r1, builder->Add(a->getRefExpr(), lit(1)) },
+        { r2, builder->Mul(b->getRefExpr(), lit(2)) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+    Variable* y = main->createLocal("y", bv32);
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createCallTransition(main->getEntry(), l1, callee, {
+        { a, lit(1) }, { b, lit(2) }
+    }, {
+        { x, r1->getRefExpr() }, { y, r2->getRefExpr() }
+    });
+    main->createAssignTransition(l1, err, builder->Eq(x->getRefExpr(), lit(2)));
+    main->createAssignTransition(l1, main->getExit(), builder->NotEq(x->getRefExpr(), lit(2)));
+    system.setMainAutomaton(main);
+
+    auto result = RemoveIrrelevantVariables(system);
+
+    // The second input and output of the callee, and 'y' are removed.
+    EXPECT_EQ(result.numRemovedVariables, 3u);
+    ASSERT_EQ(callee->getNumInputs(), 1u);
+    ASSERT_EQ(callee->getNumOutputs(), 1u);
+    EXPECT_EQ(callee->getInput(0), a);
+    EXPECT_EQ(callee->getOutput(0), r1);
+    EXPECT_EQ(callee->findLocalByName("r2"), nullptr);
+
+    auto call = llvm::cast<CallTransition>(*main->getEntry()->outgoing_begin());
+    ASSERT_EQ(call->getNumInputs(), 1u);
+    ASSERT_EQ(call->getNumOutputs(), 1u);
+    EXPECT_EQ(call->getInputArgument(*a)->getValue(), lit(1));
+    EXPECT_EQ(call->getOutputArgument(*r1)->getVariable(), x);
+}
+
+TEST_F(ConeOfInfluenceTest, KeepLoopCarriedVariables)
+{
+    Cfa* main = system.createCfa("main");
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", bv32);
+    Variable* s = loop->createInput("s", bv32);
+    Variable* i1 = loop->createLocal("i1", bv32);
+    Variable* s1 = loop->createLocal("s1", bv32);
+    Location* body = loop->createLocation();
+    Location* err = loop->createErrorLocation();
+    loop->addErrorCode(err, lit(1));
+
+    // The counter is relevant through the recursive call, while the sum is never read.
+    loop->createAssignTransition(loop->getEntry(), body, builder->BvSLt(i->getRefExpr(), lit(10)), {
+        { i1, builder->Add(i->getRefExpr(), lit(1)) },
+        { s1, builder->Add(s->getRefExpr(), i->getRefExpr()) }
+    });
+    loop->createAssignTransition(loop->getEntry(), loop->getExit(), builder->BvSGtEq(i->getRefExpr(), lit(10)));
+    loop->createAssignTransition(body, err, builder->Eq(i1->getRefExpr(), lit(20)));
+    loop->createCallTransition(body, loop->getExit(), builder->NotEq(i1->getRefExpr(), lit(20)), loop, {
+        { i, i1->getRefExpr() }, { s, s1->getRefExpr() }
+    }, {});
+
+    main->createCallTransition(main->getEntry(), main->getExit(), loop, {
+        { i, lit(0) }, { s, lit(0) }
+    }, {});
+    system.setMainAutomaton(main);
+
+    auto result = RemoveIrrelevantVariables(system);
+
+    EXPECT_EQ(result.numRemovedVariables, 2u);
+    ASSERT_EQ(loop->getNumInputs(), 1u);
+    EXPECT_EQ(loop->getInput(0), i);
+    EXPECT_EQ(loop->findLocalByName("i1"), i1);
+    EXPECT_EQ(loop->findLocalByName("s1"), nullptr);
+
+    for (Transition* edge : loop->edges()) {
+        if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            EXPECT_EQ(call->getNumInputs(), 1u);
+        }
+    }
+    EXPECT_EQ(llvm::cast<CallTransition>(*main->getEntry()->outgoing_begin())->getNumInputs(), 1u);
+}
+
+} // end anonymous namespace
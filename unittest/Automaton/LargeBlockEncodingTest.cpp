@@ -0,0 +1,155 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class LargeBlockEncodingTest : public AutomatonTestFixture
+{
+protected:
+    LargeBlockEncodingTest() {
+        builder = CreateFoldingExprBuilder(context);
+    }
+};
+
+TEST_F(LargeBlockEncodingTest, MergeSequentialTransitions)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* a = main->createInput("a", bv32);
+    Variable* x = main->createLocal("x", bv32);
+    Variable* y = main->createLocal("y", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+
+    main->createAssignTransition(main->getEntry(), l1, {{ x, builder->Add(a->getRefExpr(), lit(1)) }});
+    main->createAssignTransition(l1, l2, builder->BvSLt(x->getRefExpr(), lit(10)), {
+        { y, builder->Mul(x->getRefExpr(), lit(2)) }
+    });
+    main->createAssignTransition(l2, main->getExit());
+    system.setMainAutomaton(main);
+
+    auto result = EncodeLargeBlocks(system);
+
+    EXPECT_EQ(result.originalLocations, 4u);
+    EXPECT_EQ(result.remainingLocations, 2u);
+    EXPECT_EQ(result.originalTransitions, 3u);
+    EXPECT_EQ(result.remainingTransitions, 1u);
+
+    ASSERT_EQ(main->getEntry()->getNumOutgoing(), 1u);
+    auto edge = llvm::cast<AssignTransition>(*main->getEntry()->outgoing_begin());
+    EXPECT_EQ(edge->getTarget(), main->getExit());
+
+    // The guard is rewritten over the state before the transition, while
+    // the assignments are kept in their original order.
+    EXPECT_EQ(edge->getGuard(), builder->BvSLt(builder->Add(a->getRefExpr(), lit(1)), lit(10)));
+    std::vector<VariableAssignment> expected = {
+        { x, builder->Add(a->getRefExpr(), lit(1)) },
+        { y, builder->Mul(x->getRefExpr(), lit(2)) }
+    };
+    EXPECT_TRUE(std::equal(edge->begin(), edge->end(), expected.begin(), expected.end()));
+}
+
+TEST_F(LargeBlockEncodingTest, DoNotSubstituteUndef)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, lit(1));
+
+    main->createAssignTransition(main->getEntry(), l1, {{ x, builder->Undef(bv32) }});
+    main->createAssignTransition(l1, err, builder->BvSGt(x->getRefExpr(), lit(10)));
+    main->createAssignTransition(l1, main->getExit(), builder->BvSLtEq(x->getRefExpr(), lit(10)));
+    system.setMainAutomaton(main);
+
+    auto result = EncodeLargeBlocks(system);
+
+    EXPECT_EQ(result.remainingLocations, result.originalLocations);
+    EXPECT_EQ(result.remainingTransitions, result.originalTransitions);
+    EXPECT_EQ(main->getNumErrors(), 1u);
+}
+
+TEST_F(LargeBlockEncodingTest, MergeParallelTransitions)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createInput("x", bv32);
+    Variable* y = main->createLocal("y", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+
+    main->createAssignTransition(main->getEntry(), l1, builder->Eq(x->getRefExpr(), lit(1)), {{ y, lit(0) }});
+    main->createAssignTransition(main->getEntry(), l1, builder->Eq(x->getRefExpr(), lit(2)), {{ y, lit(0) }});
+    main->createAssignTransition(main->getEntry(), l2, builder->Eq(x->getRefExpr(), lit(3)), {{ y, lit(1) }});
+    main->createAssignTransition(l1, main->getExit());
+    main->createAssignTransition(l2, main->getExit());
+    system.setMainAutomaton(main);
+
+    // Keep the intermediate locations to only test parallel composition.
+    auto result = EncodeLargeBlocks(system, [l1, l2](Location* loc) { return loc == l1 || loc == l2; });
+
+    EXPECT_EQ(result.remainingLocations, 4u);
+    EXPECT_EQ(result.remainingTransitions, 4u);
+    ASSERT_EQ(l1->getNumIncoming(), 1u);
+
+    auto edge = llvm::cast<AssignTransition>(*l1->incoming_begin());
+    ASSERT_EQ(edge->getNumAssignments(), 1u);
+    EXPECT_EQ(*edge->begin(), VariableAssignment(y, lit(0)));
+    EXPECT_EQ(l2->getNumIncoming(), 1u);
+}
+
+TEST_F(LargeBlockEncodingTest, KeepCallsAndTermSizeLimit)
+{
+    Cfa* callee = system.createCfa("callee");
+    Cfa* main = system.createCfa("main");
+    Variable* a = main->createInput("a", bv32);
+    Variable* x = main->createLocal("x", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+
+    ExprPtr value = a->getRefExpr();
+    for (unsigned i = 0; i < 10; ++i) {
+        value = builder->Mul(value, builder->Add(value, lit(i + 1)));
+    }
+
+    main->createAssignTransition(main->getEntry(), l1, {{ x, value }});
+    main->createAssignTransition(l1, l2, builder->BvSLt(x->getRefExpr(), lit(10)));
+    main->createCallTransition(l2, main->getExit(), callee, {}, {});
+    system.setMainAutomaton(main);
+
+    auto result = EncodeLargeBlocks(system, nullptr, 16);
+
+    // The value of 'x' is too large to be substituted into the guard.
+    EXPECT_EQ(result.remainingLocations, result.originalLocations);
+    EXPECT_EQ(l1->getNumIncoming(), 1u);
+    EXPECT_EQ(l2->getNumOutgoing(), 1u);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,243 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class LoopAccelerationTest : public AutomatonTestFixture
+{
+protected:
+    /// Builds the automaton of a loop in the form of
+    ///     while (i <pred> n) { i = i + step; x = x + xStep; }
+    Cfa* createLoop(
+        Type& type,
+        std::function<ExprPtr(ExprPtr, ExprPtr)> predicate,
+        const ExprPtr& step,
+        const ExprPtr& xStep)
+    {
+        Cfa* loop = system.createCfa("loop");
+        Variable* i = loop->createInput("i", type);
+        Variable* x = loop->createInput("x", type);
+        Variable* n = loop->createInput("n", type);
+
+        Variable* cond = loop->createLocal("cond", BoolType::Get(context));
+        Variable* i1 = loop->createLocal("i1", type);
+        Variable* x1 = loop->createLocal("x1", type);
+        Variable* xOut = loop->createLocal("x_out", type);
+        loop->addOutput(xOut);
+
+        Location* l1 = loop->createLocation();
+        Location* l2 = loop->createLocation();
+        Location* l3 = loop->createLocation();
+        Location* l4 = loop->createLocation();
+
+        loop->createAssignTransition(loop->getEntry(), l1, builder->True());
+        loop->createAssignTransition(l1, l2, {
+            { cond, predicate(i->getRefExpr(), n->getRefExpr()) }
+        });
+        loop->createAssignTransition(l2, l3, cond->getRefExpr());
+        loop->createAssignTransition(l2, loop->getExit(), builder->Not(cond->getRefExpr()), {
+            { xOut, x->getRefExpr() }
+        });
+        loop->createAssignTransition(l3, l4, builder->True(), {
+            { i1, builder->Add(i->getRefExpr(), step) },
+            { x1, builder->Add(x->getRefExpr(), xStep) }
+        });
+        loop->createCallTransition(l4, loop->getExit(), builder->True(), loop, {
+            { i, i1->getRefExpr() },
+            { x, x1->getRefExpr() },
+            { n, n->getRefExpr() }
+        }, {
+            { xOut, xOut->getRefExpr() }
+        });
+
+        return loop;
+    }
+
+    /// Executes a single-path automaton and returns the value of its first
+    /// output, or nullptr if the exit location is not reachable.
+    ExprRef<LiteralExpr> execute(Cfa* cfa, std::vector<ExprRef<LiteralExpr>> inputs)
+    {
+        Valuation valuation;
+        for (size_t idx = 0; idx < inputs.size(); ++idx) {
+            valuation[cfa->getInput(idx)] = inputs[idx];
+        }
+
+        Location* current = cfa->getEntry();
+        while (current != cfa->getExit()) {
+            EXPECT_EQ(current->getNumOutgoing(), 1u);
+            auto edge = llvm::dyn_cast<AssignTransition>(*current->outgoing_begin());
+            if (edge == nullptr) {
+                return nullptr;
+            }
+
+            auto guard = ValuationExprEvaluator(valuation).evaluate(edge->getGuard());
+            if (!llvm::cast<BoolLiteralExpr>(guard)->isTrue()) {
+                return nullptr;
+            }
+
+            for (const VariableAssignment& assign : *edge) {
+                auto value = ValuationExprEvaluator(valuation).evaluate(assign.getValue());
+                valuation[assign.getVariable()] = llvm::cast<LiteralExpr>(value);
+            }
+
+            current = edge->getTarget();
+        }
+
+        return valuation[cfa->getOutput(0)];
+    }
+
+    static bool hasCalls(Cfa* cfa)
+    {
+        return llvm::any_of(cfa->edges(), [](Transition* edge) { return edge->isCall(); });
+    }
+};
+
+TEST_F(LoopAccelerationTest, AccelerateIncreasingBvLoop)
+{
+    auto& bv32 = BvType::Get(context, 32);
+    Cfa* loop = this->createLoop(
+        bv32,
+        [this](ExprPtr i, ExprPtr n) { return builder->BvSLt(i, n); },
+        builder->BvLit(1, 32), builder->BvLit(3, 32)
+    );
+
+    ASSERT_EQ(AccelerateLoops(system), 1u);
+    EXPECT_FALSE(hasCalls(loop));
+    EXPECT_NE(loop->findLocalByName("__loop_iterations"), nullptr);
+
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(0, 32), builder->BvLit(5, 32), builder->BvLit(1000, 32) }),
+        builder->BvLit(3005, 32)
+    );
+
+    // The loop condition does not hold initially.
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(10, 32), builder->BvLit(5, 32), builder->BvLit(3, 32) }),
+        builder->BvLit(5, 32)
+    );
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(0, 32), builder->BvLit(5, 32), builder->BvLit(-5, 32) }),
+        builder->BvLit(5, 32)
+    );
+
+    // Signed bounds work across zero.
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(-2, 32), builder->BvLit(0, 32), builder->BvLit(2, 32) }),
+        builder->BvLit(12, 32)
+    );
+}
+
+TEST_F(LoopAccelerationTest, AccelerateDecreasingIntLoop)
+{
+    auto& intTy = IntType::Get(context);
+    Cfa* loop = this->createLoop(
+        intTy,
+        [this](ExprPtr i, ExprPtr n) { return builder->GtEq(i, n); },
+        builder->IntLit(-1), builder->IntLit(2)
+    );
+
+    ASSERT_EQ(AccelerateLoops(system), 1u);
+    EXPECT_FALSE(hasCalls(loop));
+
+    // Iterates for i = 10, 9, ..., 0.
+    EXPECT_EQ(
+        execute(loop, { builder->IntLit(10), builder->IntLit(1), builder->IntLit(0) }),
+        builder->IntLit(23)
+    );
+    EXPECT_EQ(
+        execute(loop, { builder->IntLit(-1), builder->IntLit(1), builder->IntLit(0) }),
+        builder->IntLit(1)
+    );
+}
+
+TEST_F(LoopAccelerationTest, InclusiveLoopWithMaximalBoundDoesNotTerminate)
+{
+    auto& bv8 = BvType::Get(context, 8);
+    Cfa* loop = this->createLoop(
+        bv8,
+        [this](ExprPtr i, ExprPtr n) { return builder->BvULtEq(i, n); },
+        builder->BvLit(1, 8), builder->BvLit(1, 8)
+    );
+
+    ASSERT_EQ(AccelerateLoops(system), 1u);
+
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(0, 8), builder->BvLit(0, 8), builder->BvLit(9, 8) }),
+        builder->BvLit(10, 8)
+    );
+    EXPECT_EQ(
+        execute(loop, { builder->BvLit(0, 8), builder->BvLit(0, 8), builder->BvLit(255, 8) }),
+        nullptr
+    );
+}
+
+TEST_F(LoopAccelerationTest, DoNotAccelerateNonUnitCounterSteps)
+{
+    auto& bv32 = BvType::Get(context, 32);
+    Cfa* loop = this->createLoop(
+        bv32,
+        [this](ExprPtr i, ExprPtr n) { return builder->BvSLt(i, n); },
+        builder->BvLit(2, 32), builder->BvLit(3, 32)
+    );
+
+    EXPECT_EQ(AccelerateLoops(system), 0u);
+    EXPECT_TRUE(hasCalls(loop));
+}
+
+TEST_F(LoopAccelerationTest, DoNotAccelerateVariantIncrements)
+{
+    auto& bv32 = BvType::Get(context, 32);
+    Cfa* loop = this->createLoop(
+        bv32,
+        [this](ExprPtr i, ExprPtr n) { return builder->BvSLt(i, n); },
+        builder->BvLit(1, 32), builder->BvLit(3, 32)
+    );
+
+    // Make the increment of 'x' depend on the counter: x1 := x + i.
+    Variable* x1 = loop->findLocalByName("x1");
+    Variable* i = loop->findInputByName("i");
+    for (Transition* edge : loop->edges()) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge); assign && assign->getNumAssignments() == 2) {
+            Location* source = assign->getSource();
+            Location* target = assign->getTarget();
+            loop->disconnectEdge(assign);
+            loop->createAssignTransition(source, target, builder->True(), {
+                { loop->findLocalByName("i1"), builder->Add(i->getRefExpr(), builder->BvLit(1, 32)) },
+                { x1, builder->Add(loop->findInputByName("x")->getRefExpr(), i->getRefExpr()) }
+            });
+            break;
+        }
+    }
+    loop->clearDisconnectedElements();
+
+    EXPECT_EQ(AccelerateLoops(system), 0u);
+    EXPECT_TRUE(hasCalls(loop));
+}
+
+} // end anonymous namespace
@@ -19,6 +19,7 @@
 #include "gazer/Core/ExprTypes.h"
 #include "gazer/Core/LiteralExpr.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
 
 #include <llvm/Support/raw_ostream.h>
 
@@ -101,4 +102,136 @@ TEST(PathConditionTest, PredecessorTest)
     ASSERT_EQ(expected, actual);
 }
 
+TEST(PathConditionTest, InstantiateTest)
+{
+    GazerContext ctx;
+    AutomataSystem system(ctx);
+
+    Cfa* cfa = system.createCfa("main");
+    auto x = cfa->createLocal("x", IntType::Get(ctx));
+    auto y = cfa->createLocal("y", IntType::Get(ctx));
+    auto x1 = cfa->createLocal("x1", IntType::Get(ctx));
+    auto y1 = cfa->createLocal("y1", IntType::Get(ctx));
+
+    auto l2 = cfa->createLocation();
+    auto le = cfa->createErrorLocation();
+
+    auto gt = GtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(ctx, 0));
+
+    // l0 --> l2 [ x > 0 ] { y := x + 1 }
+    auto edge = cfa->createAssignTransition(cfa->getEntry(), l2, gt, {
+        { y, AddExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(ctx, 1)) }
+    });
+
+    // l2 --> ERROR [ y == 2 ]
+    cfa->createAssignTransition(l2, le, EqExpr::Create(y->getRefExpr(), IntLiteralExpr::Get(ctx, 2)));
+    cfa->createAssignTransition(l2, cfa->getExit(), BoolLiteralExpr::False(ctx));
+
+    auto builder = CreateExprBuilder(ctx);
+
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> indexMap;
+    createTopologicalSort(*cfa, topo, &indexMap);
+
+    // Only the expressions of the first edge are renamed.
+    VariableExprRewrite rewrite(*builder);
+    rewrite[x] = x1->getRefExpr();
+    rewrite[y] = y1->getRefExpr();
+
+    PathConditionCalculator pathCond(
+        topo, *builder,
+        [&indexMap](auto l) { return indexMap[l]; },
+        [&ctx](auto t) { return BoolLiteralExpr::True(ctx); },
+        nullptr,
+        [&rewrite, edge](Transition* t, const ExprPtr& expr) {
+            return t == edge ? rewrite.walk(expr) : expr;
+        }
+    );
+
+    auto expected = builder->And(
+        builder->And(
+            builder->And(builder->True(), builder->Gt(x1->getRefExpr(), builder->IntLit(0))),
+            builder->And({ builder->Eq(y1->getRefExpr(), builder->Add(x1->getRefExpr(), builder->IntLit(1))) })
+        ),
+        builder->Eq(y->getRefExpr(), builder->IntLit(2))
+    );
+
+    auto actual = pathCond.encode(cfa->getEntry(), le);
+
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(PathConditionTest, ReachabilityEncodingTest)
+{
+    GazerContext ctx;
+    AutomataSystem system(ctx);
+
+    Cfa* cfa = system.createCfa("main");
+    auto x = cfa->createLocal("x", IntType::Get(ctx));
+    auto y = cfa->createLocal("y", IntType::Get(ctx));
+
+    auto l2 = cfa->createLocation();
+    auto l3 = cfa->createLocation();
+    auto l4 = cfa->createLocation();
+    auto le = cfa->createErrorLocation();
+
+    auto gt = GtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(ctx, 0));
+
+    // l0 --> l2 { x := undef }
+    // l2 --> l3 [ x > 0 ] { y := x }
+    // l2 --> l3 [ not x > 0 ] { y := 0 }
+    // l3 --> l4 {}
+    // l4 --> ERROR [ y == 0 ]
+    cfa->createAssignTransition(cfa->getEntry(), l2, {{ x, UndefExpr::Get(IntType::Get(ctx)) }});
+    cfa->createAssignTransition(l2, l3, gt, {{ y, x->getRefExpr() }});
+    cfa->createAssignTransition(l2, l3, NotExpr::Create(gt), {{ y, IntLiteralExpr::Get(ctx, 0) }});
+    cfa->createAssignTransition(l3, l4);
+    cfa->createAssignTransition(l4, le, EqExpr::Create(y->getRefExpr(), IntLiteralExpr::Get(ctx, 0)));
+    cfa->createAssignTransition(l4, cfa->getExit(), BoolLiteralExpr::False(ctx));
+
+    auto builder = CreateExprBuilder(ctx);
+
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> indexMap;
+    createTopologicalSort(*cfa, topo, &indexMap);
+
+    auto encodeWith = [&](PathConditionEncoding encoding) {
+        PathConditionCalculator pathCond(
+            topo, *builder,
+            [&indexMap](auto l) { return indexMap[l]; },
+            [&ctx](auto t) { return BoolLiteralExpr::True(ctx); },
+            nullptr
+        );
+        pathCond.setEncoding(encoding);
+
+        return pathCond.encode(cfa->getEntry(), le);
+    };
+
+    // The last operand is the reachability variable of the target,
+    // each other operand defines a location.
+    ExprPtr reachExpr = encodeWith(PathConditionEncoding::Reachability);
+    auto reach = llvm::dyn_cast<AndExpr>(reachExpr.get());
+    ASSERT_NE(reach, nullptr);
+    EXPECT_TRUE(llvm::isa<VarRefExpr>(reach->getOperand(reach->getNumOperands() - 1).get()));
+
+    // Only l2 (branch), l3 (join) and l4 (branch) start a new block.
+    ExprPtr blockExpr = encodeWith(PathConditionEncoding::Block);
+    auto block = llvm::dyn_cast<AndExpr>(blockExpr.get());
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->getNumOperands(), 4);
+    EXPECT_LT(block->getNumOperands(), reach->getNumOperands());
+
+    // Encoding the same region again reuses the reachability variables.
+    PathConditionCalculator pathCond(
+        topo, *builder,
+        [&indexMap](auto l) { return indexMap[l]; },
+        [&ctx](auto t) { return BoolLiteralExpr::True(ctx); },
+        nullptr
+    );
+    pathCond.setEncoding(PathConditionEncoding::Reachability);
+
+    ExprPtr first = pathCond.encode(cfa->getEntry(), le);
+    EXPECT_EQ(first, pathCond.encode(cfa->getEntry(), le));
+}
+
 }
\ No newline at end of file
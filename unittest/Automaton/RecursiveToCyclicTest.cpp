@@ -0,0 +1,212 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include "AutomatonTestFixture.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class RecursiveToCyclicTest : public AutomatonTestFixture
+{
+protected:
+    /// Builds a procedure in the form of
+    ///     int name(int n) { if (n == 0) return base; ... }
+    /// The recursive case is added later with addCall.
+    Cfa* createProcedure(const std::string& name, unsigned base)
+    {
+        Cfa* cfa = system.createCfa(name);
+        Variable* n = cfa->createInput("n", bv32);
+        cfa->createLocal("r", bv32);
+        Variable* ret = cfa->createLocal("RET_VAL", bv32);
+        cfa->addOutput(ret);
+
+        cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), builder->Eq(n->getRefExpr(), builder->BvLit(0, 32)), {
+            { ret, builder->BvLit(base, 32) }
+        });
+
+        return cfa;
+    }
+
+    /// Adds the recursive case
+    ///     r = callee(n - 1); return r + extra;
+    /// to the given procedure, which is a tail call if \p extra is zero.
+    void addCall(Cfa* cfa, Cfa* callee, unsigned extra)
+    {
+        Variable* n = cfa->getInput(0);
+        Variable* r = cfa->findLocalByName("r");
+        Variable* ret = cfa->getOutput(0);
+
+        Location* l1 = cfa->createLocation();
+        Location* l2 = cfa->createLocation();
+        cfa->createAssignTransition(cfa->getEntry(), l1, builder->NotEq(n->getRefExpr(), builder->BvLit(0, 32)));
+        cfa->createCallTransition(l1, l2, builder->True(), callee, {
+            { callee->getInput(0), builder->Sub(n->getRefExpr(), builder->BvLit(1, 32)) }
+        }, {
+            { r, callee->getOutput(0)->getRefExpr() }
+        });
+
+        ExprPtr value = extra == 0 ? r->getRefExpr() : builder->Add(r->getRefExpr(), builder->BvLit(extra, 32));
+        cfa->createAssignTransition(l2, cfa->getExit(), builder->True(), {
+            { ret, value }
+        });
+    }
+
+    /// Creates a main automaton calling \p callee and failing if its result is one.
+    Cfa* createMain(Cfa* callee)
+    {
+        Cfa* main = system.createCfa("main");
+        Variable* x = main->createLocal("x", bv32);
+        Variable* y = main->createLocal("y", bv32);
+
+        Location* l1 = main->createLocation();
+        Location* l2 = main->createLocation();
+        Location* err = main->createErrorLocation();
+        main->addErrorCode(err, builder->BvLit(1, 16));
+
+        main->createAssignTransition(main->getEntry(), l1, builder->True(), {
+            { x, builder->Undef(bv32) }
+        });
+        main->createCallTransition(l1, l2, builder->True(), callee, {
+            { callee->getInput(0), x->getRefExpr() }
+        }, {
+            { y, callee->getOutput(0)->getRefExpr() }
+        });
+        main->createAssignTransition(l2, err, builder->Eq(y->getRefExpr(), builder->BvLit(1, 32)));
+        main->createAssignTransition(l2, main->getExit(), builder->NotEq(y->getRefExpr(), builder->BvLit(1, 32)));
+        system.setMainAutomaton(main);
+
+        return main;
+    }
+
+    static unsigned countCalls(Cfa* cfa)
+    {
+        unsigned numCalls = 0;
+        for (Transition* edge : cfa->edges()) {
+            numCalls += llvm::isa<CallTransition>(edge);
+        }
+
+        return numCalls;
+    }
+};
+
+TEST_F(RecursiveToCyclicTest, MutualTailRecursionBecomesCyclic)
+{
+    Cfa* even = createProcedure("even", 1);
+    Cfa* odd = createProcedure("odd", 0);
+    addCall(even, odd, 0);
+    addCall(odd, even, 0);
+    Cfa* main = createMain(even);
+    Variable* y = main->findLocalByName("y");
+
+    auto result = TransformRecursiveToCyclic(main);
+    ASSERT_NE(result.errorLocation, nullptr);
+
+    EXPECT_EQ(countCalls(main), 0u);
+
+    // Both procedures are inlined once, their results are written directly
+    // into the output argument of the original call.
+    unsigned numEntries = 0;
+    unsigned numResultWrites = 0;
+    for (Transition* edge : main->edges()) {
+        Location* original = result.inlinedLocations.lookup(edge->getTarget());
+        if (original != nullptr && original == original->getAutomaton()->getEntry()) {
+            ++numEntries;
+        }
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            for (auto& assignment : *assign) {
+                numResultWrites += assignment.getVariable() == y;
+            }
+        }
+    }
+
+    // The initial call and the two latches.
+    EXPECT_EQ(numEntries, 3u);
+    EXPECT_EQ(numResultWrites, 4u);
+}
+
+TEST_F(RecursiveToCyclicTest, NonTailMutualRecursionIsKept)
+{
+    Cfa* even = createProcedure("even", 1);
+    Cfa* odd = createProcedure("odd", 0);
+    addCall(even, odd, 0);
+    addCall(odd, even, 2);
+    Cfa* main = createMain(even);
+
+    TransformRecursiveToCyclic(main);
+
+    EXPECT_EQ(countCalls(main), 1u);
+}
+
+TEST_F(RecursiveToCyclicTest, SelfTailRecursionBecomesCyclic)
+{
+    Cfa* loop = createProcedure("loop", 1);
+    addCall(loop, loop, 0);
+    Cfa* main = createMain(loop);
+
+    auto result = TransformRecursiveToCyclic(main);
+
+    EXPECT_EQ(countCalls(main), 0u);
+
+    unsigned numLatches = 0;
+    for (Transition* edge : main->edges()) {
+        Location* source = result.inlinedLocations.lookup(edge->getSource());
+        Location* target = result.inlinedLocations.lookup(edge->getTarget());
+        if (source != nullptr && target == loop->getEntry()) {
+            ++numLatches;
+        }
+    }
+
+    EXPECT_EQ(numLatches, 1u);
+}
+
+TEST_F(RecursiveToCyclicTest, OverwrittenOutputIsNotForwarded)
+{
+    Cfa* loop = createProcedure("loop", 1);
+    Variable* n = loop->getInput(0);
+    Variable* r = loop->findLocalByName("r");
+    Variable* ret = loop->getOutput(0);
+
+    // r = loop(n - 1); r = n; return r;
+    Location* l1 = loop->createLocation();
+    Location* l2 = loop->createLocation();
+    loop->createAssignTransition(loop->getEntry(), l1, builder->NotEq(n->getRefExpr(), builder->BvLit(0, 32)));
+    loop->createCallTransition(l1, l2, builder->True(), loop, {
+        { n, builder->Sub(n->getRefExpr(), builder->BvLit(1, 32)) }
+    }, {
+        { r, ret->getRefExpr() }
+    });
+    loop->createAssignTransition(l2, loop->getExit(), builder->True(), {
+        { r, n->getRefExpr() },
+        { ret, r->getRefExpr() }
+    });
+    Cfa* main = createMain(loop);
+
+    TransformRecursiveToCyclic(main);
+
+    EXPECT_EQ(countCalls(main), 1u);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,207 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/VerdictCache.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+/// A backend which always returns the same verdict and counts its invocations.
+class FakeBackend : public VerificationAlgorithm
+{
+public:
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system, CfaTraceBuilder& traceBuilder) override
+    {
+        ++numCalls;
+        if (status == VerificationResult::Success) {
+            return VerificationResult::CreateSuccess();
+        }
+
+        if (status == VerificationResult::Timeout) {
+            return VerificationResult::CreateTimeout();
+        }
+
+        auto fail = std::make_unique<FailResult>(3, traceBuilder.build(states, actions));
+        fail->addFailure(std::make_unique<FailResult>(4));
+
+        return fail;
+    }
+
+    unsigned numCalls = 0;
+    VerificationResult::Status status = VerificationResult::Fail;
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+};
+
+/// Remembers the steps it was asked to build a trace from.
+class RecordingBuilder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        this->states = states;
+        this->actions = actions;
+
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+};
+
+class VerdictCacheTest : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    BvType& bv32 = BvType::Get(context, 32);
+    FakeBackend backend;
+    VerdictCacheSettings settings;
+
+    Variable* x;
+    Variable* f;
+
+    void SetUp() override
+    {
+        llvm::SmallString<128> directory;
+        ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("gazer-verdict-cache", directory));
+        settings.directory = directory.str().str();
+
+        Cfa* main = system.createCfa("main");
+        x = main->createLocal("x", bv32);
+        f = main->createLocal("f", FloatType::Get(context, FloatType::Double));
+        Location* l1 = main->createLocation();
+        system.setMainAutomaton(main);
+
+        backend.states = { main->getEntry(), l1 };
+        backend.actions = {
+            { { x, BvLiteralExpr::Get(bv32, 7) }, { f, UndefExpr::Get(f->getType()) } }
+        };
+    }
+
+    void TearDown() override {
+        llvm::sys::fs::remove_directories(settings.directory);
+    }
+
+    std::unique_ptr<VerificationResult> check(llvm::StringRef key, RecordingBuilder& builder)
+    {
+        VerdictCache cache(backend, key.str(), settings);
+        return cache.check(system, builder);
+    }
+
+    std::vector<std::string> listEntries()
+    {
+        std::vector<std::string> entries;
+        std::error_code ec;
+        for (llvm::sys::fs::directory_iterator it(settings.directory, ec), end; it != end && !ec; it.increment(ec)) {
+            if (llvm::sys::path::filename(it->path()).startswith("llvmcache-")) {
+                entries.push_back(it->path());
+            }
+        }
+
+        return entries;
+    }
+};
+
+TEST_F(VerdictCacheTest, RoundTripCounterexample)
+{
+    RecordingBuilder first;
+    auto stored = this->check("key", first);
+    ASSERT_TRUE(stored->isFail());
+    EXPECT_EQ(backend.numCalls, 1u);
+    EXPECT_EQ(listEntries().size(), 1u);
+
+    RecordingBuilder second;
+    auto loaded = this->check("key", second);
+    EXPECT_EQ(backend.numCalls, 1u);
+
+    ASSERT_TRUE(loaded->isFail());
+    auto fail = llvm::cast<FailResult>(loaded.get());
+    EXPECT_EQ(fail->getErrorID(), 3u);
+    EXPECT_TRUE(fail->hasTrace());
+    ASSERT_EQ(fail->getNumFailures(), 2u);
+    EXPECT_EQ(fail->other_failures().begin()->getErrorID(), 4u);
+
+    // The trace is rebuilt from the stored steps with the current builder.
+    EXPECT_EQ(second.states, backend.states);
+    ASSERT_EQ(second.actions.size(), 1u);
+    ASSERT_EQ(second.actions[0].size(), 2u);
+    EXPECT_EQ(second.actions[0][0], backend.actions[0][0]);
+    EXPECT_EQ(second.actions[0][1].getVariable(), f);
+    EXPECT_TRUE(second.actions[0][1].getValue()->isUndef());
+}
+
+TEST_F(VerdictCacheTest, RoundTripSuccess)
+{
+    backend.status = VerificationResult::Success;
+
+    RecordingBuilder builder;
+    this->check("key", builder);
+    auto loaded = this->check("key", builder);
+
+    EXPECT_EQ(backend.numCalls, 1u);
+    EXPECT_TRUE(loaded->isSuccess());
+}
+
+TEST_F(VerdictCacheTest, KeyMismatchIsMiss)
+{
+    RecordingBuilder builder;
+    this->check("key1", builder);
+    auto entries = listEntries();
+    ASSERT_EQ(entries.size(), 1u);
+    std::string first = entries[0];
+
+    backend.status = VerificationResult::Success;
+    this->check("key2", builder);
+    entries = listEntries();
+    ASSERT_EQ(entries.size(), 2u);
+    std::string second = entries[0] == first ? entries[1] : entries[0];
+
+    // Put the entry of the first key in place of the second, as if their hashes collided.
+    ASSERT_FALSE(llvm::sys::fs::copy_file(first, second));
+
+    auto result = this->check("key2", builder);
+    EXPECT_EQ(backend.numCalls, 3u);
+    EXPECT_TRUE(result->isSuccess());
+}
+
+TEST_F(VerdictCacheTest, InconclusiveVerdictsAreNotStored)
+{
+    backend.status = VerificationResult::Timeout;
+
+    RecordingBuilder builder;
+    this->check("key", builder);
+    this->check("key", builder);
+
+    EXPECT_EQ(backend.numCalls, 2u);
+    EXPECT_TRUE(listEntries().empty());
+}
+
+} // end anonymous namespace
@@ -259,5 +259,47 @@ TEST_F(ExprEvalTest, TestSignedCompareBv)
     TRUE_COMPARE(BvSGtEq, two, minusTwo);
 }
 
+TEST_F(ExprEvalTest, TestFloatArithmetic)
+{
+    auto vb = Valuation::CreateBuilder();
+    ValuationExprEvaluator eval{vb.build()};
+
+    auto rm = llvm::APFloat::rmNearestTiesToEven;
+    auto& fp32 = FloatType::Get(context, FloatType::Single);
+    auto& fp64 = FloatType::Get(context, FloatType::Double);
+
+    auto oneAndHalf = builder->FloatLit(llvm::APFloat(1.5f));
+    auto two = builder->FloatLit(llvm::APFloat(2.0f));
+    auto nan = builder->FloatLit(llvm::APFloat::getNaN(llvm::APFloat::IEEEsingle()));
+
+    EXPECT_EQ(eval.evaluate(builder->FAdd(oneAndHalf, two, rm)), builder->FloatLit(llvm::APFloat(3.5f)));
+    EXPECT_EQ(eval.evaluate(builder->FMul(oneAndHalf, two, rm)), builder->FloatLit(llvm::APFloat(3.0f)));
+    EXPECT_EQ(eval.evaluate(builder->FDiv(oneAndHalf, two, rm)), builder->FloatLit(llvm::APFloat(0.75f)));
+
+    // Rounding: 0.1 + 0.2 is not exactly 0.3 in double precision.
+    auto sum = eval.evaluate(builder->FAdd(
+        builder->FloatLit(llvm::APFloat(0.1)), builder->FloatLit(llvm::APFloat(0.2)), rm));
+    EXPECT_NE(sum, builder->FloatLit(llvm::APFloat(0.3)));
+
+    // Casts
+    EXPECT_EQ(eval.evaluate(builder->FCast(oneAndHalf, fp64, rm)), builder->FloatLit(llvm::APFloat(1.5)));
+    EXPECT_EQ(
+        eval.evaluate(builder->SignedToFp(builder->BvLit(-3, 32), fp32, rm)),
+        builder->FloatLit(llvm::APFloat(-3.0f))
+    );
+    EXPECT_EQ(
+        eval.evaluate(builder->FpToSigned(oneAndHalf, BvType::Get(context, 32), llvm::APFloat::rmTowardZero)),
+        builder->BvLit(1, 32)
+    );
+    EXPECT_TRUE(eval.evaluate(builder->FpToSigned(nan, BvType::Get(context, 32), rm))->isUndef());
+
+    // Comparisons are unordered for NaN.
+    TRUE_COMPARE(FLt, oneAndHalf, two);
+    FALSE_COMPARE(FGtEq, oneAndHalf, two);
+    FALSE_COMPARE(FEq, nan, nan);
+    FALSE_COMPARE(FLtEq, nan, two);
+    EXPECT_EQ(eval.evaluate(builder->FIsNan(nan)), builder->True());
+}
+
 #undef TRUE_COMPARE
 #undef FALSE_COMPARE
\ No newline at end of file
@@ -0,0 +1,133 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Z3Solver/Z3ChcVerifier.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class RecordingTraceBuilder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        mStates = states;
+        mActions = actions;
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    std::vector<Location*> mStates;
+    std::vector<std::vector<VariableAssignment>> mActions;
+};
+
+/// Builds the following program:
+///     int loop(int i) { return i < 10 ? loop(i + 1) : i; }
+///     int main() { int x = loop(0); if (x == 10) error(); }
+/// If \p safe is true, the condition of the error is (x != 10) instead.
+std::unique_ptr<AutomataSystem> buildLoopSystem(GazerContext& ctx, bool safe)
+{
+    auto system = std::make_unique<AutomataSystem>(ctx);
+    auto& intTy = BvType::Get(ctx, 32);
+    auto& errTy = BvType::Get(ctx, 16);
+    auto lit = [&intTy](unsigned value) { return BvLiteralExpr::Get(intTy, llvm::APInt(32, value)); };
+
+    Cfa* loop = system->createCfa("loop");
+    auto i = loop->createInput("i", intTy);
+    auto res = loop->createLocal("res", intTy);
+    auto rec = loop->createLocal("rec", intTy);
+    loop->addOutput(res);
+
+    auto l1 = loop->createLocation();
+    auto cond = BvSLtExpr::Create(i->getRefExpr(), lit(10));
+    loop->createCallTransition(
+        loop->getEntry(), l1, cond, loop,
+        {{i, AddExpr::Create(i->getRefExpr(), lit(1))}}, {{rec, res->getRefExpr()}}
+    );
+    loop->createAssignTransition(l1, loop->getExit(), {{res, rec->getRefExpr()}});
+    loop->createAssignTransition(
+        loop->getEntry(), loop->getExit(), NotExpr::Create(cond), {{res, i->getRefExpr()}}
+    );
+
+    Cfa* main = system->createCfa("main");
+    auto x = main->createLocal("x", intTy);
+    auto m1 = main->createLocation();
+    auto err = main->createErrorLocation();
+    main->addErrorCode(err, BvLiteralExpr::Get(errTy, llvm::APInt(16, 2)));
+
+    main->createCallTransition(main->getEntry(), m1, loop, {{i, lit(0)}}, {{x, res->getRefExpr()}});
+
+    ExprPtr errCond = EqExpr::Create(x->getRefExpr(), lit(10));
+    if (safe) {
+        errCond = NotExpr::Create(errCond);
+    }
+    main->createAssignTransition(m1, err, errCond);
+    main->createAssignTransition(m1, main->getExit(), NotExpr::Create(errCond));
+
+    system->setMainAutomaton(main);
+    return system;
+}
+
+TEST(Z3ChcVerifierTest, RecursiveSafe)
+{
+    GazerContext ctx;
+    auto system = buildLoopSystem(ctx, true);
+
+    RecordingTraceBuilder traceBuilder;
+    Z3ChcVerifier verifier(ChcSettings{});
+
+    auto result = verifier.check(*system, traceBuilder);
+    EXPECT_TRUE(result->isSuccess());
+}
+
+TEST(Z3ChcVerifierTest, RecursiveFail)
+{
+    GazerContext ctx;
+    auto system = buildLoopSystem(ctx, false);
+
+    RecordingTraceBuilder traceBuilder;
+    ChcSettings settings;
+    settings.trace = true;
+    Z3ChcVerifier verifier(settings);
+
+    auto result = verifier.check(*system, traceBuilder);
+    ASSERT_TRUE(result->isFail());
+    EXPECT_EQ(llvm::cast<FailResult>(*result).getErrorID(), 2);
+
+    Cfa* main = system->getMainAutomaton();
+    Cfa* loop = system->getAutomatonByName("loop");
+
+    auto& states = traceBuilder.mStates;
+    ASSERT_EQ(states.size(), traceBuilder.mActions.size() + 1);
+    ASSERT_FALSE(states.empty());
+    EXPECT_EQ(states.front(), main->getEntry());
+    EXPECT_TRUE(states.back()->isError());
+
+    // The loop is entered eleven times, once for each value of 'i' in [0, 10].
+    unsigned numEntries = std::count(states.begin(), states.end(), loop->getEntry());
+    EXPECT_EQ(numEntries, 11);
+}
+
+} // end anonymous namespace